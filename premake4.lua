@@ -101,6 +101,15 @@ solution "simhub"
                 "src/test/**.h", 
                 "src/test/**.cpp", 
                 "src/app/simhub.cpp",
+                "src/libs/plugins/prepare3d/ProsimStreamParser/**.cpp",
+                "src/libs/plugins/prepare3d/ProsimWriteQueue/**.cpp",
+                "src/libs/plugins/pokey/PollScheduler/**.cpp",
+                "src/libs/plugins/pokey/PinRemapArbiter/**.cpp",
+                "src/libs/plugins/pokey/FrameFlusher/**.cpp",
+                "src/libs/plugins/pokey/SegmentDisplay/**.cpp",
+                "src/libs/plugins/pokey/EncoderAccumulator/**.cpp",
+                "src/libs/plugins/pokey/drivers/PokeyMAX7219Manager/MAX7219FrameBuffer.cpp",
+                "src/libs/plugins/pokey/drivers/PokeySwitchMatrixManager/SwitchScanPlan.cpp",
                 "src/libs/googletest/src/gtest-all.cc" }
 
         configuration {"Debug"}
@@ -135,6 +144,16 @@ solution "simhub"
             links { "boost_thread-mt" }
         configuration {}
 
+    project "prosimparser_bench"
+        kind "ConsoleApp"
+        language "C++"
+        files { "src/bench/prosimparser_bench.cpp",
+                "src/libs/plugins/prepare3d/ProsimStreamParser/**.cpp" }
+        includedirs { "src",
+                      "src/libs" }
+        targetdir ("bin")
+        buildoptions { "--std=c++14", "-O2" }
+
     project "prepare3d_plugin"
             kind "SharedLib"
                 language "C++"
@@ -145,8 +164,7 @@ solution "simhub"
                 'pthread'}
         files { "src/libs/plugins/prepare3d/**.h",
                 "src/libs/plugins/common/**.cpp",
-                "src/libs/plugins/prepare3d/**.cpp",
-                "src/common/elements/attributes/attribute.cpp" }
+                "src/libs/plugins/prepare3d/**.cpp" }
         includedirs { "src/libs/googletest/include", 
                       "src/libs/googletest", 
                       "src/common",
@@ -196,8 +214,7 @@ solution "simhub"
                 "uv" }
         files { "src/libs/plugins/pokey/**.h",
                 "src/libs/plugins/common/**.cpp",
-                "src/libs/plugins/pokey/**.cpp",
-                "src/common/elements/attributes/attribute.cpp" }
+                "src/libs/plugins/pokey/**.cpp" }
         includedirs { "src/libs/googletest/include", 
                       "src/libs/googletest", 
                       "src/common",
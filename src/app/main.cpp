@@ -40,7 +40,6 @@ void configureCli(cmdline::parser *cli)
 //! this static allows the signal handlers to control shutdown/restart logic in main()
 static bool ReloadRestart = false;
 
-// TODO: handle SIGHUP for settings reload
 void sigint_handler(int sigid)
 {
     if (sigid == SIGINT) {
@@ -49,11 +48,19 @@ void sigint_handler(int sigid)
         SimHubEventController::EventControllerInstance()->ceaseEventLoop();
         ReloadRestart = false;
     }
-    else if (sigid == SIGHUP || sigid == SIGQUIT) {
-        // tell app event loop to end on control+h
-        // -- destroy and reload event controller
-        // -- cheat a little and capture SIGQUIT so we can use ctrl+\
-		//    as keyboard shortcut for this
+    else if (sigid == SIGHUP) {
+        // -- reread the mapping file and swap it in between events, the
+        //    plugins and their connections stay up
+        SimHubEventController::EventControllerInstance()->requestMappingReload();
+    }
+    else if (sigid == SIGUSR1) {
+        // -- start or stop recording the event stream to a new log
+        SimHubEventController::EventControllerInstance()->toggleEventRecording();
+    }
+    else if (sigid == SIGQUIT) {
+        // tell app event loop to end on control+\ (SIGQUIT)
+        // -- destroy and reload event controller, for changes a mapping
+        //    reload can't pick up (plugins, coalesced elements)
 
         logger.log(LOG_INFO, "Reload simhub, this may take a couple seconds...");
         ReloadRestart = true;
@@ -79,25 +86,22 @@ void run_simhub(const cmdline::parser &cli)
     simhubController->enableKinesis();
 #endif
 
-    if (simhubController->loadPokeyPlugin()) {
-        if (simhubController->loadPrepare3dPlugin()) {
-            // kick off the simhub envent loop
+    if (simhubController->loadPlugins()) {
+        // kick off the simhub envent loop
 
-            simhubController->runEventLoop([=](std::shared_ptr<Attribute> value) {
-                bool deliveryResult = simhubController->deliverValue(value);
+        simhubController->runBatchedEventLoop([=](EventBatch &values) {
+            bool deliveryResult = simhubController->deliverValues(values);
 
 #if defined(_AWS_SDK)
+            for (const EventValue &value : values) {
                 simhubController->deliverKinesisValue(value);
+            }
 #endif
-                return deliveryResult;
-            });
-        }
-        else {
-            logger.log(LOG_ERROR, "error loading prepare3d plugin");
-        }
+            return deliveryResult;
+        });
     }
     else {
-        logger.log(LOG_ERROR, "Could not load pokey plugin");
+        logger.log(LOG_ERROR, "Could not load plugins");
     }
 }
 
@@ -108,6 +112,7 @@ int main(int argc, char *argv[])
     sigaction(SIGINT, &act, NULL);
     sigaction(SIGHUP, &act, NULL);
     sigaction(SIGQUIT, &act, NULL);
+    sigaction(SIGUSR1, &act, NULL);
 
     cmdline::parser cli;
     configureCli(&cli);
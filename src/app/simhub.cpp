@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <chrono>
+#include <string.h>
 #include <utility>
 
 #include "common/configmanager/configmanager.h"
@@ -32,11 +33,17 @@ void SimHubEventController::DestroyEventControllerInstance(void)
 }
 
 SimHubEventController::SimHubEventController()
+    : _pendingRouting(NULL)
+    , _reloadRequested(false)
+    , _reloadThreadRunning(false)
+    , _eventStrings(EVENT_STRING_CAPACITY)
+    , _namedEventTicket(0)
+    , _unresolvedCount(0)
 {
-    _prepare3dMethods.plugin_instance = NULL;
-    _pokeyMethods.plugin_instance = NULL;
     _configManager = NULL;
     _running = false;
+    _eventBatchSize = DEFAULT_EVENT_BATCH_SIZE;
+    generic_pool_init(&_deliveryPool);
 
 #if defined(_AWS_SDK)
     _awsHelper.init();
@@ -138,7 +145,7 @@ std::string libconfigToJSON(std::string configFilename)
  */
 void SimHubEventController::httpGETConfigurationHandler(web::http::http_request request)
 {
-    std::string config_json = libconfigToJSON(_configManager->pokeyConfigurationFilename());
+    std::string config_json = libconfigToJSON(_configManager->pluginConfigurationFilename("pokey"));
     request.reply(web::http::status_codes::OK, config_json);
 }
 
@@ -164,6 +171,8 @@ SimHubEventController::~SimHubEventController(void)
         terminate();
     }
 
+    stopReloadThread();
+
 #if defined(_AWS_SDK)
     if (_awsHelper.polly()) {
         _awsHelper.polly()->shutdown();
@@ -175,66 +184,47 @@ SimHubEventController::~SimHubEventController(void)
 
     _awsHelper.shutdown();
 #endif
+
+    generic_pool_destroy(&_deliveryPool);
 }
 
 #if defined(_AWS_SDK)
 void SimHubEventController::startSustainThread(void)
 {
     _awsHelper.polly()->say("Simulator is ready.");
-    std::shared_ptr<std::thread> sustainThread = std::make_shared<std::thread>([=] {
-        _sustainThreadManager.setThreadRunning(true);
-        while (!_sustainThreadManager.threadCanceled()) {
-            std::this_thread::sleep_for(100ms);
-
-            // build up list of values that need to be resent to kinesis
-            // due to expiration of their sustain timer
-            std::lock_guard<std::mutex> sustainGuard(_sustainValuesMutex);
-
-            std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
-
-            for (std::pair<std::string, SustainMapEntry> entry: _sustainValues) {
-                std::chrono::milliseconds sustain = entry.second.first;
-                std::chrono::milliseconds ts = entry.second.second->timestamp();
 
-                if ((ts + sustain) <= now) {
-                    entry.second.second->resetTimestamp();
-                    logger.log(LOG_INFO, "sustaining value: %s", entry.second.second->name().c_str());
-                    deliverKinesisValue(entry.second.second);
-                }
-            }
-        }
-        _sustainThreadManager.setThreadRunning(false);
-    });
+    // resent values go to kinesis with their timestamp moved to now
+    _sustainScheduler.reset(new SustainScheduler([this](const EventValue &value) {
+        logger.log(LOG_INFO, "sustaining value: %s", _configManager->mapManager()->symbols().name(value.elementId).c_str());
+        deliverKinesisValue(value);
+    }));
 
-    _sustainThreadManager.setManagedThread(sustainThread);
+    _sustainScheduler->start();
 }
 
 void SimHubEventController::ceaseSustainThread(void)
 {
-    _sustainThreadManager.shutdownThread();
+    _sustainScheduler->stop();
+    logger.log(LOG_INFO, "Sustained %lu element(s), %lu value(s) resent", _sustainScheduler->sustainedCount(), _sustainScheduler->resentCount());
 }
 
-void SimHubEventController::deliverKinesisValue(std::shared_ptr<Attribute> value)
+//! hands the value to the sustain scheduler if the element is sustained
+void SimHubEventController::updateSustainValue(const EventValue &value)
 {
-    std::string name = value->name();
-    std::string val = value->valueToString();
-    std::string ts = value->timestampAsString();
-    std::string description = value->description();
-    std::string units = value->units();
+    unsigned int sustainPeriod = _routing->mapping->sustainPeriod(value.elementId);
 
-    // {s:"a",t:"b",v:"123", ts:121}
-    std::stringstream ss;
-
-    ss << "{ \"s\" : \"" << name << "\", \"val\" : \"" << val << "\", \"ts\" : \"" << ts << "\", \"d\" : \"" << description << "\", \"u\":\"" << units << "\"}";
-    std::string dataString = ss.str();
-
-    Aws::Utils::ByteBuffer data(dataString.length());
-
-    for (int i = 0; i < dataString.length(); i++) {
-        data[i] = dataString[i];
+    if (sustainPeriod > 0) {
+        _sustainScheduler->update(value, sustainPeriod);
     }
+}
 
-    _awsHelper.kinesis()->putRecord(data);
+//! called from the event and the sustain threads, each encodes into a buffer of its own
+void SimHubEventController::deliverKinesisValue(const EventValue &value)
+{
+    static thread_local std::string record;
+
+    _telemetryEncoder->encode(value, record);
+    _awsHelper.kinesis()->putRecord(record);
 }
 
 void SimHubEventController::enablePolly(void)
@@ -251,19 +241,218 @@ void SimHubEventController::enableKinesis(void)
     std::string region;
     std::string stream;
     std::string partition;
+    std::string endpoint;
+    std::string formatName = "json";
+    TelemetryFormat format = TELEMETRY_JSON;
+    RecordBatcherConfiguration batching = RecordBatcher::DefaultConfiguration();
+    int capacity = batching.capacity;
+    int maxBatchRecords = batching.maxBatchRecords;
+    int maxBatchSize = batching.maxBatchSize;
+    int maxAggregateSize = batching.maxAggregateSize;
+    RecordSpoolConfiguration spooling = RecordSpool::DefaultConfiguration("");
+    int segmentSize = spooling.segmentSize;
+    int maxSpoolSize = spooling.maxSize / 1048576;
     // read the configuration values
     aws.lookupValue("region", region);
     kinesis.lookupValue("stream", stream);
     kinesis.lookupValue("partition", partition);
+    kinesis.lookupValue("endpoint", endpoint);
+    kinesis.lookupValue("format", formatName);
+    kinesis.lookupValue("capacity", capacity);
+    kinesis.lookupValue("maxBatchRecords", maxBatchRecords);
+    kinesis.lookupValue("maxBatchSize", maxBatchSize);
+    kinesis.lookupValue("maxAggregateSize", maxAggregateSize);
+    kinesis.lookupValue("linger", batching.linger);
+    kinesis.lookupValue("maxRetries", batching.maxRetries);
+    kinesis.lookupValue("retryBackoff", batching.retryBackoff);
+    // PutRecords takes at most 500 records and 5MB, a record at most 1MB
+    batching.capacity = capacity;
+    batching.maxBatchRecords = std::min(maxBatchRecords, BATCHER_DEFAULT_MAX_BATCH_RECORDS);
+    batching.maxBatchSize = std::min(maxBatchSize, BATCHER_DEFAULT_MAX_BATCH_SIZE);
+    batching.maxAggregateSize = std::min(maxAggregateSize, 1048576);
+
+    if (kinesis.exists("spool")) {
+        const libconfig::Setting &spool = kinesis.lookup("spool");
+        spool.lookupValue("directory", spooling.directory);
+        spool.lookupValue("segmentSize", segmentSize);
+        spool.lookupValue("maxSize", maxSpoolSize);
+        spooling.segmentSize = segmentSize;
+        spooling.maxSize = (size_t)maxSpoolSize * 1048576;
+    }
+
+    if (!TelemetryFormatFromString(formatName, &format)) {
+        logger.log(LOG_ERROR, "Unknown kinesis record format '%s' - using 'json'", formatName.c_str());
+    }
+
+    _telemetryEncoder.reset(new TelemetryEncoder(_configManager->mapManager()->symbols(), _eventStrings, format));
     // initialise the kinesis helper
-    _awsHelper.initKinesis(stream, partition, region);
+    _awsHelper.initKinesis(stream, partition, region, endpoint, batching, spooling);
 }
 
 #endif
 
 void SimHubEventController::setConfigManager(ConfigManager *configManager)
 {
+    assert(!_running);
+
     _configManager = configManager;
+
+    QueueOverflowPolicy overflowPolicy = OVERFLOW_BLOCK;
+    std::string overflowPolicyName = _configManager->eventQueueOverflowPolicy();
+
+    if (!QueueOverflowPolicyFromString(overflowPolicyName, &overflowPolicy)) {
+        logger.log(LOG_ERROR, "Unknown event queue overflow policy '%s' - using 'block'", overflowPolicyName.c_str());
+    }
+
+    // coalescing overflow keeps only the latest value per element
+    _eventQueue.setCoalesceKey([](const EventValue &value) { return std::to_string(value.elementId); });
+
+    // a coalesced element is queued once while its slot is dirty, so a
+    // dropped one has to clean the slot for the element to be queued again
+    _eventQueue.setDropCallback([this](const EventValue &value) {
+        if (value.elementId == INVALID_ELEMENT_ID) {
+            std::lock_guard<std::mutex> lock(_namedEventsMutex);
+            _namedEvents.erase(value.value.int_value);
+            return;
+        }
+
+        int slot = _eventCoalescer.slotForId(value.elementId);
+
+        if (slot != COALESCER_NO_SLOT) {
+            _eventCoalescer.release(slot);
+        }
+    });
+    _eventQueue.configure(_configManager->eventQueueCapacity(), overflowPolicy);
+    _eventBatchSize = std::max((size_t)1, _configManager->eventBatchSize());
+
+    logger.log(LOG_INFO, "Event queue capacity %lu (%s on overflow)", _eventQueue.capacity(), overflowPolicyName.c_str());
+
+    _coalescedElements = _configManager->mapManager()->snapshot()->coalesceSet;
+    _eventCoalescer.configure(_coalescedElements);
+
+    if (_eventCoalescer.enabled()) {
+        logger.log(LOG_INFO, "Coalescing the latest value of %lu element(s)", _eventCoalescer.slotCount());
+    }
+
+    EventRecorderConfiguration recorder = _configManager->eventRecorderConfiguration();
+    _eventRecorder.reset(new EventRecorder(_configManager->mapManager()->symbols(), _eventStrings, recorder));
+
+    logger.log(LOG_INFO, "Event recording to %s %s (SIGUSR1 toggles)", recorder.directory.c_str(), recorder.enabled ? "on" : "off");
+}
+
+//! queues an event, collapsing it into its pending slot for coalesced elements
+void SimHubEventController::enqueueEvent(const EventValue &value)
+{
+    int slot = _eventCoalescer.slotForId(value.elementId);
+
+    if (slot == COALESCER_NO_SLOT || _eventCoalescer.offer(slot, value)) {
+        _eventQueue.push(value);
+    }
+}
+
+/**
+ * swaps a coalesced element popped off the queue for its latest
+ * value - returns false when that value has already been delivered
+ */
+bool SimHubEventController::resolveCoalescedEvent(EventValue &value)
+{
+    int slot = _eventCoalescer.slotForId(value.elementId);
+
+    if (slot != COALESCER_NO_SLOT) {
+        return _eventCoalescer.take(slot, value);
+    }
+
+    return true;
+}
+
+void SimHubEventController::resolveCoalescedEvents(EventBatch &values)
+{
+    if (!_eventCoalescer.enabled()) {
+        return;
+    }
+
+    EventBatch::iterator out = values.begin();
+
+    for (EventValue &value : values) {
+        if (resolveCoalescedEvent(value)) {
+            *out++ = value;
+        }
+    }
+
+    values.erase(out, values.end());
+}
+
+/**
+ * slow path for an event whose name isn't in the symbol table yet -
+ * the event is held by name and a placeholder carrying its ticket is
+ * queued in its place, so the event thread interns the name and the
+ * event keeps its place in the stream
+ */
+void SimHubEventController::enqueueNamedEvent(const char *name, const EventValue &value)
+{
+    EventValue placeholder;
+
+    memset(&placeholder, 0, sizeof(EventValue));
+    placeholder.elementId = INVALID_ELEMENT_ID;
+    placeholder.owner = value.owner;
+    placeholder.timestamp = value.timestamp;
+
+    {
+        std::lock_guard<std::mutex> lock(_namedEventsMutex);
+        placeholder.value.int_value = ++_namedEventTicket;
+        _namedEvents[placeholder.value.int_value] = { name, value };
+    }
+
+    _eventQueue.push(placeholder);
+}
+
+/**
+ * swaps a placeholder popped off the queue for the event it stands
+ * for, interning its name - returns false when the symbol table is
+ * full and the event can't be given an id
+ */
+bool SimHubEventController::resolveNamedEvent(EventValue &value)
+{
+    if (value.elementId != INVALID_ELEMENT_ID) {
+        return true;
+    }
+
+    NamedEvent named;
+
+    {
+        std::lock_guard<std::mutex> lock(_namedEventsMutex);
+        std::map<uint64_t, NamedEvent>::iterator it = _namedEvents.find(value.value.int_value);
+
+        if (it == _namedEvents.end()) {
+            return false;
+        }
+
+        named = it->second;
+        _namedEvents.erase(it);
+    }
+
+    value = named.value;
+    value.elementId = _configManager->mapManager()->symbols().intern(named.name);
+
+    if (value.elementId == INVALID_ELEMENT_ID) {
+        _unresolvedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+void SimHubEventController::resolveNamedEvents(EventBatch &values)
+{
+    EventBatch::iterator out = values.begin();
+
+    for (EventValue &value : values) {
+        if (resolveNamedEvent(value)) {
+            *out++ = value;
+        }
+    }
+
+    values.erase(out, values.end());
 }
 
 void SimHubEventController::ceaseEventLoop(void)
@@ -271,81 +460,135 @@ void SimHubEventController::ceaseEventLoop(void)
     _eventQueue.unblock();
 }
 
-bool SimHubEventController::deliverValue(std::shared_ptr<Attribute> value)
+//! maps an event owner id back onto the plugin instance
+SPHANDLE SimHubEventController::ownerPlugin(EventOwnerID owner)
 {
-    assert(_pokeyMethods.simplug_deliver_value);
+    return owner > EVENT_OWNER_NONE && owner <= _plugins.size() ? _plugins[owner - 1]->methods.plugin_instance : NULL;
+}
 
-    GenericTLV *c_value = AttributeToCGeneric(value);
+//! C generic for handing value to a plugin, owned by the host delivery pool
+GenericTLV *SimHubEventController::deliverableValue(const EventValue &value)
+{
+    GenericTLV *retVal = EventValueToCGeneric(value, _configManager->mapManager()->symbols(), _eventStrings, &_deliveryPool);
+    retVal->ownerPlugin = ownerPlugin(value.owner);
+    return retVal;
+}
 
-    bool retVal = false;
+/**
+ * queues a value for every destination the routing table has for its
+ * element - elements without a mapping go to every plugin but the
+ * one the value came from. Each destination's worker hands it over
+ */
+bool SimHubEventController::deliverValue(const EventValue &value)
+{
+    if (_pendingRouting.load(std::memory_order_relaxed)) {
+        adoptPendingRoutes();
+    }
 
 #if defined(_AWS_SDK)
-    if (mapContains(_configManager->mapManager()->sustainMap(), value->name())) {
-        // update the sustain value map entry
-        std::lock_guard<std::mutex> sustainGuard(_sustainValuesMutex);
-        _sustainValues[value->name()].second = value;
-        _sustainValues[value->name()].first = std::chrono::milliseconds(_configManager->mapManager()->sustainMap()[value->name()]);
-    }
+    updateSustainValue(value);
 #endif
 
-    // determine value destination from the source - very simple at the moment
-    // (just deliver to whatever instance is not the source) - may want more
-    // sophisticated logic here
+    for (const Route &route : _routing->routes.routes(value.elementId)) {
+        if ((route.skipSource && route.owner == value.owner) || !route.methods->plugin_instance) {
+            continue;
+        }
 
-    if (value->ownerPlugin() == _pokeyMethods.plugin_instance) {
-        retVal = !_prepare3dMethods.simplug_deliver_value(_prepare3dMethods.plugin_instance, c_value);
-    }
-    else if (value->ownerPlugin() == _prepare3dMethods.plugin_instance) {
+        EventValue routedValue = value;
+
+        if (route.target != INVALID_ELEMENT_ID) {
+            routedValue.elementId = route.target;
+        }
 
 #if defined(_AWS_SDK)
-        if (value->name() == "N_ELEC_PANEL_LOWER_LEFT") {
-                  _awsHelper.polly()->say("dc volts %i", c_value->value);
+        if (routedValue.elementId == _routing->dcVoltsElement && routedValue.elementId != INVALID_ELEMENT_ID) {
+            _awsHelper.polly()->say("dc volts %i", (int)routedValue.value.int_value);
         }
 #endif
 
-        retVal = !_pokeyMethods.simplug_deliver_value(_pokeyMethods.plugin_instance, c_value);
+        _workers[route.owner]->push(routedValue);
     }
 
-    return retVal;
+    return true;
 }
 
-// these callbacks will be called from the thread of the event
-// generator which is assumed to not be the thread of the for loop
-// below
-
-void SimHubEventController::prepare3dEventCallback(SPHANDLE eventSource, void *eventData)
+//! hands a group of values to a plugin in one call when it supports it
+bool SimHubEventController::deliverBatch(simplug_vtable &pluginMethods, std::vector<GenericTLV *> &values)
 {
-    // event source will pass through NULL in event of error
-    if (eventData) {
-        GenericTLV *data = static_cast<GenericTLV *>(eventData);
-        assert(data != NULL);
+    bool retVal = true;
 
-        std::shared_ptr<Attribute> attribute = AttributeFromCGeneric(data);
-        MapEntry *mapEntry;
+    if (values.empty()) {
+        return retVal;
+    }
 
-        if (_configManager->mapManager()->find(data->name, &mapEntry)) {
-            _eventQueue.push(attribute);
+    if (pluginMethods.simplug_deliver_values) {
+        retVal = !pluginMethods.simplug_deliver_values(pluginMethods.plugin_instance, values.data(), values.size());
+    }
+    else {
+        for (GenericTLV *value : values) {
+            retVal = !pluginMethods.simplug_deliver_value(pluginMethods.plugin_instance, value) && retVal;
         }
+    }
 
-        release_generic(data);
+    for (GenericTLV *value : values) {
+        release_generic(value);
     }
-    else {
-        ceaseEventLoop();
+
+    values.clear();
+
+    return retVal;
+}
+
+//! queues every value of a batch for its destinations, in the order they were queued
+bool SimHubEventController::deliverValues(EventBatch &values)
+{
+    bool retVal = true;
+
+    for (const EventValue &value : values) {
+        retVal = deliverValue(value) && retVal;
+    }
+
+    return retVal;
+}
+
+/**
+ * delivery function of a plugin's worker - runs on the worker thread,
+ * each plugin sees one delivery call per batch
+ */
+bool SimHubEventController::deliverToPlugin(PluginSlot *plugin, EventBatch &values)
+{
+    for (const EventValue &value : values) {
+        plugin->batch.push_back(deliverableValue(value));
     }
+
+    return deliverBatch(plugin->methods, plugin->batch);
 }
 
-void SimHubEventController::pokeyEventCallback(SPHANDLE eventSource, void *eventData)
+//! converts a plugin generic into an event and queues it
+void SimHubEventController::pluginEventCallback(EventOwnerID owner, void *eventData)
 {
     // event source will pass through NULL in event of error
     if (eventData) {
         GenericTLV *data = static_cast<GenericTLV *>(eventData);
         assert(data != NULL);
 
-        std::shared_ptr<Attribute> attribute = AttributeFromCGeneric(data);
-        MapEntry *mapEntry;
+        // plugins that haven't bound the symbol resolver leave the id unset - every
+        // configured name is already in the table, so the lookup doesn't intern
+        if (data->element_id == INVALID_ELEMENT_ID) {
+            data->element_id = _configManager->mapManager()->symbols().find(data->name);
+        }
 
-        if (_configManager->mapManager()->find(data->name, &mapEntry)) {
-            _eventQueue.push(attribute);
+        if (data->type == CONFIG_STRING && data->value.string_value && strlen(data->value.string_value) >= EVENT_STRING_SLOT_SIZE) {
+            logger.log(LOG_ERROR, "WARNING | %s value is longer than %i characters and is cut short", data->name, EVENT_STRING_SLOT_SIZE - 1);
+        }
+
+        // nothing is configured for a name that isn't known, but the
+        // event still goes to every plugin, kinesis and the recorder
+        if (data->element_id != INVALID_ELEMENT_ID) {
+            enqueueEvent(EventValueFromCGeneric(data, owner, _eventStrings));
+        }
+        else {
+            enqueueNamedEvent(data->name, EventValueFromCGeneric(data, owner, _eventStrings));
         }
 
         release_generic(data);
@@ -355,6 +598,22 @@ void SimHubEventController::pokeyEventCallback(SPHANDLE eventSource, void *event
     }
 }
 
+/**
+ * resolves a plugin's element names - names from its configuration are
+ * interned while it's set up, once it's eventing names are only looked
+ * up so producer threads never take the table's lock or fill it
+ */
+ElementID SimHubEventController::ResolveElementSymbol(const char *name, void *arg)
+{
+    PluginSlot *plugin = static_cast<PluginSlot *>(arg);
+
+    assert(plugin && plugin->controller && plugin->controller->_configManager);
+
+    ElementSymbolTable &symbols = plugin->controller->_configManager->mapManager()->symbols();
+
+    return plugin->configuring.load(std::memory_order_acquire) ? symbols.intern(name) : symbols.find(name);
+}
+
 void SimHubEventController::LoggerWrapper(const int category, const char *msg, ...)
 {
     // TODO: make logger a class instance member
@@ -367,12 +626,12 @@ void SimHubEventController::LoggerWrapper(const int category, const char *msg, .
     logger.log(category, buff);
 }
 
-simplug_vtable SimHubEventController::loadPlugin(std::string dylibName, libconfig::Config *pluginConfig, EnqueueEventHandler eventCallback)
+simplug_vtable SimHubEventController::loadPlugin(std::string dylibName, libconfig::Config *pluginConfig, EnqueueEventHandler eventCallback, void *eventArg)
 {
     SPHANDLE pluginInstance = NULL;
     simplug_vtable pluginMethods;
 
-    memset(&pluginMethods, sizeof(simplug_vtable), 0);
+    memset(&pluginMethods, 0, sizeof(simplug_vtable));
 
     // TODO: use correct path
     std::string fullPath("plugins/");
@@ -390,12 +649,18 @@ simplug_vtable SimHubEventController::loadPlugin(std::string dylibName, libconfi
 
         pluginMethods.simplug_config_passthrough(pluginInstance, pluginConfig);
 
+        // share the element symbol table so the plugin can resolve its
+        // configured names to ids before preflight
+        if (pluginMethods.simplug_bind_symbol_resolver) {
+            pluginMethods.simplug_bind_symbol_resolver(pluginInstance, &SimHubEventController::ResolveElementSymbol, eventArg);
+        }
+
         // TODO: add error checking
 
         if (pluginMethods.simplug_preflight_complete(pluginInstance) == 0) {
             // proxy the C style lambda call through to the member
             // function above
-            pluginMethods.simplug_commence_eventing(pluginInstance, eventCallback, this);
+            pluginMethods.simplug_commence_eventing(pluginInstance, eventCallback, eventArg);
         }
         else {
             pluginMethods.simplug_release(pluginInstance);
@@ -406,25 +671,276 @@ simplug_vtable SimHubEventController::loadPlugin(std::string dylibName, libconfi
     return pluginMethods;
 }
 
-bool SimHubEventController::loadPrepare3dPlugin(void)
+/**
+ * adds a plugin to load - its EventOwnerID is fixed here, before it's
+ * loaded, as its events carry it from the moment eventing commences
+ */
+void SimHubEventController::addPlugin(std::string name, std::string library, libconfig::Config *pluginConfig, const DeliveryQueueConfiguration &delivery)
+{
+    assert(!_running);
+
+    std::unique_ptr<PluginSlot> plugin(new PluginSlot);
+
+    plugin->name = name;
+    plugin->library = library;
+    plugin->config = pluginConfig;
+    plugin->controller = this;
+    plugin->configuring.store(false, std::memory_order_relaxed);
+    plugin->delivery = delivery;
+    memset(&plugin->methods, 0, sizeof(simplug_vtable));
+
+    // every routing table compiled later adds the plugins in this order
+    // so the owner ids stay the same across reloads
+    if (_plugins.size() + 1 >= ROUTING_MAX_PLUGINS) {
+        logger.log(LOG_ERROR, "Too many plugins, can't load %s (at most %i)", name.c_str(), ROUTING_MAX_PLUGINS - 1);
+        return;
+    }
+
+    plugin->owner = (EventOwnerID)(_plugins.size() + 1);
+    _plugins.push_back(std::move(plugin));
+}
+
+//! loads every plugin in the order they were added, then compiles the routes between them
+bool SimHubEventController::loadPlugins(void)
+{
+    // the event callback finds its plugin through the slot address
+    auto eventCallback = [](SPHANDLE, void *eventData, void *arg) {
+        PluginSlot *plugin = static_cast<PluginSlot *>(arg);
+        plugin->controller->pluginEventCallback(plugin->owner, eventData);
+    };
+
+    if (_plugins.empty()) {
+        logger.log(LOG_ERROR, "No plugins configured");
+        return false;
+    }
+
+    for (std::unique_ptr<PluginSlot> &plugin : _plugins) {
+        plugin->configuring.store(true, std::memory_order_release);
+        plugin->methods = loadPlugin(plugin->library, plugin->config, eventCallback, plugin.get());
+        plugin->configuring.store(false, std::memory_order_release);
+
+        if (!plugin->methods.plugin_instance) {
+            logger.log(LOG_ERROR, "Could not load %s plugin", plugin->name.c_str());
+            return false;
+        }
+
+        logger.log(LOG_INFO, "Loaded %s plugin", plugin->name.c_str());
+    }
+
+    _routing.reset(compileRoutes(_configManager->mapManager()->snapshot()));
+    startDeliveryWorkers();
+    startReloadThread();
+
+    return true;
+}
+
+//! builds a routing table from a version of the mappings, resolving destination plugin names
+RoutingSnapshot *SimHubEventController::compileRoutes(std::shared_ptr<const MappingSnapshot> mapping)
+{
+    RoutingSnapshot *routing = new RoutingSnapshot;
+    ElementSymbolTable &symbols = _configManager->mapManager()->symbols();
+
+    routing->mapping = mapping;
+
+#if defined(_AWS_SDK)
+    routing->dcVoltsElement = symbols.find("N_ELEC_PANEL_LOWER_LEFT");
+#endif
+
+    for (std::unique_ptr<PluginSlot> &plugin : _plugins) {
+        EventOwnerID owner = routing->routes.addPlugin(plugin->name, &plugin->methods);
+        assert(owner == plugin->owner);
+    }
+
+    for (const MappingRoute &route : mapping->routes) {
+        ElementID target = route.target == route.source ? INVALID_ELEMENT_ID : route.target;
+
+        if (route.destinations.empty()) {
+            routing->routes.addRoute(route.source, target);
+            continue;
+        }
+
+        for (const std::string &destination : route.destinations) {
+            EventOwnerID owner = routing->routes.owner(destination);
+
+            if (owner == EVENT_OWNER_NONE) {
+                logger.log(LOG_ERROR, "Mapping | WARNING | %s goes to unknown plugin %s. Skipping....", symbols.name(route.source).c_str(), destination.c_str());
+                continue;
+            }
+
+            routing->routes.addRoute(route.source, target, owner);
+        }
+    }
+
+    routing->routes.compile();
+
+    logger.log(LOG_INFO, "Routing %lu route(s) between %lu plugin(s)", routing->routes.routeCount(), routing->routes.pluginCount());
+
+    return routing;
+}
+
+/**
+ * swaps in the routing table published by the reload thread - runs on
+ * the event thread, the only reader of _routing, so the previous table
+ * can be released straight away
+ */
+void SimHubEventController::adoptPendingRoutes(void)
+{
+    RoutingSnapshot *pending = _pendingRouting.exchange(NULL, std::memory_order_acquire);
+
+    if (!pending) {
+        return;
+    }
+
+#if defined(_AWS_SDK)
+    // sustain periods that changed apply to the values already sustained
+    const MappingSnapshot &previous = *_routing->mapping;
+    const MappingSnapshot &next = *pending->mapping;
+    size_t elementCount = std::max(previous.sustainPeriods.size(), next.sustainPeriods.size());
+
+    for (ElementID id = 1; id < elementCount; id++) {
+        if (previous.sustainPeriod(id) != next.sustainPeriod(id)) {
+            _sustainScheduler->setPeriod(id, next.sustainPeriod(id));
+        }
+    }
+#endif
+
+    _routing.reset(pending);
+
+    logger.log(LOG_INFO, "Mapping | Now routing with v%s", _routing->mapping->version.c_str());
+}
+
+void SimHubEventController::requestMappingReload(void)
+{
+    _reloadRequested.store(true, std::memory_order_release);
+    _reloadEvent.notifyAll();
+}
+
+//! rereads the mappings and hands the event thread a routing table compiled from them
+void SimHubEventController::reloadMappings(void)
+{
+    std::shared_ptr<MappingConfigManager> mapManager = _configManager->mapManager();
+
+    logger.log(LOG_INFO, "Mapping | Reloading %s", mapManager->configFilename().c_str());
+
+    if (mapManager->reload() != RETURN_OK) {
+        return;
+    }
+
+    std::shared_ptr<const MappingSnapshot> mapping = mapManager->snapshot();
+
+    // the coalescer's slots are laid out once, before any event is queued - _routing
+    // belongs to the event thread, so compare against the set they were laid out for
+    if (mapping->coalesceSet != _coalescedElements) {
+        logger.log(LOG_ERROR, "Mapping | WARNING | Coalesced elements changed, restart simhub (ctrl+\\) for that to take effect");
+    }
+
+    // a table the event thread never picked up is replaced by this one
+    delete _pendingRouting.exchange(compileRoutes(mapping), std::memory_order_acq_rel);
+}
+
+//! parks a thread until a reload is requested, so reloads never run on the signal handler or the event thread
+void SimHubEventController::startReloadThread(void)
+{
+    _reloadThreadRunning = true;
+
+    _reloadThread = std::thread([this] {
+        while (true) {
+            uint32_t key = _reloadEvent.prepareWait();
+
+            if (!_reloadThreadRunning) {
+                _reloadEvent.cancelWait();
+                break;
+            }
+
+            if (_reloadRequested.exchange(false, std::memory_order_acq_rel)) {
+                _reloadEvent.cancelWait();
+                reloadMappings();
+                continue;
+            }
+
+            _reloadEvent.commitWait(key);
+        }
+    });
+}
+
+void SimHubEventController::stopReloadThread(void)
+{
+    _reloadThreadRunning = false;
+    _reloadEvent.notifyAll();
+
+    if (_reloadThread.joinable()) {
+        _reloadThread.join();
+    }
+
+    delete _pendingRouting.exchange(NULL);
+}
+
+//! gives every plugin its own delivery queue and thread
+void SimHubEventController::startDeliveryWorkers(void)
 {
-    auto prepare3dCallback = [](SPHANDLE eventSource, void *eventData, void *arg) { static_cast<SimHubEventController *>(arg)->prepare3dEventCallback(eventSource, eventData); };
+    _workers.assign(_plugins.size() + 1, NULL);
 
-    _prepare3dMethods = loadPlugin("libprepare3d", _prepare3dDeviceConfig, prepare3dCallback);
+    for (std::unique_ptr<PluginSlot> &plugin : _plugins) {
+        PluginSlot *slot = plugin.get();
 
-    return _prepare3dMethods.plugin_instance != NULL;
+        slot->worker.reset(new DeliveryWorker(slot->name, [this, slot](EventBatch &values) { return deliverToPlugin(slot, values); }));
+
+        if (!slot->worker->configure(slot->delivery)) {
+            logger.log(LOG_ERROR, "Unknown delivery overflow policy '%s' for %s - using 'block'", slot->delivery.overflowPolicy.c_str(), slot->name.c_str());
+        }
+
+        logger.log(LOG_INFO, "Delivery | %s | queue capacity %lu (%s on overflow)", slot->name.c_str(), slot->worker->capacity(), slot->delivery.overflowPolicy.c_str());
+
+        _workers[slot->owner] = slot->worker.get();
+        slot->worker->start();
+    }
 }
 
-bool SimHubEventController::loadPokeyPlugin(void)
+//! delivers whatever is still queued, stops the workers and logs their queue metrics
+void SimHubEventController::stopDeliveryWorkers(void)
 {
-    auto pokeyCallback = [](SPHANDLE eventSource, void *eventData, void *arg) { static_cast<SimHubEventController *>(arg)->pokeyEventCallback(eventSource, eventData); };
+    for (std::unique_ptr<PluginSlot> &plugin : _plugins) {
+        DeliveryWorker *worker = plugin->worker.get();
 
-    _pokeyMethods = loadPlugin("libpokey", _pokeyDeviceConfig, pokeyCallback);
+        if (!worker) {
+            continue;
+        }
 
-    return _pokeyMethods.plugin_instance != NULL;
+        worker->stop();
+
+        logger.log(LOG_INFO, "Delivery | %s | %lu delivered, max depth %lu of %lu, %lu dropped, %lu coalesced, %lu failed batch(es)", worker->name().c_str(),
+            worker->deliveredCount(), worker->maxDepth(), worker->capacity(), worker->droppedCount(), worker->coalescedCount(), worker->failedCount());
+    }
+}
+
+//! the recorder's writer runs with the event loop, it only records once recording is toggled on
+void SimHubEventController::startEventRecorder(void)
+{
+    for (std::unique_ptr<PluginSlot> &plugin : _plugins) {
+        _eventRecorder->setOwnerName(plugin->owner, plugin->name);
+    }
+
+    _eventRecorder->start();
 }
 
-//! perform shutdown ceremonies on both plugins - this unloads both plugins
+void SimHubEventController::stopEventRecorder(void)
+{
+    _eventRecorder->stop();
+
+    if (_eventRecorder->recordedCount() > 0 || _eventRecorder->droppedCount() > 0) {
+        logger.log(LOG_INFO, "Recorder | %lu recorded, %lu dropped, %lu bytes written, last to %s", _eventRecorder->recordedCount(),
+            _eventRecorder->droppedCount(), _eventRecorder->bytesWritten(), _eventRecorder->path().c_str());
+    }
+}
+
+void SimHubEventController::toggleEventRecording(void)
+{
+    if (_eventRecorder) {
+        _eventRecorder->toggleRecording();
+    }
+}
+
+//! perform shutdown ceremonies on every plugin - this unloads them all
 void SimHubEventController::terminate(void)
 {
     assert(_running);
@@ -437,9 +953,23 @@ void SimHubEventController::terminate(void)
     auto listenerCloseTask = _configurationHTTPListener->close();
     listenerCloseTask.wait();
 
-    shutdownPlugin(_prepare3dMethods);
-    shutdownPlugin(_pokeyMethods);
-    
+    stopReloadThread();
+    stopEventRecorder();
+    stopDeliveryWorkers();
+
+    if (_eventStrings.expiredCount() > 0) {
+        logger.log(LOG_INFO, "%lu long string value(s) were reused before they were read, and went out empty", (unsigned long)_eventStrings.expiredCount());
+    }
+
+    if (_unresolvedCount > 0) {
+        logger.log(LOG_INFO, "Dropped %lu event(s) for names that didn't fit in the symbol table", (unsigned long)_unresolvedCount.load());
+    }
+
+    // unload in reverse of the load order
+    for (auto plugin = _plugins.rbegin(); plugin != _plugins.rend(); plugin++) {
+        shutdownPlugin((*plugin)->methods);
+    }
+
     _running = false;
 }
 
@@ -3,9 +3,11 @@
 
 #include <atomic>
 #include <list>
+#include <map>
 #include <string>
 #include <thread>
 #include <atomic>
+#include <vector>
 #include <mutex>
 #include <sstream>
 #include <cpprest/http_listener.h>
@@ -13,14 +15,22 @@
 #include "plugins/common/utils.h"
 #include "elements/attributes/attribute.h"
 #include "plugins/common/simhubdeviceplugin.h"
-#include "common/support/threadmanager.h"
+#include "coalescer/eventcoalescer.h"
+#include "delivery/deliveryworker.h"
+#include "elements/events/eventvalue.h"
 #include "queue/concurrent_queue.h"
+#include "queue/mpsc_ring_queue.h"
+#include "recorder/eventrecorder.h"
+#include "routing/routingtable.h"
 
 #if defined(_AWS_SDK)
 #include "aws/aws.h"
+#include "sustain/sustainscheduler.h"
+#include "telemetry/telemetryencoder.h"
 #endif
 
 class ConfigManager; // forward reference
+struct MappingSnapshot;
 
 /**
  * Base of the simhub app controller logic
@@ -32,8 +42,41 @@ class ConfigManager; // forward reference
  *   void * to 'this' that was passed to the plugin when it registered
  *   the callback stub, to call into the proper 'eventCallback' member
  */
- 
- typedef std::pair<std::chrono::milliseconds, std::shared_ptr<Attribute>> SustainMapEntry;
+
+typedef std::vector<EventValue> EventBatch; ///< events drained from the queue in one wake-up
+
+#define DEFAULT_EVENT_BATCH_SIZE 256
+
+class SimHubEventController;
+
+//! a plugin listed in the configuration - its address is the argument of its event callback
+typedef struct {
+    std::string name;
+    std::string library;
+    libconfig::Config *config;
+    simplug_vtable methods;
+    EventOwnerID owner;
+    std::atomic<bool> configuring; ///< names the plugin resolves are interned until its preflight completes
+    SimHubEventController *controller;
+    DeliveryQueueConfiguration delivery;
+    std::unique_ptr<DeliveryWorker> worker; ///< delivers the values routed to the plugin on a thread of its own
+    std::vector<GenericTLV *> batch; ///< reused by the worker per batch to avoid allocations
+} PluginSlot;
+
+//! an event for a name the symbol table didn't have when it was produced
+typedef struct {
+    std::string name;
+    EventValue value;
+} NamedEvent;
+
+//! a version of the mappings and the routing table compiled from it
+typedef struct {
+    std::shared_ptr<const MappingSnapshot> mapping;
+    RoutingTable routes;
+#if defined(_AWS_SDK)
+    ElementID dcVoltsElement; ///< read out by polly when it's delivered
+#endif
+} RoutingSnapshot;
 
 class SimHubEventController
 {
@@ -43,31 +86,59 @@ protected:
 protected:
     SimHubEventController(void);
 
-    void prepare3dEventCallback(SPHANDLE eventSource, void *eventData);
-    void pokeyEventCallback(SPHANDLE eventSource, void *eventData);
-    simplug_vtable loadPlugin(std::string dylibName, libconfig::Config *pluginConfigs, EnqueueEventHandler eventCallback);
+    void pluginEventCallback(EventOwnerID owner, void *eventData);
+    simplug_vtable loadPlugin(std::string dylibName, libconfig::Config *pluginConfigs, EnqueueEventHandler eventCallback, void *eventArg);
+    RoutingSnapshot *compileRoutes(std::shared_ptr<const MappingSnapshot> mapping);
+    void adoptPendingRoutes(void);
+    void startReloadThread(void);
+    void stopReloadThread(void);
+    void reloadMappings(void);
+    void startDeliveryWorkers(void);
+    void stopDeliveryWorkers(void);
+    void startEventRecorder(void);
+    void stopEventRecorder(void);
+    bool deliverToPlugin(PluginSlot *plugin, EventBatch &values);
     void terminate(void);
     void shutdownPlugin(simplug_vtable &pluginMethods);
     void startSustainThread(void);
     void ceaseSustainThread(void);
+    bool deliverBatch(simplug_vtable &pluginMethods, std::vector<GenericTLV *> &values);
+    void enqueueEvent(const EventValue &value);
+    bool resolveCoalescedEvent(EventValue &value);
+    void resolveCoalescedEvents(EventBatch &values);
+    void enqueueNamedEvent(const char *name, const EventValue &value);
+    bool resolveNamedEvent(EventValue &value);
+    void resolveNamedEvents(EventBatch &values);
+    GenericTLV *deliverableValue(const EventValue &value);
 
-    ConcurrentQueue<std::shared_ptr<Attribute>> _eventQueue;
-    simplug_vtable _prepare3dMethods;
-    simplug_vtable _pokeyMethods;
+    MPSCRingQueue<EventValue> _eventQueue;
+    size_t _eventBatchSize;
+    std::vector<std::unique_ptr<PluginSlot>> _plugins; ///< in load order
+    std::unique_ptr<RoutingSnapshot> _routing; ///< only touched by the event thread, swapped between events on a reload
+    std::atomic<RoutingSnapshot *> _pendingRouting; ///< compiled by the reload thread, waiting for the event thread
+    std::thread _reloadThread;
+    WakeEvent _reloadEvent;
+    std::atomic<bool> _reloadRequested;
+    std::atomic<bool> _reloadThreadRunning;
+    std::vector<DeliveryWorker *> _workers; ///< indexed by EventOwnerID
+    GenericTLVPool _deliveryPool; ///< records for values handed to plugins
+    EventCoalescer _eventCoalescer;
+    std::set<ElementID> _coalescedElements; ///< the coalescer was laid out for these, compared against on a reload
+    EventStringTable _eventStrings; ///< string values of events, referenced by StringHandle
+    std::mutex _namedEventsMutex;
+    std::map<uint64_t, NamedEvent> _namedEvents; ///< by the ticket their placeholder on the event queue carries
+    uint64_t _namedEventTicket;
+    std::atomic<uint64_t> _unresolvedCount; ///< events dropped because the symbol table is full
+    std::unique_ptr<EventRecorder> _eventRecorder; ///< records what comes off the event queue, created with the configuration
     ConfigManager *_configManager;
 
 #if defined(_AWS_SDK)
-    CancelableThreadManager _sustainThreadManager;
-    std::map<std::string, SustainMapEntry> _sustainValues;
-    std::mutex _sustainValuesMutex;
+    std::unique_ptr<SustainScheduler> _sustainScheduler; ///< resends sustained values, created with the event loop
+    std::unique_ptr<TelemetryEncoder> _telemetryEncoder; ///< kinesis records, created by enableKinesis
 #endif
 
     bool _running;
 
-    // -- temp solution to plugin device configuration conundrum
-    libconfig::Config *_pokeyDeviceConfig;
-    libconfig::Config *_prepare3dDeviceConfig;
-
     //! implements configuration server
     std::shared_ptr<web::http::experimental::listener::http_listener> _configurationHTTPListener;
     std::string _httpListenAddress;
@@ -77,25 +148,21 @@ protected:
 
 public:
     virtual ~SimHubEventController(void);
-    bool loadPrepare3dPlugin(void);
-    bool loadPokeyPlugin(void);
-    bool deliverValue(std::shared_ptr<Attribute> value);
-    void setConfigManager(ConfigManager *configManager);
+    void addPlugin(std::string name, std::string library, libconfig::Config *pluginConfig, const DeliveryQueueConfiguration &delivery);
+    bool loadPlugins(void);
+    bool deliverValue(const EventValue &value);
+    bool deliverValues(EventBatch &values);
+    SPHANDLE ownerPlugin(EventOwnerID owner);
 
-    // -- temp solution to plugin device configuration conundrum
-    void setPrepare3dConfig(libconfig::Config *prepare3dConfig)
-    {
-        assert(prepare3dConfig != NULL);
-        _prepare3dDeviceConfig = prepare3dConfig;
-    };
-    
-    void setPokeyConfig(libconfig::Config *pokeyConfig)
-    {
-        assert(pokeyConfig != NULL);
-        _pokeyDeviceConfig = pokeyConfig;
-    };
+    //! asks the reload thread to reread the mappings - safe to call from a signal handler
+    void requestMappingReload(void);
+
+    //! starts or stops recording the event stream - safe to call from a signal handler
+    void toggleEventRecording(void);
+    void setConfigManager(ConfigManager *configManager);
 
     template <class F> void runEventLoop(F &&eventProcessorFunctor);
+    template <class F> void runBatchedEventLoop(F &&eventBatchProcessorFunctor);
 
     void ceaseEventLoop(void);
 
@@ -104,11 +171,13 @@ public:
 
     void enablePolly(void);
     void enableKinesis(void);
-    void deliverKinesisValue(std::shared_ptr<Attribute> value);
+    void deliverKinesisValue(const EventValue &value);
+    void updateSustainValue(const EventValue &value);
 #endif
 
 public:
     static void LoggerWrapper(const int category, const char *msg, ...);
+    static ElementID ResolveElementSymbol(const char *name, void *arg);
     static std::shared_ptr<SimHubEventController> EventControllerInstance(void);
     static void DestroyEventControllerInstance(void);
 };
@@ -128,12 +197,55 @@ template <class F> void SimHubEventController::runEventLoop(F &&eventProcessorFu
     startSustainThread();
 #endif
 
+    startEventRecorder();
     startHTTPListener();
 
     while (!breakLoop) {
         try {
-            std::shared_ptr<Attribute> data = _eventQueue.pop();
-            breakLoop = !eventProcessorFunctor(data);
+            EventValue data = _eventQueue.pop();
+
+            if (resolveNamedEvent(data) && resolveCoalescedEvent(data)) {
+                _eventRecorder->record(data);
+                breakLoop = !eventProcessorFunctor(data);
+            }
+        }
+        catch (ConcurrentQueueInterrupted &queueException) {
+            breakLoop = true;
+        }
+    }
+
+    terminate();
+}
+
+//! same as runEventLoop but drains every queued event per wake-up and
+//  hands them to the functor together
+template <class F> void SimHubEventController::runBatchedEventLoop(F &&eventBatchProcessorFunctor)
+{
+    bool breakLoop = false;
+    EventBatch batch;
+
+    batch.reserve(_eventBatchSize);
+
+    _running = true;
+
+#if defined(_AWS_SDK)
+    startSustainThread();
+#endif
+
+    startEventRecorder();
+    startHTTPListener();
+
+    while (!breakLoop) {
+        try {
+            batch.clear();
+            _eventQueue.popBatch(batch, _eventBatchSize);
+            resolveNamedEvents(batch);
+            resolveCoalescedEvents(batch);
+
+            if (!batch.empty()) {
+                _eventRecorder->record(batch.data(), batch.size());
+                breakLoop = !eventBatchProcessorFunctor(batch);
+            }
         }
         catch (ConcurrentQueueInterrupted &queueException) {
             breakLoop = true;
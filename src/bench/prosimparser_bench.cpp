@@ -0,0 +1,191 @@
+/**
+ * throughput of the ProSim stream parser, with each of its scanners,
+ * against the previous strtok/malloc based parsing
+ *
+ *   prosimparser_bench [capture file] [iterations]
+ *
+ * the capture file holds the raw bytes received from the ProSim
+ * socket (e.g. recorded with "nc <prosim host> 8091 > capture.txt").
+ * Without one a stream in the same format as the prosim-emulator
+ * tool is synthesised.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "plugins/prepare3d/ProsimStreamParser/ProsimStreamParser.h"
+
+#define BENCH_READ_SIZE 1460 ///< typical tcp segment payload
+#define LEGACY_BUFFER_LEN 4096
+#define LEGACY_MAX_ELEMENTS_PER_UPDATE 1024
+
+static volatile uint64_t Sink;
+
+static std::string synthesiseCapture(size_t bytes)
+{
+    static const char *indicators[] = { "I_OH_SPEED_TRIM", "I_OH_GROUND_POWER_AVAILABLE", "I_OH_STDBY_POWER_OFF", "I_MC_FUEL", "I_MC_DOORS" };
+    static const char *analogs[] = { "A_ASP_ADF_1_VOLUME", "A_ASP_MARKER_VOLUME", "A_CDU1_BRIGHTNESS", "R_XPDR1" };
+    static const char *gauges[] = { "G_OH_TEMPERATURE", "G_OH_FUEL_TEMP", "G_PED_RUDDER_TRIM", "G_THROTTLE_LEFT", "G_THROTTLE_RIGHT" };
+
+    std::mt19937 random(42);
+    std::ostringstream oss;
+
+    while ((size_t)oss.tellp() < bytes) {
+        for (int i = 0; i < 20; i++) {
+            switch (random() % 3) {
+            case 0:
+                oss << indicators[random() % 5] << " = " << random() % 2 << " \n";
+                break;
+            case 1:
+                oss << analogs[random() % 4] << " = " << random() % 256 << "\n";
+                break;
+            default:
+                oss << gauges[random() % 5] << " = " << (random() % 500000) / 1000.0 << "\n";
+                break;
+            }
+        }
+
+        oss << "\n";
+    }
+
+    return oss.str();
+}
+
+static void countElement(ProsimElement *element, void *)
+{
+    Sink += element->nameLength + element->value.int_value;
+}
+
+static uint64_t runParser(const std::string &capture, ProsimScanFunction scanner)
+{
+    std::unique_ptr<ProsimStreamParser> parser(new ProsimStreamParser());
+    uint64_t retVal = 0;
+
+    parser->setScanner(scanner);
+
+    for (size_t pos = 0; pos < capture.size(); pos += BENCH_READ_SIZE) {
+        size_t length = std::min((size_t)BENCH_READ_SIZE, capture.size() - pos);
+        size_t copied = 0;
+
+        // same path as the plugin: read into the ring, commit, parse
+        while (copied < length) {
+            char *base;
+            size_t space;
+
+            parser->writableRegion(&base, &space);
+            space = std::min(space, length - copied);
+            memcpy(base, capture.data() + pos + copied, space);
+            parser->commit(space);
+            copied += space;
+
+            retVal += parser->parse(countElement, NULL);
+        }
+    }
+
+    return retVal;
+}
+
+//! the parsing the plugin did before ProsimStreamParser, minus the event generation
+static uint64_t runLegacy(const std::string &capture)
+{
+    uint64_t retVal = 0;
+
+    for (size_t pos = 0; pos < capture.size(); pos += BENCH_READ_SIZE) {
+        size_t nread = std::min((size_t)BENCH_READ_SIZE, capture.size() - pos);
+        char *data = (char *)malloc(nread);
+        memcpy(data, capture.data() + pos, nread);
+        data[nread - 1] = '\0';
+
+        int elementCount = 0;
+        char *p = strtok(data, "\n");
+        char *array[LEGACY_MAX_ELEMENTS_PER_UPDATE];
+
+        while (p != NULL && elementCount < LEGACY_MAX_ELEMENTS_PER_UPDATE) {
+            size_t len = strlen(p);
+
+            if (len > 2) {
+                char *buffer = (char *)malloc(LEGACY_BUFFER_LEN);
+                memset(buffer, 0, LEGACY_BUFFER_LEN);
+                memcpy(buffer, p, len);
+                buffer[len - 1] = '\0';
+                array[elementCount++] = buffer;
+            }
+
+            p = strtok(NULL, "\n");
+        }
+
+        for (int i = 0; i < elementCount; ++i) {
+            char *name = strtok(array[i], "=");
+            char *value = strtok(NULL, " =");
+
+            if (value != NULL) {
+                Sink += strlen(name) + (name[0] == 'G' ? (int)atof(value) : atoi(value));
+                retVal++;
+            }
+
+            free(array[i]);
+        }
+
+        free(data);
+    }
+
+    return retVal;
+}
+
+template <class F> static void report(const char *label, const std::string &capture, int iterations, F &&run)
+{
+    uint64_t elements = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        elements += run(capture);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = (double)capture.size() * iterations / (1024 * 1024);
+
+    std::cout << label << ": " << megabytes / seconds << " MB/s, " << elements / seconds / 1e6 << " M elements/s (" << elements / iterations << " elements per pass)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string capture;
+    int iterations = argc > 2 ? atoi(argv[2]) : 50;
+
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+
+        if (!file) {
+            std::cerr << "unable to open capture " << argv[1] << std::endl;
+            return 1;
+        }
+
+        capture.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    else {
+        capture = synthesiseCapture(8 * 1024 * 1024);
+    }
+
+    std::cout << "capture: " << capture.size() << " bytes, " << iterations << " iterations, " << BENCH_READ_SIZE << " byte reads" << std::endl;
+
+    report("ProsimStreamParser scalar", capture, iterations, [](const std::string &data) { return runParser(data, ProsimScanScalar); });
+
+#if defined(PROSIM_SCAN_X86)
+    report("ProsimStreamParser sse2  ", capture, iterations, [](const std::string &data) { return runParser(data, ProsimScanSSE2); });
+
+    if (ProsimSelectScanner() == ProsimScanAVX2) {
+        report("ProsimStreamParser avx2  ", capture, iterations, [](const std::string &data) { return runParser(data, ProsimScanAVX2); });
+    }
+#endif
+
+    report("legacy strtok            ", capture, iterations, runLegacy);
+
+    return 0;
+}
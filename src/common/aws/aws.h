@@ -25,7 +25,7 @@ public:
     void init(void);
     void shutdown(void);
     void initPolly(void);
-    void initKinesis(std::string streamName, std::string partition, std::string region);
+    void initKinesis(std::string streamName, std::string partition, std::string region, std::string endpoint, const RecordBatcherConfiguration &batching, const RecordSpoolConfiguration &spooling);
     std::shared_ptr<Polly> polly(void);
     std::shared_ptr<Kinesis> kinesis(void);
 
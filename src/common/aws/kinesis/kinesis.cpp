@@ -1,3 +1,4 @@
+#include <errno.h>
 #include <unistd.h>
 
 #include "../../log/clog.h"
@@ -6,37 +7,50 @@
 #include "../aws.h"
 #endif
 
-Kinesis::Kinesis(std::string streamName, std::string partition, std::string region)
+Kinesis::Kinesis(std::string streamName, std::string partition, std::string region, std::string endpoint, const RecordBatcherConfiguration &batching,
+    const RecordSpoolConfiguration &spooling)
     : _partition(partition)
     , _streamName(streamName)
     , _region(region)
+    , _endpoint(endpoint)
 {
-
     Aws::Client::ClientConfiguration config;
     config.region = Aws::String(_region.c_str());
+
+    if (!_endpoint.empty()) {
+        std::string host = _endpoint;
+
+        // plain http for a local stand-in
+        if (host.compare(0, 7, "http://") == 0) {
+            config.scheme = Aws::Http::Scheme::HTTP;
+            host = host.substr(7);
+        }
+        else if (host.compare(0, 8, "https://") == 0) {
+            host = host.substr(8);
+        }
+
+        config.endpointOverride = Aws::String(host.c_str());
+    }
+
     _kinesisClient = Aws::MakeShared<KinesisClient>(ALLOCATION_TAG, config);
-    _recordCounter = 0;
-      
-    std::shared_ptr<std::thread> kinesisThread = std::make_shared<std::thread>([=] {
-        _threadManager.setThreadRunning(true);
-        logger.log(LOG_INFO, " - Starting AWS Kinesis Service...");
-        while (!_threadManager.threadCanceled()) {
-            try {
-                Aws::Utils::ByteBuffer data = _queue.pop(); ///< grab an item off the queue
-                Aws::Kinesis::Model::PutRecordRequest *request = new Aws::Kinesis::Model::PutRecordRequest();
-                request->SetStreamName(Aws::String(_streamName.c_str()));
-                request->WithData(data).WithPartitionKey(Aws::String(_partition.c_str()));
-                _kinesisClient->PutRecord(*request);
-                _recordCounter++;
-            }
-            catch (ConcurrentQueueInterrupted &except) {
-            }
+
+    logger.log(LOG_INFO, " - Starting AWS Kinesis Service (%lu records per request, %ums linger)", batching.maxBatchRecords, batching.linger);
+
+    if (!spooling.directory.empty()) {
+        _spool.reset(new RecordSpool(spooling));
+
+        if (_spool->open()) {
+            logger.log(LOG_INFO, " - Spooling Kinesis records to %s (%lu bytes waiting)", spooling.directory.c_str(), _spool->readableSize());
+        }
+        else {
+            logger.log(LOG_ERROR, " - Failed to open Kinesis spool %s: %s - records are only queued in memory", spooling.directory.c_str(), strerror(errno));
+            _spool.reset();
         }
-        _threadManager.setThreadRunning(false);
-        logger.log(LOG_INFO, " - Terminated AWS Kinesis Service");
-    });
+    }
 
-    _threadManager.setManagedThread(kinesisThread);
+    _batcher.reset(new RecordBatcher(
+        _partition, [this](const std::vector<std::string> &records, std::vector<bool> &failed) { return putRecords(records, failed); }, batching, _spool.get()));
+    _batcher->start();
 }
 
 Kinesis::~Kinesis()
@@ -46,11 +60,50 @@ Kinesis::~Kinesis()
 
 void Kinesis::shutdown(void)
 {
-    _queue.unblock();
-    _threadManager.shutdownThread();
+    _batcher->stop();
+
+    logger.log(LOG_INFO, " - Terminated AWS Kinesis Service (%lu records in %lu requests, %lu retried, %lu failed, %lu dropped)", _batcher->recordCount(),
+        _batcher->requestCount(), _batcher->retriedCount(), _batcher->failedCount(), _batcher->droppedCount());
+
+    if (_spool) {
+        _spool->close();
+
+        logger.log(LOG_INFO, " - Kinesis spool closed (%lu spooled, %lu committed, %lu dropped)", _spool->appendedCount(), _spool->committedCount(),
+            _spool->droppedCount());
+    }
+}
+
+void Kinesis::putRecord(const std::string &data)
+{
+    _batcher->push(data);
 }
 
-void Kinesis::putRecord(Aws::Utils::ByteBuffer data)
+//! one PutRecords request, runs on the batcher thread
+bool Kinesis::putRecords(const std::vector<std::string> &records, std::vector<bool> &failed)
 {
-    _queue.push(data);
+    Aws::Kinesis::Model::PutRecordsRequest request;
+    request.SetStreamName(Aws::String(_streamName.c_str()));
+
+    for (const std::string &record : records) {
+        Aws::Kinesis::Model::PutRecordsRequestEntry entry;
+        entry.SetPartitionKey(Aws::String(_partition.c_str()));
+        entry.SetData(Aws::Utils::ByteBuffer((const unsigned char *)record.data(), record.size()));
+        request.AddRecords(entry);
+    }
+
+    Aws::Kinesis::Model::PutRecordsOutcome outcome = _kinesisClient->PutRecords(request);
+
+    if (!outcome.IsSuccess()) {
+        logger.log(LOG_ERROR, " - Kinesis PutRecords failed: %s", outcome.GetError().GetMessage().c_str());
+        return false;
+    }
+
+    // throttled records come back with an error code
+    const Aws::Vector<Aws::Kinesis::Model::PutRecordsResultEntry> &results = outcome.GetResult().GetRecords();
+
+    for (size_t i = 0; i < results.size() && i < failed.size(); i++) {
+        failed[i] = !results[i].GetErrorCode().empty();
+    }
+
+    return true;
 }
@@ -1,41 +1,52 @@
 #ifndef __AWS_KINESIS_H
 #define __AWS_KINESIS_H
 
-#include "../../libs/queue/concurrent_queue.h"
 #include <aws/core/Aws.h>
 #include <aws/core/Version.h>
 #include <aws/core/utils/Outcome.h>
 #include <aws/core/utils/memory/stl/AWSAllocator.h>
 #include <aws/kinesis/KinesisClient.h>
-#include <aws/kinesis/model/PutRecordRequest.h>
-#include <condition_variable>
+#include <aws/kinesis/model/PutRecordsRequest.h>
 #include <cstdarg>
 #include <iostream>
+#include <memory>
 #include <stdio.h>
 #include <string.h>
 
-#include "common/support/threadmanager.h"
+#include "streaming/recordbatcher.h"
+#include "streaming/recordspool.h"
 
 typedef Aws::Kinesis::KinesisClient KinesisClient;
 
 static const char *ALLOCATION_TAG = "Kinesis::Main";
+
+/**
+ * ships records to a Kinesis stream - records are aggregated and sent
+ * in PutRecords batches by a RecordBatcher, endpoint overrides the
+ * regional endpoint (e.g. a local stand-in like kinesalite). With a
+ * spool directory, records are spooled to disk until the stream has
+ * taken them, so they survive outages and restarts
+ */
 class Kinesis
 {
 protected:
     std::shared_ptr<KinesisClient> _kinesisClient; ///< main kinesis client
-    ConcurrentQueue<Aws::Utils::ByteBuffer> _queue;
     std::string _partition;
     std::string _streamName;
     std::string _region;
-    CancelableThreadManager _threadManager;
-    long _recordCounter;
+    std::string _endpoint;
+    std::unique_ptr<RecordSpool> _spool; ///< NULL without a spool directory, outlives the batcher
+    std::unique_ptr<RecordBatcher> _batcher;
+
+    bool putRecords(const std::vector<std::string> &records, std::vector<bool> &failed);
 
 public:
     // Default constructor
-    Kinesis(std::string streamName, std::string partition, std::string region);
+    Kinesis(std::string streamName, std::string partition, std::string region, std::string endpoint, const RecordBatcherConfiguration &batching,
+        const RecordSpoolConfiguration &spooling);
     // Destructor
     ~Kinesis(void);
-    void putRecord(Aws::Utils::ByteBuffer data);
+    void putRecord(const std::string &data);
     virtual void shutdown(void);
 };
 
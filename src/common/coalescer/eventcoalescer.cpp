@@ -0,0 +1,142 @@
+#include <assert.h>
+#include <string.h>
+
+#include "eventcoalescer.h"
+
+EventCoalescer::EventCoalescer(void)
+    : _slotCount(0)
+    , _coalescedCount(0)
+{
+}
+
+void EventCoalescer::configure(const std::set<ElementID> &elementIds)
+{
+    size_t words = (elementIds.size() + 63) / 64;
+
+    _slotIndex.clear();
+    _slotCount = elementIds.size();
+    _slots.reset(new Slot[_slotCount]);
+    _dirty.reset(new std::atomic<uint64_t>[words]);
+
+    for (size_t i = 0; i < _slotCount; i++) {
+        _slots[i].sequence.store(0, std::memory_order_relaxed);
+        _slots[i].takenSequence = 0;
+
+        for (size_t w = 0; w < COALESCER_SLOT_WORDS; w++) {
+            _slots[i].words[w].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    for (size_t i = 0; i < words; i++) {
+        _dirty[i].store(0, std::memory_order_relaxed);
+    }
+
+    if (elementIds.empty()) {
+        return;
+    }
+
+    // ids are dense so the index is sized by the largest coalesced one
+    _slotIndex.resize(*elementIds.rbegin() + 1, COALESCER_NO_SLOT);
+
+    int slot = 0;
+
+    for (ElementID id : elementIds) {
+        _slotIndex[id] = slot++;
+    }
+}
+
+void EventCoalescer::store(Slot &slot, const EventValue &value)
+{
+    uint64_t words[COALESCER_SLOT_WORDS] = { 0 };
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    memcpy(words, &value, sizeof(EventValue));
+
+    // an odd sequence marks the slot as being written - claiming it also
+    // serialises producers that update the same element
+    for (;;) {
+        if (!(sequence & 1) && slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            break;
+        }
+
+        sequence = slot.sequence.load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t w = 0; w < COALESCER_SLOT_WORDS; w++) {
+        slot.words[w].store(words[w], std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+uint32_t EventCoalescer::load(Slot &slot, EventValue &value)
+{
+    uint64_t words[COALESCER_SLOT_WORDS];
+    uint32_t before;
+    uint32_t after;
+
+    do {
+        before = slot.sequence.load(std::memory_order_acquire);
+
+        for (size_t w = 0; w < COALESCER_SLOT_WORDS; w++) {
+            words[w] = slot.words[w].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    memcpy(&value, words, sizeof(EventValue));
+
+    return after;
+}
+
+bool EventCoalescer::offer(int slot, const EventValue &value)
+{
+    assert(slot >= 0 && (size_t)slot < _slotCount);
+
+    uint64_t bit = 1ULL << (slot & 63);
+
+    // publish the value before the bit so a consumer that sees the bit
+    // also sees (at least) this value
+    store(_slots[slot], value);
+
+    bool wasClean = !(_dirty[slot >> 6].fetch_or(bit, std::memory_order_acq_rel) & bit);
+
+    if (!wasClean) {
+        _coalescedCount++;
+    }
+
+    return wasClean;
+}
+
+bool EventCoalescer::take(int slot, EventValue &value)
+{
+    assert(slot >= 0 && (size_t)slot < _slotCount);
+
+    uint64_t bit = 1ULL << (slot & 63);
+
+    // clear the bit before taking the value - a producer racing with us
+    // then re-queues the element rather than having its value lost
+    _dirty[slot >> 6].fetch_and(~bit, std::memory_order_acq_rel);
+
+    uint32_t sequence = load(_slots[slot], value);
+
+    // a value already handed out is not delivered twice
+    if (sequence == _slots[slot].takenSequence) {
+        return false;
+    }
+
+    _slots[slot].takenSequence = sequence;
+
+    return true;
+}
+
+void EventCoalescer::release(int slot)
+{
+    assert(slot >= 0 && (size_t)slot < _slotCount);
+
+    _dirty[slot >> 6].fetch_and(~(1ULL << (slot & 63)), std::memory_order_acq_rel);
+}
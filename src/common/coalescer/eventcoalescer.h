@@ -0,0 +1,85 @@
+#ifndef __EVENTCOALESCER_H
+#define __EVENTCOALESCER_H
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdint.h>
+#include <vector>
+
+#include "elements/events/eventvalue.h"
+
+#define COALESCER_NO_SLOT -1
+#define COALESCER_SLOT_WORDS ((sizeof(EventValue) + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+
+/**
+ * Last-value-wins stage between the plugin event callbacks and the
+ * event loop.
+ *
+ * Every coalesced element owns one slot holding its newest value and
+ * one bit in a dirty bitmap. A producer stores the value and sets the
+ * bit - only the producer that flips the bit from 0 to 1 needs to
+ * queue the element, so however many updates arrive before the
+ * consumer gets to it, the element sits in the queue once. The
+ * consumer takes the slot, which clears the bit and hands back the
+ * latest value. A queue that throws the element away has to release
+ * the slot instead, or the bit stays set and the element is never
+ * queued again.
+ *
+ * Slots are seqlocks over the EventValue words: an odd sequence means
+ * a producer is writing (and doubles as the writers' lock), the
+ * consumer retries its copy until it reads the same even sequence
+ * before and after.
+ *
+ * The slot table is indexed by ElementID, fixed when configure is
+ * called and read without locks afterwards.
+ */
+class EventCoalescer
+{
+protected:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        uint32_t takenSequence; ///< consumer only - sequence of the last value taken
+        std::atomic<uint64_t> words[COALESCER_SLOT_WORDS];
+    };
+
+    std::vector<int> _slotIndex; ///< indexed by ElementID
+    std::unique_ptr<Slot[]> _slots;
+    std::unique_ptr<std::atomic<uint64_t>[]> _dirty;
+    size_t _slotCount;
+
+    std::atomic<uint64_t> _coalescedCount;
+
+    void store(Slot &slot, const EventValue &value);
+    uint32_t load(Slot &slot, EventValue &value);
+
+public:
+    EventCoalescer(void);
+
+    EventCoalescer(const EventCoalescer &) = delete; // disable copying
+    EventCoalescer &operator=(const EventCoalescer &) = delete; // disable assignment
+
+    //! builds the slot table - must be called before any producer runs
+    void configure(const std::set<ElementID> &elementIds);
+
+    //! returns the slot of the element or COALESCER_NO_SLOT when it isn't coalesced
+    int slotForId(ElementID id) const { return id < _slotIndex.size() ? _slotIndex[id] : COALESCER_NO_SLOT; };
+
+    /**
+     * stores value as the latest for slot - returns true when the
+     * caller has to queue the element (i.e. it wasn't already pending)
+     */
+    bool offer(int slot, const EventValue &value);
+
+    //! copies the latest value for slot into value and marks it clean - false if it was already taken
+    bool take(int slot, EventValue &value);
+
+    //! marks slot clean after its queued element was thrown away, so the next offer queues it again
+    void release(int slot);
+
+    bool enabled(void) const { return _slotCount > 0; };
+    size_t slotCount(void) const { return _slotCount; };
+    uint64_t coalescedCount(void) const { return _coalescedCount; };
+};
+
+#endif
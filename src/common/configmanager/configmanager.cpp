@@ -67,35 +67,95 @@ std::string ConfigManager::mappingConfigFilename(void)
     return _mappingConfigFilename;
 }
 
-std::string ConfigManager::loadPrepare3DConfiguration(void)
+void ConfigManager::addPluginConfiguration(std::string name, std::string library, std::string configurationFilename, const libconfig::Setting *delivery)
 {
-    if (_prepare3dConfigurationFilename.empty()) {
-        try {
-            _prepare3dConfigurationFilename = (const char *)_config.lookup("prepare3dConfigurationFile");
-            _prepare3dConfig.readFile(_prepare3dConfigurationFilename.c_str());
-            logger.log(LOG_INFO, "Loading prepare3d configuration from %s", _prepare3dConfigurationFilename.c_str());
+    PluginConfiguration plugin;
+    int capacity = DELIVERY_DEFAULT_CAPACITY;
+    int batchSize = DELIVERY_DEFAULT_BATCH_SIZE;
+
+    plugin.name = name;
+    plugin.library = library;
+    plugin.configurationFilename = configurationFilename;
+    plugin.config = std::make_shared<libconfig::Config>();
+    plugin.delivery.overflowPolicy = DELIVERY_DEFAULT_OVERFLOW_POLICY;
+
+    if (delivery) {
+        delivery->lookupValue("capacity", capacity);
+        delivery->lookupValue("overflowPolicy", plugin.delivery.overflowPolicy);
+        delivery->lookupValue("batchSize", batchSize);
+    }
+
+    plugin.delivery.capacity = capacity;
+    plugin.delivery.batchSize = batchSize;
+
+    logger.log(LOG_INFO, "Loading %s configuration from %s", name.c_str(), configurationFilename.c_str());
+    plugin.config->readFile(configurationFilename.c_str());
+
+    _plugins.push_back(plugin);
+}
+
+/**
+ *   @brief  reads the list of plugins and their configuration files -
+ *           configurations without a plugins list load pokey and
+ *           prepare3d from pokeyConfigurationFile and
+ *           prepare3dConfigurationFile
+ *
+ *   @return nothing
+ */
+void ConfigManager::loadPluginConfigurations(void)
+{
+    _plugins.clear();
+
+    if (!_config.exists("plugins")) {
+        std::string pokeyConfigurationFilename;
+        std::string prepare3dConfigurationFilename;
+
+        if (_config.lookupValue("pokeyConfigurationFile", pokeyConfigurationFilename)) {
+            addPluginConfiguration("pokey", "libpokey", pokeyConfigurationFilename);
         }
-        catch (const libconfig::SettingNotFoundException &nfex) {
+        else {
+            logger.log(LOG_ERROR, "No pokey configuration file set in config");
+        }
+
+        if (_config.lookupValue("prepare3dConfigurationFile", prepare3dConfigurationFilename)) {
+            addPluginConfiguration("prepare3d", "libprepare3d", prepare3dConfigurationFilename);
+        }
+        else {
             logger.log(LOG_ERROR, "No prepare3d configuration file set in config");
         }
+
+        return;
+    }
+
+    libconfig::Setting &plugins = _config.lookup("plugins");
+
+    for (int i = 0; i < plugins.getLength(); i++) {
+        std::string name;
+        std::string library;
+        std::string configurationFilename;
+
+        if (!plugins[i].lookupValue("name", name) || !plugins[i].lookupValue("configurationFile", configurationFilename)) {
+            logger.log(LOG_ERROR, "Plugin %i needs a name and configurationFile. Skipping....", i);
+            continue;
+        }
+
+        if (!plugins[i].lookupValue("library", library)) {
+            library = "lib" + name;
+        }
+
+        addPluginConfiguration(name, library, configurationFilename, plugins[i].exists("delivery") ? &plugins[i].lookup("delivery") : NULL);
     }
-    return _prepare3dConfigurationFilename;
 }
 
-std::string ConfigManager::loadPokeyConfiguration(void)
+std::string ConfigManager::pluginConfigurationFilename(std::string name)
 {
-    if (_pokeyConfigurationFilename.empty()) {
-        try {
-            _pokeyConfigurationFilename = (const char *)_config.lookup("pokeyConfigurationFile");
-            _pokeyConfig.readFile(_pokeyConfigurationFilename.c_str());
-            logger.log(LOG_INFO, "Loading pokey configuration from %s", _pokeyConfigurationFilename.c_str());
-        }
-        catch (const libconfig::SettingNotFoundException &nfex) {
-            logger.log(LOG_ERROR, "No pokey configuration file set in config");
+    for (PluginConfiguration &plugin : _plugins) {
+        if (plugin.name == name) {
+            return plugin.configurationFilename;
         }
     }
 
-    return _pokeyConfigurationFilename;
+    return "";
 }
 
 int ConfigManager::init(std::shared_ptr<SimHubEventController> simhubController)
@@ -123,11 +183,11 @@ int ConfigManager::init(std::shared_ptr<SimHubEventController> simhubController)
 
     /** load the various config files **/
     try {
-        loadPrepare3DConfiguration();
-        simhubController->setPrepare3dConfig(&_prepare3dConfig);
+        loadPluginConfigurations();
 
-        loadPokeyConfiguration();
-        simhubController->setPokeyConfig(&_pokeyConfig);
+        for (PluginConfiguration &plugin : _plugins) {
+            simhubController->addPlugin(plugin.name, plugin.library, plugin.config.get(), plugin.delivery);
+        }
 
         _mappingConfigManager.reset(new MappingConfigManager(mappingConfigFilename()));
     }
@@ -199,3 +259,54 @@ size_t ConfigManager::httpListenPort(void)
     config()->lookupValue("httpListenPort", port);
     return port;
 }
+
+size_t ConfigManager::eventQueueCapacity(void)
+{
+    int capacity = MPSC_RING_DEFAULT_CAPACITY;
+
+    if (config()->exists("eventQueue")) {
+        config()->lookup("eventQueue").lookupValue("capacity", capacity);
+    }
+
+    return capacity;
+}
+
+std::string ConfigManager::eventQueueOverflowPolicy(void)
+{
+    std::string retVal("block");
+
+    if (config()->exists("eventQueue")) {
+        config()->lookup("eventQueue").lookupValue("overflowPolicy", retVal);
+    }
+
+    return retVal;
+}
+
+size_t ConfigManager::eventBatchSize(void)
+{
+    int batchSize = DEFAULT_EVENT_BATCH_SIZE;
+
+    if (config()->exists("eventQueue")) {
+        config()->lookup("eventQueue").lookupValue("batchSize", batchSize);
+    }
+
+    return batchSize;
+}
+
+EventRecorderConfiguration ConfigManager::eventRecorderConfiguration(void)
+{
+    EventRecorderConfiguration retVal = EventRecorder::DefaultConfiguration();
+    int bufferEvents = retVal.bufferEvents;
+
+    if (config()->exists("recorder")) {
+        const libconfig::Setting &recorder = config()->lookup("recorder");
+        recorder.lookupValue("directory", retVal.directory);
+        recorder.lookupValue("enabled", retVal.enabled);
+        recorder.lookupValue("bufferEvents", bufferEvents);
+        recorder.lookupValue("flushInterval", retVal.flushInterval);
+    }
+
+    retVal.bufferEvents = bufferEvents;
+
+    return retVal;
+}
@@ -30,6 +30,15 @@
 #define RETURN_ERROR -1
 #endif
 
+//! a plugin the host loads and the configuration handed to it
+typedef struct {
+    std::string name;
+    std::string library; ///< shared library name in the plugin directory, without extension
+    std::string configurationFilename;
+    std::shared_ptr<libconfig::Config> config;
+    DeliveryQueueConfiguration delivery;
+} PluginConfiguration;
+
 /**
  * Base class for all pin based classes
  **/
@@ -44,15 +53,12 @@ protected:
     std::string _mappingConfigFilename;
     std::shared_ptr<MappingConfigManager> _mappingConfigManager;
 
-    libconfig::Config _prepare3dConfig;
-    std::string _prepare3dConfigurationFilename;
-
-    libconfig::Config _pokeyConfig;
-    std::string _pokeyConfigurationFilename;
+    std::vector<PluginConfiguration> _plugins;
 
     libconfig::Setting *_root;
 
     bool fileExists(std::string filename);
+    void addPluginConfiguration(std::string name, std::string library, std::string configurationFilename, const libconfig::Setting *delivery = NULL);
 
 public:
     ConfigManager(std::string);
@@ -61,13 +67,16 @@ public:
     int init(std::shared_ptr<SimHubEventController> simhubController);
     std::string configFilename(void);
     std::string mappingConfigFilename(void);
-    std::string loadPrepare3DConfiguration(void);
-    std::string loadPokeyConfiguration(void);
+    void loadPluginConfigurations(void);
     std::string version(void);
     std::string name(void);
     std::string httpListenAddress(void);
     size_t httpListenPort(void);
-    std::string pokeyConfigurationFilename(void) { return _pokeyConfigurationFilename; };
+    size_t eventQueueCapacity(void);
+    std::string eventQueueOverflowPolicy(void);
+    size_t eventBatchSize(void);
+    EventRecorderConfiguration eventRecorderConfiguration(void);
+    std::string pluginConfigurationFilename(std::string name);
     std::shared_ptr<MappingConfigManager> mapManager(void);
     libconfig::Config *config() { return &_config; }
 };
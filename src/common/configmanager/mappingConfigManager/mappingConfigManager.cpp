@@ -45,9 +45,56 @@ std::string MappingConfigManager::configFilename(void)
 
 int MappingConfigManager::init(void)
 {
+    std::shared_ptr<MappingSnapshot> snapshot = std::make_shared<MappingSnapshot>();
+    int retVal = load(*snapshot);
+
+    std::atomic_store(&_snapshot, std::shared_ptr<const MappingSnapshot>(snapshot));
+
+    return retVal;
+}
+
+/**
+ *   @brief  read the mapping file again and publish it in place of the
+ *           current mappings - readers holding the previous snapshot
+ *           keep using it until they next ask for one
+ *
+ *   @return int RETURN_OK once published, RETURN_ERROR if the file can't
+ *           be read, in which case the current mappings stay in use
+ */
+int MappingConfigManager::reload(void)
+{
+    std::shared_ptr<MappingSnapshot> snapshot = std::make_shared<MappingSnapshot>();
+
+    try {
+        if (load(*snapshot) != RETURN_OK) {
+            logger.log(LOG_ERROR, "Mapping | Reload of %s failed, keeping v%s", _configFilename.c_str(), version().c_str());
+            return RETURN_ERROR;
+        }
+    }
+    catch (std::runtime_error &e) {
+        logger.log(LOG_ERROR, "Mapping | Reload of %s failed, keeping v%s", _configFilename.c_str(), version().c_str());
+        return RETURN_ERROR;
+    }
+
+    std::atomic_store(&_snapshot, std::shared_ptr<const MappingSnapshot>(snapshot));
+
+    return RETURN_OK;
+}
+
+/**
+ *   @brief  parse the mapping file into a snapshot
+ *
+ *   @param  MappingSnapshot the empty snapshot to fill in
+ *
+ *   @return int RETURN_OK or RETURN_ERROR, throws if the file can't be read
+ */
+int MappingConfigManager::load(MappingSnapshot &snapshot)
+{
+    libconfig::Config config;
+
     // read the config file and handle any errors
     try {
-        _config.readFile(_configFilename.c_str());
+        config.readFile(_configFilename.c_str());
     }
     catch (const libconfig::FileIOException &fioex) {
         logger.log(LOG_ERROR, "Config file I/O error while reading file.");
@@ -58,28 +105,44 @@ int MappingConfigManager::init(void)
         throw std::runtime_error("Config file parse error - See log file");
     }
 
-    logger.log(LOG_INFO, "Loading mapping configuration file: %s  (v%s)", _configFilename.c_str(), version().c_str());
+    try {
+        snapshot.version = (const char *)config.lookup("version");
+    }
+    catch (const libconfig::SettingNotFoundException &nfex) {
+        logger.log(LOG_ERROR, "<WARNING> <ERROR> No version set in config");
+    }
 
-    _root = &_config.getRoot();
+    logger.log(LOG_INFO, "Loading mapping configuration file: %s  (v%s)", _configFilename.c_str(), snapshot.version.c_str());
 
     try {
-        _mappingConfig = &_config.lookup("mapping");
-        logger.log(LOG_INFO, "Mapping | %d mapping(s)", _mappingConfig->getLength());
+        libconfig::Setting &mappingConfig = config.lookup("mapping");
+        logger.log(LOG_INFO, "Mapping | %d mapping(s)", mappingConfig.getLength());
 
         // no need to continue if there are no mappings to be processed
-        if (_mappingConfig->getLength() == 0) {
+        if (mappingConfig.getLength() == 0) {
             return RETURN_OK;
         }
 
-        for (int i = 0; i <= _mappingConfig->getLength() - 1; i++) {
+        for (int i = 0; i <= mappingConfig.getLength() - 1; i++) {
             std::string source;
             std::string target;
             unsigned int sustain = 0;
+            bool coalesce = false;
+            MappingRoute route;
 
             try {
-                source = (const char *)(*_mappingConfig)[i].lookup("source");
-                target = (const char *)(*_mappingConfig)[i].lookup("target");
-                (*_mappingConfig)[i].lookupValue("sustain", sustain);
+                source = (const char *)mappingConfig[i].lookup("source");
+                target = (const char *)mappingConfig[i].lookup("target");
+                mappingConfig[i].lookupValue("sustain", sustain);
+                mappingConfig[i].lookupValue("coalesce", coalesce);
+
+                if (mappingConfig[i].exists("destinations")) {
+                    libconfig::Setting &destinations = mappingConfig[i].lookup("destinations");
+
+                    for (int d = 0; d < destinations.getLength(); d++) {
+                        route.destinations.push_back((const char *)destinations[d]);
+                    }
+                }
             }
             catch (const libconfig::SettingNotFoundException &nfex) {
                 logger.log(LOG_ERROR, "Mapping | WARNING | Config file parse error at %s. Skipping....", nfex.getPath());
@@ -90,20 +153,49 @@ int MappingConfigManager::init(void)
                 continue;
             }
 
-            if (mapContains(_mapping, source)) {
+            ElementID sourceId = _symbols.intern(source);
+            ElementID targetId = _symbols.intern(target);
+
+            if (sourceId == INVALID_ELEMENT_ID || targetId == INVALID_ELEMENT_ID) {
+                logger.log(LOG_ERROR, "Mapping | WARNING | Element symbol table full (%lu). Skipping %s....", _symbols.capacity(), source.c_str());
+                continue;
+            }
+
+            if (sourceId >= snapshot.mapping.size()) {
+                snapshot.mapping.resize(_symbols.size() + 1);
+                snapshot.sustainPeriods.resize(_symbols.size() + 1, 0);
+            }
+
+            route.source = sourceId;
+            route.target = targetId;
+
+            if (!addRoute(snapshot, route)) {
                 logger.log(LOG_INFO, "Mapping | WARNING | Skipping duplicate source %s ", source.c_str());
                 continue;
             }
+            else if (!snapshot.mapping[sourceId].first.empty()) {
+                logger.log(LOG_INFO, "Mapping | %s also to %s", source.c_str(), target.c_str());
+            }
             else {
-                _mapping[source] = std::make_pair(source, target);
+                snapshot.mapping[sourceId] = std::make_pair(source, target);
+                snapshot.mappingCount++;
                 logger.log(LOG_INFO, "Mapping | %s to %s", source.c_str(), target.c_str());
             }
 
-            if (sustain > 0 && !mapContains(_sustainMap, source)) {
-                _sustainMap[source] = sustain;
+            if (sustain > 0) {
+                snapshot.sustainPeriods[sourceId] = sustain;
+            }
+
+            if (coalesce) {
+                if (canCoalesce(source)) {
+                    snapshot.coalesceSet.insert(sourceId);
+                }
+                else {
+                    logger.log(LOG_ERROR, "Mapping | WARNING | %s is an edge triggered element and can't be coalesced", source.c_str());
+                }
             }
         }
-        logger.log(LOG_INFO, "Mapping | %i Mappings", _mapping.size());
+        logger.log(LOG_INFO, "Mapping | %lu Mappings (%lu coalesced)", snapshot.mappingCount, snapshot.coalesceSet.size());
     }
     catch (std::exception &e) {
         logger.log(LOG_ERROR, "Mapping | %s", e.what());
@@ -113,37 +205,44 @@ int MappingConfigManager::init(void)
     return RETURN_OK;
 }
 
-std::string MappingConfigManager::version(void)
+/**
+ *   @brief keep a mapping unless the same source, target and
+ *          destinations are already mapped
+ *
+ *   @param  MappingSnapshot the snapshot being loaded
+ *   @param  MappingRoute the mapping to add
+ *
+ *   @return bool false for a duplicate mapping
+ */
+bool MappingConfigManager::addRoute(MappingSnapshot &snapshot, MappingRoute &route)
 {
-    if (_mappingConfigFileVersion.empty()) {
-        try {
-            _mappingConfigFileVersion = (const char *)_config.lookup("version");
-        }
-        catch (const libconfig::SettingNotFoundException &nfex) {
-            logger.log(LOG_ERROR, "<WARNING> <ERROR> No version set in config");
+    for (const MappingRoute &existing : snapshot.routes) {
+        if (existing.source == route.source && existing.target == route.target && existing.destinations == route.destinations) {
+            return false;
         }
     }
 
-    return _mappingConfigFileVersion;
+    snapshot.routes.push_back(route);
+
+    return true;
 }
 
 /**
- *   @brief find a source and target pair based on a source
+ *   @brief check if an element may have intermediate values dropped
  *
- *   @param  std::string A string representing the name of the source element
- *   @param  MapEntry MapEntry to return into
+ *   @param  std::string the name of the source element
  *
- *   @return bool true if file exists, otherwise false
+ *   @return bool false for switches (S_) and indicators (I_) where every
+ *           edge has to be delivered, otherwise true
  */
-bool MappingConfigManager::find(std::string key, MapEntry **retMapEntry)
+bool MappingConfigManager::canCoalesce(std::string source)
 {
-    ElementMap::iterator ret = _mapping.find(key);
-    if (ret != _mapping.end()) {
-        *retMapEntry = &(ret->second);
-        return true;
-    }
-    else {
-        // provide a default mapping
-        return true;
-    }
+    return source.compare(0, 2, "S_") != 0 && source.compare(0, 2, "I_") != 0;
+}
+
+std::string MappingConfigManager::version(void)
+{
+    std::shared_ptr<const MappingSnapshot> current = snapshot();
+
+    return current ? current->version : "";
 }
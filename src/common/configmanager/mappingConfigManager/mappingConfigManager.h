@@ -12,41 +12,72 @@
 #include <iostream>
 #include <libconfig.h++>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <sys/stat.h>
 #include <vector>
 
+#include "plugins/common/elementsymboltable.h"
 #include "plugins/common/utils.h"
 
 #define RETURN_OK 1
 #define RETURN_ERROR 0
 
 typedef std::pair<std::string, std::string> MapEntry;
-typedef std::map<std::string, MapEntry> ElementMap;
+typedef std::vector<MapEntry> ElementMap; ///< indexed by source ElementID, empty source if unmapped
+
+//! one source to target mapping and the plugins it's delivered to
+typedef struct {
+    ElementID source;
+    ElementID target;
+    std::vector<std::string> destinations; ///< plugin names, empty for every plugin but the source
+} MappingRoute;
+
+typedef std::vector<MappingRoute> MappingRouteList;
+
+/**
+ * everything read from one version of the mapping file - built in
+ * full before it's published and never changed afterwards, so readers
+ * holding a snapshot need no locks while a reload builds the next one
+ */
+struct MappingSnapshot {
+    std::string version;
+    ElementMap mapping;
+    MappingRouteList routes; ///< every mapping, a source mapped more than once fans out
+    size_t mappingCount;
+    std::vector<unsigned int> sustainPeriods; ///< indexed by source ElementID, 0 if not sustained
+    std::set<ElementID> coalesceSet; ///< sources where only the latest value matters
+
+    MappingSnapshot(void)
+        : mappingCount(0){};
+
+    unsigned int sustainPeriod(ElementID id) const { return id < sustainPeriods.size() ? sustainPeriods[id] : 0; };
+};
 
 class MappingConfigManager
 {
 protected:
-    libconfig::Config _config;
-    libconfig::Setting *_mappingConfig;
     std::string _configFilename;
-    std::string _mappingConfigFileVersion;
-    std::string _configName;
-    libconfig::Setting *_root;
-    ElementMap _mapping;
+    ElementSymbolTable _symbols; ///< every source and target name gets an id at load, shared by every snapshot
+    std::shared_ptr<const MappingSnapshot> _snapshot; ///< swapped atomically by init and reload
 
-    std::map<std::string, unsigned int> _sustainMap;
+    bool canCoalesce(std::string source);
+    bool addRoute(MappingSnapshot &snapshot, MappingRoute &route);
+    int load(MappingSnapshot &snapshot);
 
 public:
     MappingConfigManager(std::string);
     ~MappingConfigManager(void);
-    const libconfig::Setting *config(void);
     int init(void);
+
+    //! rereads the mapping file into a new snapshot, the current one is kept if it can't be read
+    int reload(void);
     bool fileExists(std::string filename);
     std::string configFilename(void);
     std::string version(void);
-    bool find(std::string key, MapEntry **retMapEntry);
-    std::map<std::string, unsigned int> &sustainMap(void) { return _sustainMap; };
+    std::shared_ptr<const MappingSnapshot> snapshot(void) { return std::atomic_load(&_snapshot); };
+    ElementSymbolTable &symbols(void) { return _symbols; };
 };
 
 #endif
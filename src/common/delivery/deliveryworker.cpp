@@ -0,0 +1,98 @@
+#include <algorithm>
+
+#include "deliveryworker.h"
+
+DeliveryWorker::DeliveryWorker(std::string name, DeliveryFunction deliver)
+    : _name(name)
+    , _deliver(deliver)
+    , _queue(DELIVERY_DEFAULT_CAPACITY, OVERFLOW_BLOCK)
+    , _batchSize(DELIVERY_DEFAULT_BATCH_SIZE)
+    , _queuedCount(0)
+    , _deliveredCount(0)
+    , _failedCount(0)
+    , _maxDepth(0)
+{
+    // coalescing overflow keeps only the latest value per element
+    _queue.setCoalesceKey([](const EventValue &value) { return std::to_string(value.elementId); });
+}
+
+DeliveryWorker::~DeliveryWorker(void)
+{
+    stop();
+}
+
+bool DeliveryWorker::configure(const DeliveryQueueConfiguration &configuration)
+{
+    QueueOverflowPolicy policy = OVERFLOW_BLOCK;
+    bool retVal = QueueOverflowPolicyFromString(configuration.overflowPolicy, &policy);
+
+    if (!retVal) {
+        policy = OVERFLOW_BLOCK;
+    }
+
+    _queue.configure(configuration.capacity, policy);
+    _batchSize = std::max((size_t)1, configuration.batchSize);
+
+    return retVal;
+}
+
+void DeliveryWorker::push(const EventValue &value)
+{
+    _queue.push(value);
+    _queuedCount.fetch_add(1, std::memory_order_relaxed);
+
+    size_t depth = _queue.size();
+    size_t maxDepth = _maxDepth.load(std::memory_order_relaxed);
+
+    while (depth > maxDepth && !_maxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {
+    }
+}
+
+void DeliveryWorker::start(void)
+{
+    if (!_thread.joinable()) {
+        _thread = std::thread(&DeliveryWorker::run, this);
+    }
+}
+
+void DeliveryWorker::stop(void)
+{
+    _queue.unblock();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void DeliveryWorker::deliver(std::vector<EventValue> &batch)
+{
+    if (!_deliver(batch)) {
+        _failedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _deliveredCount.fetch_add(batch.size(), std::memory_order_relaxed);
+    batch.clear();
+}
+
+void DeliveryWorker::run(void)
+{
+    std::vector<EventValue> batch;
+
+    batch.reserve(_batchSize);
+
+    for (;;) {
+        try {
+            _queue.popBatch(batch, _batchSize);
+        }
+        catch (ConcurrentQueueInterrupted &queueException) {
+            break;
+        }
+
+        deliver(batch);
+    }
+
+    // hand over whatever was queued before the stop
+    while (_queue.drainTo(batch, _batchSize) > 0) {
+        deliver(batch);
+    }
+}
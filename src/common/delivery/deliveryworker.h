@@ -0,0 +1,86 @@
+#ifndef __DELIVERYWORKER_H
+#define __DELIVERYWORKER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "elements/events/eventvalue.h"
+#include "queue/mpsc_ring_queue.h"
+
+#define DELIVERY_DEFAULT_CAPACITY 1024
+#define DELIVERY_DEFAULT_OVERFLOW_POLICY "block"
+#define DELIVERY_DEFAULT_BATCH_SIZE 64
+
+//! per destination queue settings from the plugin configuration
+typedef struct {
+    size_t capacity;
+    std::string overflowPolicy; ///< "block", "dropOldest" or "coalesce"
+    size_t batchSize;
+} DeliveryQueueConfiguration;
+
+//! hands a batch of values to the destination, returns false when delivery failed
+typedef std::function<bool(std::vector<EventValue> &values)> DeliveryFunction;
+
+/**
+ * bounded queue and thread in front of one destination plugin - the
+ * event loop only pushes, so a plugin that is slow to take its values
+ * holds up its own queue and no other destination's
+ *
+ * each destination has a single FIFO queue so values of one element
+ * reach it in the order they were routed, whatever the overflow policy
+ * (coalesce keeps the latest value per element, dropOldest drops from
+ * the head). block makes the event loop wait for the destination once
+ * its queue is full, which is what the other two policies avoid - it's
+ * the default, as coalescing would merge the press and release of a
+ * switch and only suits destinations that take level values
+ */
+class DeliveryWorker
+{
+protected:
+    std::string _name;
+    DeliveryFunction _deliver;
+    MPSCRingQueue<EventValue> _queue;
+    size_t _batchSize;
+    std::thread _thread;
+
+    std::atomic<uint64_t> _queuedCount;
+    std::atomic<uint64_t> _deliveredCount;
+    std::atomic<uint64_t> _failedCount; ///< batches the destination refused
+    std::atomic<size_t> _maxDepth;
+
+    void run(void);
+    void deliver(std::vector<EventValue> &batch);
+
+public:
+    DeliveryWorker(std::string name, DeliveryFunction deliver);
+    virtual ~DeliveryWorker(void);
+
+    DeliveryWorker(const DeliveryWorker &) = delete; // disable copying
+    DeliveryWorker &operator=(const DeliveryWorker &) = delete; // disable assignment
+
+    //! sizes the queue - returns false for an unknown overflow policy, which falls back to block
+    bool configure(const DeliveryQueueConfiguration &configuration);
+
+    void push(const EventValue &value);
+
+    void start(void);
+
+    //! stops the thread once everything queued so far has been delivered
+    void stop(void);
+
+    const std::string &name(void) { return _name; };
+    size_t depth(void) { return _queue.size(); };
+    size_t maxDepth(void) { return _maxDepth.load(std::memory_order_relaxed); };
+    size_t capacity(void) { return _queue.capacity(); };
+    QueueOverflowPolicy overflowPolicy(void) { return _queue.overflowPolicy(); };
+    uint64_t queuedCount(void) { return _queuedCount.load(std::memory_order_relaxed); };
+    uint64_t deliveredCount(void) { return _deliveredCount.load(std::memory_order_relaxed); };
+    uint64_t failedCount(void) { return _failedCount.load(std::memory_order_relaxed); };
+    uint64_t droppedCount(void) { return _queue.droppedCount(); };
+    uint64_t coalescedCount(void) { return _queue.coalescedCount(); };
+};
+
+#endif
@@ -4,10 +4,17 @@
 #include "attribute.h"
 #include "plugins/common/simhubdeviceplugin.h"
 
-//! marshals C++ Attribute instance to C generic struct
-GenericTLV *AttributeToCGeneric(std::shared_ptr<Attribute> value)
+//! marshals C++ Attribute instance to C generic struct - from pool when one is given
+GenericTLV *AttributeToCGeneric(std::shared_ptr<Attribute> value, GenericTLVPool *pool)
 {
-    GenericTLV *retVal = make_generic(value->name().c_str(), (const char *)"-");
+    GenericTLV *retVal = NULL;
+
+    if (pool) {
+        retVal = pool_make_generic(pool, value->elementId(), value->name().c_str(), (const char *)"-");
+    }
+    else {
+        retVal = make_generic(value->name().c_str(), (const char *)"-");
+    }
 
     // strncpy(retVal->description, value->description().c_str(), value->description().size());
     // strncpy(retVal->units, value->units().c_str(), value->units().size());
@@ -34,8 +41,7 @@ GenericTLV *AttributeToCGeneric(std::shared_ptr<Attribute> value)
         break;
 
     case STRING_ATTRIBUTE:
-        free(retVal);
-        retVal = make_string_generic(value->name().c_str(), (const char *)"-", value->value<std::string>().c_str());
+        generic_set_string_value(retVal, value->value<std::string>().c_str());
         break;
 
     default:
@@ -44,6 +50,7 @@ GenericTLV *AttributeToCGeneric(std::shared_ptr<Attribute> value)
     }
 
     retVal->ownerPlugin = value->ownerPlugin();
+    retVal->element_id = value->elementId();
 
     return retVal;
 }
@@ -81,6 +88,7 @@ std::shared_ptr<Attribute> AttributeFromCGeneric(GenericTLV *generic)
     }
 
     retVal->setName(generic->name);
+    retVal->setElementId(generic->element_id);
     // retVal->setDescription(generic->description);
     // retVal->setUnits(generic->units);
 
@@ -90,7 +98,8 @@ std::shared_ptr<Attribute> AttributeFromCGeneric(GenericTLV *generic)
 // -- instance methods
 
 Attribute::Attribute(SPHANDLE ownerPlugin)
-    : _ownerPlugin(ownerPlugin)
+    : _elementId(INVALID_ELEMENT_ID)
+    , _ownerPlugin(ownerPlugin)
 {
 }
 
@@ -17,6 +17,7 @@ protected:
     mpark::variant<int64_t, int, float, double, bool, std::string> _defaultValue;
 
     std::string _name;
+    ElementID _elementId;
     std::string _description;
     std::string _units;
     std::chrono::milliseconds _timestamp;
@@ -29,6 +30,9 @@ public:
     std::string name(void) const { return _name; };
     void setName(std::string name) { _name = name; };
 
+    ElementID elementId(void) const { return _elementId; };
+    void setElementId(ElementID elementId) { _elementId = elementId; };
+
     SPHANDLE ownerPlugin(void) { return _ownerPlugin; };
 
     std::string description(void) { return _description.empty() ? "none" : _description; };
@@ -86,7 +90,7 @@ public:
     std::string timestampString();
 };
 
-GenericTLV *AttributeToCGeneric(std::shared_ptr<Attribute> value);
+GenericTLV *AttributeToCGeneric(std::shared_ptr<Attribute> value, GenericTLVPool *pool = NULL);
 //! marshals the C generic struct instance into an Attribute C++ generic container
 std::shared_ptr<Attribute> AttributeFromCGeneric(GenericTLV *generic);
 
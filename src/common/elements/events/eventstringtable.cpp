@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "eventstringtable.h"
+
+EventStringTable::EventStringTable(size_t capacity)
+    : _next(INVALID_STRING_HANDLE)
+    , _truncatedCount(0)
+    , _expiredCount(0)
+{
+    size_t size = 2;
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    _slots.reset(new Slot[size]);
+    _mask = size - 1;
+
+    for (size_t i = 0; i < size; i++) {
+        _slots[i].sequence.store(0, std::memory_order_relaxed);
+        _slots[i].handle.store(INVALID_STRING_HANDLE, std::memory_order_relaxed);
+    }
+}
+
+StringHandle EventStringTable::store(const char *value)
+{
+    uint64_t words[EVENT_STRING_SLOT_WORDS] = { 0 };
+    size_t length = strlen(value);
+    StringHandle handle;
+
+    if (length >= EVENT_STRING_SLOT_SIZE) {
+        length = EVENT_STRING_SLOT_SIZE - 1;
+        _truncatedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    memcpy(words, value, length);
+
+    // handles wrap after 4G stores, skipping the invalid one
+    do {
+        handle = _next.fetch_add(1, std::memory_order_relaxed) + 1;
+    } while (handle == INVALID_STRING_HANDLE);
+
+    Slot &slot = _slots[handle & _mask];
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    for (;;) {
+        if (!(sequence & 1) && slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            break;
+        }
+
+        sequence = slot.sequence.load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.handle.store(handle, std::memory_order_relaxed);
+
+    for (size_t w = 0; w < EVENT_STRING_SLOT_WORDS; w++) {
+        slot.words[w].store(words[w], std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    return handle;
+}
+
+bool EventStringTable::load(StringHandle handle, EventStringBuffer buffer) const
+{
+    uint64_t words[EVENT_STRING_SLOT_WORDS];
+    const Slot &slot = _slots[handle & _mask];
+    StringHandle stored;
+    uint32_t before;
+    uint32_t after;
+
+    buffer[0] = '\0';
+
+    if (handle == INVALID_STRING_HANDLE) {
+        return false;
+    }
+
+    do {
+        before = slot.sequence.load(std::memory_order_acquire);
+        stored = slot.handle.load(std::memory_order_relaxed);
+
+        for (size_t w = 0; w < EVENT_STRING_SLOT_WORDS; w++) {
+            words[w] = slot.words[w].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    if (stored != handle) {
+        _expiredCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    memcpy(buffer, words, EVENT_STRING_SLOT_SIZE);
+    buffer[EVENT_STRING_SLOT_SIZE - 1] = '\0';
+
+    return true;
+}
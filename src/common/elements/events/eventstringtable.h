@@ -0,0 +1,67 @@
+#ifndef __EVENTSTRINGTABLE_H
+#define __EVENTSTRINGTABLE_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+#define EVENT_STRING_CAPACITY 4096 ///< long strings held at once, rounded up to a power of two
+#define EVENT_STRING_SLOT_SIZE 256 ///< longest string held, including its terminator
+#define EVENT_STRING_SLOT_WORDS (EVENT_STRING_SLOT_SIZE / sizeof(uint64_t))
+
+typedef uint32_t StringHandle; ///< id of a string stored in an EventStringTable
+typedef char EventStringBuffer[EVENT_STRING_SLOT_SIZE]; ///< a string copied out of an EventStringTable
+
+#define INVALID_STRING_HANDLE 0
+
+/**
+ * Bounded ring holding the string values too long to travel inside an
+ * event.
+ *
+ * The sims send free-form strings, so rather than keeping every
+ * distinct one the table reuses its oldest slot for each new string.
+ * A handle names the store rather than the slot - once its slot has
+ * been reused, load fails instead of returning another string. Values
+ * only expire when more than capacity long strings arrive before they
+ * are read.
+ *
+ * Storing never takes a lock: a producer claims the next slot with a
+ * fetch_add and writes it under the slot's seqlock (an odd sequence
+ * marks it as being written and serialises producers that wrap onto
+ * the same slot). Readers retry their copy until they read the same
+ * even sequence before and after.
+ */
+class EventStringTable
+{
+protected:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        std::atomic<StringHandle> handle; ///< of the string in words
+        std::atomic<uint64_t> words[EVENT_STRING_SLOT_WORDS];
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask;
+    std::atomic<StringHandle> _next;
+
+    std::atomic<uint64_t> _truncatedCount;
+    mutable std::atomic<uint64_t> _expiredCount;
+
+public:
+    EventStringTable(size_t capacity = EVENT_STRING_CAPACITY);
+
+    EventStringTable(const EventStringTable &) = delete; // disable copying
+    EventStringTable &operator=(const EventStringTable &) = delete; // disable assignment
+
+    //! stores value and returns its handle - a value longer than a slot is cut short and counted
+    StringHandle store(const char *value);
+
+    //! copies the string of handle into buffer - false, leaving it empty, once its slot has been reused
+    bool load(StringHandle handle, EventStringBuffer buffer) const;
+
+    size_t capacity(void) const { return _mask + 1; };
+    uint64_t truncatedCount(void) const { return _truncatedCount.load(std::memory_order_relaxed); };
+    uint64_t expiredCount(void) const { return _expiredCount.load(std::memory_order_relaxed); };
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include <assert.h>
+#include <sstream>
+#include <string.h>
+
+#include "eventvalue.h"
+
+int64_t EventTimestampToEpochMs(int64_t timestamp)
+{
+    using namespace std::chrono;
+
+    int64_t age = EventTimestampNow() - timestamp;
+    milliseconds now = duration_cast<milliseconds>(system_clock::now().time_since_epoch());
+
+    return now.count() - duration_cast<milliseconds>(nanoseconds(age)).count();
+}
+
+void EventValueSetString(EventValue &value, const char *string, EventStringTable &strings)
+{
+    size_t length = strlen(string);
+
+    memset(&value.value, 0, sizeof(value.value));
+
+    if (length < EVENT_INLINE_STRING_SIZE) {
+        memcpy(value.value.string_value, string, length);
+        value.flags &= ~EVENT_FLAG_STRING_HANDLE;
+    }
+    else {
+        value.value.string_handle = strings.store(string);
+        value.flags |= EVENT_FLAG_STRING_HANDLE;
+    }
+}
+
+const char *EventValueString(const EventValue &value, const EventStringTable &strings, EventStringBuffer buffer)
+{
+    if (value.flags & EVENT_FLAG_STRING_HANDLE) {
+        strings.load(value.value.string_handle, buffer);
+        return buffer;
+    }
+
+    return value.value.string_value;
+}
+
+EventValue EventValueFromCGeneric(const GenericTLV *generic, EventOwnerID owner, EventStringTable &strings)
+{
+    EventValue retVal;
+
+    memset(&retVal, 0, sizeof(EventValue));
+
+    retVal.elementId = generic->element_id;
+    retVal.owner = owner;
+    retVal.timestamp = EventTimestampNow();
+
+    switch (generic->type) {
+    case CONFIG_BOOL:
+        retVal.type = BOOL_ATTRIBUTE;
+        retVal.value.bool_value = generic->value.bool_value;
+        break;
+    case CONFIG_FLOAT:
+        retVal.type = FLOAT_ATTRIBUTE;
+        retVal.value.float_value = generic->value.float_value;
+        break;
+    case CONFIG_INT:
+    case CONFIG_UINT:
+        retVal.type = INT_ATTRIBUTE;
+        retVal.value.int_value = generic->value.int_value;
+        break;
+    case CONFIG_STRING:
+        retVal.type = STRING_ATTRIBUTE;
+        EventValueSetString(retVal, generic->value.string_value ? generic->value.string_value : "", strings);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    return retVal;
+}
+
+GenericTLV *EventValueToCGeneric(const EventValue &value, const ElementSymbolTable &symbols, const EventStringTable &strings, GenericTLVPool *pool)
+{
+    GenericTLV *retVal = NULL;
+    const char *name = symbols.name(value.elementId).c_str();
+    EventStringBuffer buffer;
+
+    if (pool) {
+        retVal = pool_make_generic(pool, value.elementId, name, (const char *)"-");
+    }
+    else {
+        retVal = make_generic(name, (const char *)"-");
+        retVal->element_id = value.elementId;
+    }
+
+    switch (value.type) {
+    case BOOL_ATTRIBUTE:
+        retVal->type = CONFIG_BOOL;
+        retVal->value.bool_value = value.value.bool_value;
+        break;
+    case FLOAT_ATTRIBUTE:
+        retVal->type = CONFIG_FLOAT;
+        retVal->value.float_value = value.value.float_value;
+        break;
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        retVal->type = CONFIG_INT;
+        retVal->value.int_value = (int)value.value.int_value;
+        break;
+    case STRING_ATTRIBUTE:
+        generic_set_string_value(retVal, EventValueString(value, strings, buffer));
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    return retVal;
+}
+
+std::string EventValueToString(const EventValue &value, const EventStringTable &strings)
+{
+    std::ostringstream oss;
+    EventStringBuffer buffer;
+
+    switch (value.type) {
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        oss << (int)value.value.int_value;
+        break;
+    case FLOAT_ATTRIBUTE:
+        oss << value.value.float_value;
+        break;
+    case STRING_ATTRIBUTE:
+        oss << EventValueString(value, strings, buffer);
+        break;
+    case BOOL_ATTRIBUTE:
+        oss << value.value.bool_value;
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    return oss.str();
+}
+
+std::shared_ptr<Attribute> AttributeFromEventValue(const EventValue &value, const ElementSymbolTable &symbols, const EventStringTable &strings, SPHANDLE ownerPlugin)
+{
+    std::shared_ptr<Attribute> retVal(new Attribute(ownerPlugin));
+    EventStringBuffer buffer;
+
+    switch (value.type) {
+    case BOOL_ATTRIBUTE:
+        retVal->setValue<bool>(value.value.bool_value);
+        break;
+    case FLOAT_ATTRIBUTE:
+        retVal->setValue<float>(value.value.float_value);
+        break;
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        retVal->setValue<int>((int)value.value.int_value);
+        break;
+    case STRING_ATTRIBUTE:
+        retVal->setValue<std::string>(EventValueString(value, strings, buffer));
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    retVal->setType((eAttribute_t)value.type);
+    retVal->setName(symbols.name(value.elementId));
+    retVal->setElementId(value.elementId);
+
+    return retVal;
+}
@@ -0,0 +1,77 @@
+#ifndef __EVENTVALUE_H
+#define __EVENTVALUE_H
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+#include "elements/attributes/attribute.h"
+#include "eventstringtable.h"
+#include "plugins/common/elementsymboltable.h"
+#include "plugins/common/simhubdeviceplugin.h"
+
+#define EVENT_INLINE_STRING_SIZE 16 ///< strings shorter than this travel inside the event
+
+typedef uint8_t EventOwnerID; ///< small host assigned id of the plugin an event came from
+
+#define EVENT_OWNER_NONE 0
+#define EVENT_FLAG_STRING_HANDLE 0x01 ///< the string value is in an EventStringTable rather than inline
+
+/**
+ * compact, trivially copyable event - moves through the event queue,
+ * the coalescer and the sustain table by value, replacing the heap
+ * allocated shared_ptr<Attribute> per event
+ *
+ * the values the sims and transforms produce are mostly short ("ON",
+ * "OFF", mode names ...) and are carried inline - only longer ones go
+ * to an EventStringTable, use EventValueSetString/EventValueString
+ * rather than the union members for strings
+ */
+typedef struct {
+    ElementID elementId;
+    uint8_t type; ///< eAttribute_t
+    EventOwnerID owner;
+    uint8_t flags; ///< EVENT_FLAG_*
+    uint8_t reserved;
+    union {
+        int64_t int_value;
+        float float_value;
+        bool bool_value;
+        StringHandle string_handle;
+        char string_value[EVENT_INLINE_STRING_SIZE]; ///< nul terminated
+    } value;
+    int64_t timestamp; ///< steady clock nanoseconds, see EventTimestampNow
+} EventValue;
+
+static_assert(std::is_trivially_copyable<EventValue>::value, "EventValue must stay trivially copyable");
+static_assert(sizeof(EventValue) <= 32, "EventValue must fit in half a cache line");
+
+//! monotonic timestamp used for events - not affected by wall clock changes
+inline int64_t EventTimestampNow(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! converts an event timestamp into milliseconds since the unix epoch
+int64_t EventTimestampToEpochMs(int64_t timestamp);
+
+//! sets the string value of an event, storing it in strings when it doesn't fit inline
+void EventValueSetString(EventValue &value, const char *string, EventStringTable &strings);
+
+//! the string value of an event, copied into buffer when it's in strings - empty once that has expired
+const char *EventValueString(const EventValue &value, const EventStringTable &strings, EventStringBuffer buffer);
+
+//! builds an event from a plugin generic - long string values are stored in strings
+EventValue EventValueFromCGeneric(const GenericTLV *generic, EventOwnerID owner, EventStringTable &strings);
+
+//! marshals an event into a C generic for delivery to a plugin - from pool when one is given
+GenericTLV *EventValueToCGeneric(const EventValue &value, const ElementSymbolTable &symbols, const EventStringTable &strings, GenericTLVPool *pool = NULL);
+
+//! same formatting as Attribute::valueToString
+std::string EventValueToString(const EventValue &value, const EventStringTable &strings);
+
+//! Attribute facade of an event, for code that still works with attributes
+std::shared_ptr<Attribute> AttributeFromEventValue(const EventValue &value, const ElementSymbolTable &symbols, const EventStringTable &strings, SPHANDLE ownerPlugin);
+
+#endif
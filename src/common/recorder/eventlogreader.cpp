@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "eventlogreader.h"
+
+EventLogReader::EventLogReader(void)
+    : _file(NULL)
+    , _startTimestamp(0)
+    , _startEpochMs(0)
+    , _position(0)
+    , _remaining(0)
+    , _lastTimestamp(0)
+{
+}
+
+EventLogReader::~EventLogReader(void)
+{
+    close();
+}
+
+bool EventLogReader::open(const std::string &path)
+{
+    uint64_t magic;
+    uint64_t version;
+    uint64_t value;
+
+    close();
+
+    if (!(_file = fopen(path.c_str(), "rb"))) {
+        return false;
+    }
+
+    _block.resize(RECORDER_HEADER_SIZE);
+    _position = 0;
+
+    if (fread(&_block[0], 1, RECORDER_HEADER_SIZE, _file) != RECORDER_HEADER_SIZE || !readLittleEndian(magic, 4) || magic != RECORDER_MAGIC
+        || !readLittleEndian(version, 4) || (version & 0xFFFF) != RECORDER_VERSION) {
+        close();
+        return false;
+    }
+
+    readLittleEndian(value, 8);
+    _startTimestamp = value;
+    readLittleEndian(value, 8);
+    _startEpochMs = value;
+
+    return true;
+}
+
+void EventLogReader::close(void)
+{
+    if (_file) {
+        fclose(_file);
+        _file = NULL;
+    }
+
+    _remaining = 0;
+    _stringHandles.clear();
+
+    for (std::vector<std::string> &names : _names) {
+        names.clear();
+    }
+}
+
+const std::string &EventLogReader::name(RecorderStringKind kind, uint32_t id)
+{
+    static const std::string emptyName;
+    return id < _names[kind].size() ? _names[kind][id] : emptyName;
+}
+
+bool EventLogReader::readVarint(uint64_t &value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64 && _position < _block.size(); shift += 7) {
+        uint8_t byte = _block[_position++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool EventLogReader::readLittleEndian(uint64_t &value, size_t size)
+{
+    if (_block.size() - _position < size) {
+        return false;
+    }
+
+    value = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        value |= (uint64_t)(uint8_t)_block[_position++] << (i * 8);
+    }
+
+    return true;
+}
+
+//! reads the block at the file position into _block, false when there's no complete block left
+bool EventLogReader::readBlock(uint8_t &type)
+{
+    uint8_t header[RECORDER_BLOCK_HEADER_SIZE];
+    uint32_t length = 0;
+    struct stat status;
+
+    if (!_file || fread(header, 1, sizeof(header), _file) != sizeof(header) || fstat(fileno(_file), &status) != 0) {
+        return false;
+    }
+
+    type = header[0];
+
+    for (size_t i = 0; i < 4; i++) {
+        length |= (uint32_t)header[1 + i] << (i * 8);
+    }
+
+    // a length past the end of the file is a block cut short
+    if ((uint64_t)length > (uint64_t)(status.st_size - ftello(_file))) {
+        return false;
+    }
+
+    _block.resize(length);
+    _position = 0;
+
+    return length == 0 || fread(&_block[0], 1, length, _file) == length;
+}
+
+bool EventLogReader::readStrings(void)
+{
+    uint64_t count;
+
+    if (!readVarint(count)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t id;
+        uint64_t length;
+
+        if (_position >= _block.size()) {
+            return false;
+        }
+
+        uint8_t kind = _block[_position++];
+
+        if (kind > RECORDER_STRING_PLUGIN || !readVarint(id) || !readVarint(length) || _block.size() - _position < length) {
+            return false;
+        }
+
+        if (id >= _names[kind].size()) {
+            _names[kind].resize(id + 1);
+        }
+
+        _names[kind][id].assign(_block, _position, length);
+        _position += length;
+    }
+
+    return true;
+}
+
+//! fills in the string value of length at the block position, naming a long one with a handle of the log's own
+void EventLogReader::readString(EventValue &value, size_t length)
+{
+    if (length < EVENT_INLINE_STRING_SIZE) {
+        memcpy(value.value.string_value, &_block[_position], length);
+    }
+    else {
+        std::string string(_block, _position, length);
+        std::map<std::string, StringHandle>::iterator it = _stringHandles.find(string);
+        std::vector<std::string> &values = _names[RECORDER_STRING_VALUE];
+
+        if (it == _stringHandles.end()) {
+            values.resize(std::max((size_t)1, values.size()));
+            it = _stringHandles.emplace(string, values.size()).first;
+            values.push_back(string);
+        }
+
+        value.flags |= EVENT_FLAG_STRING_HANDLE;
+        value.value.string_handle = it->second;
+    }
+
+    _position += length;
+}
+
+bool EventLogReader::next(EventValue &value)
+{
+    uint64_t field;
+
+    while (_remaining == 0) {
+        uint8_t type;
+
+        if (!readBlock(type)) {
+            return false;
+        }
+
+        if (type == RECORDER_BLOCK_TRAILER || (type == RECORDER_BLOCK_STRINGS && !readStrings())) {
+            return false;
+        }
+        else if (type == RECORDER_BLOCK_EVENTS) {
+            uint64_t timestamp;
+
+            if (!readVarint(field) || !readLittleEndian(timestamp, 8)) {
+                return false;
+            }
+
+            _remaining = field;
+            _lastTimestamp = timestamp;
+        }
+    }
+
+    memset(&value, 0, sizeof(EventValue));
+
+    if (!readVarint(field) || _block.size() - _position < 2) {
+        _remaining = 0;
+        return false;
+    }
+
+    value.elementId = field;
+    value.type = _block[_position++];
+    value.owner = _block[_position++];
+
+    if (!readVarint(field)) {
+        _remaining = 0;
+        return false;
+    }
+
+    _lastTimestamp += (int64_t)(field >> 1) ^ -(int64_t)(field & 1);
+    value.timestamp = _lastTimestamp;
+
+    bool decoded = true;
+
+    switch (value.type) {
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        decoded = readVarint(field);
+        value.value.int_value = (int64_t)(field >> 1) ^ -(int64_t)(field & 1);
+        break;
+
+    case FLOAT_ATTRIBUTE: {
+        uint32_t bits;
+        decoded = readLittleEndian(field, 4);
+        bits = field;
+        memcpy(&value.value.float_value, &bits, sizeof(bits));
+        break;
+    }
+
+    case BOOL_ATTRIBUTE:
+        decoded = readLittleEndian(field, 1);
+        value.value.bool_value = field != 0;
+        break;
+
+    case STRING_ATTRIBUTE:
+        decoded = readVarint(field) && _block.size() - _position >= field;
+
+        if (decoded) {
+            readString(value, field);
+        }
+        break;
+    }
+
+    if (!decoded) {
+        _remaining = 0;
+        return false;
+    }
+
+    _remaining--;
+
+    return true;
+}
+
+bool EventLogReader::index(std::vector<EventLogIndexEntry> &entries)
+{
+    uint64_t offset;
+    uint64_t magic;
+
+    if (!_file) {
+        return false;
+    }
+
+    // the blocks are read from here again afterwards
+    off_t position = ftello(_file);
+    std::string block;
+
+    block.swap(_block);
+    size_t blockPosition = _position;
+
+    uint8_t type;
+    bool retVal = fseeko(_file, -(RECORDER_BLOCK_HEADER_SIZE + RECORDER_TRAILER_SIZE), SEEK_END) == 0 && readBlock(type) && type == RECORDER_BLOCK_TRAILER
+        && readLittleEndian(offset, 8) && readLittleEndian(magic, 4) && magic == RECORDER_TRAILER_MAGIC;
+
+    std::vector<EventLogIndexEntry> found;
+
+    // index blocks are chained from the last one back
+    while (retVal && offset != 0) {
+        uint64_t count;
+        std::vector<EventLogIndexEntry> blockEntries;
+
+        retVal = fseeko(_file, offset, SEEK_SET) == 0 && readBlock(type) && type == RECORDER_BLOCK_INDEX && readLittleEndian(offset, 8) && readVarint(count);
+
+        for (uint64_t i = 0; retVal && i < count; i++) {
+            EventLogIndexEntry entry;
+            uint64_t timestamp;
+            uint64_t events;
+
+            retVal = readLittleEndian(entry.offset, 8) && readLittleEndian(timestamp, 8) && readVarint(events);
+            entry.timestamp = timestamp;
+            entry.count = events;
+            blockEntries.push_back(entry);
+        }
+
+        found.insert(found.begin(), blockEntries.begin(), blockEntries.end());
+    }
+
+    if (retVal) {
+        entries.insert(entries.end(), found.begin(), found.end());
+    }
+
+    fseeko(_file, position, SEEK_SET);
+    _block.swap(block);
+    _position = blockPosition;
+
+    return retVal;
+}
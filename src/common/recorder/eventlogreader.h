@@ -0,0 +1,69 @@
+#ifndef __EVENTLOGREADER_H
+#define __EVENTLOGREADER_H
+
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "eventrecorder.h"
+
+//! an events block listed by an index block
+typedef struct {
+    uint64_t offset;
+    int64_t timestamp; ///< of the first event of the block
+    size_t count;
+} EventLogIndexEntry;
+
+/**
+ * reads back the events of a log written by EventRecorder, in the
+ * order they were recorded - element ids and owners are those of the
+ * recording session and are named by the log itself. String values
+ * too long to be inline get handles of the log's own, see stringValue
+ */
+class EventLogReader
+{
+protected:
+    FILE *_file;
+    int64_t _startTimestamp;
+    int64_t _startEpochMs;
+    std::string _block;
+    size_t _position; ///< in _block
+    size_t _remaining; ///< events left in the current events block
+    int64_t _lastTimestamp;
+    std::vector<std::string> _names[RECORDER_STRING_PLUGIN + 1]; ///< by RecorderStringKind, indexed by id
+    std::map<std::string, StringHandle> _stringHandles; ///< long string values read so far
+
+    bool readBlock(uint8_t &type);
+    bool readStrings(void);
+    void readString(EventValue &value, size_t length);
+    bool readVarint(uint64_t &value);
+    bool readLittleEndian(uint64_t &value, size_t size);
+    const std::string &name(RecorderStringKind kind, uint32_t id);
+
+public:
+    EventLogReader(void);
+    virtual ~EventLogReader(void);
+
+    EventLogReader(const EventLogReader &) = delete; // disable copying
+    EventLogReader &operator=(const EventLogReader &) = delete; // disable assignment
+
+    //! false when the file isn't an event log
+    bool open(const std::string &path);
+    void close(void);
+
+    //! the next event, false at the end of the log or of its last complete block
+    bool next(EventValue &value);
+
+    //! every events block of a finished log, from its index blocks - false without a trailer
+    bool index(std::vector<EventLogIndexEntry> &entries);
+
+    const std::string &elementName(ElementID id) { return name(RECORDER_STRING_ELEMENT, id); };
+    const std::string &pluginName(EventOwnerID owner) { return name(RECORDER_STRING_PLUGIN, owner); };
+    const std::string &stringValue(StringHandle handle) { return name(RECORDER_STRING_VALUE, handle); };
+    int64_t startTimestamp(void) { return _startTimestamp; };
+    int64_t startEpochMs(void) { return _startEpochMs; };
+};
+
+#endif
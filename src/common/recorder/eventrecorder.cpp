@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "eventrecorder.h"
+
+static void AppendLittleEndian(std::string &out, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        out.push_back((char)(value >> (i * 8)));
+    }
+}
+
+static void AppendVarint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((char)value);
+}
+
+static void AppendZigzag(std::string &out, int64_t value)
+{
+    AppendVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+EventRecorder::EventRecorder(const ElementSymbolTable &symbols, const EventStringTable &strings, const EventRecorderConfiguration &configuration)
+    : _symbols(symbols)
+    , _strings(strings)
+    , _configuration(configuration)
+    , _active(0)
+    , _requested(configuration.enabled)
+    , _recording(false)
+    , _inRecord(false)
+    , _terminated(false)
+    , _file(NULL)
+    , _offset(0)
+    , _lastTimestamp(0)
+    , _blockTimestamp(0)
+    , _blockEventCount(0)
+    , _stringCount(0)
+    , _lastIndexOffset(0)
+    , _recordedCount(0)
+    , _droppedCount(0)
+    , _bytesWritten(0)
+{
+    _configuration.bufferEvents = std::max((size_t)1, _configuration.bufferEvents);
+
+    for (RecordBuffer &buffer : _buffers) {
+        buffer.events.reset(new EventValue[_configuration.bufferEvents]);
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.full.store(false, std::memory_order_relaxed);
+        buffer.written = 0;
+    }
+}
+
+EventRecorder::~EventRecorder(void)
+{
+    stop();
+}
+
+EventRecorderConfiguration EventRecorder::DefaultConfiguration(void)
+{
+    return { "./recordings", false, RECORDER_DEFAULT_BUFFER_EVENTS, RECORDER_DEFAULT_FLUSH_INTERVAL };
+}
+
+void EventRecorder::setOwnerName(EventOwnerID owner, const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (owner >= _ownerNames.size()) {
+        _ownerNames.resize(owner + 1);
+    }
+
+    _ownerNames[owner] = name;
+}
+
+std::string EventRecorder::path(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _path;
+}
+
+void EventRecorder::record(const EventValue *values, size_t count)
+{
+    if (!_recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // stopRecording waits for the event thread to be out of here before
+    // it touches the buffers, see there
+    _inRecord.store(true, std::memory_order_seq_cst);
+
+    if (_recording.load(std::memory_order_seq_cst)) {
+        RecordBuffer *buffer = &_buffers[_active.load(std::memory_order_relaxed)];
+        size_t used = buffer->count.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < count; i++) {
+            if (used == _configuration.bufferEvents) {
+                buffer->count.store(used, std::memory_order_release);
+
+                if (!swapBuffers()) {
+                    _droppedCount.fetch_add(count - i, std::memory_order_relaxed);
+                    break;
+                }
+
+                buffer = &_buffers[_active.load(std::memory_order_relaxed)];
+                used = 0;
+            }
+
+            buffer->events[used++] = values[i];
+        }
+
+        buffer->count.store(used, std::memory_order_release);
+    }
+
+    _inRecord.store(false, std::memory_order_release);
+}
+
+//! hands the full active buffer to the writer, false while the writer still has the other one
+bool EventRecorder::swapBuffers(void)
+{
+    int active = _active.load(std::memory_order_relaxed);
+
+    if (_buffers[active ^ 1].full.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    _buffers[active].full.store(true, std::memory_order_release);
+    _active.store(active ^ 1, std::memory_order_release);
+    _writeEvent.notifyAll();
+
+    return true;
+}
+
+void EventRecorder::setRecording(bool recording)
+{
+    _requested.store(recording, std::memory_order_release);
+    _writeEvent.notifyAll();
+}
+
+void EventRecorder::toggleRecording(void)
+{
+    bool requested = _requested.load(std::memory_order_relaxed);
+
+    while (!_requested.compare_exchange_weak(requested, !requested)) {
+    }
+
+    _writeEvent.notifyAll();
+}
+
+void EventRecorder::start(void)
+{
+    if (!_thread.joinable()) {
+        _terminated = false;
+        _thread = std::thread(&EventRecorder::run, this);
+    }
+}
+
+void EventRecorder::stop(void)
+{
+    _terminated = true;
+    _writeEvent.notifyAll();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void EventRecorder::run(void)
+{
+    for (;;) {
+        bool terminated = _terminated.load(std::memory_order_acquire);
+        bool requested = _requested.load(std::memory_order_acquire);
+
+        if (_recording && (terminated || !requested)) {
+            stopRecording();
+        }
+
+        if (terminated) {
+            break;
+        }
+
+        // a log that can't be created waits for the next request
+        if (!_recording && requested && !startRecording()) {
+            _requested.store(false, std::memory_order_release);
+        }
+
+        if (_recording) {
+            drain();
+        }
+
+        uint32_t key = _writeEvent.prepareWait();
+
+        if (_terminated || _requested != _recording || (_recording && _buffers[_active.load(std::memory_order_acquire) ^ 1].full)) {
+            _writeEvent.cancelWait();
+            continue;
+        }
+
+        _writeEvent.commitWait(key, _recording ? std::chrono::nanoseconds(std::chrono::milliseconds(_configuration.flushInterval)) : std::chrono::nanoseconds::max());
+    }
+}
+
+//! opens a new log, the event thread starts recording once it's set up
+bool EventRecorder::startRecording(void)
+{
+    char name[64];
+    std::string path;
+    time_t now = time(NULL);
+    struct tm local;
+
+    if (mkdir(_configuration.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    localtime_r(&now, &local);
+    strftime(name, sizeof(name), "events-%Y%m%d-%H%M%S", &local);
+
+    // recordings started within the same second get a suffix
+    for (int i = 0; !_file && i < 100; i++) {
+        path = _configuration.directory + "/" + name + (i > 0 ? "-" + std::to_string(i) : "") + ".shev";
+        _file = fopen(path.c_str(), "wbx");
+
+        if (!_file && errno != EEXIST) {
+            break;
+        }
+    }
+
+    if (!_file) {
+        return false;
+    }
+
+    int64_t timestamp = EventTimestampNow();
+
+    _offset = 0;
+    _lastIndexOffset = 0;
+    _index.clear();
+    _eventBlock.clear();
+    _blockEventCount = 0;
+    _stringBlock.clear();
+    _stringCount = 0;
+    _namedElements.assign(_symbols.capacity() + 1, false);
+
+    _payload.clear();
+    AppendLittleEndian(_payload, RECORDER_MAGIC, 4);
+    AppendLittleEndian(_payload, RECORDER_VERSION, 2);
+    AppendLittleEndian(_payload, 0, 2);
+    AppendLittleEndian(_payload, timestamp, 8);
+    AppendLittleEndian(_payload, EventTimestampToEpochMs(timestamp), 8);
+    write(_payload.data(), _payload.size());
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _path = path;
+
+        for (size_t owner = EVENT_OWNER_NONE + 1; owner < _ownerNames.size(); owner++) {
+            if (!_ownerNames[owner].empty()) {
+                addString(RECORDER_STRING_PLUGIN, owner, _ownerNames[owner]);
+            }
+        }
+    }
+
+    // the event thread stays out of the buffers until recording is set
+    _active.store(0, std::memory_order_relaxed);
+
+    for (RecordBuffer &buffer : _buffers) {
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.full.store(false, std::memory_order_relaxed);
+        buffer.written = 0;
+    }
+
+    _recording.store(true, std::memory_order_seq_cst);
+
+    return true;
+}
+
+//! writes out everything recorded and closes the log
+void EventRecorder::stopRecording(void)
+{
+    // once the event thread is seen out of record after recording is
+    // cleared it won't touch the buffers again
+    _recording.store(false, std::memory_order_seq_cst);
+
+    while (_inRecord.load(std::memory_order_seq_cst)) {
+        std::this_thread::yield();
+    }
+
+    drain();
+    writeIndexBlock();
+
+    _payload.clear();
+    AppendLittleEndian(_payload, _lastIndexOffset, 8);
+    AppendLittleEndian(_payload, RECORDER_TRAILER_MAGIC, 4);
+    writeBlock(RECORDER_BLOCK_TRAILER, _payload);
+
+    fclose(_file);
+    _file = NULL;
+}
+
+//! writes what the event thread has recorded so far, the full buffer first as it holds the older events
+void EventRecorder::drain(void)
+{
+    int active = _active.load(std::memory_order_acquire);
+    RecordBuffer &previous = _buffers[active ^ 1];
+    RecordBuffer &current = _buffers[active];
+
+    if (previous.full.load(std::memory_order_acquire)) {
+        drainBuffer(previous, previous.count.load(std::memory_order_acquire));
+        previous.written = 0;
+        previous.count.store(0, std::memory_order_relaxed);
+        previous.full.store(false, std::memory_order_release);
+    }
+
+    drainBuffer(current, current.count.load(std::memory_order_acquire));
+    writeEventBlock();
+
+    if (fflush(_file) != 0 || ferror(_file)) {
+        _requested.store(false, std::memory_order_release);
+    }
+}
+
+void EventRecorder::drainBuffer(RecordBuffer &buffer, size_t count)
+{
+    for (size_t i = buffer.written; i < count; i++) {
+        encode(buffer.events[i]);
+
+        if (_blockEventCount == RECORDER_MAX_BLOCK_EVENTS) {
+            writeEventBlock();
+        }
+    }
+
+    if (count > buffer.written) {
+        _recordedCount.fetch_add(count - buffer.written, std::memory_order_relaxed);
+        buffer.written = count;
+    }
+}
+
+void EventRecorder::encode(const EventValue &value)
+{
+    if (_blockEventCount == 0) {
+        _eventBlock.clear();
+        AppendLittleEndian(_eventBlock, value.timestamp, 8);
+        _blockTimestamp = value.timestamp;
+        _lastTimestamp = value.timestamp;
+    }
+
+    if (value.elementId < _namedElements.size() && !_namedElements[value.elementId]) {
+        _namedElements[value.elementId] = true;
+        addString(RECORDER_STRING_ELEMENT, value.elementId, _symbols.name(value.elementId));
+    }
+
+    AppendVarint(_eventBlock, value.elementId);
+    _eventBlock.push_back((char)value.type);
+    _eventBlock.push_back((char)value.owner);
+    AppendZigzag(_eventBlock, value.timestamp - _lastTimestamp);
+    _lastTimestamp = value.timestamp;
+
+    switch (value.type) {
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        AppendZigzag(_eventBlock, value.value.int_value);
+        break;
+
+    case FLOAT_ATTRIBUTE: {
+        uint32_t bits;
+        memcpy(&bits, &value.value.float_value, sizeof(bits));
+        AppendLittleEndian(_eventBlock, bits, 4);
+        break;
+    }
+
+    case BOOL_ATTRIBUTE:
+        _eventBlock.push_back(value.value.bool_value ? 1 : 0);
+        break;
+
+    case STRING_ATTRIBUTE: {
+        EventStringBuffer buffer;
+        const char *string = EventValueString(value, _strings, buffer);
+        size_t length = strlen(string);
+
+        // the sims send free-form strings, so they're written as they are
+        AppendVarint(_eventBlock, length);
+        _eventBlock.append(string, length);
+        break;
+    }
+    }
+
+    _blockEventCount++;
+}
+
+void EventRecorder::addString(RecorderStringKind kind, uint32_t id, const std::string &value)
+{
+    _stringBlock.push_back((char)kind);
+    AppendVarint(_stringBlock, id);
+    AppendVarint(_stringBlock, value.size());
+    _stringBlock.append(value);
+    _stringCount++;
+}
+
+//! writes the strings the open events block introduced, then the block
+void EventRecorder::writeEventBlock(void)
+{
+    if (_stringCount > 0) {
+        _payload.clear();
+        AppendVarint(_payload, _stringCount);
+        _payload.append(_stringBlock);
+        writeBlock(RECORDER_BLOCK_STRINGS, _payload);
+
+        _stringBlock.clear();
+        _stringCount = 0;
+    }
+
+    if (_blockEventCount == 0) {
+        return;
+    }
+
+    _index.push_back({ _offset, _blockTimestamp, _blockEventCount });
+
+    _payload.clear();
+    AppendVarint(_payload, _blockEventCount);
+    _payload.append(_eventBlock);
+    writeBlock(RECORDER_BLOCK_EVENTS, _payload);
+
+    _eventBlock.clear();
+    _blockEventCount = 0;
+
+    if (_index.size() >= RECORDER_INDEX_INTERVAL) {
+        writeIndexBlock();
+    }
+}
+
+void EventRecorder::writeIndexBlock(void)
+{
+    if (_index.empty()) {
+        return;
+    }
+
+    uint64_t offset = _offset;
+
+    _payload.clear();
+    AppendLittleEndian(_payload, _lastIndexOffset, 8);
+    AppendVarint(_payload, _index.size());
+
+    for (const IndexEntry &entry : _index) {
+        AppendLittleEndian(_payload, entry.offset, 8);
+        AppendLittleEndian(_payload, entry.timestamp, 8);
+        AppendVarint(_payload, entry.count);
+    }
+
+    writeBlock(RECORDER_BLOCK_INDEX, _payload);
+
+    _lastIndexOffset = offset;
+    _index.clear();
+}
+
+void EventRecorder::writeBlock(RecorderBlockType type, const std::string &payload)
+{
+    uint8_t header[RECORDER_BLOCK_HEADER_SIZE];
+
+    header[0] = type;
+
+    for (size_t i = 0; i < 4; i++) {
+        header[1 + i] = (uint8_t)(payload.size() >> (i * 8));
+    }
+
+    write(header, sizeof(header));
+    write(payload.data(), payload.size());
+}
+
+void EventRecorder::write(const void *data, size_t size)
+{
+    if (fwrite(data, 1, size, _file) == size) {
+        _offset += size;
+        _bytesWritten.fetch_add(size, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,177 @@
+#ifndef __EVENTRECORDER_H
+#define __EVENTRECORDER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "elements/events/eventvalue.h"
+#include "queue/mpsc_ring_queue.h"
+
+#define RECORDER_DEFAULT_BUFFER_EVENTS 65536 ///< events per buffer, there are two
+#define RECORDER_DEFAULT_FLUSH_INTERVAL 100 ///< ms between writes of a partly filled buffer
+#define RECORDER_MAX_BLOCK_EVENTS 4096 ///< most events per events block
+#define RECORDER_INDEX_INTERVAL 64 ///< events blocks between index blocks
+
+#define RECORDER_MAGIC 0x56454853 ///< "SHEV"
+#define RECORDER_TRAILER_MAGIC 0x49454853 ///< "SHEI"
+#define RECORDER_VERSION 2
+#define RECORDER_HEADER_SIZE 24
+#define RECORDER_BLOCK_HEADER_SIZE 5
+#define RECORDER_TRAILER_SIZE 12 ///< payload of the trailer block
+
+typedef enum { RECORDER_BLOCK_STRINGS = 1, RECORDER_BLOCK_EVENTS, RECORDER_BLOCK_INDEX, RECORDER_BLOCK_TRAILER } RecorderBlockType;
+typedef enum { RECORDER_STRING_ELEMENT = 0, RECORDER_STRING_VALUE, RECORDER_STRING_PLUGIN } RecorderStringKind; ///< values aren't named since version 2
+
+//! recorder settings from the application configuration
+typedef struct {
+    std::string directory; ///< a log per recording is created here
+    bool enabled; ///< recording from the start
+    size_t bufferEvents;
+    uint32_t flushInterval; ///< ms
+} EventRecorderConfiguration;
+
+/**
+ * records every event the event loop takes off the event queue into a
+ * compact binary log, for replaying or analysing a session later
+ *
+ * the event thread only copies events into the active one of two
+ * buffers - a writer thread encodes them and writes the log, taking
+ * the events of the active buffer as they're published and swapping
+ * in a full buffer for the empty one. Nothing on the event thread
+ * waits for the writer: when both buffers are full, events are
+ * dropped and counted
+ *
+ * recording is started and stopped at runtime with setRecording,
+ * which only flags the writer so it's safe from a signal handler. A
+ * write error stops the recording. Each recording goes to a log of
+ * its own in the configured directory, all little endian
+ *
+ *   header   u32 RECORDER_MAGIC, u16 version, u16 0
+ *            i64 event timestamp (steady clock ns) and ms since the
+ *            unix epoch, both at the start of the recording
+ *   blocks   u8 RecorderBlockType, u32 payload length, payload
+ *
+ *   strings  varint count, then per string u8 RecorderStringKind,
+ *            varint id, varint length, bytes. An element or plugin is
+ *            named before the first block using it
+ *   events   varint count, i64 timestamp of the first event, then per
+ *            event varint element id, u8 eAttribute_t, u8 owner,
+ *            zigzag varint ns since the previous event and the value -
+ *            zigzag varint (int, uint), f32 (float), u8 (bool),
+ *            varint length and bytes (string)
+ *   index    u64 offset of the previous index block (0 for none),
+ *            varint count, then per events block since the previous
+ *            index u64 offset, i64 first timestamp, varint count
+ *   trailer  the last block, u64 offset of the last index block and
+ *            u32 RECORDER_TRAILER_MAGIC
+ *
+ * the trailer is only written when a recording stops - a log cut short
+ * is read block by block up to its last complete block
+ */
+class EventRecorder
+{
+protected:
+    typedef struct {
+        std::unique_ptr<EventValue[]> events;
+        std::atomic<size_t> count; ///< published by the event thread after each event
+        std::atomic<bool> full; ///< handed to the writer, the event thread has moved on to the other buffer
+        size_t written; ///< writer thread only
+    } RecordBuffer;
+
+    typedef struct {
+        uint64_t offset;
+        int64_t timestamp;
+        size_t count;
+    } IndexEntry;
+
+    const ElementSymbolTable &_symbols;
+    const EventStringTable &_strings;
+    EventRecorderConfiguration _configuration;
+    RecordBuffer _buffers[2];
+    std::atomic<int> _active; ///< buffer the event thread appends to
+
+    std::atomic<bool> _requested; ///< what setRecording asked for
+    std::atomic<bool> _recording; ///< what the writer has set up
+    std::atomic<bool> _inRecord; ///< the event thread is in record, see stopRecording
+    std::atomic<bool> _terminated;
+    WakeEvent _writeEvent;
+    std::thread _thread;
+
+    // writer thread only
+    FILE *_file;
+    std::string _path; ///< of the current or last log, guarded by _mutex
+    uint64_t _offset;
+    int64_t _lastTimestamp;
+    std::string _eventBlock; ///< events of the open block, after its count
+    std::string _payload;
+    int64_t _blockTimestamp; ///< of the first event of the open block
+    std::string _stringBlock;
+    size_t _blockEventCount;
+    size_t _stringCount;
+    std::vector<bool> _namedElements;
+    std::vector<IndexEntry> _index;
+    uint64_t _lastIndexOffset;
+
+    std::mutex _mutex; ///< guards the owner names and the path
+    std::vector<std::string> _ownerNames; ///< indexed by EventOwnerID
+
+    std::atomic<uint64_t> _recordedCount;
+    std::atomic<uint64_t> _droppedCount;
+    std::atomic<uint64_t> _bytesWritten;
+
+    void run(void);
+    bool startRecording(void);
+    void stopRecording(void);
+    void drain(void);
+    void drainBuffer(RecordBuffer &buffer, size_t count);
+    bool swapBuffers(void);
+    void encode(const EventValue &value);
+    void addString(RecorderStringKind kind, uint32_t id, const std::string &value);
+    void writeEventBlock(void);
+    void writeIndexBlock(void);
+    void writeBlock(RecorderBlockType type, const std::string &payload);
+    void write(const void *data, size_t size);
+
+public:
+    EventRecorder(const ElementSymbolTable &symbols, const EventStringTable &strings, const EventRecorderConfiguration &configuration);
+    virtual ~EventRecorder(void);
+
+    EventRecorder(const EventRecorder &) = delete; // disable copying
+    EventRecorder &operator=(const EventRecorder &) = delete; // disable assignment
+
+    static EventRecorderConfiguration DefaultConfiguration(void);
+
+    //! names the plugin events with this owner come from, in every log from the next recording on
+    void setOwnerName(EventOwnerID owner, const std::string &name);
+
+    //! records the events, called only from the event thread - does nothing unless recording
+    void record(const EventValue &value)
+    {
+        record(&value, 1);
+    }
+
+    void record(const EventValue *values, size_t count);
+
+    //! starts or stops recording, picked up by the writer thread - safe from a signal handler
+    void setRecording(bool recording);
+    void toggleRecording(void);
+
+    void start(void);
+
+    //! stops the writer thread, finishing the current recording
+    void stop(void);
+
+    bool recording(void) { return _recording.load(std::memory_order_relaxed); };
+    std::string path(void);
+    uint64_t recordedCount(void) { return _recordedCount.load(std::memory_order_relaxed); };
+    uint64_t droppedCount(void) { return _droppedCount.load(std::memory_order_relaxed); };
+    uint64_t bytesWritten(void) { return _bytesWritten.load(std::memory_order_relaxed); };
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "routingtable.h"
+
+RoutingTable::RoutingTable(void)
+{
+    _plugins.push_back(NULL);
+    _pluginNames.push_back("");
+}
+
+EventOwnerID RoutingTable::addPlugin(std::string name, simplug_vtable *methods)
+{
+    if (_plugins.size() >= ROUTING_MAX_PLUGINS) {
+        return EVENT_OWNER_NONE;
+    }
+
+    _plugins.push_back(methods);
+    _pluginNames.push_back(name);
+
+    return (EventOwnerID)(_plugins.size() - 1);
+}
+
+EventOwnerID RoutingTable::owner(const std::string &name)
+{
+    for (size_t i = 1; i < _pluginNames.size(); i++) {
+        if (_pluginNames[i] == name) {
+            return (EventOwnerID)i;
+        }
+    }
+
+    return EVENT_OWNER_NONE;
+}
+
+const std::string &RoutingTable::pluginName(EventOwnerID owner)
+{
+    return owner < _pluginNames.size() ? _pluginNames[owner] : _pluginNames[EVENT_OWNER_NONE];
+}
+
+void RoutingTable::addRoute(ElementID source, ElementID target, EventOwnerID destination)
+{
+    _staged.push_back({ source, { NULL, destination, destination == ROUTE_TO_OTHERS, target } });
+}
+
+//! expands a route to every other plugin into one route per plugin
+void RoutingTable::addRoutes(std::vector<Route> &routes, EventOwnerID destination, ElementID target)
+{
+    if (destination != ROUTE_TO_OTHERS) {
+        routes.push_back({ _plugins[destination], destination, false, target });
+        return;
+    }
+
+    for (size_t owner = 1; owner < _plugins.size(); owner++) {
+        routes.push_back({ _plugins[owner], (EventOwnerID)owner, true, target });
+    }
+}
+
+void RoutingTable::compile(void)
+{
+    std::vector<StagedRoute> staged(_staged);
+
+    // routes of one source keep the order they were configured in
+    std::stable_sort(staged.begin(), staged.end(), [](const StagedRoute &a, const StagedRoute &b) { return a.source < b.source; });
+
+    _routes.clear();
+    _firstRoute.clear();
+    _defaultRoutes.clear();
+
+    addRoutes(_defaultRoutes, ROUTE_TO_OTHERS, INVALID_ELEMENT_ID);
+
+    if (!staged.empty()) {
+        _firstRoute.resize(staged.back().source + 2, 0);
+    }
+
+    for (const StagedRoute &entry : staged) {
+        if (entry.route.owner != ROUTE_TO_OTHERS && entry.route.owner >= _plugins.size()) {
+            continue;
+        }
+
+        addRoutes(_routes, entry.route.owner, entry.route.target);
+        _firstRoute[entry.source + 1] = _routes.size();
+    }
+
+    // sources without routes start where the previous source ended
+    for (size_t i = 1; i < _firstRoute.size(); i++) {
+        _firstRoute[i] = std::max(_firstRoute[i], _firstRoute[i - 1]);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef __ROUTINGTABLE_H
+#define __ROUTINGTABLE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "elements/events/eventvalue.h"
+
+#define ROUTING_MAX_PLUGINS 32 ///< most plugins the host can load, owner ids 1..31
+#define ROUTE_TO_OTHERS EVENT_OWNER_NONE ///< destination of a route that goes to every plugin but the source
+
+//! one destination of an element - the plugin methods and the element it's delivered as
+typedef struct {
+    simplug_vtable *methods;
+    EventOwnerID owner;
+    bool skipSource; ///< not delivered back to the plugin the value came from
+    ElementID target; ///< INVALID_ELEMENT_ID to deliver under the source element
+} Route;
+
+//! the routes of one source element, in the order they were added
+class RouteRange
+{
+protected:
+    const Route *_first;
+    const Route *_last;
+
+public:
+    RouteRange(const Route *first, const Route *last)
+        : _first(first)
+        , _last(last){};
+
+    const Route *begin(void) const { return _first; };
+    const Route *end(void) const { return _last; };
+    size_t size(void) const { return _last - _first; };
+};
+
+/**
+ * fan-out table of the loaded plugins - every plugin registers its
+ * methods and gets the EventOwnerID its events carry, mappings add
+ * routes from a source element to one plugin or to every plugin but
+ * the source. compile flattens the routes into one array with an
+ * offset per source ElementID, so finding the destinations of an
+ * event is two array reads and a walk over its own routes
+ *
+ * elements without a mapping go to every plugin but the source
+ *
+ * plugins and routes are added during configuration, routes() is read
+ * without locks by the event loop once compile has been called
+ */
+class RoutingTable
+{
+protected:
+    typedef struct {
+        ElementID source;
+        Route route;
+    } StagedRoute;
+
+    std::vector<simplug_vtable *> _plugins; ///< indexed by EventOwnerID, owner 0 unused
+    std::vector<std::string> _pluginNames;
+    std::vector<StagedRoute> _staged;
+    std::vector<Route> _routes; ///< grouped by source element
+    std::vector<uint32_t> _firstRoute; ///< indexed by source ElementID, one extra entry at the end
+    std::vector<Route> _defaultRoutes; ///< for elements without a mapping
+
+    void addRoutes(std::vector<Route> &routes, EventOwnerID destination, ElementID target);
+
+public:
+    RoutingTable(void);
+
+    //! registers a plugin, returns its owner id or EVENT_OWNER_NONE when the table is full
+    EventOwnerID addPlugin(std::string name, simplug_vtable *methods);
+    EventOwnerID owner(const std::string &name);
+    const std::string &pluginName(EventOwnerID owner);
+    simplug_vtable *plugin(EventOwnerID owner) { return owner < _plugins.size() ? _plugins[owner] : NULL; };
+    size_t pluginCount(void) { return _plugins.size() - 1; };
+
+    //! routes source to the destination plugin, or to every other plugin with ROUTE_TO_OTHERS
+    void addRoute(ElementID source, ElementID target, EventOwnerID destination = ROUTE_TO_OTHERS);
+
+    //! builds the lookup arrays from the plugins and routes added so far
+    void compile(void);
+    size_t routeCount(void) { return _routes.size(); };
+
+    RouteRange routes(ElementID source)
+    {
+        if (source + 1 < _firstRoute.size() && _firstRoute[source] != _firstRoute[source + 1]) {
+            return RouteRange(&_routes[_firstRoute[source]], &_routes[_firstRoute[source + 1]]);
+        }
+
+        return RouteRange(_defaultRoutes.data(), _defaultRoutes.data() + _defaultRoutes.size());
+    };
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include <openssl/evp.h>
+#include <string.h>
+
+#include "recordaggregator.h"
+
+// protobuf field keys of the AggregatedRecord and Record messages
+#define PB_PARTITION_KEY_TABLE 0x0A ///< field 1, length delimited
+#define PB_RECORDS 0x1A ///< field 3, length delimited
+#define PB_PARTITION_KEY_INDEX 0x08 ///< field 1, varint
+#define PB_DATA 0x1A ///< field 3, length delimited
+
+#define PB_WIRE_VARINT 0
+#define PB_WIRE_FIXED64 1
+#define PB_WIRE_LENGTH 2
+#define PB_WIRE_FIXED32 5
+
+static size_t VarintSize(uint64_t value)
+{
+    size_t size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+static void AppendVarint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((char)value);
+}
+
+static bool ReadVarint(const uint8_t *&pos, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        uint8_t byte = *pos++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! steps over a field of a wire type we don't need
+static bool SkipField(const uint8_t *&pos, const uint8_t *end, uint64_t key)
+{
+    uint64_t value;
+
+    switch (key & 0x07) {
+    case PB_WIRE_VARINT:
+        return ReadVarint(pos, end, value);
+    case PB_WIRE_FIXED64:
+        pos += 8;
+        return pos <= end;
+    case PB_WIRE_LENGTH:
+        if (!ReadVarint(pos, end, value) || value > (uint64_t)(end - pos)) {
+            return false;
+        }
+        pos += value;
+        return true;
+    case PB_WIRE_FIXED32:
+        pos += 4;
+        return pos <= end;
+    default:
+        return false;
+    }
+}
+
+static void Digest(const char *data, size_t size, unsigned char *digest)
+{
+    unsigned int digestSize = AGGREGATION_DIGEST_SIZE;
+    EVP_Digest(data, size, digest, &digestSize, EVP_md5(), NULL);
+}
+
+//! the data field of one Record message
+static bool ReadRecord(const uint8_t *pos, const uint8_t *end, std::string &data)
+{
+    while (pos < end) {
+        uint64_t key;
+        uint64_t length;
+
+        if (!ReadVarint(pos, end, key)) {
+            return false;
+        }
+
+        if (key != PB_DATA) {
+            if (!SkipField(pos, end, key)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (!ReadVarint(pos, end, length) || length > (uint64_t)(end - pos)) {
+            return false;
+        }
+
+        data.assign((const char *)pos, length);
+        pos += length;
+    }
+
+    return true;
+}
+
+RecordAggregator::RecordAggregator(std::string partitionKey, size_t maxSize)
+    : _partitionKey(partitionKey)
+    , _maxSize(maxSize)
+    , _count(0)
+    , _firstSize(0)
+{
+}
+
+size_t RecordAggregator::messageSize(size_t recordsSize)
+{
+    return 1 + VarintSize(_partitionKey.size()) + _partitionKey.size() + recordsSize;
+}
+
+bool RecordAggregator::add(const std::string &data)
+{
+    size_t recordSize = 2 + 1 + VarintSize(data.size()) + data.size();
+    size_t entrySize = 1 + VarintSize(recordSize) + recordSize;
+
+    if (_count > 0 && AGGREGATION_MAGIC_SIZE + messageSize(_records.size() + entrySize) + AGGREGATION_DIGEST_SIZE > _maxSize) {
+        return false;
+    }
+
+    _records.push_back((char)PB_RECORDS);
+    AppendVarint(_records, recordSize);
+    _records.push_back((char)PB_PARTITION_KEY_INDEX);
+    _records.push_back(0);
+    _records.push_back((char)PB_DATA);
+    AppendVarint(_records, data.size());
+    _records.append(data);
+
+    if (_count++ == 0) {
+        _firstSize = data.size();
+    }
+
+    return true;
+}
+
+size_t RecordAggregator::size(void)
+{
+    if (_count == 0) {
+        return 0;
+    }
+    else if (_count == 1) {
+        return _firstSize;
+    }
+
+    return AGGREGATION_MAGIC_SIZE + messageSize(_records.size()) + AGGREGATION_DIGEST_SIZE;
+}
+
+void RecordAggregator::build(std::string &out)
+{
+    out.clear();
+
+    if (_count == 1) {
+        // the one record is the tail of its encoded entry
+        const uint8_t *pos = (const uint8_t *)_records.data() + 1;
+        const uint8_t *end = (const uint8_t *)_records.data() + _records.size();
+        uint64_t recordSize;
+
+        ReadVarint(pos, end, recordSize);
+        ReadRecord(pos, pos + recordSize, out);
+    }
+    else if (_count > 1) {
+        unsigned char digest[AGGREGATION_DIGEST_SIZE];
+
+        out.reserve(size());
+        out.append(AGGREGATION_MAGIC, AGGREGATION_MAGIC_SIZE);
+        out.push_back((char)PB_PARTITION_KEY_TABLE);
+        AppendVarint(out, _partitionKey.size());
+        out.append(_partitionKey);
+        out.append(_records);
+
+        Digest(out.data() + AGGREGATION_MAGIC_SIZE, out.size() - AGGREGATION_MAGIC_SIZE, digest);
+        out.append((const char *)digest, AGGREGATION_DIGEST_SIZE);
+    }
+
+    clear();
+}
+
+void RecordAggregator::clear(void)
+{
+    _records.clear();
+    _count = 0;
+}
+
+bool RecordAggregator::Deaggregate(const std::string &data, std::vector<std::string> &records)
+{
+    if (data.size() < AGGREGATION_MAGIC_SIZE + AGGREGATION_DIGEST_SIZE || memcmp(data.data(), AGGREGATION_MAGIC, AGGREGATION_MAGIC_SIZE) != 0) {
+        records.push_back(data);
+        return true;
+    }
+
+    unsigned char digest[AGGREGATION_DIGEST_SIZE];
+    size_t messageSize = data.size() - AGGREGATION_MAGIC_SIZE - AGGREGATION_DIGEST_SIZE;
+    const uint8_t *pos = (const uint8_t *)data.data() + AGGREGATION_MAGIC_SIZE;
+    const uint8_t *end = pos + messageSize;
+
+    Digest((const char *)pos, messageSize, digest);
+
+    if (memcmp(digest, end, AGGREGATION_DIGEST_SIZE) != 0) {
+        return false;
+    }
+
+    while (pos < end) {
+        uint64_t key;
+        uint64_t length;
+
+        if (!ReadVarint(pos, end, key)) {
+            return false;
+        }
+
+        if (key != PB_RECORDS) {
+            if (!SkipField(pos, end, key)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (!ReadVarint(pos, end, length) || length > (uint64_t)(end - pos)) {
+            return false;
+        }
+
+        records.push_back(std::string());
+
+        if (!ReadRecord(pos, pos + length, records.back())) {
+            return false;
+        }
+
+        pos += length;
+    }
+
+    return true;
+}
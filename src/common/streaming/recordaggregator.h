@@ -0,0 +1,53 @@
+#ifndef __RECORDAGGREGATOR_H
+#define __RECORDAGGREGATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define AGGREGATION_MAGIC "\xF3\x89\x9A\xC2" ///< leading bytes of a KPL aggregated record
+#define AGGREGATION_MAGIC_SIZE 4
+#define AGGREGATION_DIGEST_SIZE 16 ///< trailing MD5 of the protobuf message
+#define AGGREGATION_DEFAULT_MAX_SIZE 51200 ///< same default as the KPL
+
+/**
+ * packs many small records into one Kinesis record in the KPL
+ * aggregated record format - the magic, an AggregatedRecord protobuf
+ * message and the MD5 of that message - so a consumer using the KCL
+ * (or any KPL deaggregator) gets the original records back
+ *
+ * every record shares the one partition key of the aggregator. A lone
+ * record is built as is, the way the KPL sends it
+ */
+class RecordAggregator
+{
+protected:
+    std::string _partitionKey;
+    size_t _maxSize;
+    std::string _records; ///< encoded records field of the AggregatedRecord message
+    size_t _count;
+    size_t _firstSize; ///< a lone record is built as is
+
+    size_t messageSize(size_t recordsSize);
+
+public:
+    RecordAggregator(std::string partitionKey, size_t maxSize = AGGREGATION_DEFAULT_MAX_SIZE);
+
+    //! adds a record unless it would take the aggregate over its max size - an empty aggregator takes any record
+    bool add(const std::string &data);
+
+    //! writes the aggregated record to out and starts a new one
+    void build(std::string &out);
+    void clear(void);
+
+    //! bytes build would write now
+    size_t size(void);
+    size_t count(void) { return _count; };
+    bool empty(void) { return _count == 0; };
+
+    //! unpacks an aggregated record - data without the magic is a single record, false for a bad digest or message
+    static bool Deaggregate(const std::string &data, std::vector<std::string> &records);
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <chrono>
+
+#include "recordbatcher.h"
+
+RecordBatcher::RecordBatcher(std::string partitionKey, PutRecordsFunction put, const RecordBatcherConfiguration &configuration, RecordSpool *spool)
+    : _put(put)
+    , _configuration(configuration)
+    , _queue(std::max((size_t)1, configuration.capacity), OVERFLOW_DROP_OLDEST)
+    , _aggregator(partitionKey, configuration.maxAggregateSize)
+    , _partitionKeySize(partitionKey.size())
+    , _batchSize(0)
+    , _spool(spool)
+    , _unsent(false)
+    , _stopping(false)
+    , _recordCount(0)
+    , _requestCount(0)
+    , _sentCount(0)
+    , _retriedCount(0)
+    , _failedCount(0)
+{
+    _configuration.maxBatchRecords = std::max((size_t)1, _configuration.maxBatchRecords);
+    _batch.reserve(_configuration.maxBatchRecords);
+}
+
+RecordBatcher::~RecordBatcher(void)
+{
+    stop();
+}
+
+RecordBatcherConfiguration RecordBatcher::DefaultConfiguration(void)
+{
+    return { BATCHER_DEFAULT_CAPACITY, BATCHER_DEFAULT_MAX_BATCH_RECORDS, BATCHER_DEFAULT_MAX_BATCH_SIZE, AGGREGATION_DEFAULT_MAX_SIZE, BATCHER_DEFAULT_LINGER,
+        BATCHER_DEFAULT_MAX_RETRIES, BATCHER_DEFAULT_RETRY_BACKOFF };
+}
+
+void RecordBatcher::push(const std::string &record)
+{
+    if (_spool) {
+        _spool->append(record);
+    }
+    else {
+        _queue.push(record);
+    }
+}
+
+void RecordBatcher::start(void)
+{
+    if (!_thread.joinable()) {
+        _thread = std::thread(&RecordBatcher::run, this);
+    }
+}
+
+void RecordBatcher::stop(void)
+{
+    _stopping = true;
+    _stopEvent.notifyAll();
+    _queue.unblock();
+
+    if (_spool) {
+        _spool->unblock();
+    }
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void RecordBatcher::add(const std::string &record)
+{
+    _recordCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (!_aggregator.add(record)) {
+        seal();
+        _aggregator.add(record);
+    }
+}
+
+//! moves the open aggregated record into the batch, sending the batch once another wouldn't fit
+void RecordBatcher::seal(void)
+{
+    if (_aggregator.empty()) {
+        return;
+    }
+
+    _batch.push_back(std::string());
+    _aggregator.build(_batch.back());
+    _batchSize += _batch.back().size() + _partitionKeySize;
+
+    if (_batch.size() >= _configuration.maxBatchRecords || _batchSize + _configuration.maxAggregateSize + _partitionKeySize > _configuration.maxBatchSize) {
+        send();
+    }
+}
+
+//! sends the batch, resending what the stream refused until it's all taken or out of retries
+void RecordBatcher::send(void)
+{
+    uint32_t backoff = _configuration.retryBackoff;
+
+    for (uint32_t attempt = 0; !_batch.empty(); attempt++) {
+        _failed.assign(_batch.size(), false);
+        _requestCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (!_put(_batch, _failed)) {
+            _failed.assign(_batch.size(), true);
+        }
+
+        // keep only the refused records, in their original order
+        size_t refused = 0;
+
+        for (size_t i = 0; i < _batch.size(); i++) {
+            if (_failed[i]) {
+                _batch[refused++].swap(_batch[i]);
+            }
+        }
+
+        _sentCount.fetch_add(_batch.size() - refused, std::memory_order_relaxed);
+        _batch.resize(refused);
+
+        if (refused == 0) {
+            break;
+        }
+        else if (attempt >= _configuration.maxRetries && !_spool) {
+            _failedCount.fetch_add(refused, std::memory_order_relaxed);
+            _batch.clear();
+            break;
+        }
+
+        _retriedCount.fetch_add(refused, std::memory_order_relaxed);
+
+        if (!_spool) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff));
+            backoff *= 2;
+        }
+        else if (pause(backoff)) {
+            backoff = std::min(backoff * 2, (uint32_t)BATCHER_MAX_RETRY_BACKOFF);
+        }
+        else {
+            // stopping - the records are still in the spool for the next run
+            _batch.clear();
+            _unsent = true;
+            break;
+        }
+    }
+
+    _batchSize = 0;
+}
+
+//! sleeps for milliseconds, returns false straight away once stopping
+bool RecordBatcher::pause(uint32_t milliseconds)
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+
+    for (;;) {
+        uint32_t key = _stopEvent.prepareWait();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (_stopping) {
+            _stopEvent.cancelWait();
+            return false;
+        }
+        else if (now >= deadline) {
+            _stopEvent.cancelWait();
+            return true;
+        }
+
+        _stopEvent.commitWait(key, deadline - now);
+    }
+}
+
+//! ships from the spool, committing each batch once the stream has taken all of it
+void RecordBatcher::runSpooled(void)
+{
+    std::vector<std::string> records;
+
+    while (!_stopping && _spool->wait()) {
+        // give a batch time to fill unless there's a full one spooled already
+        if (_spool->readableSize() < _configuration.maxBatchSize) {
+            pause(_configuration.linger);
+        }
+
+        records.clear();
+        _spool->read(records, _configuration.maxBatchSize);
+        _unsent = false;
+
+        for (const std::string &record : records) {
+            add(record);
+        }
+
+        seal();
+        send();
+
+        if (_unsent) {
+            _spool->rewind();
+        }
+        else {
+            _spool->commit();
+        }
+    }
+}
+
+void RecordBatcher::run(void)
+{
+    std::string record;
+    bool stopping = false;
+
+    if (_spool) {
+        runSpooled();
+        return;
+    }
+
+    while (!stopping) {
+        try {
+            _queue.pop(record);
+        }
+        catch (ConcurrentQueueInterrupted &queueException) {
+            break;
+        }
+
+        add(record);
+
+        // the first record of a batch waits at most linger ms for company
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_configuration.linger);
+
+        for (;;) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            if (now >= deadline) {
+                break;
+            }
+
+            try {
+                if (!_queue.pop(record, deadline - now)) {
+                    break;
+                }
+            }
+            catch (ConcurrentQueueInterrupted &queueException) {
+                stopping = true;
+                break;
+            }
+
+            add(record);
+        }
+
+        seal();
+        send();
+    }
+
+    // send whatever was queued before the stop
+    while (_queue.tryPop(record)) {
+        add(record);
+    }
+
+    seal();
+    send();
+}
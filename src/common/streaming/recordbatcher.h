@@ -0,0 +1,112 @@
+#ifndef __RECORDBATCHER_H
+#define __RECORDBATCHER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "queue/mpsc_ring_queue.h"
+#include "recordaggregator.h"
+#include "recordspool.h"
+
+#define BATCHER_DEFAULT_CAPACITY 8192 ///< records waiting to be aggregated, the oldest are dropped past this
+#define BATCHER_DEFAULT_MAX_BATCH_RECORDS 500 ///< PutRecords limit
+#define BATCHER_DEFAULT_MAX_BATCH_SIZE 5242880 ///< PutRecords limit
+#define BATCHER_DEFAULT_LINGER 100 ///< ms
+#define BATCHER_DEFAULT_MAX_RETRIES 3
+#define BATCHER_DEFAULT_RETRY_BACKOFF 100 ///< ms, doubled per retry
+#define BATCHER_MAX_RETRY_BACKOFF 30000 ///< ms, spooled records are retried at least this often
+
+//! batching settings from the kinesis configuration
+typedef struct {
+    size_t capacity;
+    size_t maxBatchRecords; ///< aggregated records per request
+    size_t maxBatchSize; ///< bytes per request
+    size_t maxAggregateSize; ///< bytes per aggregated record
+    uint32_t linger; ///< ms the first record of a batch waits for more
+    uint32_t maxRetries;
+    uint32_t retryBackoff; ///< ms
+} RecordBatcherConfiguration;
+
+/**
+ * sends one PutRecords request - sets failed[i] for every record the
+ * stream didn't take and returns false when the request as a whole
+ * failed
+ */
+typedef std::function<bool(const std::vector<std::string> &records, std::vector<bool> &failed)> PutRecordsFunction;
+
+/**
+ * queues records from any thread and ships them from a thread of its
+ * own - records are aggregated into KPL aggregated records and the
+ * aggregated records are sent together, so a burst costs one request
+ * instead of one per record
+ *
+ * a batch is sent once it's full (by record count or size) or when its
+ * first record has waited linger ms. Records the stream refuses are
+ * retried with a doubling backoff and dropped after maxRetries
+ *
+ * with a spool, records go to disk instead of the queue and are only
+ * committed there once the stream has taken them - refused records
+ * are retried for as long as it takes (backing off up to
+ * BATCHER_MAX_RETRY_BACKOFF) and whatever is left at a stop is sent
+ * by the next run. Delivery is at least once
+ */
+class RecordBatcher
+{
+protected:
+    PutRecordsFunction _put;
+    RecordBatcherConfiguration _configuration;
+    MPSCRingQueue<std::string> _queue;
+    RecordAggregator _aggregator;
+    size_t _partitionKeySize;
+    std::vector<std::string> _batch; ///< sealed aggregated records of the next request
+    size_t _batchSize;
+    std::vector<bool> _failed;
+    RecordSpool *_spool; ///< not owned, NULL without one
+    bool _unsent; ///< a spooled batch was abandoned at a stop
+    std::atomic<bool> _stopping;
+    WakeEvent _stopEvent;
+    std::thread _thread;
+
+    std::atomic<uint64_t> _recordCount;
+    std::atomic<uint64_t> _requestCount;
+    std::atomic<uint64_t> _sentCount; ///< aggregated records the stream took
+    std::atomic<uint64_t> _retriedCount;
+    std::atomic<uint64_t> _failedCount; ///< aggregated records dropped after their last retry
+
+    void run(void);
+    void runSpooled(void);
+    bool pause(uint32_t milliseconds);
+    void add(const std::string &record);
+    void seal(void);
+    void send(void);
+
+public:
+    RecordBatcher(std::string partitionKey, PutRecordsFunction put, const RecordBatcherConfiguration &configuration, RecordSpool *spool = NULL);
+    virtual ~RecordBatcher(void);
+
+    RecordBatcher(const RecordBatcher &) = delete; // disable copying
+    RecordBatcher &operator=(const RecordBatcher &) = delete; // disable assignment
+
+    //! default settings, within the PutRecords limits
+    static RecordBatcherConfiguration DefaultConfiguration(void);
+
+    void push(const std::string &record);
+
+    void start(void);
+
+    //! stops the thread once everything queued so far has been sent (or, with a spool, tried once)
+    void stop(void);
+
+    size_t depth(void) { return _queue.size(); };
+    uint64_t recordCount(void) { return _recordCount.load(std::memory_order_relaxed); };
+    uint64_t requestCount(void) { return _requestCount.load(std::memory_order_relaxed); };
+    uint64_t sentCount(void) { return _sentCount.load(std::memory_order_relaxed); };
+    uint64_t retriedCount(void) { return _retriedCount.load(std::memory_order_relaxed); };
+    uint64_t failedCount(void) { return _failedCount.load(std::memory_order_relaxed); };
+    uint64_t droppedCount(void) { return _queue.droppedCount(); };
+};
+
+#endif
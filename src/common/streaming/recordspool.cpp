@@ -0,0 +1,638 @@
+#include <algorithm>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "recordspool.h"
+
+#define SPOOL_CURSOR_FILE "cursor"
+#define SPOOL_CURSOR_MAGIC 0x52534853 ///< "SHSR"
+#define SPOOL_CURSOR_SIZE 24 ///< magic, crc, sequence, offset
+
+// segments and the cursor are in host byte order, they never leave the machine
+
+static uint32_t ReadU32(const uint8_t *data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static void WriteU32(uint8_t *data, uint32_t value)
+{
+    memcpy(data, &value, sizeof(value));
+}
+
+static uint32_t Crc32(const uint8_t *data, size_t size)
+{
+    static uint32_t Table[256];
+    static bool TableBuilt = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+
+            for (int bit = 0; bit < 8; bit++) {
+                crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+            }
+
+            Table[i] = crc;
+        }
+
+        return true;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+
+    (void)TableBuilt;
+
+    for (size_t i = 0; i < size; i++) {
+        crc = Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+//! mkdir -p
+static bool MakeDirectories(const std::string &path)
+{
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        std::string directory = path.substr(0, pos);
+
+        if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+
+        if (pos == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+RecordSpool::RecordSpool(const RecordSpoolConfiguration &configuration)
+    : _configuration(configuration)
+    , _totalSize(0)
+    , _open(false)
+    , _terminated(false)
+    , _appendedCount(0)
+    , _committedCount(0)
+    , _droppedCount(0)
+    , _uncommittedCount(0)
+{
+    _configuration.segmentSize = std::max(_configuration.segmentSize, (size_t)SPOOL_SEGMENT_HEADER_SIZE + SPOOL_FRAME_HEADER_SIZE + 1);
+    _readCursor = { 0, 0 };
+    _committedCursor = { 0, 0 };
+}
+
+RecordSpool::~RecordSpool(void)
+{
+    close();
+}
+
+RecordSpoolConfiguration RecordSpool::DefaultConfiguration(std::string directory)
+{
+    return { directory, SPOOL_DEFAULT_SEGMENT_SIZE, SPOOL_DEFAULT_MAX_SIZE };
+}
+
+std::string RecordSpool::segmentPath(uint64_t sequence)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/segment-%016" PRIx64 ".spool", sequence);
+    return _configuration.directory + name;
+}
+
+std::string RecordSpool::cursorPath(void)
+{
+    return _configuration.directory + "/" + SPOOL_CURSOR_FILE;
+}
+
+RecordSpool::Segment *RecordSpool::segment(uint64_t sequence)
+{
+    for (Segment &segment : _segments) {
+        if (segment.sequence == sequence) {
+            return &segment;
+        }
+    }
+
+    return NULL;
+}
+
+bool RecordSpool::open(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<uint64_t> sequences;
+    SpoolCursor cursor;
+
+    if (_open) {
+        return true;
+    }
+
+    if (!MakeDirectories(_configuration.directory)) {
+        return false;
+    }
+
+    DIR *directory = opendir(_configuration.directory.c_str());
+
+    if (!directory) {
+        return false;
+    }
+
+    while (struct dirent *entry = readdir(directory)) {
+        uint64_t sequence;
+        int length = 0;
+
+        if (sscanf(entry->d_name, "segment-%16" SCNx64 ".spool%n", &sequence, &length) == 1 && entry->d_name[length] == '\0') {
+            sequences.push_back(sequence);
+        }
+    }
+
+    closedir(directory);
+    std::sort(sequences.begin(), sequences.end());
+
+    bool haveCursor = loadCursor(cursor);
+
+    for (uint64_t sequence : sequences) {
+        Segment segment = { sequence, segmentPath(sequence), -1, NULL, 0, 0 };
+
+        // segments behind the checkpoint were finished before the restart
+        if ((haveCursor && sequence < cursor.sequence) || !recoverSegment(segment)) {
+            unlink(segment.path.c_str());
+            continue;
+        }
+
+        _segments.push_back(segment);
+        _totalSize += segment.end;
+    }
+
+    // every run writes to a segment of its own
+    uint64_t next = _segments.empty() ? 1 : _segments.back().sequence + 1;
+
+    if (haveCursor) {
+        next = std::max(next, cursor.sequence);
+    }
+
+    if (!createSegment(next)) {
+        return false;
+    }
+
+    Segment *start = haveCursor ? segment(cursor.sequence) : NULL;
+
+    if (!start) {
+        start = &_segments.front();
+        cursor.offset = SPOOL_SEGMENT_HEADER_SIZE;
+    }
+
+    cursor.sequence = start->sequence;
+    cursor.offset = std::min(std::max(cursor.offset, (uint64_t)SPOOL_SEGMENT_HEADER_SIZE), (uint64_t)start->end);
+
+    _readCursor = cursor;
+    _committedCursor = cursor;
+    _open = true;
+
+    while (_totalSize > _configuration.maxSize && _segments.size() > 1) {
+        dropOldestSegment();
+    }
+
+    return true;
+}
+
+void RecordSpool::close(void)
+{
+    SpoolCursor cursor;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_open) {
+            return;
+        }
+
+        for (Segment &segment : _segments) {
+            if (segment.fd >= 0) {
+                sealSegment(segment);
+            }
+
+            unmapSegment(segment);
+        }
+
+        _segments.clear();
+        _totalSize = 0;
+        _open = false;
+        cursor = _committedCursor;
+    }
+
+    saveCursor(cursor);
+}
+
+//! starts the segment appends go to, mapped for writing at its full size
+bool RecordSpool::createSegment(uint64_t sequence)
+{
+    Segment segment = { sequence, segmentPath(sequence), -1, NULL, 0, SPOOL_SEGMENT_HEADER_SIZE };
+
+    segment.fd = ::open(segment.path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (segment.fd < 0) {
+        return false;
+    }
+
+    if (ftruncate(segment.fd, _configuration.segmentSize) != 0) {
+        ::close(segment.fd);
+        unlink(segment.path.c_str());
+        return false;
+    }
+
+    void *data = mmap(NULL, _configuration.segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+
+    if (data == MAP_FAILED) {
+        ::close(segment.fd);
+        unlink(segment.path.c_str());
+        return false;
+    }
+
+    segment.data = (uint8_t *)data;
+    segment.mappedSize = _configuration.segmentSize;
+    WriteU32(segment.data, SPOOL_SEGMENT_MAGIC);
+    WriteU32(segment.data + 4, SPOOL_SEGMENT_VERSION);
+
+    _segments.push_back(segment);
+    _totalSize += _configuration.segmentSize;
+
+    return true;
+}
+
+//! maps a sealed segment for reading
+bool RecordSpool::mapSegment(Segment &segment)
+{
+    int fd = ::open(segment.path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    void *data = mmap(NULL, segment.end, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    segment.data = (uint8_t *)data;
+    segment.mappedSize = segment.end;
+
+    return true;
+}
+
+void RecordSpool::unmapSegment(Segment &segment)
+{
+    if (segment.data) {
+        munmap(segment.data, segment.mappedSize);
+        segment.data = NULL;
+        segment.mappedSize = 0;
+    }
+}
+
+//! stops writing to a segment and trims the file to its records
+void RecordSpool::sealSegment(Segment &segment)
+{
+    if (segment.fd < 0) {
+        return;
+    }
+
+    msync(segment.data, segment.end, MS_ASYNC);
+    unmapSegment(segment);
+
+    if (ftruncate(segment.fd, segment.end) == 0) {
+        _totalSize -= _configuration.segmentSize - segment.end;
+    }
+
+    ::close(segment.fd);
+    segment.fd = -1;
+}
+
+//! finds the end of the records of a segment left by an earlier run, a torn write ends it
+bool RecordSpool::recoverSegment(Segment &segment)
+{
+    struct stat status;
+    int fd = ::open(segment.path.c_str(), O_RDWR);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    if (fstat(fd, &status) != 0 || (size_t)status.st_size < SPOOL_SEGMENT_HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = status.st_size;
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (mapped == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    const uint8_t *data = (const uint8_t *)mapped;
+    size_t offset = SPOOL_SEGMENT_HEADER_SIZE;
+    bool retVal = ReadU32(data) == SPOOL_SEGMENT_MAGIC && ReadU32(data + 4) == SPOOL_SEGMENT_VERSION;
+
+    while (retVal && offset + SPOOL_FRAME_HEADER_SIZE <= size) {
+        uint32_t length = ReadU32(data + offset);
+
+        if (length == 0 || length > size - offset - SPOOL_FRAME_HEADER_SIZE || Crc32(data + offset + SPOOL_FRAME_HEADER_SIZE, length) != ReadU32(data + offset + 4)) {
+            break;
+        }
+
+        offset += SPOOL_FRAME_HEADER_SIZE + length;
+    }
+
+    munmap(mapped, size);
+
+    if (retVal && offset < size && ftruncate(fd, offset) != 0) {
+        retVal = false;
+    }
+
+    ::close(fd);
+    segment.end = offset;
+
+    return retVal;
+}
+
+size_t RecordSpool::countRecords(Segment &segment, size_t offset)
+{
+    size_t retVal = 0;
+
+    if (!segment.data && !mapSegment(segment)) {
+        return 0;
+    }
+
+    while (offset < segment.end) {
+        offset += SPOOL_FRAME_HEADER_SIZE + ReadU32(segment.data + offset);
+        retVal++;
+    }
+
+    return retVal;
+}
+
+//! retention - the oldest segment goes whether it has been read or not
+void RecordSpool::dropOldestSegment(void)
+{
+    Segment &oldest = _segments.front();
+    uint64_t next = _segments[1].sequence;
+
+    if (_readCursor.sequence == oldest.sequence) {
+        _droppedCount.fetch_add(countRecords(oldest, _readCursor.offset), std::memory_order_relaxed);
+        _readCursor = { next, SPOOL_SEGMENT_HEADER_SIZE };
+    }
+
+    if (_committedCursor.sequence == oldest.sequence) {
+        _committedCursor = { next, SPOOL_SEGMENT_HEADER_SIZE };
+    }
+
+    unmapSegment(oldest);
+    unlink(oldest.path.c_str());
+    _totalSize -= oldest.end;
+    _segments.pop_front();
+}
+
+bool RecordSpool::append(const std::string &record)
+{
+    size_t frameSize = SPOOL_FRAME_HEADER_SIZE + record.size();
+
+    if (record.empty() || frameSize > _configuration.segmentSize - SPOOL_SEGMENT_HEADER_SIZE) {
+        _droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_open) {
+            return false;
+        }
+
+        Segment *writer = &_segments.back();
+
+        if (writer->fd < 0 || writer->end + frameSize > writer->mappedSize) {
+            sealSegment(*writer);
+
+            if (!createSegment(writer->sequence + 1)) {
+                _droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            while (_totalSize > _configuration.maxSize && _segments.size() > 1) {
+                dropOldestSegment();
+            }
+
+            writer = &_segments.back();
+        }
+
+        uint8_t *frame = writer->data + writer->end;
+
+        WriteU32(frame, record.size());
+        WriteU32(frame + 4, Crc32((const uint8_t *)record.data(), record.size()));
+        memcpy(frame + SPOOL_FRAME_HEADER_SIZE, record.data(), record.size());
+        writer->end += frameSize;
+    }
+
+    _appendedCount.fetch_add(1, std::memory_order_relaxed);
+    _dataEvent.notifyAll();
+
+    return true;
+}
+
+size_t RecordSpool::read(std::vector<std::string> &records, size_t maxSize)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t retVal = 0;
+
+    for (size_t i = 0; _open && i < _segments.size(); i++) {
+        Segment &segment = _segments[i];
+
+        if (segment.sequence != _readCursor.sequence) {
+            continue;
+        }
+
+        if (_readCursor.offset >= segment.end) {
+            if (i + 1 == _segments.size()) {
+                break;
+            }
+
+            // done with a sealed segment, on to the next
+            if (segment.fd < 0) {
+                unmapSegment(segment);
+            }
+
+            _readCursor = { _segments[i + 1].sequence, SPOOL_SEGMENT_HEADER_SIZE };
+            continue;
+        }
+
+        if (!segment.data && !mapSegment(segment)) {
+            break;
+        }
+
+        uint32_t length = ReadU32(segment.data + _readCursor.offset);
+
+        if (retVal > 0 && retVal + length > maxSize) {
+            break;
+        }
+
+        records.push_back(std::string((const char *)segment.data + _readCursor.offset + SPOOL_FRAME_HEADER_SIZE, length));
+        _readCursor.offset += SPOOL_FRAME_HEADER_SIZE + length;
+        _uncommittedCount++;
+        retVal += length;
+
+        // carry on in the same segment
+        i--;
+    }
+
+    return retVal;
+}
+
+void RecordSpool::commit(void)
+{
+    std::vector<std::string> finished;
+    SpoolCursor cursor;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _committedCursor = _readCursor;
+        _committedCount.fetch_add(_uncommittedCount, std::memory_order_relaxed);
+        _uncommittedCount = 0;
+
+        while (_segments.size() > 1 && _segments.front().sequence < _committedCursor.sequence) {
+            unmapSegment(_segments.front());
+            finished.push_back(_segments.front().path);
+            _totalSize -= _segments.front().end;
+            _segments.pop_front();
+        }
+
+        cursor = _committedCursor;
+    }
+
+    for (const std::string &path : finished) {
+        unlink(path.c_str());
+    }
+
+    saveCursor(cursor);
+}
+
+void RecordSpool::rewind(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _readCursor = _committedCursor;
+    _uncommittedCount = 0;
+}
+
+bool RecordSpool::readable(void)
+{
+    return readableSize() > 0;
+}
+
+size_t RecordSpool::readableSize(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t retVal = 0;
+    bool reached = false;
+
+    for (Segment &segment : _segments) {
+        if (segment.sequence == _readCursor.sequence) {
+            reached = true;
+            retVal += segment.end - std::min((size_t)_readCursor.offset, segment.end);
+        }
+        else if (reached) {
+            retVal += segment.end - SPOOL_SEGMENT_HEADER_SIZE;
+        }
+    }
+
+    return retVal;
+}
+
+bool RecordSpool::wait(std::chrono::nanoseconds timeout)
+{
+    for (;;) {
+        uint32_t key = _dataEvent.prepareWait();
+
+        if (_terminated) {
+            _dataEvent.cancelWait();
+            return false;
+        }
+        else if (readable()) {
+            _dataEvent.cancelWait();
+            return true;
+        }
+
+        if (!_dataEvent.commitWait(key, timeout)) {
+            return !_terminated && readable();
+        }
+    }
+}
+
+void RecordSpool::unblock(void)
+{
+    _terminated = true;
+    _dataEvent.notifyAll();
+}
+
+size_t RecordSpool::size(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _totalSize;
+}
+
+size_t RecordSpool::segmentCount(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _segments.size();
+}
+
+bool RecordSpool::loadCursor(SpoolCursor &cursor)
+{
+    uint8_t data[SPOOL_CURSOR_SIZE];
+    int fd = ::open(cursorPath().c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    bool retVal = ::read(fd, data, SPOOL_CURSOR_SIZE) == SPOOL_CURSOR_SIZE && ReadU32(data) == SPOOL_CURSOR_MAGIC && ReadU32(data + 4) == Crc32(data + 8, 16);
+    ::close(fd);
+
+    if (retVal) {
+        memcpy(&cursor.sequence, data + 8, 8);
+        memcpy(&cursor.offset, data + 16, 8);
+    }
+
+    return retVal;
+}
+
+//! written aside and renamed over the old checkpoint, a torn write leaves the previous one
+bool RecordSpool::saveCursor(const SpoolCursor &cursor)
+{
+    uint8_t data[SPOOL_CURSOR_SIZE];
+    std::string path = cursorPath();
+    std::string pending = path + ".tmp";
+
+    memcpy(data + 8, &cursor.sequence, 8);
+    memcpy(data + 16, &cursor.offset, 8);
+    WriteU32(data, SPOOL_CURSOR_MAGIC);
+    WriteU32(data + 4, Crc32(data + 8, 16));
+
+    int fd = ::open(pending.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    bool retVal = ::write(fd, data, SPOOL_CURSOR_SIZE) == SPOOL_CURSOR_SIZE;
+    ::close(fd);
+
+    return retVal && rename(pending.c_str(), path.c_str()) == 0;
+}
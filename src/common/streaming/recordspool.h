@@ -0,0 +1,133 @@
+#ifndef __RECORDSPOOL_H
+#define __RECORDSPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "queue/mpsc_ring_queue.h"
+
+#define SPOOL_DEFAULT_SEGMENT_SIZE 4194304
+#define SPOOL_DEFAULT_MAX_SIZE 268435456 ///< oldest segments are dropped past this, read or not
+#define SPOOL_SEGMENT_MAGIC 0x50534853 ///< "SHSP"
+#define SPOOL_SEGMENT_VERSION 1
+#define SPOOL_SEGMENT_HEADER_SIZE 8 ///< magic, version
+#define SPOOL_FRAME_HEADER_SIZE 8 ///< length, crc32 of the record
+
+//! spool settings from the kinesis configuration
+typedef struct {
+    std::string directory;
+    size_t segmentSize;
+    size_t maxSize;
+} RecordSpoolConfiguration;
+
+/**
+ * durable FIFO of records on disk - records are appended to memory
+ * mapped segment files and read back in order by one reader, which
+ * commits what it has handed on. The committed position is
+ * checkpointed to a cursor file, so a restart carries on from the
+ * first record that wasn't committed
+ *
+ * - segments are append only, each record is framed with its length
+ *   and CRC so recovery stops at a torn write
+ * - a new segment is started on every open and when the current one
+ *   is full, segments behind the committed position are deleted
+ * - once the segments take more than maxSize the oldest are dropped
+ *   even if they haven't been read, so an outage of any length takes
+ *   a bounded amount of disk and memory
+ *
+ * append may be called from any thread, read/commit/rewind/wait only
+ * from the reader thread
+ */
+class RecordSpool
+{
+protected:
+    typedef struct {
+        uint64_t sequence;
+        std::string path;
+        int fd; ///< only open while the segment is written to
+        uint8_t *data; ///< NULL when unmapped
+        size_t mappedSize;
+        size_t end; ///< offset past the last record
+    } Segment;
+
+    typedef struct {
+        uint64_t sequence;
+        uint64_t offset;
+    } SpoolCursor;
+
+    RecordSpoolConfiguration _configuration;
+    std::mutex _mutex;
+    std::deque<Segment> _segments; ///< oldest first, the last one is written to
+    SpoolCursor _readCursor;
+    SpoolCursor _committedCursor;
+    size_t _totalSize;
+    bool _open;
+    WakeEvent _dataEvent;
+    std::atomic<bool> _terminated;
+
+    std::atomic<uint64_t> _appendedCount;
+    std::atomic<uint64_t> _committedCount;
+    std::atomic<uint64_t> _droppedCount; ///< records lost to retention or too big for a segment
+    uint64_t _uncommittedCount; ///< read since the last commit
+
+    std::string segmentPath(uint64_t sequence);
+    std::string cursorPath(void);
+    Segment *segment(uint64_t sequence);
+    bool createSegment(uint64_t sequence);
+    bool mapSegment(Segment &segment);
+    void unmapSegment(Segment &segment);
+    void sealSegment(Segment &segment);
+    bool recoverSegment(Segment &segment);
+    size_t countRecords(Segment &segment, size_t offset);
+    void dropOldestSegment(void);
+    bool readable(void);
+    bool loadCursor(SpoolCursor &cursor);
+    bool saveCursor(const SpoolCursor &cursor);
+
+public:
+    RecordSpool(const RecordSpoolConfiguration &configuration);
+    virtual ~RecordSpool(void);
+
+    RecordSpool(const RecordSpool &) = delete; // disable copying
+    RecordSpool &operator=(const RecordSpool &) = delete; // disable assignment
+
+    static RecordSpoolConfiguration DefaultConfiguration(std::string directory);
+
+    //! creates the directory if needed and recovers whatever an earlier run left in it
+    bool open(void);
+
+    //! seals the current segment and checkpoints the committed position
+    void close(void);
+
+    //! returns false when the record can't be spooled (too big for a segment or a failed write)
+    bool append(const std::string &record);
+
+    //! appends records from the read position onwards, up to maxSize bytes (at least one record) - returns the bytes read
+    size_t read(std::vector<std::string> &records, size_t maxSize);
+
+    //! everything read so far has been handed on - checkpoints the read position and deletes finished segments
+    void commit(void);
+
+    //! reads again from the committed position
+    void rewind(void);
+
+    //! waits until there's something to read, false once unblocked
+    bool wait(std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max());
+    void unblock(void);
+
+    //! bytes of records between the read position and the end of the spool
+    size_t readableSize(void);
+
+    size_t size(void);
+    size_t segmentCount(void);
+    uint64_t appendedCount(void) { return _appendedCount.load(std::memory_order_relaxed); };
+    uint64_t committedCount(void) { return _committedCount.load(std::memory_order_relaxed); };
+    uint64_t droppedCount(void) { return _droppedCount.load(std::memory_order_relaxed); };
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include <string.h>
+
+#include "sustainscheduler.h"
+
+SustainScheduler::SustainScheduler(SustainFunction resend)
+    : _resend(resend)
+    , _updates(SUSTAIN_QUEUE_CAPACITY, OVERFLOW_COALESCE)
+    , _sustainedCount(0)
+    , _resentCount(0)
+    , _wakeCount(0)
+{
+    // an element's latest update replaces any older one still queued
+    _updates.setCoalesceKey([](const SustainUpdate &update) { return std::to_string(update.value.elementId); });
+}
+
+SustainScheduler::~SustainScheduler(void)
+{
+    stop();
+}
+
+void SustainScheduler::update(const EventValue &value, uint32_t period)
+{
+    _updates.push({ value, period, true });
+}
+
+void SustainScheduler::setPeriod(ElementID id, uint32_t period)
+{
+    SustainUpdate update;
+
+    memset(&update, 0, sizeof(SustainUpdate));
+    update.value.elementId = id;
+    update.period = period;
+    update.hasValue = false;
+
+    _updates.push(update);
+}
+
+void SustainScheduler::start(void)
+{
+    if (!_thread.joinable()) {
+        _thread = std::thread(&SustainScheduler::run, this);
+    }
+}
+
+void SustainScheduler::stop(void)
+{
+    _updates.unblock();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void SustainScheduler::apply(const SustainUpdate &update)
+{
+    ElementID id = update.value.elementId;
+
+    if (id >= _elements.size()) {
+        if (!update.hasValue) {
+            return;
+        }
+
+        _elements.resize(id + 1, SustainedElement());
+    }
+
+    SustainedElement &element = _elements[id];
+    bool wasSustained = element.hasValue && element.period > 0;
+
+    if (update.hasValue) {
+        element.value = update.value;
+        element.hasValue = true;
+    }
+
+    element.period = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(update.period)).count();
+
+    // a period change before the element's first value waits for that value
+    if (!element.hasValue) {
+        return;
+    }
+
+    bool sustained = element.period > 0;
+
+    if (sustained != wasSustained) {
+        sustained ? _sustainedCount++ : _sustainedCount--;
+    }
+
+    if (sustained) {
+        element.deadline = element.value.timestamp + element.period;
+        schedule(element, id);
+    }
+}
+
+//! gives an element a heap entry unless it has one that is due no later
+void SustainScheduler::schedule(SustainedElement &element, ElementID id)
+{
+    if (element.scheduled == 0 || element.deadline < element.scheduled) {
+        element.scheduled = element.deadline;
+        _deadlines.push(Deadline(element.deadline, id));
+    }
+}
+
+//! resends every value whose deadline has passed
+void SustainScheduler::expire(int64_t now)
+{
+    while (!_deadlines.empty() && _deadlines.top().first <= now) {
+        Deadline due = _deadlines.top();
+        SustainedElement &element = _elements[due.second];
+
+        _deadlines.pop();
+
+        // an earlier entry took over from this one
+        if (due.first != element.scheduled) {
+            continue;
+        }
+
+        element.scheduled = 0;
+
+        if (!element.hasValue || element.period == 0) {
+            continue;
+        }
+
+        // a newer value arrived since the entry was pushed
+        if (element.deadline > now) {
+            schedule(element, due.second);
+            continue;
+        }
+
+        element.value.timestamp = now;
+        element.deadline = now + element.period;
+        _resend(element.value);
+        _resentCount.fetch_add(1, std::memory_order_relaxed);
+
+        schedule(element, due.second);
+    }
+}
+
+void SustainScheduler::run(void)
+{
+    SustainUpdate update;
+
+    for (;;) {
+        bool received = false;
+
+        try {
+            if (_deadlines.empty()) {
+                received = _updates.pop(update);
+            }
+            else {
+                int64_t wait = _deadlines.top().first - EventTimestampNow();
+                received = wait > 0 ? _updates.pop(update, std::chrono::nanoseconds(wait)) : _updates.tryPop(update);
+            }
+        }
+        catch (ConcurrentQueueInterrupted &queueException) {
+            break;
+        }
+
+        _wakeCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (received) {
+            apply(update);
+
+            while (_updates.tryPop(update)) {
+                apply(update);
+            }
+        }
+
+        expire(EventTimestampNow());
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef __SUSTAINSCHEDULER_H
+#define __SUSTAINSCHEDULER_H
+
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "elements/events/eventvalue.h"
+#include "queue/mpsc_ring_queue.h"
+
+#define SUSTAIN_QUEUE_CAPACITY 1024
+
+//! resends a sustained value, called on the scheduler thread with the value's timestamp set to now
+typedef std::function<void(const EventValue &value)> SustainFunction;
+
+/**
+ * resends the latest value of sustained elements once they've been
+ * quiet for their sustain period
+ *
+ * the event thread only pushes updates onto a lock-free queue - the
+ * scheduler thread owns every element's state and a min-heap of
+ * deadlines, and sleeps on the queue until the earliest deadline (or
+ * indefinitely when nothing is sustained), so there's no tick and no
+ * lock shared with the event thread
+ *
+ * each element has at most one live heap entry: a newer value moves
+ * its deadline later, and the entry is pushed back when it comes up
+ * early instead of adding another
+ */
+class SustainScheduler
+{
+protected:
+    typedef struct {
+        EventValue value;
+        uint32_t period; ///< ms, 0 when the element has no value to sustain
+        bool hasValue; ///< false for a period change from a mapping reload
+    } SustainUpdate;
+
+    typedef struct {
+        EventValue value;
+        int64_t period; ///< ns, 0 when not sustained
+        int64_t deadline; ///< when the value is due to be resent
+        int64_t scheduled; ///< deadline of the element's heap entry, 0 when it has none
+        bool hasValue;
+    } SustainedElement;
+
+    typedef std::pair<int64_t, ElementID> Deadline;
+
+    SustainFunction _resend;
+    MPSCRingQueue<SustainUpdate> _updates;
+    std::vector<SustainedElement> _elements; ///< indexed by ElementID, only touched by the scheduler thread
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> _deadlines;
+    std::thread _thread;
+
+    std::atomic<size_t> _sustainedCount;
+    std::atomic<uint64_t> _resentCount;
+    std::atomic<uint64_t> _wakeCount;
+
+    void run(void);
+    void apply(const SustainUpdate &update);
+    void schedule(SustainedElement &element, ElementID id);
+    void expire(int64_t now);
+
+public:
+    SustainScheduler(SustainFunction resend);
+    virtual ~SustainScheduler(void);
+
+    SustainScheduler(const SustainScheduler &) = delete; // disable copying
+    SustainScheduler &operator=(const SustainScheduler &) = delete; // disable assignment
+
+    //! the latest value of a sustained element - resent once nothing newer arrives for period ms
+    void update(const EventValue &value, uint32_t period);
+
+    //! changes the sustain period of an element, 0 stops sustaining it
+    void setPeriod(ElementID id, uint32_t period);
+
+    void start(void);
+    void stop(void);
+
+    size_t sustainedCount(void) { return _sustainedCount.load(std::memory_order_relaxed); };
+    uint64_t resentCount(void) { return _resentCount.load(std::memory_order_relaxed); };
+    uint64_t wakeCount(void) { return _wakeCount.load(std::memory_order_relaxed); };
+};
+
+#endif
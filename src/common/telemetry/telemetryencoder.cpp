@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "telemetryencoder.h"
+
+static void AppendLittleEndian(std::string &out, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        out.push_back((char)(value >> (i * 8)));
+    }
+}
+
+bool TelemetryFormatFromString(const std::string &name, TelemetryFormat *format)
+{
+    if (name == "json") {
+        *format = TELEMETRY_JSON;
+    }
+    else if (name == "binary") {
+        *format = TELEMETRY_BINARY;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+TelemetryEncoder::TelemetryEncoder(const ElementSymbolTable &symbols, const EventStringTable &strings, TelemetryFormat format)
+    : _symbols(symbols)
+    , _strings(strings)
+    , _format(format)
+    , _fragmentCount(symbols.capacity() + 1)
+    , _fragments(new std::atomic<const ElementFragment *>[symbols.capacity() + 1])
+{
+    for (size_t i = 0; i < _fragmentCount; i++) {
+        _fragments[i].store(NULL, std::memory_order_relaxed);
+    }
+}
+
+TelemetryEncoder::~TelemetryEncoder(void)
+{
+    for (size_t i = 0; i < _fragmentCount; i++) {
+        delete _fragments[i].load(std::memory_order_relaxed);
+    }
+}
+
+//! the cached fragments of an element, built by whichever thread sees it first
+const TelemetryEncoder::ElementFragment *TelemetryEncoder::fragment(ElementID id)
+{
+    if (id >= _fragmentCount) {
+        id = INVALID_ELEMENT_ID;
+    }
+
+    const ElementFragment *retVal = _fragments[id].load(std::memory_order_acquire);
+
+    if (retVal) {
+        return retVal;
+    }
+
+    ElementFragment *built = new ElementFragment;
+    const std::string &name = _symbols.name(id);
+
+    if (_format == TELEMETRY_JSON) {
+        built->head = "{\"s\":\"";
+        AppendEscaped(built->head, name.c_str());
+        built->head += "\",\"val\":\"";
+        built->tail = "\",\"d\":\"";
+        AppendEscaped(built->tail, TELEMETRY_DEFAULT_DESCRIPTION);
+        built->tail += "\",\"u\":\"";
+        AppendEscaped(built->tail, TELEMETRY_DEFAULT_UNITS);
+        built->tail += "\"}";
+    }
+    else {
+        size_t length = std::min(name.size(), (size_t)UINT16_MAX);
+
+        built->head.push_back((char)TELEMETRY_SCHEMA_EVENT);
+        AppendLittleEndian(built->head, length, 2);
+        built->head.append(name, 0, length);
+    }
+
+    // another thread may have built it meanwhile, theirs is kept
+    if (_fragments[id].compare_exchange_strong(retVal, built, std::memory_order_acq_rel)) {
+        retVal = built;
+    }
+    else {
+        delete built;
+    }
+
+    return retVal;
+}
+
+void TelemetryEncoder::encode(const EventValue &value, std::string &out)
+{
+    const ElementFragment *element = fragment(value.elementId);
+
+    out.clear();
+
+    if (_format == TELEMETRY_JSON) {
+        encodeJSON(value, element, out);
+    }
+    else {
+        encodeBinary(value, element, out);
+    }
+}
+
+void TelemetryEncoder::encodeJSON(const EventValue &value, const ElementFragment *element, std::string &out)
+{
+    out += element->head;
+
+    switch (value.type) {
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        AppendInteger(out, value.value.int_value);
+        break;
+    case FLOAT_ATTRIBUTE:
+        AppendFloat(out, value.value.float_value);
+        break;
+    case STRING_ATTRIBUTE: {
+        EventStringBuffer buffer;
+        AppendEscaped(out, EventValueString(value, _strings, buffer));
+        break;
+    }
+    case BOOL_ATTRIBUTE:
+        out.push_back(value.value.bool_value ? '1' : '0');
+        break;
+    default:
+        break;
+    }
+
+    out += "\",\"ts\":\"";
+    AppendInteger(out, EventTimestampToEpochMs(value.timestamp));
+    out += element->tail;
+}
+
+void TelemetryEncoder::encodeBinary(const EventValue &value, const ElementFragment *element, std::string &out)
+{
+    uint32_t floatBits;
+
+    out += element->head;
+    out.push_back((char)value.type);
+
+    switch (value.type) {
+    case INT_ATTRIBUTE:
+    case UINT_ATTRIBUTE:
+        AppendLittleEndian(out, (uint64_t)value.value.int_value, 8);
+        break;
+    case FLOAT_ATTRIBUTE:
+        memcpy(&floatBits, &value.value.float_value, sizeof(floatBits));
+        AppendLittleEndian(out, floatBits, 4);
+        break;
+    case STRING_ATTRIBUTE: {
+        EventStringBuffer buffer;
+        const char *string = EventValueString(value, _strings, buffer);
+        size_t length = strlen(string);
+
+        AppendLittleEndian(out, length, 2);
+        out.append(string, length);
+        break;
+    }
+    case BOOL_ATTRIBUTE:
+        out.push_back(value.value.bool_value ? 1 : 0);
+        break;
+    default:
+        break;
+    }
+
+    AppendLittleEndian(out, (uint64_t)EventTimestampToEpochMs(value.timestamp), 8);
+    out += element->tail;
+}
+
+void TelemetryEncoder::AppendInteger(std::string &out, int64_t value)
+{
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *pos = end;
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+
+    do {
+        *--pos = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0) {
+        *--pos = '-';
+    }
+
+    out.append(pos, end - pos);
+}
+
+//! same digits as streaming the float (%g, 6 significant digits)
+void TelemetryEncoder::AppendFloat(std::string &out, float value)
+{
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%g", (double)value);
+
+    out.append(buffer, length);
+}
+
+void TelemetryEncoder::AppendEscaped(std::string &out, const char *value)
+{
+    static const char *Hex = "0123456789abcdef";
+
+    for (; *value; value++) {
+        char c = *value;
+
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                out += "\\u00";
+                out.push_back(Hex[(c >> 4) & 0x0F]);
+                out.push_back(Hex[c & 0x0F]);
+            }
+            else {
+                out.push_back(c);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef __TELEMETRYENCODER_H
+#define __TELEMETRYENCODER_H
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+#include "elements/events/eventvalue.h"
+
+#define TELEMETRY_DEFAULT_DESCRIPTION "none"
+#define TELEMETRY_DEFAULT_UNITS "none"
+#define TELEMETRY_SCHEMA_EVENT 0x01 ///< first byte of a binary event record
+
+typedef enum { TELEMETRY_JSON = 0, TELEMETRY_BINARY } TelemetryFormat;
+
+//! "json" or "binary", returns false for anything else
+bool TelemetryFormatFromString(const std::string &name, TelemetryFormat *format);
+
+/**
+ * encodes events into telemetry records without any stream or string
+ * copies on the way - the parts of a record that only depend on the
+ * element (its escaped name, description and units) are built the
+ * first time the element is seen and appended from then on, numbers
+ * are formatted straight into the output
+ *
+ * JSON records keep the fields simhub has always sent
+ *
+ *   {"s":"N_ELEMENT","val":"123","ts":"1500000000000","d":"none","u":"none"}
+ *
+ * binary records are little endian and start with a schema tag
+ *
+ *   u8 TELEMETRY_SCHEMA_EVENT
+ *   u16 name length, name
+ *   u8 eAttribute_t
+ *   value - i64 (int, uint), f32 (float), u8 (bool), u16 length + bytes (string)
+ *   i64 timestamp, ms since the unix epoch
+ *
+ * the element fragments are published with a CAS, so encode can be
+ * called from any thread
+ */
+class TelemetryEncoder
+{
+protected:
+    typedef struct {
+        std::string head; ///< everything before the value
+        std::string tail; ///< everything after the timestamp
+    } ElementFragment;
+
+    const ElementSymbolTable &_symbols;
+    const EventStringTable &_strings;
+    TelemetryFormat _format;
+    size_t _fragmentCount;
+    std::unique_ptr<std::atomic<const ElementFragment *>[]> _fragments; ///< indexed by ElementID, built on first use
+
+    const ElementFragment *fragment(ElementID id);
+    void encodeJSON(const EventValue &value, const ElementFragment *element, std::string &out);
+    void encodeBinary(const EventValue &value, const ElementFragment *element, std::string &out);
+
+public:
+    TelemetryEncoder(const ElementSymbolTable &symbols, const EventStringTable &strings, TelemetryFormat format = TELEMETRY_JSON);
+    virtual ~TelemetryEncoder(void);
+
+    TelemetryEncoder(const TelemetryEncoder &) = delete; // disable copying
+    TelemetryEncoder &operator=(const TelemetryEncoder &) = delete; // disable assignment
+
+    //! replaces the content of out with the record of value - out keeps its capacity between calls
+    void encode(const EventValue &value, std::string &out);
+
+    TelemetryFormat format(void) { return _format; };
+
+    static void AppendInteger(std::string &out, int64_t value);
+    static void AppendFloat(std::string &out, float value);
+    static void AppendEscaped(std::string &out, const char *value);
+};
+
+#endif
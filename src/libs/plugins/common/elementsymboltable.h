@@ -0,0 +1,147 @@
+#ifndef __ELEMENTSYMBOLTABLE_H
+#define __ELEMENTSYMBOLTABLE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include "simhubdeviceplugin.h"
+
+#define ELEMENT_SYMBOL_CAPACITY 8192
+
+/**
+ * Interns element names into dense ElementIDs (1..capacity) so that
+ * the rest of the pipeline can index tables by integer rather than
+ * comparing and copying strings.
+ *
+ * - open addressing hash with twice the capacity in slots
+ * - lookups are lock-free: a slot is published (release) only after
+ *   the name it refers to has been written, and once published
+ *   neither changes
+ * - interning a new name takes a mutex - configured names are interned
+ *   while configuration is loaded, at runtime producers only find
+ *   names and the event thread interns the ones first seen then
+ * - capacity is fixed - intern returns INVALID_ELEMENT_ID when full
+ */
+class ElementSymbolTable
+{
+protected:
+    size_t _capacity;
+    size_t _slotMask;
+    std::unique_ptr<std::atomic<ElementID>[]> _slots;
+    std::unique_ptr<std::string[]> _names; ///< indexed by ElementID
+    std::atomic<ElementID> _count;
+    std::mutex _internMutex;
+
+    static uint32_t hash(const char *name, size_t length)
+    {
+        uint32_t retVal = 2166136261u; // FNV-1a
+
+        for (size_t i = 0; i < length; i++) {
+            retVal = (retVal ^ (uint8_t)name[i]) * 16777619u;
+        }
+
+        return retVal;
+    }
+
+    //! returns the matching id or, when absent, 0 with slot set to the empty slot ending the probe
+    ElementID probe(const char *name, size_t length, size_t *slot) const
+    {
+        size_t index = hash(name, length) & _slotMask;
+
+        for (;;) {
+            ElementID id = _slots[index].load(std::memory_order_acquire);
+
+            if (id == INVALID_ELEMENT_ID) {
+                *slot = index;
+                return INVALID_ELEMENT_ID;
+            }
+
+            if (_names[id].size() == length && memcmp(_names[id].data(), name, length) == 0) {
+                return id;
+            }
+
+            index = (index + 1) & _slotMask;
+        }
+    }
+
+public:
+    ElementSymbolTable(size_t capacity = ELEMENT_SYMBOL_CAPACITY)
+        : _capacity(capacity)
+        , _count(0)
+    {
+        size_t slots = 2;
+
+        while (slots < capacity * 2) {
+            slots <<= 1;
+        }
+
+        _slotMask = slots - 1;
+        _slots.reset(new std::atomic<ElementID>[slots]);
+        _names.reset(new std::string[capacity + 1]);
+
+        for (size_t i = 0; i < slots; i++) {
+            _slots[i].store(INVALID_ELEMENT_ID, std::memory_order_relaxed);
+        }
+    }
+
+    ElementSymbolTable(const ElementSymbolTable &) = delete; // disable copying
+    ElementSymbolTable &operator=(const ElementSymbolTable &) = delete; // disable assignment
+
+    //! lock-free lookup - INVALID_ELEMENT_ID when the name has not been interned
+    ElementID find(const char *name) const
+    {
+        size_t slot;
+        return probe(name, strlen(name), &slot);
+    }
+
+    ElementID find(const std::string &name) const
+    {
+        size_t slot;
+        return probe(name.data(), name.size(), &slot);
+    }
+
+    //! returns the id of name, assigning the next free one if it is new
+    ElementID intern(const char *name)
+    {
+        size_t length = strlen(name);
+        size_t slot;
+        ElementID retVal = probe(name, length, &slot);
+
+        if (retVal != INVALID_ELEMENT_ID) {
+            return retVal;
+        }
+
+        std::lock_guard<std::mutex> lock(_internMutex);
+
+        // somebody may have beaten us to it
+        retVal = probe(name, length, &slot);
+
+        if (retVal == INVALID_ELEMENT_ID && _count < _capacity) {
+            retVal = _count + 1;
+            _names[retVal].assign(name, length);
+            _count.store(retVal, std::memory_order_release);
+            _slots[slot].store(retVal, std::memory_order_release);
+        }
+
+        return retVal;
+    }
+
+    ElementID intern(const std::string &name) { return intern(name.c_str()); };
+
+    //! name of an interned id - empty for unknown ids
+    const std::string &name(ElementID id) const
+    {
+        static const std::string emptyName;
+        return (id > 0 && id <= _count.load(std::memory_order_acquire)) ? _names[id] : emptyName;
+    }
+
+    //! highest assigned id - tables indexed by id need size() + 1 entries
+    size_t size(void) const { return _count.load(std::memory_order_acquire); };
+    size_t capacity(void) const { return _capacity; };
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <sstream>
 #include <unistd.h>
 
 #include "pluginstatemanager.h"
@@ -7,11 +8,15 @@ PluginStateManager::PluginStateManager(LoggingFunctionCB logger)
     : _enqueueCallback(NULL)
     , _logger(logger)
     , _pluginThread(NULL)
+    , _symbolResolver(NULL)
+    , _symbolResolverArg(NULL)
 {
+    generic_pool_init(&_eventPool);
 }
 
 PluginStateManager::~PluginStateManager(void)
 {
+    generic_pool_destroy(&_eventPool);
 }
 
 //! just queue up a copy of the device settings for use in preflightComplete
@@ -21,6 +26,22 @@ int PluginStateManager::configPassthrough(libconfig::Config *pluginConfiguration
     return 0;
 }
 
+void PluginStateManager::bindSymbolResolver(SymbolResolverCB resolver, void *arg)
+{
+    _symbolResolver = resolver;
+    _symbolResolverArg = arg;
+}
+
+//! resolves a name to the id shared with the host (or a plugin local one if there's no host resolver)
+ElementID PluginStateManager::elementId(const char *name)
+{
+    if (_symbolResolver) {
+        return _symbolResolver(name, _symbolResolverArg);
+    }
+
+    return _localSymbols.intern(name);
+}
+
 int PluginStateManager::preflightComplete(void)
 {
     return 0;
@@ -31,6 +52,22 @@ int PluginStateManager::deliverValue(GenericTLV *value)
     return 0;
 }
 
+//! default batch delivery - plugins that can do better should override
+int PluginStateManager::deliverValues(GenericTLV **values, int count)
+{
+    int retVal = 0;
+
+    for (int i = 0; i < count; i++) {
+        int err = deliverValue(values[i]);
+
+        if (err) {
+            retVal = err;
+        }
+    }
+
+    return retVal;
+}
+
 void PluginStateManager::commenceEventing(EnqueueEventHandler enqueueCallback, void *arg)
 {
     _logger(LOG_INFO, "<PluginManager> Commence eventing");
@@ -53,3 +90,30 @@ std::string PluginStateManager::transformBoolToString(std::string orginalValue,
     }
     return orginalValue;
 }
+
+//! formats the value of a generic the same way the host's Attribute::valueToString does
+std::string PluginStateManager::GenericValueToString(const GenericTLV *value)
+{
+    std::ostringstream oss;
+
+    switch (value->type) {
+    case CONFIG_INT:
+    case CONFIG_UINT:
+        oss << value->value.int_value;
+        break;
+    case CONFIG_FLOAT:
+        oss << value->value.float_value;
+        break;
+    case CONFIG_STRING:
+        oss << (value->value.string_value ? value->value.string_value : "");
+        break;
+    case CONFIG_BOOL:
+        oss << (bool)value->value.bool_value;
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    return oss.str();
+}
@@ -5,6 +5,7 @@
 #include <list>
 #include <thread>
 
+#include "common/elementsymboltable.h"
 #include "common/simhubdeviceplugin.h"
 
 #define PREFLIGHT_OK 0
@@ -36,18 +37,30 @@ protected:
     std::shared_ptr<std::thread> _pluginThread;
     std::string _name;
 
+    SymbolResolverCB _symbolResolver;
+    void *_symbolResolverArg;
+    ElementSymbolTable _localSymbols; ///< used when the host doesn't bind a resolver
+
+    GenericTLVPool _eventPool; ///< records for the events this plugin enqueues
+
 public:
     PluginStateManager(LoggingFunctionCB logger);
     virtual ~PluginStateManager(void);
 
     virtual int configPassthrough(libconfig::Config *pluginConfiguration);
+    virtual void bindSymbolResolver(SymbolResolverCB resolver, void *arg);
+    ElementID elementId(const char *name);
+    ElementID elementId(const std::string &name) { return elementId(name.c_str()); };
+    GenericTLVPool *eventPool(void) { return &_eventPool; };
     virtual int preflightComplete(void);
     virtual void commenceEventing(EnqueueEventHandler enqueueCallback, void *arg);
     virtual int deliverValue(GenericTLV *value);
+    virtual int deliverValues(GenericTLV **values, int count);
     virtual void ceaseEventing(void);
     virtual std::string name() { return _name; }
 
     // transformations
+    static std::string GenericValueToString(const GenericTLV *value);
     virtual std::string transformBoolToString(std::string orginalValue, std::string transformResultOff, std::string transformResultOn);
 };
 
@@ -3,8 +3,10 @@
 
 #include <dlfcn.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <memory.h>
 #include <assert.h>
+#include <stdint.h>
 #if defined(build_macosx)
 #define LIB_EXT ".dylib"
 #endif
@@ -19,10 +21,33 @@ extern "C" {
 
 #define SPHANDLE void *
 
+/**
+ * plugin ABI revision - bumped whenever GenericTLV or the vtable
+ * layout changes. Plugins export simplug_abi_version and the host
+ * refuses to load plugins built against a different revision
+ *
+ * 2 - element ids and pooled GenericTLV records
+ */
+#define SIMPLUG_ABI_VERSION 2
+
 typedef void (*EnqueueEventHandler)(SPHANDLE eventSource, void *event, void *arg);
 
 typedef void (*LoggingFunctionCB)(const int category, const char *msg, ...);
 
+//! dense integer handle for an element name - see ElementSymbolTable
+typedef uint32_t ElementID;
+
+#define INVALID_ELEMENT_ID 0
+
+/**
+ * resolves an element name to its id - handed to plugins by the host
+ * so that both sides share one symbol table. Names are interned up to
+ * preflight, afterwards a name the host doesn't know resolves to
+ * INVALID_ELEMENT_ID - an event sent with that id is resolved by its
+ * name on the host's event thread
+ */
+typedef ElementID (*SymbolResolverCB)(const char *name, void *arg);
+
 typedef enum { CONFIG_INT = 0, CONFIG_STRING, CONFIG_FLOAT, CONFIG_BOOL, CONFIG_UINT } ConfigType;
 
 typedef union {
@@ -35,6 +60,8 @@ typedef union {
     operator int() const { return int_value; }
 } VariantUnion;
 
+struct GenericTLVPool;
+
 typedef struct {
     char *name;
     ConfigType type;
@@ -43,8 +70,42 @@ typedef struct {
     char *description;
     char *units;
     SPHANDLE ownerPlugin;
+    ElementID element_id; ///< id of name, INVALID_ELEMENT_ID if the sender didn't resolve it
+    struct GenericTLVPool *pool; ///< owning pool, NULL for heap allocated instances
 } GenericTLV;
 
+#define GENERIC_INLINE_NAME_LEN 64
+#define GENERIC_INLINE_DESCRIPTION_LEN 32
+#define GENERIC_INLINE_UNITS_LEN 16
+#define GENERIC_INLINE_STRING_LEN 64
+
+/**
+ * fixed layout GenericTLV with inline storage for its strings - the
+ * char pointers of the embedded GenericTLV point into these buffers
+ * unless a string is too long, in which case it is heap allocated
+ */
+typedef struct GenericTLVRecord {
+    GenericTLV generic; ///< must stay the first member
+    struct GenericTLVRecord *next; ///< free list link
+    char name[GENERIC_INLINE_NAME_LEN];
+    char description[GENERIC_INLINE_DESCRIPTION_LEN];
+    char units[GENERIC_INLINE_UNITS_LEN];
+    char string_value[GENERIC_INLINE_STRING_LEN];
+} GenericTLVRecord;
+
+/**
+ * free list of GenericTLVRecords - records are only malloc'ed while the
+ * pool warms up, after which eventing recycles them. The producer
+ * (plugin) owns the pool and the consumer (host) returns records to it
+ * through release_generic, so the list is guarded by a spinlock
+ */
+typedef struct GenericTLVPool {
+    char lock;
+    GenericTLVRecord *free_list;
+    long allocated; ///< records ever malloc'ed by this pool
+    long outstanding; ///< records currently handed out
+} GenericTLVPool;
+
 // -- begin GenericTLV helper methods
 
 inline void dupe_string(char **dest, const char *source)
@@ -87,10 +148,200 @@ inline GenericTLV *make_string_generic(const char *name, const char *description
     return retVal;
 }
 
+inline void generic_pool_init(GenericTLVPool *pool)
+{
+    memset(pool, 0, sizeof(GenericTLVPool));
+}
+
+//! frees the pooled records - every record handed out must have been released
+inline void generic_pool_destroy(GenericTLVPool *pool)
+{
+    GenericTLVRecord *record = pool->free_list;
+
+    assert(pool->outstanding == 0);
+
+    while (record) {
+        GenericTLVRecord *next = record->next;
+        free(record);
+        record = next;
+    }
+
+    pool->free_list = NULL;
+}
+
+inline void generic_pool_lock(GenericTLVPool *pool)
+{
+    while (__atomic_test_and_set(&pool->lock, __ATOMIC_ACQUIRE)) {
+        // spin - the critical sections are a handful of instructions
+    }
+}
+
+inline void generic_pool_unlock(GenericTLVPool *pool)
+{
+    __atomic_clear(&pool->lock, __ATOMIC_RELEASE);
+}
+
+//! copies source into the inline buffer when it fits, otherwise onto the heap
+inline void generic_set_string(char **dest, char *inline_buffer, size_t inline_size, const char *source)
+{
+    size_t length = strlen(source);
+
+    if (*dest && *dest != inline_buffer) {
+        free(*dest);
+    }
+
+    if (length < inline_size) {
+        memcpy(inline_buffer, source, length + 1);
+        *dest = inline_buffer;
+    }
+    else {
+        *dest = (char *)malloc(length + 1);
+        memcpy(*dest, source, length + 1);
+    }
+}
+
+//! GenericTLV from the pool - no allocation once the pool holds enough records
+inline GenericTLV *pool_make_generic(GenericTLVPool *pool, ElementID element_id, const char *name, const char *description)
+{
+    GenericTLVRecord *record;
+
+    assert(pool && name && description);
+
+    generic_pool_lock(pool);
+
+    record = pool->free_list;
+
+    if (record) {
+        pool->free_list = record->next;
+    }
+
+    pool->outstanding++;
+    generic_pool_unlock(pool);
+
+    if (!record) {
+        record = (GenericTLVRecord *)malloc(sizeof(GenericTLVRecord));
+        __atomic_add_fetch(&pool->allocated, 1, __ATOMIC_RELAXED);
+    }
+
+    memset(&record->generic, 0, sizeof(GenericTLV));
+    record->generic.type = CONFIG_INT;
+    record->generic.element_id = element_id;
+    record->generic.pool = pool;
+
+    generic_set_string(&record->generic.name, record->name, GENERIC_INLINE_NAME_LEN, name);
+    generic_set_string(&record->generic.description, record->description, GENERIC_INLINE_DESCRIPTION_LEN, description);
+
+    return &record->generic;
+}
+
+//! makes generic a CONFIG_STRING holding string_value - inline for pooled records
+inline void generic_set_string_value(GenericTLV *generic, const char *string_value)
+{
+    if (generic->type != CONFIG_STRING) {
+        generic->value.string_value = NULL;
+        generic->type = CONFIG_STRING;
+    }
+
+    if (generic->pool) {
+        generic_set_string(&generic->value.string_value, ((GenericTLVRecord *)generic)->string_value, GENERIC_INLINE_STRING_LEN, string_value);
+    }
+    else {
+        if (generic->value.string_value) {
+            free(generic->value.string_value);
+        }
+        dupe_string(&(generic->value.string_value), string_value);
+    }
+}
+
+inline GenericTLV *pool_make_string_generic(GenericTLVPool *pool, ElementID element_id, const char *name, const char *description, const char *string_value)
+{
+    GenericTLV *retVal = pool_make_generic(pool, element_id, name, description);
+    generic_set_string_value(retVal, string_value);
+    return retVal;
+}
+
+//! sets units on a generic - inline for pooled records
+inline void generic_set_units(GenericTLV *generic, const char *units)
+{
+    if (generic->pool) {
+        generic_set_string(&generic->units, ((GenericTLVRecord *)generic)->units, GENERIC_INLINE_UNITS_LEN, units);
+    }
+    else {
+        if (generic->units) {
+            free(generic->units);
+        }
+        dupe_string(&(generic->units), units);
+    }
+}
+
+//! sets the name (and id) of a generic - inline for pooled records
+inline void generic_set_name(GenericTLV *generic, ElementID element_id, const char *name)
+{
+    generic->element_id = element_id;
+
+    if (generic->pool) {
+        generic_set_string(&generic->name, ((GenericTLVRecord *)generic)->name, GENERIC_INLINE_NAME_LEN, name);
+    }
+    else {
+        if (generic->name) {
+            free(generic->name);
+        }
+        dupe_string(&(generic->name), name);
+    }
+}
+
+//! sets the description of a generic - inline for pooled records
+inline void generic_set_description(GenericTLV *generic, const char *description)
+{
+    if (generic->pool) {
+        generic_set_string(&generic->description, ((GenericTLVRecord *)generic)->description, GENERIC_INLINE_DESCRIPTION_LEN, description);
+    }
+    else {
+        if (generic->description) {
+            free(generic->description);
+        }
+        dupe_string(&(generic->description), description);
+    }
+}
+
+inline void release_pooled_generic(GenericTLV *generic)
+{
+    GenericTLVRecord *record = (GenericTLVRecord *)generic;
+    GenericTLVPool *pool = generic->pool;
+
+    // only strings that didn't fit inline were heap allocated
+    if (generic->name && generic->name != record->name) {
+        free(generic->name);
+    }
+
+    if (generic->description && generic->description != record->description) {
+        free(generic->description);
+    }
+
+    if (generic->units && generic->units != record->units) {
+        free(generic->units);
+    }
+
+    if (generic->type == CONFIG_STRING && generic->value.string_value && generic->value.string_value != record->string_value) {
+        free(generic->value.string_value);
+    }
+
+    generic_pool_lock(pool);
+    record->next = pool->free_list;
+    pool->free_list = record;
+    pool->outstanding--;
+    generic_pool_unlock(pool);
+}
+
 inline void release_generic(GenericTLV *generic)
 {
     assert(generic);
 
+    if (generic->pool) {
+        release_pooled_generic(generic);
+        return;
+    }
+
     if (generic->name) {
         free(generic->name);
     }
@@ -115,12 +366,22 @@ inline void release_generic(GenericTLV *generic)
 
 //! basic block of function pointers
 typedef struct {
+    //! the SIMPLUG_ABI_VERSION the plugin was built against
+    int (*simplug_abi_version)(void);
+
     //! inits the state manager handle
     int (*simplug_init)(SPHANDLE *plugin_instance, LoggingFunctionCB logger);
 
     //! pass through kludge until we split out config files
     int (*simplug_config_passthrough)(SPHANDLE plugin_instance, void *libconfig_instance);
 
+    /**
+     * optional - gives the plugin the host's element name resolver,
+     * called after init and before preflight so that configuration
+     * can be resolved to element ids
+     */
+    void (*simplug_bind_symbol_resolver)(SPHANDLE plugin_instance, SymbolResolverCB resolver, void *arg);
+
     //! pre-flight checks method
     int (*simplug_preflight_complete)(SPHANDLE plugin_instance);
 
@@ -138,6 +399,12 @@ typedef struct {
      */
     int (*simplug_deliver_value)(SPHANDLE plugin_instance, GenericTLV *value);
 
+    /**
+     * optional batched form of simplug_deliver_value - delivers count
+     * values in one call so the plugin can coalesce its outbound writes
+     */
+    int (*simplug_deliver_values)(SPHANDLE plugin_instance, GenericTLV **values, int count);
+
     //! tell the manager to tear down the event loop
     void (*simplug_cease_eventing)(SPHANDLE plugin_instance);
 
@@ -166,6 +433,13 @@ inline int simplug_bootstrap(const char *plugin_path, simplug_vtable *plugin_vta
     // grab the addresses of the relevant public plugin interface
     // functions
 
+    plugin_vtable->simplug_abi_version = (int (*)(void))dlsym(handle, "simplug_abi_version");
+
+    if (!plugin_vtable->simplug_abi_version || plugin_vtable->simplug_abi_version() != SIMPLUG_ABI_VERSION) {
+        fprintf(stderr, "plugin %s was built against a different ABI version (host is %d)\n", plugin_path, SIMPLUG_ABI_VERSION);
+        return -1;
+    }
+
     plugin_vtable->simplug_init = (int (*)(SPHANDLE *, LoggingFunctionCB))dlsym(handle, "simplug_init");
     if (!plugin_vtable->simplug_init)
         return -1;
@@ -174,6 +448,9 @@ inline int simplug_bootstrap(const char *plugin_path, simplug_vtable *plugin_vta
     if (!plugin_vtable->simplug_config_passthrough)
         return -1;
 
+    plugin_vtable->simplug_bind_symbol_resolver = (void (*)(SPHANDLE, SymbolResolverCB, void *))dlsym(handle, "simplug_bind_symbol_resolver");
+    // NOTE: optional - plugins without it leave element_id unresolved
+
     plugin_vtable->simplug_preflight_complete = (int (*)(SPHANDLE))dlsym(handle, "simplug_preflight_complete");
     if (!plugin_vtable->simplug_preflight_complete)
         return -1;
@@ -185,6 +462,9 @@ inline int simplug_bootstrap(const char *plugin_path, simplug_vtable *plugin_vta
     plugin_vtable->simplug_deliver_value = (int (*)(SPHANDLE, GenericTLV *))dlsym(handle, "simplug_deliver_value");
     // NOTE: at this point plugins can optionally implement the deliver_value function
 
+    plugin_vtable->simplug_deliver_values = (int (*)(SPHANDLE, GenericTLV **, int))dlsym(handle, "simplug_deliver_values");
+    // NOTE: deliver_values is optional too - callers fall back to deliver_value
+
     plugin_vtable->simplug_cease_eventing = (void (*)(SPHANDLE))dlsym(handle, "simplug_cease_eventing");
     if (!plugin_vtable->simplug_cease_eventing)
         return -1;
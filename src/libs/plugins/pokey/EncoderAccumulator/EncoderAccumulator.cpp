@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <stdlib.h>
+
+#include "EncoderAccumulator.h"
+
+EncoderAccumulator::EncoderAccumulator(void)
+    : _type(ENCODER_UNUSED)
+    , _value(0)
+    , _min(0)
+    , _max(0)
+    , _step(1)
+    , _count(0)
+{
+}
+
+void EncoderAccumulator::configure(EncoderType type, int32_t defaultValue, int32_t min, int32_t max, int32_t step, uint32_t count)
+{
+    _type = type;
+    _value = defaultValue;
+    _min = min;
+    _max = max;
+    _step = step;
+    _count = count;
+    _lastMovement = std::chrono::steady_clock::time_point();
+}
+
+void EncoderAccumulator::setAcceleration(EncoderAccelerationCurve curve)
+{
+    std::sort(curve.begin(), curve.end(), [](const EncoderAccelerationPoint &a, const EncoderAccelerationPoint &b) { return a.speed < b.speed; });
+    _acceleration = curve;
+}
+
+int32_t EncoderAccumulator::multiplier(uint32_t speed)
+{
+    int32_t retVal = 1;
+
+    for (auto &point : _acceleration) {
+        if (speed < point.speed) {
+            break;
+        }
+
+        retVal = point.multiplier;
+    }
+
+    return retVal;
+}
+
+bool EncoderAccumulator::update(uint32_t count, std::chrono::steady_clock::time_point now)
+{
+    // the counter wraps, the difference as signed is still the detents turned
+    int32_t delta = (int32_t)(count - _count);
+
+    if (delta == 0 || _type == ENCODER_UNUSED) {
+        _count = count;
+        return false;
+    }
+
+    _count = count;
+
+    uint32_t speed = 0;
+
+    if (_lastMovement != std::chrono::steady_clock::time_point()) {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _lastMovement).count();
+        speed = (uint32_t)(abs(delta) * 1000 / std::max<int64_t>(elapsed, 1));
+    }
+
+    _lastMovement = now;
+
+    int32_t scaled = delta * multiplier(speed);
+
+    if (_type == ENCODER_ABSOLUTE) {
+        _value = -scaled;
+        return true;
+    }
+
+    int64_t value = (int64_t)_value + (int64_t)scaled * _step;
+    _value = (int32_t)std::min<int64_t>(std::max<int64_t>(value, _min), _max);
+
+    return true;
+}
+
+EncoderType EncoderAccumulator::TypeFromString(std::string type)
+{
+    return type == "absolute" ? ENCODER_ABSOLUTE : ENCODER_RELATIVE;
+}
@@ -0,0 +1,59 @@
+#ifndef __ENCODER_ACCUMULATOR_H
+#define __ENCODER_ACCUMULATOR_H
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+typedef enum {
+    ENCODER_UNUSED = 0,
+    ENCODER_RELATIVE, ///< keeps a value between min and max, moved by step per detent
+    ENCODER_ABSOLUTE ///< sends the detents turned, negative when turned up
+} EncoderType;
+
+//! multiplier applied to the step once the encoder turns at least speed detents a second
+typedef struct {
+    uint32_t speed;
+    int32_t multiplier;
+} EncoderAccelerationPoint;
+
+typedef std::vector<EncoderAccelerationPoint> EncoderAccelerationCurve;
+
+/**
+ * turns the raw count of a Pokey encoder into its reported value -
+ * every detent turned since the last read goes into one update, scaled
+ * by the acceleration curve for the speed the knob is turning at
+ */
+class EncoderAccumulator
+{
+protected:
+    EncoderType _type;
+    int32_t _value;
+    int32_t _min;
+    int32_t _max;
+    int32_t _step;
+    uint32_t _count; ///< raw encoder count at the last read
+    EncoderAccelerationCurve _acceleration; ///< ascending by speed
+    std::chrono::steady_clock::time_point _lastMovement;
+
+public:
+    EncoderAccumulator(void);
+
+    void configure(EncoderType type, int32_t defaultValue, int32_t min, int32_t max, int32_t step, uint32_t count);
+    void setAcceleration(EncoderAccelerationCurve curve);
+
+    //! takes the raw count of a read, returns true when there's a new value to send
+    bool update(uint32_t count, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    //! step multiplier for the given speed in detents a second
+    int32_t multiplier(uint32_t speed);
+
+    EncoderType type(void) { return _type; };
+    int32_t value(void) { return _value; };
+
+    //! "absolute" or the default, "relative"
+    static EncoderType TypeFromString(std::string type);
+};
+
+#endif
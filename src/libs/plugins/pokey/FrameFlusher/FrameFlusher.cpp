@@ -0,0 +1,89 @@
+#include "FrameFlusher.h"
+
+FrameFlusher::FrameFlusher(FlushFunction flush, uint32_t frameInterval)
+    : _flush(flush)
+    , _frameInterval(frameInterval)
+    , _running(false)
+    , _pending(false)
+    , _requestCount(0)
+    , _flushCount(0)
+{
+}
+
+FrameFlusher::~FrameFlusher(void)
+{
+    stop();
+}
+
+void FrameFlusher::request(void)
+{
+    _requestCount.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending = true;
+    }
+
+    _wakeup.notify_one();
+}
+
+void FrameFlusher::start(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_running) {
+        _running = true;
+        _thread = std::thread(&FrameFlusher::run, this);
+    }
+}
+
+void FrameFlusher::stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+
+    _wakeup.notify_one();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void FrameFlusher::run(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_running) {
+        _wakeup.wait(lock, [this] { return _pending || !_running; });
+
+        if (!_pending) {
+            break;
+        }
+
+        _pending = false;
+
+        std::chrono::steady_clock::time_point nextFrame = std::chrono::steady_clock::now() + std::chrono::milliseconds(_frameInterval);
+
+        lock.unlock();
+        bool retry = _flush();
+        _flushCount.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+
+        // whatever failed goes again next frame
+        _pending = _pending || retry;
+
+        _wakeup.wait_until(lock, nextFrame, [this] { return !_running; });
+    }
+
+    bool pending = _pending;
+    _pending = false;
+    lock.unlock();
+
+    // send whatever arrived during the last frame
+    if (pending) {
+        _flush();
+        _flushCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
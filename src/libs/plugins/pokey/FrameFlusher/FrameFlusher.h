@@ -0,0 +1,51 @@
+#ifndef __FRAME_FLUSHER_H
+#define __FRAME_FLUSHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+typedef std::function<bool(void)> FlushFunction; ///< returns true when something is left to flush next frame
+
+/**
+ * sends staged output off the event thread - the flush thread sleeps
+ * until a change is requested, flushes, then holds off until the next
+ * frame so a burst of changes is sent as one flush
+ */
+class FrameFlusher
+{
+protected:
+    FlushFunction _flush;
+    uint32_t _frameInterval;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    bool _running;
+    bool _pending;
+    std::atomic<uint64_t> _requestCount;
+    std::atomic<uint64_t> _flushCount;
+
+    void run(void);
+
+public:
+    FrameFlusher(FlushFunction flush, uint32_t frameInterval);
+    virtual ~FrameFlusher(void);
+
+    //! asks for a flush, at most one per frame interval
+    void request(void);
+
+    void start(void);
+
+    //! stops the thread after one last flush of anything still staged
+    void stop(void);
+
+    bool running(void) { return _running; };
+    uint64_t requestCount(void) { return _requestCount.load(std::memory_order_relaxed); };
+    uint64_t flushCount(void) { return _flushCount.load(std::memory_order_relaxed); };
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include <assert.h>
+
+#include "PinRemapArbiter.h"
+
+PinRemapArbiter::PinRemapArbiter(uint32_t settleInterval)
+    : _settle(std::chrono::milliseconds(settleInterval))
+    , _running(false)
+    , _reportCount(0)
+    , _suppressedCount(0)
+{
+}
+
+PinRemapArbiter::~PinRemapArbiter(void)
+{
+    stop();
+}
+
+int PinRemapArbiter::addTarget(void)
+{
+    assert(!_running);
+
+    std::unique_ptr<RemapTarget> target(new RemapTarget);
+
+    target->active.store(0, std::memory_order_relaxed);
+    target->lastEdge.store(0, std::memory_order_relaxed);
+    target->dirty.store(false, std::memory_order_relaxed);
+    target->sourceCount = 0;
+    target->reported = false;
+
+    _targets.push_back(std::move(target));
+
+    return _targets.size() - 1;
+}
+
+int PinRemapArbiter::addSource(int target, bool initialValue)
+{
+    assert(!_running);
+
+    RemapTarget *remapTarget = _targets[target].get();
+
+    if (remapTarget->sourceCount == REMAP_MAX_SOURCES) {
+        return -1;
+    }
+
+    int source = remapTarget->sourceCount++;
+
+    if (initialValue) {
+        remapTarget->active.fetch_or(1ULL << source, std::memory_order_relaxed);
+        remapTarget->reported = true;
+    }
+
+    return source;
+}
+
+void PinRemapArbiter::edge(int target, int source, bool value, Clock::time_point when)
+{
+    RemapTarget *remapTarget = _targets[target].get();
+    uint64_t bit = 1ULL << source;
+
+    if (value) {
+        remapTarget->active.fetch_or(bit, std::memory_order_relaxed);
+    }
+    else {
+        remapTarget->active.fetch_and(~bit, std::memory_order_relaxed);
+    }
+
+    remapTarget->lastEdge.store(when.time_since_epoch().count(), std::memory_order_relaxed);
+    remapTarget->dirty.store(true, std::memory_order_release);
+
+    _wakeup.notifyAll();
+}
+
+PinRemapArbiter::Clock::duration PinRemapArbiter::arbitrate(Clock::time_point now)
+{
+    Clock::duration retVal = Clock::duration::max();
+
+    for (size_t target = 0; target < _targets.size(); target++) {
+        RemapTarget *remapTarget = _targets[target].get();
+
+        if (!remapTarget->dirty.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        Clock::time_point settled = Clock::time_point(Clock::duration(remapTarget->lastEdge.load(std::memory_order_relaxed))) + _settle;
+
+        if (settled > now) {
+            retVal = std::min(retVal, settled - now);
+            continue;
+        }
+
+        // an edge landing from here on sets dirty again and is arbitrated next time round
+        remapTarget->dirty.exchange(false, std::memory_order_acq_rel);
+
+        bool value = remapTarget->active.load(std::memory_order_relaxed) != 0;
+
+        if (value == remapTarget->reported) {
+            // the sources went back to where they were, nothing to say
+            _suppressedCount.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        remapTarget->reported = value;
+        _reportCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (_report) {
+            _report(target, value);
+        }
+    }
+
+    return retVal;
+}
+
+void PinRemapArbiter::start(void)
+{
+    if (!_running.exchange(true)) {
+        _thread = std::thread(&PinRemapArbiter::run, this);
+    }
+}
+
+void PinRemapArbiter::stop(void)
+{
+    _running.store(false);
+    _wakeup.notifyAll();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void PinRemapArbiter::run(void)
+{
+    while (true) {
+        // announce the wait before looking, so an edge recorded from
+        // here on either shows up in arbitrate or wakes the commit
+        uint32_t key = _wakeup.prepareWait();
+
+        if (!_running.load()) {
+            _wakeup.cancelWait();
+            break;
+        }
+
+        Clock::duration wait = arbitrate(Clock::now());
+
+        if (wait == Clock::duration::max()) {
+            _wakeup.commitWait(key);
+        }
+        else {
+            _wakeup.commitWait(key, std::chrono::duration_cast<std::chrono::nanoseconds>(wait) + std::chrono::nanoseconds(1));
+        }
+    }
+}
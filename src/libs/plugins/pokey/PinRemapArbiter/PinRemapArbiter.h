@@ -0,0 +1,82 @@
+#ifndef __PIN_REMAP_ARBITER_H
+#define __PIN_REMAP_ARBITER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "queue/mpsc_ring_queue.h" // WakeEvent
+
+#define REMAP_SETTLE_INTERVAL 20 ///< ms a target's sources must be still before it is reported
+#define REMAP_MAX_SOURCES 64 ///< source pins that can map to one target
+
+typedef std::function<void(int target, bool value)> RemapReportFunction;
+
+/**
+ * resolves the value of pins that several input pins (on any board)
+ * are remapped to - a target is active while any of its sources is
+ *
+ * poll threads record source edges with a couple of atomic operations
+ * and never wait on one another. a single arbiter thread reports a
+ * target once its sources have been still for the settle interval, so
+ * a hand over between two sources (one closing as the other opens) is
+ * not reported as a spurious release or press
+ */
+class PinRemapArbiter
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+protected:
+    typedef struct {
+        std::atomic<uint64_t> active; ///< bit per source currently reading 1
+        std::atomic<int64_t> lastEdge; ///< Clock ticks of the latest source edge
+        std::atomic<bool> dirty; ///< an edge is waiting to be arbitrated
+        int sourceCount;
+        bool reported; ///< last value reported, only touched by the arbiter
+    } RemapTarget;
+
+    std::vector<std::unique_ptr<RemapTarget>> _targets; ///< fixed once the arbiter is started
+    Clock::duration _settle;
+    RemapReportFunction _report;
+    WakeEvent _wakeup;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<uint64_t> _reportCount;
+    std::atomic<uint64_t> _suppressedCount;
+
+    void run(void);
+
+public:
+    PinRemapArbiter(uint32_t settleInterval = REMAP_SETTLE_INTERVAL);
+    virtual ~PinRemapArbiter(void);
+
+    //! adds a target with nothing mapped to it yet, returns its index
+    int addTarget(void);
+
+    //! maps a new source onto the target, returns its source index or -1 when the target is full
+    int addSource(int target, bool initialValue);
+
+    void setReportFunction(RemapReportFunction report) { _report = report; };
+
+    //! records a source edge, safe to call from any thread without blocking
+    void edge(int target, int source, bool value, Clock::time_point when = Clock::now());
+
+    //! reports every target whose sources have settled by now, returns how
+    //! long until the next pending target settles (Clock::duration::max() when none)
+    Clock::duration arbitrate(Clock::time_point now);
+
+    void start(void);
+    void stop(void);
+
+    size_t targetCount(void) { return _targets.size(); };
+    bool value(int target) { return _targets[target]->reported; };
+    uint64_t reportCount(void) { return _reportCount.load(std::memory_order_relaxed); };
+    uint64_t suppressedCount(void) { return _suppressedCount.load(std::memory_order_relaxed); };
+};
+
+#endif
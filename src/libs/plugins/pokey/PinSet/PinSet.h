@@ -0,0 +1,54 @@
+#ifndef __PINSET_H
+#define __PINSET_H
+
+#include <stdint.h>
+
+#define PINSET_CAPACITY 64 ///< one bit per pin index, the largest board has 55
+
+/**
+ * packed set of pin indexes - lets a poll find every changed input
+ * with a single XOR and AND over the whole board, then visit only
+ * the changed pins lowest index first
+ */
+class PinSet
+{
+protected:
+    uint64_t _bits;
+
+public:
+    PinSet(uint64_t bits = 0)
+        : _bits(bits){};
+
+    void set(int index, bool value = true)
+    {
+        uint64_t bit = 1ULL << index;
+        _bits = value ? (_bits | bit) : (_bits & ~bit);
+    };
+
+    void clear(int index) { set(index, false); };
+    bool test(int index) const { return (_bits >> index) & 1; };
+    bool empty(void) const { return _bits == 0; };
+    uint64_t bits(void) const { return _bits; };
+
+    int count(void) const { return __builtin_popcountll(_bits); };
+
+    //! removes and returns the lowest index in the set, -1 when empty
+    int takeFirst(void)
+    {
+        if (_bits == 0) {
+            return -1;
+        }
+
+        int index = __builtin_ctzll(_bits);
+        _bits &= _bits - 1;
+        return index;
+    };
+
+    PinSet operator^(const PinSet &other) const { return PinSet(_bits ^ other._bits); };
+    PinSet operator&(const PinSet &other) const { return PinSet(_bits & other._bits); };
+    PinSet operator|(const PinSet &other) const { return PinSet(_bits | other._bits); };
+    PinSet operator~(void) const { return PinSet(~_bits); };
+    bool operator==(const PinSet &other) const { return _bits == other._bits; };
+};
+
+#endif
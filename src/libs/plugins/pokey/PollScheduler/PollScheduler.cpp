@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <assert.h>
+#include <stdio.h>
+
+#include "PollScheduler.h"
+
+PollPolicy::PollPolicy(PollMode mode, uint32_t interval, uint32_t minInterval)
+    : _mode(mode)
+    , _interval(interval > 0 ? interval : 1)
+    , _minInterval(std::min(std::max(minInterval, (uint32_t)1), _interval))
+    , _current(_interval)
+    , _hold(0)
+{
+}
+
+uint32_t PollPolicy::next(bool activity)
+{
+    if (_mode == POLL_FIXED) {
+        return _interval;
+    }
+
+    if (activity) {
+        _current = _minInterval;
+        _hold = POLL_ADAPTIVE_HOLD;
+    }
+    else if (_hold > 0) {
+        _hold--;
+    }
+    else if (_current < _interval) {
+        _current = std::min(_current * 2, _interval);
+    }
+
+    return _current;
+}
+
+bool PollPolicy::ModeFromString(const std::string &name, PollMode *mode)
+{
+    if (name == "fixed") {
+        *mode = POLL_FIXED;
+    }
+    else if (name == "adaptive") {
+        *mode = POLL_ADAPTIVE;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+const char *PollPolicy::ModeName(PollMode mode)
+{
+    return mode == POLL_ADAPTIVE ? "adaptive" : "fixed";
+}
+
+LatencyHistogram::LatencyHistogram(void)
+{
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t micros)
+{
+    int bucket = 0;
+
+    while (bucket < POLL_HISTOGRAM_BUCKETS - 1 && micros >= (1ULL << bucket)) {
+        bucket++;
+    }
+
+    _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    // only the poll thread records so a plain compare is enough
+    if (micros > _max.load(std::memory_order_relaxed)) {
+        _max.store(micros, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::reset(void)
+{
+    for (int i = 0; i < POLL_HISTOGRAM_BUCKETS; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+
+    _count.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double percent)
+{
+    uint64_t total = count();
+    uint64_t seen = 0;
+
+    if (total == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < POLL_HISTOGRAM_BUCKETS; i++) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+
+        if (seen * 100.0 >= total * percent) {
+            return 1ULL << i;
+        }
+    }
+
+    return max();
+}
+
+std::string LatencyHistogram::summary(void)
+{
+    char buffer[128];
+
+    snprintf(buffer, sizeof(buffer), "n=%llu p50<=%.1fms p90<=%.1fms p99<=%.1fms max=%.1fms", (unsigned long long)count(), percentile(50) / 1000.0, percentile(90) / 1000.0,
+        percentile(99) / 1000.0, max() / 1000.0);
+
+    return buffer;
+}
+
+PollScheduler::PollScheduler(void)
+    : _running(false)
+    , _pollCount(0)
+{
+}
+
+PollScheduler::~PollScheduler(void)
+{
+    stop();
+}
+
+void PollScheduler::add(PollFunction poll, PollPolicy policy, uint32_t startDelay)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _clients.push_back({ poll, policy });
+    _deadlines.push({ Clock::now() + std::chrono::milliseconds(startDelay), _clients.size() - 1 });
+    _wakeup.notify_one();
+}
+
+void PollScheduler::start(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_running) {
+        _running = true;
+        _thread = std::thread(&PollScheduler::run, this);
+    }
+}
+
+void PollScheduler::stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+        _wakeup.notify_one();
+    }
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void PollScheduler::run(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_running) {
+        if (_deadlines.empty()) {
+            _wakeup.wait(lock);
+            continue;
+        }
+
+        PollDeadline due = _deadlines.top();
+
+        // woken early by a new client or stop, look again
+        if (Clock::now() < due.deadline) {
+            _wakeup.wait_until(lock, due.deadline);
+            continue;
+        }
+
+        _deadlines.pop();
+
+        // the lock isn't held over the (slow) device round trip, clients
+        // may be added meanwhile so the entry is looked up again after
+        PollFunction poll = _clients[due.client].poll;
+
+        lock.unlock();
+        bool activity = poll();
+        lock.lock();
+
+        _pollCount.fetch_add(1, std::memory_order_relaxed);
+
+        Clock::time_point now = Clock::now();
+        Clock::time_point next = due.deadline + std::chrono::milliseconds(_clients[due.client].policy.next(activity));
+
+        // a device that has fallen behind is polled again straight
+        // away rather than trying to catch up on the polls it missed
+        _deadlines.push({ next > now ? next : now, due.client });
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef __POLL_SCHEDULER_H
+#define __POLL_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define POLL_DEFAULT_INTERVAL 100 ///< ms, the interval boards were always polled at
+#define POLL_ADAPTIVE_MIN_INTERVAL 5 ///< ms, adaptive polling rate while inputs are changing
+#define POLL_ADAPTIVE_HOLD 20 ///< polls kept at the fastest rate after the last change
+#define POLL_HISTOGRAM_BUCKETS 32
+
+enum PollMode { POLL_FIXED = 0, POLL_ADAPTIVE };
+
+/**
+ * decides when a device is polled next - fixed mode always waits the
+ * configured interval, adaptive mode drops to the minimum interval as
+ * soon as an input changes, holds it for a while and then doubles the
+ * interval on every idle poll until it is back at the configured one
+ */
+class PollPolicy
+{
+protected:
+    PollMode _mode;
+    uint32_t _interval;
+    uint32_t _minInterval;
+    uint32_t _current;
+    uint32_t _hold;
+
+public:
+    PollPolicy(PollMode mode = POLL_FIXED, uint32_t interval = POLL_DEFAULT_INTERVAL, uint32_t minInterval = POLL_ADAPTIVE_MIN_INTERVAL);
+
+    //! interval (ms) to wait after a poll, activity is whether that poll saw a change
+    uint32_t next(bool activity);
+
+    PollMode mode(void) { return _mode; };
+    uint32_t interval(void) { return _interval; };
+    uint32_t minInterval(void) { return _minInterval; };
+    uint32_t current(void) { return _current; };
+
+    static bool ModeFromString(const std::string &name, PollMode *mode);
+    static const char *ModeName(PollMode mode);
+};
+
+/**
+ * log2 bucketed histogram of microsecond latencies, recorded by a
+ * single poll thread and safe to read from any other
+ */
+class LatencyHistogram
+{
+protected:
+    std::atomic<uint64_t> _buckets[POLL_HISTOGRAM_BUCKETS]; ///< bucket n counts latencies below 2^n us
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _max;
+
+public:
+    LatencyHistogram(void);
+
+    void record(uint64_t micros);
+    void reset(void);
+
+    uint64_t count(void) { return _count.load(std::memory_order_relaxed); };
+    uint64_t max(void) { return _max.load(std::memory_order_relaxed); };
+
+    //! upper bound (us) of the bucket holding the given percentile, 0 when empty
+    uint64_t percentile(double percent);
+
+    //! one line summary e.g. "n=12 p50<=4.1ms p90<=8.2ms p99<=16.4ms max=12.9ms"
+    std::string summary(void);
+};
+
+typedef std::function<bool(void)> PollFunction; ///< returns true when the poll saw a change
+
+/**
+ * polls any number of devices from a single thread - each device has
+ * its own deadline and policy, the thread sleeps until the earliest
+ * deadline, polls that device and reschedules it
+ */
+class PollScheduler
+{
+protected:
+    typedef std::chrono::steady_clock Clock;
+
+    typedef struct {
+        PollFunction poll;
+        PollPolicy policy;
+    } PollClient;
+
+    typedef struct {
+        Clock::time_point deadline;
+        size_t client;
+    } PollDeadline;
+
+    struct LaterDeadline {
+        bool operator()(const PollDeadline &a, const PollDeadline &b) const { return a.deadline > b.deadline; }
+    };
+
+    std::vector<PollClient> _clients;
+    std::priority_queue<PollDeadline, std::vector<PollDeadline>, LaterDeadline> _deadlines;
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::thread _thread;
+    bool _running;
+    std::atomic<uint64_t> _pollCount;
+
+    void run(void);
+
+public:
+    PollScheduler(void);
+    virtual ~PollScheduler(void);
+
+    //! first poll of the new client happens startDelay ms from now
+    void add(PollFunction poll, PollPolicy policy, uint32_t startDelay = 0);
+
+    void start(void);
+    void stop(void);
+
+    bool running(void) { return _running; };
+    size_t clientCount(void) { return _clients.size(); };
+    uint64_t pollCount(void) { return _pollCount.load(std::memory_order_relaxed); };
+};
+
+#endif
@@ -0,0 +1,93 @@
+#include <string.h>
+
+#include "SegmentDisplay.h"
+
+const uint8_t SegmentDisplay::Digits[10] = { 0b11111100, 0b01100000, 0b11011010, 0b11110010, 0b01100110, 0b10110110, 0b10111110, 0b11100000, 0b11111110, 0b11100110 };
+
+SegmentDisplay::SegmentDisplay(void)
+    : _dirty(0)
+    , _updates(0)
+    , _renders(0)
+{
+    for (int i = 0; i < SEGMENT_DISPLAY_GROUPS; i++) {
+        _groups[i].position = 0;
+        _groups[i].length = 0;
+        _groups[i].value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void SegmentDisplay::addGroup(int group, uint8_t position, uint8_t length)
+{
+    if (group < 0 || group >= SEGMENT_DISPLAY_GROUPS || position >= SEGMENT_DISPLAY_DIGITS) {
+        return;
+    }
+
+    _groups[group].position = position;
+    _groups[group].length = position + length > SEGMENT_DISPLAY_DIGITS ? SEGMENT_DISPLAY_DIGITS - position : length;
+}
+
+bool SegmentDisplay::set(int group, int32_t value)
+{
+    if (group < 0 || group >= SEGMENT_DISPLAY_GROUPS || _groups[group].length == 0) {
+        return false;
+    }
+
+    _groups[group].value.store(value, std::memory_order_relaxed);
+    _updates.fetch_add(1, std::memory_order_relaxed);
+
+    return _dirty.fetch_or(1 << group, std::memory_order_release) == 0;
+}
+
+bool SegmentDisplay::render(uint8_t *data)
+{
+    uint32_t dirty = _dirty.exchange(0, std::memory_order_acq_rel);
+
+    if (dirty == 0) {
+        return false;
+    }
+
+    while (dirty) {
+        int group = __builtin_ctz(dirty);
+        dirty &= dirty - 1;
+
+        RenderGroup(_groups[group].value.load(std::memory_order_relaxed), _groups[group].position, _groups[group].length, data);
+    }
+
+    _renders.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+void SegmentDisplay::RenderGroup(int32_t value, uint8_t position, uint8_t length, uint8_t *data)
+{
+    uint8_t digits[10];
+    int count = 0;
+
+    if (value == SEGMENT_BLANK) {
+        memset(data + position, 0, length);
+        return;
+    }
+
+    // we should only display +ve values
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+
+    do {
+        digits[count++] = magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (count > length) {
+        return;
+    }
+
+    memset(data + position, 0, length);
+
+    if (value == 0) {
+        data[position + length - 1] = Digits[0];
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        data[position + i] = Digits[digits[count - 1 - i]];
+    }
+}
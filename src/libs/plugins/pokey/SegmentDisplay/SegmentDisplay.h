@@ -0,0 +1,52 @@
+#ifndef __SEGMENT_DISPLAY_H
+#define __SEGMENT_DISPLAY_H
+
+#include <atomic>
+#include <stdint.h>
+
+#define SEGMENT_DISPLAY_DIGITS 8 ///< digits driven by one Pokey matrix LED display
+#define SEGMENT_DISPLAY_GROUPS 8
+#define SEGMENT_BLANK -1 ///< value that blanks a group
+
+/**
+ * 7-segment matrix LED display made up of groups of digits - values
+ * are staged from any thread (the latest staged value of a group wins)
+ * and rendered into the display's segment buffer by the refresh
+ * thread, so intermediate values never reach the board
+ */
+class SegmentDisplay
+{
+protected:
+    typedef struct {
+        uint8_t position;
+        uint8_t length; ///< 0 when the group isn't configured
+        std::atomic<int32_t> value;
+    } SegmentGroup;
+
+    SegmentGroup _groups[SEGMENT_DISPLAY_GROUPS];
+    std::atomic<uint32_t> _dirty; ///< bit per group with a staged value
+    std::atomic<uint64_t> _updates;
+    std::atomic<uint64_t> _renders;
+
+public:
+    static const uint8_t Digits[10]; ///< segment pattern of each decimal digit
+
+    SegmentDisplay(void);
+
+    void addGroup(int group, uint8_t position, uint8_t length);
+
+    //! stages a value, returns true when the display had nothing staged before
+    bool set(int group, int32_t value);
+
+    //! renders the staged groups into the 8 segment bytes, false when nothing was staged
+    bool render(uint8_t *data);
+
+    bool dirty(void) { return _dirty.load(std::memory_order_acquire) != 0; };
+    uint64_t updates(void) { return _updates.load(std::memory_order_relaxed); };
+    uint64_t renders(void) { return _renders.load(std::memory_order_relaxed); };
+
+    //! left aligned digits, zero on the rightmost digit, a value too long for the group leaves it as it was
+    static void RenderGroup(int32_t value, uint8_t position, uint8_t length, uint8_t *data);
+};
+
+#endif
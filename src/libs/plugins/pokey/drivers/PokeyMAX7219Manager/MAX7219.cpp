@@ -4,19 +4,21 @@
 #include <unistd.h>
 using namespace std::chrono_literals;
 
-MAX7219::MAX7219(sPoKeysDevice *pokey, int id, uint8_t chipSelect, std::string matrixType, uint8_t enabled, std::string name, std::string description)
+MAX7219::MAX7219(sPoKeysDevice *pokey, std::mutex *ioMutex, int id, uint8_t chipSelect, std::string matrixType, uint8_t enabled, std::string name, std::string description)
 {
     _chipSelect = chipSelect;
     _id = id;
     _matrixType = matrixType;
     _description = description;
     _pokey = pokey;
+    _ioMutex = ioMutex;
     _name = name;
 
-    _stateMatrix = { { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 },
-        { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 } };
+    {
+        std::lock_guard<std::mutex> lock(*_ioMutex);
+        PK_SPIConfigure(_pokey, MAX7219_PRESCALER, MAX7219_FRAMEFORMAT);
+    }
 
-    PK_SPIConfigure(_pokey, MAX7219_PRESCALER, MAX7219_FRAMEFORMAT);
     uint16_t packet = 0;
     packet = _encodeOutputPacket(REG_DECODE_MODE, MODE_DECODE_B_OFF);
     SPIWrite(packet);
@@ -50,6 +52,7 @@ uint16_t MAX7219::_encodeOutputPacket(uint8_t reg, uint8_t value)
 uint32_t MAX7219::SPIWrite(uint16_t packet)
 {
     assert(_pokey);
+    std::lock_guard<std::mutex> lock(*_ioMutex);
     return PK_SPIWrite(_pokey, (uint8_t *)&packet, sizeof(packet), _chipSelect);
 }
 
@@ -62,37 +65,35 @@ uint32_t MAX7219::setIntensity(uint8_t intensity)
 
 void MAX7219::setAllPinStates(bool enabled)
 {
-    for (uint8_t col = 1; col < 9; col++) {
-        for (uint8_t row = 1; row < 9; row++) {
-            setPinState(col, row, enabled);
-        }
-    }
+    _frame.setAll(enabled);
 }
 
+/**
+ *   @brief  only updates the frame buffer, the LED changes on the next flush
+ *
+ *   @return nothing
+ */
 void MAX7219::setPinState(uint8_t col, uint8_t row, bool enabled)
 {
-    assert(col >= 1 && col <= 8 && row >= 1 && row <= 8);
-    _stateMatrix[col - 1][row - 1] = enabled;
-    uint8_t rowMask = 0;
-    uint8_t colRegister = REG_COL_1 + col - 1;
-
-    for (uint8_t idx = 0; idx < 8; idx++) {
-        if (_stateMatrix[col - 1][idx]) {
-            rowMask |= (1 << idx);
-        }
-    }
+    _frame.set(col, row, enabled);
+}
 
-    uint16_t packet = _encodeOutputPacket(colRegister, rowMask);
+/**
+ *   @brief  sends one packet per column register changed since the
+ *           last flush, a failed write is retried by the next flush
+ *           rather than sleeping here
+ *
+ *   @return number of writes that failed
+ */
+int MAX7219::flush(void)
+{
+    int retVal = _frame.flush([this](uint8_t col, uint8_t rowMask) { return SPIWrite(_encodeOutputPacket(REG_COL_1 + col - 1, rowMask)) == PK_OK; });
 
-    if (SPIWrite(packet) != PK_OK) {
-        std::this_thread::sleep_for(50ms);
-        if (SPIWrite(packet) != PK_OK) {
-            std::this_thread::sleep_for(100ms);
-            if (SPIWrite(packet) != PK_OK) {
-                printf("failed to set MAX7219 pin state col %i row %i val %i\n", col, row, enabled);
-            }
-        }
+    if (retVal > 0) {
+        printf("failed to flush %i MAX7219 column(s) on %s, retrying next frame\n", retVal, _name.c_str());
     }
+
+    return retVal;
 }
 
 bool MAX7219::runTest(bool cycleThrough)
@@ -101,20 +102,24 @@ bool MAX7219::runTest(bool cycleThrough)
 
     try {
         setAllPinStates(true);
+        flush();
         std::this_thread::sleep_for(500ms);
         setAllPinStates(false);
+        flush();
         std::this_thread::sleep_for(250ms);
 
         if (cycleThrough) {
             for (uint8_t col = 1; col < 9; col++) {
                 for (uint8_t row = 1; row < 9; row++) {
                     setPinState(col, row, true);
+                    flush();
                     std::this_thread::sleep_for(80ms);
                 }
             }
         }
 
         setAllPinStates(false);
+        flush();
     }
     catch (std::runtime_error &err) {
         std::cout << "ERROR: " << err.what() << std::endl;
@@ -1,9 +1,12 @@
 #ifndef __MAX7219_H
 #define __MAX7219_H
 
+#include "MAX7219FrameBuffer.h"
 #include "PoKeysLib.h"
 #include <assert.h>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <unistd.h>
@@ -78,7 +81,7 @@ class Led;
 class MAX7219
 {
 protected:
-    std::vector<std::vector<bool>> _stateMatrix;
+    MAX7219FrameBuffer _frame; ///< LED state, sent to the chip by flush
     std::vector<std::shared_ptr<Led>> _leds;
     uint8_t _chipSelect;
     int _id;
@@ -87,14 +90,18 @@ protected:
     std::string _description;
     uint8_t _enabled;
     sPoKeysDevice *_pokey;
+    std::mutex *_ioMutex; ///< the device's I/O lock, held for each SPI transaction
     uint16_t _encodeOutputPacket(uint8_t reg, uint8_t value);
 
 public:
-    MAX7219(sPoKeysDevice *pokey, int id, uint8_t chipSelect, std::string matrixType, uint8_t enabled, std::string name, std::string description);
+    MAX7219(sPoKeysDevice *pokey, std::mutex *ioMutex, int id, uint8_t chipSelect, std::string matrixType, uint8_t enabled, std::string name, std::string description);
     virtual ~MAX7219(void);
 
     void setAllPinStates(bool enabled);
     void setPinState(uint8_t col, uint8_t row, bool enabled);
+    int flush(void);
+    bool dirty(void) { return _frame.dirty(); };
+    MAX7219FrameBuffer &frame(void) { return _frame; };
     uint32_t setIntensity(uint8_t intensity);
     uint32_t SPIWrite(uint16_t packet);
     bool runTest(bool cycleThrough = false);
@@ -138,6 +145,7 @@ public:
 
         if (_enabled) {
             setState(true);
+            _owner->flush();
             std::this_thread::sleep_for(80ms);
             setState(false);
         }
@@ -145,6 +153,8 @@ public:
         if (_enabled == ALWAYS_ON){
             setState(true);
         }
+
+        _owner->flush();
     }
 
     void setState(bool val) { _owner->setPinState(_col, _row, val); }
@@ -0,0 +1,78 @@
+#include <assert.h>
+
+#include "MAX7219FrameBuffer.h"
+
+MAX7219FrameBuffer::MAX7219FrameBuffer(void)
+    : _dirty(0)
+    , _updates(0)
+    , _writes(0)
+{
+    for (int i = 0; i < MAX7219_COLUMNS; i++) {
+        _columns[i].store(0, std::memory_order_relaxed);
+        _sent[i] = -1;
+    }
+}
+
+void MAX7219FrameBuffer::set(uint8_t col, uint8_t row, bool enabled)
+{
+    assert(col >= 1 && col <= 8 && row >= 1 && row <= 8);
+
+    uint8_t bit = 1 << (row - 1);
+
+    if (enabled) {
+        _columns[col - 1].fetch_or(bit, std::memory_order_relaxed);
+    }
+    else {
+        _columns[col - 1].fetch_and(~bit, std::memory_order_relaxed);
+    }
+
+    _dirty.fetch_or(1 << (col - 1), std::memory_order_release);
+    _updates.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MAX7219FrameBuffer::setAll(bool enabled)
+{
+    for (uint8_t col = 1; col <= MAX7219_COLUMNS; col++) {
+        for (uint8_t row = 1; row <= 8; row++) {
+            set(col, row, enabled);
+        }
+    }
+}
+
+bool MAX7219FrameBuffer::get(uint8_t col, uint8_t row)
+{
+    assert(col >= 1 && col <= 8 && row >= 1 && row <= 8);
+    return (_columns[col - 1].load(std::memory_order_relaxed) >> (row - 1)) & 1;
+}
+
+int MAX7219FrameBuffer::flush(MAX7219RegisterWriter write)
+{
+    std::lock_guard<std::mutex> lock(_flushMutex);
+
+    int retVal = 0;
+    uint8_t dirty = _dirty.exchange(0, std::memory_order_acq_rel);
+
+    while (dirty) {
+        int col = __builtin_ctz(dirty);
+        uint8_t rowMask = _columns[col].load(std::memory_order_relaxed);
+
+        dirty &= dirty - 1;
+
+        // the LED went back to what the chip already shows
+        if (_sent[col] == rowMask) {
+            continue;
+        }
+
+        _writes.fetch_add(1, std::memory_order_relaxed);
+
+        if (write(col + 1, rowMask)) {
+            _sent[col] = rowMask;
+        }
+        else {
+            _dirty.fetch_or(1 << col, std::memory_order_relaxed);
+            retVal++;
+        }
+    }
+
+    return retVal;
+}
@@ -0,0 +1,55 @@
+#ifndef __MAX7219FRAMEBUFFER_H
+#define __MAX7219FRAMEBUFFER_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+
+#define MAX7219_COLUMNS 8
+
+//! sends one column register, returns false when the write failed
+typedef std::function<bool(uint8_t col, uint8_t rowMask)> MAX7219RegisterWriter;
+
+/**
+ * shadow copy of the LEDs of one MAX7219 - setting an LED only flips
+ * a bit and marks its column register dirty, flush then sends each
+ * dirty column whose value differs from what the chip last accepted
+ *
+ * set may be called from any thread, flush is serialised internally
+ */
+class MAX7219FrameBuffer
+{
+protected:
+    std::atomic<uint8_t> _columns[MAX7219_COLUMNS]; ///< row bits of each column register
+    std::atomic<uint8_t> _dirty; ///< bit per column register changed since the last flush
+    int _sent[MAX7219_COLUMNS]; ///< last value the chip accepted, -1 when unknown
+    std::mutex _flushMutex;
+    std::atomic<uint64_t> _updates;
+    std::atomic<uint64_t> _writes;
+
+public:
+    MAX7219FrameBuffer(void);
+
+    //! col and row are 1 based, as wired in the configuration
+    void set(uint8_t col, uint8_t row, bool enabled);
+    void setAll(bool enabled);
+    bool get(uint8_t col, uint8_t row);
+
+    //! writes every dirty column, returns the number of writes that failed (they are retried next flush)
+    int flush(MAX7219RegisterWriter write);
+
+    bool dirty(void) { return _dirty.load(std::memory_order_acquire) != 0; };
+    uint64_t updates(void) { return _updates.load(std::memory_order_relaxed); };
+    uint64_t writes(void) { return _writes.load(std::memory_order_relaxed); };
+
+    //! SPI writes avoided compared to sending every LED update straight away
+    uint64_t writesSaved(void)
+    {
+        uint64_t updateCount = updates();
+        uint64_t writeCount = writes();
+        return updateCount > writeCount ? updateCount - writeCount : 0;
+    };
+};
+
+#endif
@@ -4,19 +4,22 @@
 
 using namespace std::chrono_literals;
 
-PokeyMAX7219Manager::PokeyMAX7219Manager(sPoKeysDevice *pokey)
+PokeyMAX7219Manager::PokeyMAX7219Manager(sPoKeysDevice *pokey, std::mutex *ioMutex)
+    : _flusher(std::bind(&PokeyMAX7219Manager::flush, this), MAX7219_FRAME_INTERVAL)
 {
     _pokey = pokey;
+    _ioMutex = ioMutex;
 }
 
 PokeyMAX7219Manager::~PokeyMAX7219Manager(void)
 {
+    stopFlushing();
 }
 
 int PokeyMAX7219Manager::addMatrix(int id, uint8_t chipSelect, std::string matrixType, uint8_t enabled, std::string name, std::string description)
 {
     int retVal = 0;
-    std::shared_ptr<MAX7219> max7219 = std::make_shared<MAX7219>(_pokey, id, chipSelect, matrixType, enabled, name, description);
+    std::shared_ptr<MAX7219> max7219 = std::make_shared<MAX7219>(_pokey, _ioMutex, id, chipSelect, matrixType, enabled, name, description);
     _max7219.push_back(max7219);
     return retVal;
 }
@@ -56,4 +59,30 @@ void PokeyMAX7219Manager::setLedByName(std::string name, bool value)
             led->setState(value);
         }
     }
+
+    _flusher.request();
+}
+
+bool PokeyMAX7219Manager::flush(void)
+{
+    bool retVal = false;
+
+    for (auto &max7219 : _max7219) {
+        if (max7219->dirty()) {
+            retVal = (max7219->flush() > 0) || retVal;
+        }
+    }
+
+    return retVal;
+}
+
+uint64_t PokeyMAX7219Manager::writesSaved(void)
+{
+    uint64_t retVal = 0;
+
+    for (auto &max7219 : _max7219) {
+        retVal += max7219->frame().writesSaved();
+    }
+
+    return retVal;
 }
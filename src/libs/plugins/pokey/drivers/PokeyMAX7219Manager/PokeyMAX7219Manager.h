@@ -2,14 +2,15 @@
 #define __MAX7219MATRIX_H
 
 #include <assert.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
-#include <thread>
 
+#include "plugins/pokey/FrameFlusher/FrameFlusher.h"
 #include "MAX7219.h"
 #include "PoKeysLib.h"
 
-
+#define MAX7219_FRAME_INTERVAL 20 ///< ms, LED matrices are flushed at most once per frame
 
 typedef std::vector<std::shared_ptr<MAX7219>> DeviceVector;
 
@@ -17,22 +18,28 @@ class PokeyMAX7219Manager
 {
 protected:
     sPoKeysDevice *_pokey;
+    std::mutex *_ioMutex; ///< the device's I/O lock
     std::vector<std::shared_ptr<MAX7219>> _max7219;
+    FrameFlusher _flusher; ///< sends the LED changes of each frame off the event thread
 
 public:
-    PokeyMAX7219Manager(sPoKeysDevice *pokey);
+    PokeyMAX7219Manager(sPoKeysDevice *pokey, std::mutex *ioMutex);
     int addMatrix(int id, uint8_t chipSelect, std::string matrixType, uint8_t enabled, std::string name, std::string description);
     int addLedToMatrix(int ledMatrixIndex, uint8_t ledIndex, std::string name, std::string description, uint8_t enabled, uint8_t row, uint8_t col);
     std::shared_ptr<MAX7219> getMax7219(int id);
 
     void setLedByName(std::string name, bool value);
 
+    void startFlushing(void) { _flusher.start(); };
+    void stopFlushing(void) { _flusher.stop(); };
 
-    virtual ~PokeyMAX7219Manager(void);
-
-    
+    //! returns true when a write failed and is left for the next frame
+    bool flush(void);
 
+    //! SPI writes avoided by every matrix compared to one write per LED change
+    uint64_t writesSaved(void);
 
+    virtual ~PokeyMAX7219Manager(void);
 };
 
 #endif
@@ -1,17 +1,20 @@
 #include <thread>
 
 #include "PokeySwitch.h"
-#include "plugins/common/utils.h"
 
-PokeySwitch::PokeySwitch(sPoKeysDevice *pokey, int id, std::string name, int pin, int enablePin, bool invert, bool invertEnablePin)
+PokeySwitch::PokeySwitch(sPoKeysDevice *pokey, std::mutex *ioMutex, int id, std::string name, ElementID elementId, int pin, int enablePin, bool invert, bool invertEnablePin)
 {
     _previousValue = -1;
     _pokey = pokey;
+    _ioMutex = ioMutex;
     _pin = pin;
     _enablePin = enablePin;
     _name = name;
+    _elementId = elementId;
     _invertEnablePin = invertEnablePin;
 
+    std::lock_guard<std::mutex> lock(*_ioMutex);
+
     if (enablePin > 1) {
         pokey->Pins[enablePin - 1].PinFunction = PK_PinCap_digitalOutput | (invertEnablePin ? PK_PinCap_invertPin : 0x00);
     }
@@ -36,35 +39,6 @@ uint8_t PokeySwitch::currentValue()
     return _currentValue;
 }
 
-void PokeySwitch::addVirtualPin(std::string name, size_t position)
-{
-    _physPinMask[name] = std::make_shared<std::pair<size_t, int>>(position, 0);
-}
-
-std::string PokeySwitch::transformedValue(void)
-{
-    if (!mapContains(_valueTransforms, (int)_currentValue)) {
-        std::cout << "/// NO TRANSFORM FOR: " << (int)_currentValue << std::endl;
-        return "";
-    }
-    else {
-        std::cout << "/// TRANSFORM FOR: " << (int)_currentValue << std::endl;
-        return _valueTransforms[_currentValue];
-    }
-}
-
-GenericTLV *PokeySwitch::valueAsGeneric(void)
-{
-    GenericTLV *el = NULL;
-    std::string value = transformedValue();
-
-    if (value.size() > 0) {
-        el = make_string_generic(name().c_str(), "pokey switch input", value.c_str());
-    }
-
-    return el;
-}
-
 using namespace std::chrono_literals;
 
 std::pair<std::string, uint8_t> PokeySwitch::read(void)
@@ -75,6 +49,10 @@ std::pair<std::string, uint8_t> PokeySwitch::read(void)
 
     std::this_thread::sleep_for(10ms);
 
+    // the enable pins are set and the switch read in one transaction,
+    // holding the device lock so the output writer can't interleave
+    std::lock_guard<std::mutex> lock(*_ioMutex);
+
     for (int i = 0; i < 8; i++) {
         // ALL HIGH EXCEPT DESIRED READ LOW
         _pokey->Pins[i].DigitalValueSet = (i == (_enablePin - 1)) ? 1 : 0;
@@ -95,39 +73,3 @@ std::pair<std::string, uint8_t> PokeySwitch::read(void)
 
     return std::make_pair(_name, _currentValue);
 }
-
-void PokeySwitch::updateVirtualValue(void)
-{
-    _previousValue = _currentValue;
-
-    _currentValue = 0;
-
-    for (PinMaskMap::iterator iter = _physPinMask.begin(); iter != _physPinMask.end(); iter++) {
-        int value = (*iter).second->second;
-        size_t pos = (*iter).second->first;
-        std::string name = (*iter).first;
-        _currentValue |= (value << pos);
-    }
-
-    if (_currentValue != _previousValue) {
-        std::cout << "/// currentValue: " << transformedValue() << std::endl;
-    }
-}
-
-bool PokeySwitch::isVirtualPinMember(std::shared_ptr<PokeySwitch> pokeyPin)
-{
-    return mapContains(_physPinMask, pokeyPin->name());
-}
-
-bool PokeySwitch::updateVirtualPinMask(std::shared_ptr<PokeySwitch> pokeyPin)
-{
-    bool retVal = false;
-
-    if (mapContains(_physPinMask, pokeyPin->name())) {
-        retVal = true;
-        std::shared_ptr<std::pair<size_t, int>> valueInfo = _physPinMask[pokeyPin->name()];
-        valueInfo->second = pokeyPin->currentValue();
-    }
-
-    return retVal;
-}
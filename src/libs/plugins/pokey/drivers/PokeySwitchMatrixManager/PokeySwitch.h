@@ -4,36 +4,35 @@
 
 #include <map>
 #include <iostream>
+#include <mutex>
 #include <stdlib.h>
 #include <vector>
 #include <PoKeysLib.h>
 
 #include "common/simhubdeviceplugin.h"
 
-typedef std::map<std::string, std::shared_ptr<std::pair<size_t, int>>> PinMaskMap;
-
 class PokeySwitch
 {
 protected:
     std::string _name;
+    ElementID _elementId;
     int _id;
     int _enablePin;
 	bool _invertEnablePin;
     bool _enabled;
     int _pin;
     sPoKeysDevice *_pokey;
+    std::mutex *_ioMutex; ///< the device's I/O lock
     uint8_t _previousValue;
     uint8_t _currentValue;
-    PinMaskMap _physPinMask;
     bool _isPartialPin;
-    std::map<int, std::string> _valueTransforms;
-
-    std::string transformedValue(void);
 
 public:
     PokeySwitch(sPoKeysDevice *pokey, 
+                std::mutex *ioMutex, 
                 int id, 
                 std::string name, 
+                ElementID elementId, 
                 int pin, 
                 int enablePin, 
                 bool invert, 
@@ -43,16 +42,10 @@ public:
     uint8_t previousValue(void);
     uint8_t currentValue(void);
     std::string name(void) { return _name; };
+    ElementID elementId(void) { return _elementId; };
     std::pair<std::string, uint8_t> read(void);
     int pin(void) { return _pin; };
 
-    void setVirtualPinMask(PinMaskMap &mask) { _physPinMask = mask; };
-    void addVirtualPin(std::string name, size_t position);
-    bool updateVirtualPinMask(std::shared_ptr<PokeySwitch> pokeyPin);
-    bool isVirtualPinMember(std::shared_ptr<PokeySwitch> pokeyPin);
-    void updateVirtualValue(void);
-    GenericTLV *valueAsGeneric(void);
-    void setValueTransforms(std::map<int, std::string> &valueTransforms) { _valueTransforms = valueTransforms; };
     void setIsPartialPin(bool isPartialPin) { _isPartialPin = isPartialPin; };
 };
 
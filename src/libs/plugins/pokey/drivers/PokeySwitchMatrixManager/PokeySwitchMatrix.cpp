@@ -1,12 +1,13 @@
 #include "PokeySwitchMatrix.h"
 
-PokeySwitchMatrix::PokeySwitchMatrix(sPoKeysDevice *pokey, int id, std::string name, std::string type, bool enabled)
+PokeySwitchMatrix::PokeySwitchMatrix(sPoKeysDevice *pokey, std::mutex *ioMutex, int id, std::string name, std::string type, bool enabled)
 {
     _name = name;
     _type = type;
     _id = id;
     _enabled = enabled;
     _pokey = pokey;
+    _ioMutex = ioMutex;
 }
 
 std::string PokeySwitchMatrix::name()
@@ -18,98 +19,81 @@ int PokeySwitchMatrix::id()
     return _id;
 }
 
-int PokeySwitchMatrix::addSwitch(int id, std::string name, int pin, int enablePin, bool invert, bool invertEnablePin)
+int PokeySwitchMatrix::addSwitch(int id, std::string name, ElementID elementId, int pin, int enablePin, bool invert, bool invertEnablePin)
 {
-    _switches.push_back(std::make_shared<PokeySwitch>(_pokey, id, name, pin, enablePin, invert, invertEnablePin));
+    _switches.push_back(std::make_shared<PokeySwitch>(_pokey, _ioMutex, id, name, elementId, pin, enablePin, invert, invertEnablePin));
+    _scanPlan.invalidate();
     return 0;
 }
 
-void PokeySwitchMatrix::addVirtualPin(std::string virtualPinName, bool invert, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms)
+void PokeySwitchMatrix::addVirtualPin(std::string virtualPinName, ElementID elementId, bool invert, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms)
 {
-    std::shared_ptr<PokeySwitch> pin = std::make_shared<PokeySwitch>(_pokey, 0, virtualPinName, 0, 0, invert, false);
-    pin->setVirtualPinMask(virtualPinMask);
-    pin->setValueTransforms(valueTransforms);
-    _virtualPins[virtualPinName] = pin;
+    _scanPlan.addVirtualPin(virtualPinName, elementId, virtualPinMask, valueTransforms);
 }
 
-bool PokeySwitchMatrix::consumePhysicalPinValue(SwitchMap &virtualPins, std::shared_ptr<PokeySwitch> pokeyPin)
+void PokeySwitchMatrix::compileScanPlan(void)
 {
-    bool retVal = false;
+    std::vector<std::string> switchNames;
+    std::vector<ElementID> switchIds;
 
-    // give all virtual pins a chance to use the value of this physical pin
-    for (SwitchMap::iterator iter = virtualPins.begin(); iter != virtualPins.end(); iter++) {
-        if ((*iter).second->updateVirtualPinMask(pokeyPin)) {
-            retVal = true;
-        }
+    for (auto &sw : _switches) {
+        switchNames.push_back(sw->name());
+        switchIds.push_back(sw->elementId());
     }
 
-    return retVal;
-}
-
-bool PokeySwitchMatrix::isPartialPin(SwitchMap &virtualPins, std::shared_ptr<PokeySwitch> pokeyPin)
-{
-    bool retVal = false;
+    _scanPlan.compile(switchNames, switchIds);
 
-    // give all virtual pins a chance to use the value of this physical pin
-    for (SwitchMap::iterator iter = virtualPins.begin(); iter != virtualPins.end(); iter++) {
-        if ((*iter).second->isVirtualPinMember(pokeyPin)) {
-            retVal = true;
-        }
+    for (size_t i : _scanPlan.partialSwitches()) {
+        _switches[i]->setIsPartialPin(true);
     }
-
-    return retVal;
 }
 
-std::vector<GenericTLV *> PokeySwitchMatrix::readSwitches()
+const std::vector<GenericTLV *> &PokeySwitchMatrix::readSwitches(GenericTLVPool *pool)
 {
-    std::vector<GenericTLV *> retVal;
-    auto end = retVal.end();
+    _scanResult.clear();
+
+    if (!_scanPlan.compiled()) {
+        compileScanPlan();
+    }
 
     // scan aggregate pins first
 
-    for (auto &sw : _switches) {
-        if (isPartialPin(_virtualPins, sw)) {
-            std::pair<std::string, uint8_t> swData = sw->read();
-            if (sw->previousValue() != sw->currentValue()) {
-                if (consumePhysicalPinValue(_virtualPins, sw)) {
-                    std::cout << "/// CONSUMED: " << sw->name() << std::endl;
-                }
-                else {
-                    std::cout << "/// AGGREGATE PIN MEMBER ISSUE: " << sw->name() << std::endl;
-                }
-            }
+    for (size_t i : _scanPlan.partialSwitches()) {
+        PokeySwitch *sw = _switches[i].get();
+        sw->read();
+
+        if (sw->previousValue() != sw->currentValue()) {
+            _scanPlan.setSwitchValue(i, sw->currentValue());
         }
     }
 
     // now scan stand-alone pins
 
-    for (auto &sw : _switches) {
-        if (isPartialPin(_virtualPins, sw)) {
-            sw->setIsPartialPin(true);
-            continue;
-        }
-
-        std::pair<std::string, uint8_t> swData = sw->read();
+    for (size_t i : _scanPlan.standaloneSwitches()) {
+        PokeySwitch *sw = _switches[i].get();
+        sw->read();
 
         if (sw->previousValue() != sw->currentValue()) {
-            GenericTLV *el = make_generic(sw->name().c_str(), "-");
+            GenericTLV *el = pool_make_generic(pool, _scanPlan.switchElementId(i), sw->name().c_str(), "-");
             el->type = CONFIG_BOOL;
-            el->value.bool_value = (int)swData.second;
-            end = retVal.insert(end, el);
+            el->value.bool_value = (int)sw->currentValue();
+            _scanResult.push_back(el);
         }
     }
 
     // now send aggregate values
 
-    for (auto vpin : _virtualPins) {
-        vpin.second->updateVirtualValue();
-        if (vpin.second->currentValue() != vpin.second->previousValue()) {
-            GenericTLV *generic = vpin.second->valueAsGeneric();
-            if (generic) {
-                end = retVal.insert(end, generic);
-            }
+    for (size_t i = 0; i < _scanPlan.virtualPinCount(); i++) {
+        if (!_scanPlan.virtualPinChanged(i)) {
+            continue;
+        }
+
+        const std::string &value = _scanPlan.transformedValue(i);
+
+        if (value.size() > 0) {
+            _scanResult.push_back(pool_make_string_generic(pool, _scanPlan.virtualPinElementId(i), _scanPlan.virtualPinName(i).c_str(), "pokey switch input", value.c_str()));
         }
     }
 
-    return retVal;
+    return _scanResult;
 }
@@ -4,12 +4,13 @@
 #include <PoKeysLib.h>
 #include <memory>
 #include <iostream>
+#include <mutex>
 #include <stdlib.h>
 #include <vector>
 
 #include "PokeySwitch.h"
+#include "SwitchScanPlan.h"
 
-typedef std::map<std::string, std::shared_ptr<PokeySwitch>> SwitchMap;
 typedef std::vector<std::shared_ptr<PokeySwitch>> SwitchVector;
 
 class PokeySwitchMatrix
@@ -20,19 +21,20 @@ protected:
     int _id;
     bool _enabled;
     sPoKeysDevice *_pokey;
+    std::mutex *_ioMutex; ///< the device's I/O lock
     SwitchVector _switches;
-    SwitchMap _virtualPins;
+    SwitchScanPlan _scanPlan;
+    std::vector<GenericTLV *> _scanResult; ///< reused by every scan
 
-    bool consumePhysicalPinValue(SwitchMap &virtualPins, std::shared_ptr<PokeySwitch> pokeyPin);
-    bool isPartialPin(SwitchMap &virtualPins, std::shared_ptr<PokeySwitch> pokeyPin);
+    void compileScanPlan(void);
 
 public:
-    PokeySwitchMatrix(sPoKeysDevice *pokey, int id, std::string name, std::string type, bool enabled);
+    PokeySwitchMatrix(sPoKeysDevice *pokey, std::mutex *ioMutex, int id, std::string name, std::string type, bool enabled);
     std::string name(void);
     int id(void);
-    int addSwitch(int id, std::string name, int pin, int enablePin, bool invert, bool invertEnablePin);
-    std::vector<GenericTLV *> readSwitches(void);
-    void addVirtualPin(std::string virtualPinName, bool invert, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms);
+    int addSwitch(int id, std::string name, ElementID elementId, int pin, int enablePin, bool invert, bool invertEnablePin);
+    const std::vector<GenericTLV *> &readSwitches(GenericTLVPool *pool);
+    void addVirtualPin(std::string virtualPinName, ElementID elementId, bool invert, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms);
 };
 
 #endif
@@ -1,16 +1,17 @@
 
 #include "PokeySwitchMatrixManager.h"
 
-PokeySwitchMatrixManager::PokeySwitchMatrixManager(sPoKeysDevice *pokey)
+PokeySwitchMatrixManager::PokeySwitchMatrixManager(sPoKeysDevice *pokey, std::mutex *ioMutex)
 {
     _pokey = pokey;
+    _ioMutex = ioMutex;
 }
 
 PokeySwitchMatrixManager::~PokeySwitchMatrixManager(void) {}
 
 int PokeySwitchMatrixManager::addMatrix(int id, std::string name, std::string type, bool enabled)
 {
-    _switchMatrix.push_back(std::make_shared<PokeySwitchMatrix>(_pokey, id, name, type, enabled));
+    _switchMatrix.push_back(std::make_shared<PokeySwitchMatrix>(_pokey, _ioMutex, id, name, type, enabled));
     return 0;
 }
 
@@ -38,18 +39,14 @@ std::shared_ptr<PokeySwitchMatrix> PokeySwitchMatrixManager::matrix(int id)
     return NULL;
 }
 
-std::vector<GenericTLV *> PokeySwitchMatrixManager::readAll()
+const std::vector<GenericTLV *> &PokeySwitchMatrixManager::readAll(GenericTLVPool *pool)
 {
+    _readResult.clear();
 
-    std::vector<GenericTLV *> retVal;
-
-    for (auto &matrix : _switchMatrix) {    
-        std::vector<GenericTLV *> switches = matrix->readSwitches();
-
-        if (switches.size() > 0) {
-            retVal.insert(retVal.end(), switches.begin(), switches.end());
-        }
+    for (auto &matrix : _switchMatrix) {
+        const std::vector<GenericTLV *> &switches = matrix->readSwitches(pool);
+        _readResult.insert(_readResult.end(), switches.begin(), switches.end());
     }
 
-    return retVal;
+    return _readResult;
 }
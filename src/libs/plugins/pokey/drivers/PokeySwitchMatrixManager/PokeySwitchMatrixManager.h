@@ -3,6 +3,7 @@
 
 #include "PoKeysLib.h"
 #include <iostream>
+#include <mutex>
 #include <stdlib.h>
 #include <vector>
 #include "PokeySwitchMatrix.h"
@@ -13,15 +14,17 @@ class PokeySwitchMatrixManager
 protected:
     std::vector<std::shared_ptr<PokeySwitchMatrix>> _switchMatrix;
     sPoKeysDevice *_pokey;
+    std::mutex *_ioMutex; ///< the device's I/O lock
+    std::vector<GenericTLV *> _readResult; ///< reused by every read
 
 public:
-    PokeySwitchMatrixManager(sPoKeysDevice *pokey);
+    PokeySwitchMatrixManager(sPoKeysDevice *pokey, std::mutex *ioMutex);
     virtual ~PokeySwitchMatrixManager(void);
 
     int addMatrix(int id, std::string name, std::string type, bool enabled);
     std::shared_ptr<PokeySwitchMatrix> matrix(std::string name);
     std::shared_ptr<PokeySwitchMatrix> matrix(int id);
-    std::vector<GenericTLV *> readAll();
+    const std::vector<GenericTLV *> &readAll(GenericTLVPool *pool);
 };
 
 #endif
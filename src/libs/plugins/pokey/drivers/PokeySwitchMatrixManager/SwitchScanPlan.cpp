@@ -0,0 +1,111 @@
+#include "SwitchScanPlan.h"
+
+SwitchScanPlan::SwitchScanPlan(void)
+    : _compiled(false)
+{
+}
+
+void SwitchScanPlan::addVirtualPin(std::string name, ElementID elementId, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms)
+{
+    VirtualPin *virtualPin = NULL;
+
+    // a virtual pin configured twice takes the later configuration
+    for (auto &existing : _virtualPins) {
+        if (existing.name == name) {
+            virtualPin = &existing;
+        }
+    }
+
+    if (!virtualPin) {
+        _virtualPins.push_back(VirtualPin());
+        virtualPin = &_virtualPins.back();
+        virtualPin->name = name;
+    }
+
+    virtualPin->elementId = elementId;
+    virtualPin->bitPositions.clear();
+    virtualPin->transforms.clear();
+    virtualPin->value = 0;
+    virtualPin->previousValue = 0;
+
+    for (auto &member : virtualPinMask) {
+        virtualPin->bitPositions[member.first] = member.second->first;
+    }
+
+    for (auto &transform : valueTransforms) {
+        if (transform.first < 0 || transform.first > SWITCH_SCAN_MAX_TRANSFORM) {
+            continue;
+        }
+
+        if ((size_t)transform.first >= virtualPin->transforms.size()) {
+            virtualPin->transforms.resize(transform.first + 1);
+        }
+
+        virtualPin->transforms[transform.first] = transform.second;
+    }
+
+    _compiled = false;
+}
+
+void SwitchScanPlan::compile(const std::vector<std::string> &switchNames, const std::vector<ElementID> &switchIds)
+{
+    _switchIds = switchIds;
+    _partialSwitches.clear();
+    _standaloneSwitches.clear();
+    _memberOffsets.clear();
+    _members.clear();
+
+    for (size_t i = 0; i < switchNames.size(); i++) {
+        _memberOffsets.push_back(_members.size());
+
+        for (size_t pin = 0; pin < _virtualPins.size(); pin++) {
+            std::map<std::string, size_t>::iterator position = _virtualPins[pin].bitPositions.find(switchNames[i]);
+
+            if (position != _virtualPins[pin].bitPositions.end() && position->second < 32) {
+                _members.push_back({ (uint32_t)pin, 1u << position->second });
+            }
+        }
+
+        if (_members.size() > _memberOffsets.back()) {
+            _partialSwitches.push_back(i);
+        }
+        else {
+            _standaloneSwitches.push_back(i);
+        }
+    }
+
+    _memberOffsets.push_back(_members.size());
+    _compiled = true;
+}
+
+void SwitchScanPlan::setSwitchValue(size_t switchIndex, bool value)
+{
+    for (size_t i = _memberOffsets[switchIndex]; i < _memberOffsets[switchIndex + 1]; i++) {
+        uint32_t &pinValue = _virtualPins[_members[i].virtualPin].value;
+        pinValue = value ? pinValue | _members[i].mask : pinValue & ~_members[i].mask;
+    }
+}
+
+bool SwitchScanPlan::virtualPinChanged(size_t virtualPin)
+{
+    VirtualPin &pin = _virtualPins[virtualPin];
+
+    if (pin.value == pin.previousValue) {
+        return false;
+    }
+
+    pin.previousValue = pin.value;
+    return true;
+}
+
+const std::string &SwitchScanPlan::transformedValue(size_t virtualPin)
+{
+    static const std::string noTransform;
+    VirtualPin &pin = _virtualPins[virtualPin];
+
+    if (pin.value >= pin.transforms.size()) {
+        return noTransform;
+    }
+
+    return pin.transforms[pin.value];
+}
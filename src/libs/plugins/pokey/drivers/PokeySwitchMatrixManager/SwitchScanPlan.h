@@ -0,0 +1,76 @@
+#ifndef __SWITCHSCANPLAN_H
+#define __SWITCHSCANPLAN_H
+
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "plugins/common/simhubdeviceplugin.h"
+
+#define SWITCH_SCAN_MAX_TRANSFORM 0xFFFF ///< largest virtual pin value with a transform
+
+typedef std::map<std::string, std::shared_ptr<std::pair<size_t, int>>> PinMaskMap;
+
+/**
+ * switch matrix scan compiled from the configuration - which physical
+ * switches make up virtual pins and at which bit, so a scan only walks
+ * index lists and flips bits in each virtual pin's packed value, and
+ * reports the element ids resolved at configure time instead of
+ * looking switches up by name
+ */
+class SwitchScanPlan
+{
+protected:
+    typedef struct {
+        std::string name;
+        ElementID elementId;
+        std::map<std::string, size_t> bitPositions; ///< member switch name to bit, as configured
+        std::vector<std::string> transforms; ///< indexed by value, empty when there's no transform
+        uint32_t value;
+        uint32_t previousValue;
+    } VirtualPin;
+
+    typedef struct {
+        uint32_t virtualPin;
+        uint32_t mask;
+    } VirtualPinMember;
+
+    std::vector<VirtualPin> _virtualPins;
+    std::vector<ElementID> _switchIds; ///< per switch, in scan order
+    std::vector<size_t> _partialSwitches; ///< switch indices read into virtual pins
+    std::vector<size_t> _standaloneSwitches; ///< switch indices reported on their own
+    std::vector<size_t> _memberOffsets; ///< per switch, first entry in _members, one extra entry at the end
+    std::vector<VirtualPinMember> _members;
+    bool _compiled;
+
+public:
+    SwitchScanPlan(void);
+
+    void addVirtualPin(std::string name, ElementID elementId, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms);
+
+    //! builds the index lists for the switches in scan order, until then the plan is stale
+    void compile(const std::vector<std::string> &switchNames, const std::vector<ElementID> &switchIds);
+    void invalidate(void) { _compiled = false; };
+    bool compiled(void) { return _compiled; };
+
+    const std::vector<size_t> &partialSwitches(void) { return _partialSwitches; };
+    const std::vector<size_t> &standaloneSwitches(void) { return _standaloneSwitches; };
+    size_t virtualPinCount(void) { return _virtualPins.size(); };
+    ElementID switchElementId(size_t switchIndex) { return _switchIds[switchIndex]; };
+    const std::string &virtualPinName(size_t virtualPin) { return _virtualPins[virtualPin].name; };
+    ElementID virtualPinElementId(size_t virtualPin) { return _virtualPins[virtualPin].elementId; };
+    uint32_t virtualPinValue(size_t virtualPin) { return _virtualPins[virtualPin].value; };
+
+    //! sets the bit of a partial switch in every virtual pin it belongs to
+    void setSwitchValue(size_t switchIndex, bool value);
+
+    //! true once per change of the virtual pin's value since the last call
+    bool virtualPinChanged(size_t virtualPin);
+
+    //! configured name for the current value, empty when there isn't one
+    const std::string &transformedValue(size_t virtualPin);
+};
+
+#endif
@@ -14,6 +14,11 @@
 
 extern "C" {
 
+int simplug_abi_version(void)
+{
+    return SIMPLUG_ABI_VERSION;
+}
+
 int simplug_init(SPHANDLE *plugin_instance, LoggingFunctionCB logger)
 {
     *plugin_instance = new PokeyDevicePluginStateManager(logger);
@@ -25,6 +30,11 @@ int simplug_config_passthrough(SPHANDLE plugin_instance, void *libconfig_instanc
     return static_cast<PluginStateManager *>(plugin_instance)->configPassthrough(static_cast<libconfig::Config *>(libconfig_instance));
 }
 
+void simplug_bind_symbol_resolver(SPHANDLE plugin_instance, SymbolResolverCB resolver, void *arg)
+{
+    static_cast<PluginStateManager *>(plugin_instance)->bindSymbolResolver(resolver, arg);
+}
+
 int simplug_preflight_complete(SPHANDLE plugin_instance)
 {
     return static_cast<PluginStateManager *>(plugin_instance)->preflightComplete();
@@ -40,6 +50,11 @@ int simplug_deliver_value(SPHANDLE plugin_instance, GenericTLV *value)
     return static_cast<PluginStateManager *>(plugin_instance)->deliverValue(value);
 }
 
+int simplug_deliver_values(SPHANDLE plugin_instance, GenericTLV **values, int count)
+{
+    return static_cast<PluginStateManager *>(plugin_instance)->deliverValues(values, count);
+}
+
 void simplug_cease_eventing(SPHANDLE plugin_instance)
 {
     static_cast<PluginStateManager *>(plugin_instance)->ceaseEventing();
@@ -80,8 +95,22 @@ void PokeyDevicePluginStateManager::ceaseEventing(void)
 {
     PluginStateManager::ceaseEventing();
 
+    _pollScheduler.stop();
+    _remapArbiter.stop();
+
     for (auto devPair : _deviceMap) {
         devPair.second->stopPolling();
+
+        if (devPair.second->inputLatency().count() > 0) {
+            _logger(LOG_INFO, "%s | input latency (%s polling) %s", devPair.second->name().c_str(), PollPolicy::ModeName(devPair.second->pollPolicy().mode()),
+                devPair.second->inputLatency().summary().c_str());
+        }
+
+        _logger(LOG_INFO, "%s | digital output writes saved %llu", devPair.second->name().c_str(), (unsigned long long)devPair.second->outputWritesSaved());
+
+        if (devPair.second->max7219Manager()) {
+            _logger(LOG_INFO, "%s | LED matrix SPI writes saved %llu", devPair.second->name().c_str(), (unsigned long long)devPair.second->max7219Manager()->writesSaved());
+        }
     }
 }
 
@@ -97,14 +126,15 @@ int PokeyDevicePluginStateManager::deliverValue(GenericTLV *data)
     int retVal = 0;
     // printf("-----> %s %i %i\n",data->name, data->type, (int)data->value);
 
-    std::shared_ptr<PokeyDevice> device = targetFromDeviceTargetList(data->name);
+    ElementID targetId = data->element_id != INVALID_ELEMENT_ID ? data->element_id : elementId(data->name);
+    std::shared_ptr<PokeyDevice> device = targetFromDeviceTargetList(targetId);
 
     if (device) {
         if (data->type == ConfigType::CONFIG_BOOL) {
-            retVal = device->targetValue(data->name, (bool)data->value);
+            retVal = device->targetValue(targetId, data->name, (bool)data->value);
         }
         else if (data->type == ConfigType::CONFIG_INT) {
-            retVal = device->targetValue(data->name, (int)data->value);
+            retVal = device->targetValue(targetId, data->name, (int)data->value);
         }
     }
     else {
@@ -149,18 +179,28 @@ void PokeyDevicePluginStateManager::enumerateDevices(void)
 bool PokeyDevicePluginStateManager::addTargetToDeviceTargetList(std::string target, std::shared_ptr<PokeyDevice> device)
 {
     // printf("----> adding %s to %s\n", target.c_str(), device->name().c_str());
-    _deviceMap.emplace(target, device);
+    ElementID targetId = elementId(target);
+
+    if (targetId == INVALID_ELEMENT_ID) {
+        _logger(LOG_ERROR, "%s | Unable to allocate an element id for %s", device->name().c_str(), target.c_str());
+        return false;
+    }
+
+    if (targetId >= _targetDevices.size()) {
+        _targetDevices.resize(targetId + 1);
+    }
+
+    if (!_targetDevices[targetId]) {
+        _targetDevices[targetId] = device;
+    }
+
     return true;
 }
 
-std::shared_ptr<PokeyDevice> PokeyDevicePluginStateManager::targetFromDeviceTargetList(std::string key)
+std::shared_ptr<PokeyDevice> PokeyDevicePluginStateManager::targetFromDeviceTargetList(ElementID targetId)
 {
-    // std::cout << "trying to find " << key << std::endl;
-
-    std::map<std::string, std::shared_ptr<PokeyDevice>>::iterator it = _deviceMap.find(key);
-
-    if (it != _deviceMap.end()) {
-        return (*it).second;
+    if (targetId < _targetDevices.size()) {
+        return _targetDevices[targetId];
     }
 
     return NULL;
@@ -263,6 +303,39 @@ bool PokeyDevicePluginStateManager::deviceConfiguration(libconfig::SettingIterat
     return retVal;
 }
 
+/**
+ *   @brief  reads how often the device inputs are polled
+ *
+ *           pollMode        - string  - fixed (default) or adaptive
+ *           pollInterval    - integer - ms between polls, the slowest adaptive rate
+ *           pollMinInterval - integer - ms between adaptive polls while inputs are changing
+ *           sharedPolling   - bool    - poll on the thread shared by all boards
+ *
+ *   @return nothing
+ */
+void PokeyDevicePluginStateManager::devicePollConfiguration(libconfig::SettingIterator iter, std::shared_ptr<PokeyDevice> pokeyDevice)
+{
+    PollMode mode = POLL_FIXED;
+    std::string modeName = PollPolicy::ModeName(mode);
+    unsigned int interval = DEVICE_READ_INTERVAL;
+    unsigned int minInterval = POLL_ADAPTIVE_MIN_INTERVAL;
+    bool sharedPolling = false;
+
+    iter->lookupValue("pollMode", modeName);
+    iter->lookupValue("pollInterval", interval);
+    iter->lookupValue("pollMinInterval", minInterval);
+    iter->lookupValue("sharedPolling", sharedPolling);
+
+    if (!PollPolicy::ModeFromString(modeName, &mode)) {
+        _logger(LOG_ERROR, "%s | Unknown pollMode %s, using fixed", pokeyDevice->name().c_str(), modeName.c_str());
+    }
+
+    pokeyDevice->setPollPolicy(PollPolicy(mode, interval, minInterval));
+    pokeyDevice->setSharedPolling(sharedPolling);
+
+    _logger(LOG_INFO, "%s | %s polling every %ums%s", pokeyDevice->name().c_str(), PollPolicy::ModeName(mode), interval, sharedPolling ? " on the shared poll thread" : "");
+}
+
 void PokeyDevicePluginStateManager::loadTransform(std::string pinName, libconfig::Setting *transform)
 {
     _logger(LOG_INFO, "Transform | %s added", pinName.c_str());
@@ -270,10 +343,18 @@ void PokeyDevicePluginStateManager::loadTransform(std::string pinName, libconfig
     if (transform->exists("On") && transform->exists("Off")) {
         std::string transformResultOn;
         std::string transformResultOff;
+        ElementID pinId = elementId(pinName);
 
         transform->lookupValue("On", transformResultOn);
         transform->lookupValue("Off", transformResultOff);
-        _pinValueTransforms.emplace(pinName, std::bind(&PokeyDevicePluginStateManager::transformBoolToString, this, std::placeholders::_1, transformResultOff, transformResultOn));
+
+        if (pinId >= _pinValueTransforms.size()) {
+            _pinValueTransforms.resize(pinId + 1);
+        }
+
+        if (!_pinValueTransforms[pinId]) {
+            _pinValueTransforms[pinId] = std::bind(&PokeyDevicePluginStateManager::transformBoolToString, this, std::placeholders::_1, transformResultOff, transformResultOn);
+        }
     }
 }
 
@@ -348,7 +429,9 @@ bool PokeyDevicePluginStateManager::devicePinsConfiguration(libconfig::Setting *
             if (pokeyDevice->validatePinCapability(pinNumber, pinType)) {
                 if (iter->exists("mapTo")) {
                     iter->lookupValue("mapTo", mapTo);
-                    assert(!mapContains(_remappedPins, pinName));
+
+                    ElementID pinId = elementId(pinName);
+                    assert(!pinRemapped(pinId));
 
                     std::shared_ptr<PokeyDevice> remapTargetDevice = deviceForPin(mapTo);
 
@@ -357,9 +440,25 @@ bool PokeyDevicePluginStateManager::devicePinsConfiguration(libconfig::Setting *
                         assert(remapTargetDevice);
                     }
 
+                    if (pinId >= _remappedPins.size()) {
+                        _remappedPins.resize(pinId + 1);
+                    }
+
+                    int sourceDefault = 0;
+                    iter->lookupValue("default", sourceDefault);
+
                     // NOTE: the fact config entries that mapTo must be defined *after* the
                     //       device to which they refer is an explicit limitation
-                    _remappedPins[pinName] = std::make_pair(remapTargetDevice, mapTo);
+                    _remappedPins[pinId].device = remapTargetDevice;
+                    _remappedPins[pinId].pinName = mapTo;
+                    _remappedPins[pinId].elementId = elementId(mapTo);
+                    _remappedPins[pinId].target = remapTarget(mapTo, remapTargetDevice);
+                    _remappedPins[pinId].source = _remapArbiter.addSource(_remappedPins[pinId].target, sourceDefault != 0);
+
+                    if (_remappedPins[pinId].source < 0) {
+                        _logger(LOG_ERROR, "%s | Remap | ERROR - Too many pins remapped to %s", pokeyDevice->name().c_str(), mapTo.c_str());
+                        _remappedPins[pinId].device = NULL;
+                    }
                 }
 
                 if (pinType == "DIGITAL_OUTPUT") {
@@ -401,35 +500,75 @@ bool PokeyDevicePluginStateManager::devicePinsConfiguration(libconfig::Setting *
 }
 
 /**
- *   @brief  Default  find a transform by element name
+ *   @brief  Default  find a transform by element id
  *
  *   @return TransformFunction or NULL if not found
  */
-TransformFunction PokeyDevicePluginStateManager::transformForPinName(std::string name)
+TransformFunction PokeyDevicePluginStateManager::transformForPin(ElementID pinId)
 {
-    TransformMap::iterator it = _pinValueTransforms.find(name);
-
-    if (it != _pinValueTransforms.end()) {
-        return (*it).second;
+    if (pinId < _pinValueTransforms.size()) {
+        return _pinValueTransforms[pinId];
     }
 
     return NULL;
 }
 
-bool PokeyDevicePluginStateManager::pinRemapped(std::string pinName)
+bool PokeyDevicePluginStateManager::pinRemapped(ElementID pinId)
+{
+    return pinId < _remappedPins.size() && _remappedPins[pinId].device != NULL;
+}
+
+const RemappedPin &PokeyDevicePluginStateManager::remappedPinDetails(ElementID pinId)
 {
-    return mapContains(_remappedPins, pinName);
+    assert(pinRemapped(pinId));
+    return _remappedPins[pinId];
 }
 
-std::pair<std::shared_ptr<PokeyDevice>, std::string> PokeyDevicePluginStateManager::remappedPinDetails(std::string pinName)
+/**
+ *   @brief  finds the arbiter target for the given remap target pin,
+ *           adding one the first time any pin is remapped to it
+ *
+ *   @return index of the PinRemapArbiter target
+ */
+int PokeyDevicePluginStateManager::remapTarget(std::string pinName, std::shared_ptr<PokeyDevice> device)
 {
-    std::pair<std::shared_ptr<PokeyDevice>, std::string> retVal;
+    ElementID pinId = elementId(pinName);
 
-    if (mapContains(_remappedPins, pinName)) {
-        retVal = _remappedPins[pinName];
+    for (size_t i = 0; i < _remapTargets.size(); i++) {
+        if (_remapTargets[i].elementId == pinId) {
+            return i;
+        }
     }
 
-    return retVal;
+    int target = _remapArbiter.addTarget();
+
+    _remapTargets.resize(target + 1);
+    _remapTargets[target].device = device;
+    _remapTargets[target].pinName = pinName;
+    _remapTargets[target].elementId = pinId;
+    _remapTargets[target].target = target;
+    _remapTargets[target].source = -1;
+
+    return target;
+}
+
+void PokeyDevicePluginStateManager::remappedPinEdge(ElementID pinId, bool value)
+{
+    const RemappedPin &remappedPin = remappedPinDetails(pinId);
+    _remapArbiter.edge(remappedPin.target, remappedPin.source, value);
+}
+
+/**
+ *   @brief  called on the arbiter thread once the pins remapped to the
+ *           target have settled on a new value
+ *
+ *   @return nothing
+ */
+void PokeyDevicePluginStateManager::reportRemappedPin(int target, bool value)
+{
+    const RemappedPin &remapTarget = _remapTargets[target];
+
+    remapTarget.device->enqueuePinValue(remapTarget.elementId, remapTarget.pinName.c_str(), value);
 }
 
 bool PokeyDevicePluginStateManager::devicePWMConfiguration(libconfig::Setting *pwm, std::shared_ptr<PokeyDevice> pokeyDevice)
@@ -468,6 +607,7 @@ bool PokeyDevicePluginStateManager::deviceEncodersConfiguration(libconfig::Setti
             int encoderStep = 1;
             int invertDirection = 0;
             std::string units = "";
+            EncoderAccelerationCurve acceleration;
 
             try {
                 iter->lookupValue("encoder", encoderNumber);
@@ -480,6 +620,19 @@ bool PokeyDevicePluginStateManager::deviceEncodersConfiguration(libconfig::Setti
                 iter->lookupValue("invertDirection", invertDirection);
                 iter->lookupValue("units", units);
                 iter->lookupValue("type", type);
+
+                if (iter->exists("acceleration")) {
+                    libconfig::Setting &curve = iter->lookup("acceleration");
+
+                    for (libconfig::SettingIterator pointIter = curve.begin(); pointIter != curve.end(); pointIter++) {
+                        int speed = 0;
+                        int multiplier = 1;
+
+                        pointIter->lookupValue("speed", speed);
+                        pointIter->lookupValue("multiplier", multiplier);
+                        acceleration.push_back({ (uint32_t)speed, multiplier });
+                    }
+                }
             }
             catch (const libconfig::SettingNotFoundException &nfex) {
                 _logger(LOG_ERROR, "%s | Encoder | Could not find %s. Skipping....", pokeyDevice->name().c_str(), nfex.what());
@@ -487,7 +640,8 @@ bool PokeyDevicePluginStateManager::deviceEncodersConfiguration(libconfig::Setti
             }
 
             if (pokeyDevice->validateEncoder(encoderNumber)) {
-                pokeyDevice->addEncoder(encoderNumber, encoderDefault, encoderName, description, encoderMin, encoderMax, encoderStep, invertDirection, units, type);
+                pokeyDevice->addEncoder(encoderNumber, encoderDefault, encoderName, description, encoderMin, encoderMax, encoderStep, invertDirection, units,
+                    EncoderAccumulator::TypeFromString(type), acceleration);
                 _logger(LOG_INFO, "%s | Encoder | Added encoder %i (%s)", pokeyDevice->name().c_str(), encoderNumber, encoderName.c_str());
                 encoderIndex++;
             }
@@ -843,7 +997,17 @@ int PokeyDevicePluginStateManager::preflightComplete(void)
         if (iter->exists("switchMatrix"))
             deviceSwitchMatrixConfiguration(&iter->lookup("switchMatrix"), pokeyDevice);
 
-        pokeyDevice->startPolling();
+        devicePollConfiguration(iter, pokeyDevice);
+        pokeyDevice->startPolling(&_pollScheduler);
+    }
+
+    if (_remapArbiter.targetCount() > 0) {
+        _remapArbiter.setReportFunction([this](int target, bool value) { reportRemappedPin(target, value); });
+        _remapArbiter.start();
+    }
+
+    if (_pollScheduler.clientCount() > 0) {
+        _pollScheduler.start();
     }
 
     if (_numberOfDevices > 0) {
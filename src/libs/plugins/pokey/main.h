@@ -7,7 +7,9 @@
 #include <mutex>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
+#include "PinRemapArbiter/PinRemapArbiter.h"
 #include "PoKeysLib.h"
 #include "common/private/pluginstatemanager.h"
 #include "common/simhubdeviceplugin.h"
@@ -22,7 +24,18 @@ typedef std::map<std::string, std::shared_ptr<PokeyDevice>> PokeyDeviceMap; ///<
 typedef PokeyDeviceMap::iterator deviceTargetIterator; ///< iterator for deviceTargers
 
 typedef std::function<std::string(std::string, std::string, std::string)> TransformFunction;
-typedef std::map<std::string, TransformFunction> TransformMap;
+typedef std::vector<TransformFunction> TransformTable; ///< indexed by ElementID
+
+//! target of a pin whose input is delivered as another device's pin
+typedef struct {
+    std::shared_ptr<PokeyDevice> device;
+    std::string pinName;
+    ElementID elementId;
+    int target; ///< PinRemapArbiter target resolving the pin
+    int source; ///< source index of the remapped pin within that target
+} RemappedPin;
+
+typedef std::vector<RemappedPin> RemappedPinTable; ///< indexed by ElementID of the source pin, or by arbiter target
 
 //! barest specialisation of the internal plugin management support base class
 class PokeyDevicePluginStateManager : public PluginStateManager
@@ -37,6 +50,7 @@ private:
 protected:
     bool validateConfig(libconfig::SettingIterator);
     bool deviceConfiguration(libconfig::SettingIterator iter, std::shared_ptr<PokeyDevice> pokeyDevice);
+    void devicePollConfiguration(libconfig::SettingIterator iter, std::shared_ptr<PokeyDevice> pokeyDevice);
     bool devicePinsConfiguration(libconfig::Setting *pins, std::shared_ptr<PokeyDevice> pokeyDevice);
     bool deviceEncodersConfiguration(libconfig::Setting *encoders, std::shared_ptr<PokeyDevice> pokeyDevice);
 
@@ -49,18 +63,23 @@ protected:
     int deviceSwitchMatrixSwitchConfiguration(libconfig::Setting *switches, int id, std::shared_ptr<PokeyDevice> pokeyDevice, std::string name, std::string type, bool enabled);
 
     bool addTargetToDeviceTargetList(std::string, std::shared_ptr<PokeyDevice> device);
-    std::shared_ptr<PokeyDevice> targetFromDeviceTargetList(std::string);
+    std::shared_ptr<PokeyDevice> targetFromDeviceTargetList(ElementID targetId);
     void enumerateDevices(void);
     void loadTransform(std::string pinName, libconfig::Setting *transform);
     void loadMapTo(std::string pinName, libconfig::Setting *mapTo);
+    int remapTarget(std::string pinName, std::shared_ptr<PokeyDevice> device);
+    void reportRemappedPin(int target, bool value);
 
     int _numberOfDevices;
-    PokeyDeviceMap _deviceMap;
+    PokeyDeviceMap _deviceMap; ///< devices by serial number
+    std::vector<std::shared_ptr<PokeyDevice>> _targetDevices; ///< owning device of each output target, indexed by ElementID
     sPoKeysNetworkDeviceSummary *_devices;
-    TransformMap _pinValueTransforms;
-    std::map<std::string, std::pair<std::shared_ptr<PokeyDevice>, std::string>> _remappedPins;
-    std::mutex _pinRemappingMutex;
+    TransformTable _pinValueTransforms;
+    RemappedPinTable _remappedPins;
+    RemappedPinTable _remapTargets; ///< pins that other pins are remapped to, indexed by arbiter target
     std::vector<std::string> _pinNames;
+    PinRemapArbiter _remapArbiter; ///< resolves remapped pins, stops before the devices go
+    PollScheduler _pollScheduler; ///< polls every device configured with sharedPolling, declared last so it stops before the devices go
 
 public:
     PokeyDevicePluginStateManager(LoggingFunctionCB logger);
@@ -72,17 +91,17 @@ public:
     std::shared_ptr<PokeyDevice> device(std::string);
     virtual int processPokeyDeviceUpdate(std::shared_ptr<PokeyDevice> device);
 
-    //! returns the value transformation for the given pin name
-    TransformFunction transformForPinName(std::string name);
+    //! returns the value transformation for the given pin
+    TransformFunction transformForPin(ElementID pinId);
 
     //! allows callers to check if a given pin has a remapping
-    bool pinRemapped(std::string pinName);
+    bool pinRemapped(ElementID pinId);
 
-    //! returns the final target device and ping from the give original source pin
-    std::pair<std::shared_ptr<PokeyDevice>, std::string> remappedPinDetails(std::string pinName);
+    //! returns the final target device and pin from the given original source pin
+    const RemappedPin &remappedPinDetails(ElementID pinId);
 
-    //! KLUDGE: will refactor
-    std::mutex &pinRemappingMutex(void) { return _pinRemappingMutex; };
+    //! records an edge of a remapped pin, the target is reported once its sources settle
+    void remappedPinEdge(ElementID pinId, bool value);
 
     std::shared_ptr<PokeyDevice> deviceForPin(std::string pinName);
 
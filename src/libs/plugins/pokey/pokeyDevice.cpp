@@ -1,16 +1,24 @@
 #include <string.h>
 
-#include "elements/attributes/attribute.h"
 #include "main.h"
 #include "pokeyDevice.h"
 
 using namespace std::chrono_literals;
 
 PokeyDevice::PokeyDevice(PokeyDevicePluginStateManager *owner, sPoKeysNetworkDeviceSummary deviceSummary, uint8_t index)
+    : _outputValues(0)
+    , _outputsSent(0)
+    , _outputsSentValid(false)
+    , _outputUpdates(0)
+    , _outputWrites(0)
+    , _outputFlusher(std::bind(&PokeyDevice::flushOutputs, this), DEVICE_WRITE_INTERVAL)
+    , _displayFlusher(std::bind(&PokeyDevice::flushDisplays, this), DEVICE_DISPLAY_INTERVAL)
 {
     _callbackArg = NULL;
     _enqueueCallback = NULL;
     _owner = owner;
+    _pollLoop = NULL;
+    _sharedPolling = false;
 
     _pokey = PK_ConnectToNetworkDevice(&deviceSummary);
 
@@ -28,32 +36,26 @@ PokeyDevice::PokeyDevice(PokeyDevicePluginStateManager *owner, sPoKeysNetworkDev
     _hardwareType = deviceSummary.HWtype;
     _dhcp = deviceSummary.DHCP;
 
-    _intToDisplayRow[0] = 0b11111100;
-    _intToDisplayRow[1] = 0b01100000;
-    _intToDisplayRow[2] = 0b11011010;
-    _intToDisplayRow[3] = 0b11110010;
-    _intToDisplayRow[4] = 0b01100110;
-    _intToDisplayRow[5] = 0b10110110;
-    _intToDisplayRow[6] = 0b10111110;
-    _intToDisplayRow[7] = 0b11100000;
-    _intToDisplayRow[8] = 0b11111110;
-    _intToDisplayRow[9] = 0b11100110;
-
-    _switchMatrixManager = std::make_shared<PokeySwitchMatrixManager>(_pokey);
-
-    loadPinConfiguration();
-    if (makeAllPinsInactive()) {
-        _pollTimer.data = this;
-        _pollLoop = uv_loop_new();
-        uv_timer_init(_pollLoop, &_pollTimer);
+    for (int i = 0; i < MAX_PINS; i++) {
+        _pins[i].elementId = INVALID_ELEMENT_ID;
+    }
 
-        int ret = uv_timer_start(&_pollTimer, (uv_timer_cb)&PokeyDevice::DigitalIOTimerCallback, DEVICE_START_DELAY, DEVICE_READ_INTERVAL);
+    for (int i = 0; i < MAX_ENCODERS; i++) {
+        _encoders[i].elementId = INVALID_ELEMENT_ID;
+    }
 
-        if (ret == 0) {
-            _pollThread = std::make_shared<std::thread>([=] { uv_run(_pollLoop, UV_RUN_DEFAULT); });
+    for (int i = 0; i < MAX_MATRIX_LEDS; i++) {
+        for (int j = 0; j < MAX_MATRIX_LED_GROUPS; j++) {
+            _matrixLED[i].group[j].elementId = INVALID_ELEMENT_ID;
         }
     }
-    else {
+
+    _switchMatrixManager = std::make_shared<PokeySwitchMatrixManager>(_pokey, &_ioMutex);
+
+    loadPinConfiguration();
+    _pollReady = makeAllPinsInactive();
+
+    if (!_pollReady) {
         printf("Failed to make all pins inactive - pokey polling loop inactive");
     }
 }
@@ -97,205 +99,145 @@ void PokeyDevice::DigitalIOTimerCallback(uv_timer_t *timer, int status)
 
     assert(self);
 
+    bool activity = self->poll();
+
+    uv_timer_start(timer, (uv_timer_cb)&PokeyDevice::DigitalIOTimerCallback, self->_pollPolicy.next(activity), 0);
+}
+
+/**
+ *   @brief  reads the inputs of the device once and enqueues an event
+ *           for every change, used by both the device's own poll loop
+ *           and the shared PollScheduler
+ *
+ *   @return true if any input changed
+ */
+bool PokeyDevice::poll(void)
+{
     // only run if we have complete our preflight
-    if (!self->_owner->successfulPreflightCompleted()) {
-        return;
+    if (!_owner->successfulPreflightCompleted()) {
+        return false;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool retVal = readInputs();
+
+    // a change seen now happened at some point since the previous poll
+    // began, so that (plus this round trip) bounds its latency
+    if (retVal && _lastPollStart.time_since_epoch().count() != 0) {
+        _inputLatency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _lastPollStart).count());
     }
 
+    _lastPollStart = start;
+
+    return retVal;
+}
+
+bool PokeyDevice::readInputs(void)
+{
     // Process the encoders
-    int encoderRetValue = PK_EncoderValuesGet(self->_pokey);
+    bool retVal = false;
+    int encoderCount = _pokey->info.iEncodersCount < MAX_ENCODERS ? _pokey->info.iEncodersCount : MAX_ENCODERS;
+    uint32_t encoderValues[MAX_ENCODERS];
+    int encoderRetValue;
+
+    // copy the values out under the device lock, the writer and display
+    // threads share _pokey
+    {
+        std::lock_guard<std::mutex> lock(_ioMutex);
+        encoderRetValue = PK_EncoderValuesGet(_pokey);
+
+        for (int i = 0; i < encoderCount; i++) {
+            encoderValues[i] = _pokey->Encoders[i].encoderValue;
+        }
+    }
 
     if (encoderRetValue == PK_OK) {
         GenericTLV *el = NULL;
 
-        for (int i = 0; i < self->_encoderMap.size(); i++) {
-
-            uint32_t step = self->_encoders[i].step;
-            uint32_t newEncoderValue = self->_pokey->Encoders[i].encoderValue;
-            uint32_t previousEncoderValue = self->_encoders[i].previousEncoderValue;
-
-            uint32_t currentValue = self->_encoders[i].value;
-            uint32_t min = self->_encoders[i].min;
-            uint32_t max = self->_encoders[i].max;
-
-            if (previousEncoderValue != newEncoderValue) {
-
-                if (newEncoderValue < previousEncoderValue) {
-                    // values are decreasing
-                    // absolute encoders send 1 or -1
-                    if (self->_encoders[i].type == "absolute") {
-                        self->_encoders[i].value = 1;
-                    }
-                    else {
-                        if (currentValue <= min) {
-                            self->_encoders[i].previousValue = min;
-                            self->_encoders[i].value = min;
-                        }
-                        else {
-                            self->_encoders[i].value = currentValue - step;
-                        }
-                    }
-                }
-                else {
-                    // values are increasing
-                    if (self->_encoders[i].type == "absolute") {
-                        // absolute encoders send 1 or -1
-                        self->_encoders[i].value = -1;
-                    }
-                    else {
-                        if (currentValue >= max) {
-                            self->_encoders[i].previousValue = max;
-                            self->_encoders[i].value = max;
-                        }
-                        else {
-                            self->_encoders[i].value = currentValue + step;
-                        }
-                    }
-                }
-
-                el = make_generic(self->_encoders[i].name.c_str(), self->_encoders[i].description.c_str());
-
-                el->ownerPlugin = self->_owner;
-                el->type = CONFIG_INT;
-                el->value.int_value = (int)self->_encoders[i].value;
-                el->length = sizeof(uint32_t);
-                dupe_string(&(el->units), self->_encoders[i].units.c_str());
-
-                // enqueue the element
-                self->_enqueueCallback(self, (void *)el, self->_callbackArg);
-                // set previous to equal new
-                self->_encoders[i].previousEncoderValue = newEncoderValue;
+        for (int i = 0; i < encoderCount; i++) {
+            // every detent turned since the last read goes out as one value
+            if (!_encoders[i].accumulator.update(encoderValues[i])) {
+                continue;
             }
+
+            el = pool_make_generic(_owner->eventPool(), _encoders[i].elementId, _encoders[i].name.c_str(), _encoders[i].description.c_str());
+
+            el->ownerPlugin = _owner;
+            el->type = CONFIG_INT;
+            el->value.int_value = (int)_encoders[i].accumulator.value();
+            el->length = sizeof(uint32_t);
+            generic_set_units(el, _encoders[i].units.c_str());
+
+            // enqueue the element
+            _enqueueCallback(this, (void *)el, _callbackArg);
+            retVal = true;
         }
     }
     // Finish processing the encoders
 
-    int retVal = PK_DigitalIOGet(self->_pokey);
-
-    if (retVal == PK_OK) {
-        self->_owner->pinRemappingMutex().lock();
-
-        for (int i = 0; i < self->_pokey->info.iPinCount; i++) {
-            GenericTLV *el = make_generic((const char *)"-", (const char *)"-");
-
-            if (self->_pins[i].type == "DIGITAL_INPUT") {
-                int sourcePinNumber = self->_pins[i].pinNumber;
-
-                if (self->_pins[i].value != self->_pokey->Pins[sourcePinNumber - 1].DigitalValueGet && !self->_pins[i].skipNext) {
-                    // data has changed so send it off for processing
-                    printf("DIN pin-index %i - %i\n", sourcePinNumber - 1, self->_pokey->Pins[sourcePinNumber - 1].DigitalValueGet);
-
-                    el->ownerPlugin = self->_owner;
-                    el->type = CONFIG_BOOL;
-                    bool hackSkip = false;
-                    el->length = sizeof(uint8_t);
-
-                    if (self->_owner->pinRemapped(self->_pins[i].pinName)) {
-                        // KLUDGE: as each device has its own polling
-                        //         thread, the logic below is a
-                        //         critical section because it can
-                        //         touch the state of multiple device
-                        //         pins
-
-                        std::pair<std::shared_ptr<PokeyDevice>, std::string> remappedPinInfo = self->_owner->remappedPinDetails(self->_pins[i].pinName);
-                        int remappedPinIndex = remappedPinInfo.first->pinIndexFromName(remappedPinInfo.second);
-
-                        // remappedPinInfo.first->pins()[remappedPinIndex].previousValue = self->_pins[self->_pins[i].pinNumber - 1].value;
-                        self->_pins[i].previousValue = self->_pins[self->_pins[i].pinNumber - 1].value;
-
-                        remappedPinInfo.first->_pins[remappedPinIndex].previousValue = self->_pokey->Pins[sourcePinNumber - 1].DigitalValueGet;
-
-                        remappedPinInfo.first->_pins[remappedPinIndex].value = self->_pokey->Pins[sourcePinNumber - 1].DigitalValueGet;
-                        self->_pins[i].value = self->_pokey->Pins[sourcePinNumber - 1].DigitalValueGet;
-
-                        dupe_string(&(el->name), remappedPinInfo.second.c_str());
-                        el->value.bool_value = self->_pokey->Pins[sourcePinNumber - 1].DigitalValueGet;
-
-                        if (el->value.bool_value == 0) {
-                            remappedPinInfo.first->_pins[remappedPinIndex].skipNext = true;
-                        }
-                        else {
-                            if (!remappedPinInfo.first->_pins[remappedPinIndex].skipNext) {
-                                self->_owner->pinRemappingMutex().unlock();
-                                std::this_thread::sleep_for(250ms);
-                                // give any other remapped polling
-                                // threads a chance to send a state
-                                // change
-                                if (remappedPinInfo.first->_pins[remappedPinIndex].skipNext) {
-                                    hackSkip = true;
-                                }
-                            }
-
-                            remappedPinInfo.first->_pins[remappedPinIndex].skipNext = false;
-                        }
-
-                        printf("--> remapping %s to  %s\n", self->_pins[i].pinName.c_str(), remappedPinInfo.first->pins()[remappedPinIndex].pinName.c_str());
-                    }
-                    else {
-                        dupe_string(&(el->name), self->_pins[i].pinName.c_str());
-                        el->value.bool_value = self->_pins[i].value;
-                        self->_pins[i].previousValue = self->_pins[i].value;
-                        self->_pins[i].value = self->_pokey->Pins[self->_pins[i].pinNumber - 1].DigitalValueGet;
-                    }
-
-                    if (hackSkip) {
-                        printf("HACKSKIP, %s, %i\n", self->_pins[i].pinName.c_str(), self->_pins[i].value);
-                        release_generic(el);
-                        self->_owner->pinRemappingMutex().unlock();
-                        return;
-                    }
-
-                    if (self->_pins[i].description.size() > 0) {
-                        dupe_string(&(el->description), self->_pins[i].description.c_str());
-                    }
-
-                    if (self->_pins[i].units.size() > 0) {
-                        dupe_string(&(el->units), self->_pins[i].units.c_str());
-                    }
-
-                    std::shared_ptr<Attribute> attribute = AttributeFromCGeneric(el);
-                    TransformFunction transformer = self->_owner->transformForPinName(self->_pins[i].pinName);
-
-                    if (transformer) {
-                        std::string transformedValue = transformer(attribute->valueToString(), "NULL", "NULL");
-
-                        attribute->setType(STRING_ATTRIBUTE);
-                        attribute->setValue(transformedValue);
-                        GenericTLV *transformedGeneric = AttributeToCGeneric(attribute);
-
-                        printf("---> %s: %s\n", (char *)self->_pins[i].pinName.c_str(), transformedValue.c_str());
-                        self->_enqueueCallback(self, (void *)transformedGeneric, self->_callbackArg);
-                    }
-                    else {
-                        printf("---> %s\n", (char *)self->_pins[i].pinName.c_str());
-                        self->_enqueueCallback(self, (void *)el, self->_callbackArg);
-                    }
-                }
+    uint8_t inputValues[MAX_PINS];
+    PinSet changed;
+    int ioRetValue;
+
+    {
+        std::lock_guard<std::mutex> lock(_ioMutex);
+        ioRetValue = PK_DigitalIOGet(_pokey);
+
+        if (ioRetValue == PK_OK) {
+            changed = changedInputs();
+            PinSet pins = changed;
+
+            while (!pins.empty()) {
+                int i = pins.takeFirst();
+                inputValues[i] = _pokey->Pins[_pins[i].pinNumber - 1].DigitalValueGet;
             }
         }
+    }
+
+    if (ioRetValue == PK_OK) {
+        while (!changed.empty()) {
+            int i = changed.takeFirst();
+            uint8_t value = inputValues[i];
+            uint8_t reportedValue = _pins[i].value; // direct pins report the value held before this read
+
+            retVal = true;
+
+            _pins[i].previousValue = _pins[i].value;
+            setPinValue(i, value);
+
+            if (_owner->pinRemapped(_pins[i].elementId)) {
+                // reported by the remap arbiter once every pin mapped to
+                // the same target has settled
+                _owner->remappedPinEdge(_pins[i].elementId, value);
+                continue;
+            }
+
+            enqueuePinValue(_pins[i].elementId, _pins[i].pinName.c_str(), reportedValue);
+        }
 
         // -- process all switch matrix
-        std::vector<GenericTLV *> matrixResult = self->_switchMatrixManager->readAll();
+        const std::vector<GenericTLV *> &matrixResult = _switchMatrixManager->readAll(_owner->eventPool());
 
         for (auto &res : matrixResult) {
-            res->ownerPlugin = self->_owner;
-            self->_enqueueCallback(self, (void *)res, self->_callbackArg);
+            res->ownerPlugin = _owner;
+            _enqueueCallback(this, (void *)res, _callbackArg);
+            retVal = true;
         }
         // -- end process all switch matrix
-
-        self->_owner->pinRemappingMutex().unlock();
     }
     else {
-        if (retVal == PK_ERR_TRANSFER) {
-            printf("----> PK_ERR_TRANSFER %i\n\n", retVal);
+        if (ioRetValue == PK_ERR_TRANSFER) {
+            printf("----> PK_ERR_TRANSFER %i\n\n", ioRetValue);
         }
-        else if (retVal == PK_ERR_GENERIC) {
-            printf("----> PK_ERR_GENERIC %i\n\n", retVal);
+        else if (ioRetValue == PK_ERR_GENERIC) {
+            printf("----> PK_ERR_GENERIC %i\n\n", ioRetValue);
         }
-        else if (retVal == PK_ERR_PARAMETER) {
-            printf("----> PK_ERR_PARAMETER %i\n\n", retVal);
+        else if (ioRetValue == PK_ERR_PARAMETER) {
+            printf("----> PK_ERR_PARAMETER %i\n\n", ioRetValue);
         }
     }
+
+    return retVal;
 }
 
 void PokeyDevice::addPin(int pinIndex, std::string pinName, int pinNumber, std::string pinType, int defaultValue, std::string description, bool invert)
@@ -305,28 +247,139 @@ void PokeyDevice::addPin(int pinIndex, std::string pinName, int pinNumber, std::
     if (pinType == "DIGITAL_INPUT")
         inputPin(pinNumber, invert);
 
-    mapNameToPin(pinName.c_str(), pinNumber);
+    ElementID elementId = _owner->elementId(pinName);
+
+    mapElementToPin(elementId, pinNumber);
 
     _pins[pinIndex].pinName = pinName;
+    _pins[pinIndex].elementId = elementId;
     _pins[pinIndex].pinIndex = pinIndex;
     _pins[pinIndex].type = pinType.c_str();
     _pins[pinIndex].pinNumber = pinNumber;
     _pins[pinIndex].defaultValue = defaultValue;
-    _pins[pinIndex].value = defaultValue;
     _pins[pinIndex].description = description;
+    _digitalInputs.set(pinIndex, pinType == "DIGITAL_INPUT");
+    setPinValue(pinIndex, defaultValue);
+
+    if (pinType == "DIGITAL_OUTPUT") {
+        _outputPins.set(pinNumber - 1);
+        stageOutput(pinNumber - 1, defaultValue);
+    }
 }
 
-void PokeyDevice::startPolling()
+/**
+ *   @brief  enqueues the value of a digital input pin, applying the
+ *           description, units and transform configured for that pin
+ *
+ *   @return nothing
+ */
+void PokeyDevice::enqueuePinValue(ElementID elementId, const char *pinName, bool value)
 {
-    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+    GenericTLV *el = pool_make_generic(_owner->eventPool(), elementId, pinName, "-");
+    int pinIndex = pinIndexFromElement(elementId);
+
+    el->ownerPlugin = _owner;
+    el->type = CONFIG_BOOL;
+    el->length = sizeof(uint8_t);
+    el->value.bool_value = value;
+
+    if (pinIndex >= 0) {
+        if (_pins[pinIndex].description.size() > 0) {
+            generic_set_description(el, _pins[pinIndex].description.c_str());
+        }
+
+        if (_pins[pinIndex].units.size() > 0) {
+            generic_set_units(el, _pins[pinIndex].units.c_str());
+        }
+    }
+
+    TransformFunction transformer = _owner->transformForPin(elementId);
+
+    if (transformer) {
+        std::string transformedValue = transformer(PluginStateManager::GenericValueToString(el), "NULL", "NULL");
+
+        // the record is reused to carry the transformed value
+        generic_set_string_value(el, transformedValue.c_str());
+    }
+
+    _enqueueCallback(this, (void *)el, _callbackArg);
+}
+
+void PokeyDevice::setPinValue(int pinIndex, uint8_t value)
+{
+    _pins[pinIndex].value = value;
+    _inputValues.set(pinIndex, value != 0);
+}
+
+/**
+ *   @brief  compares the last digital input read with the values
+ *           held for each input pin, called with the device lock held
+ *
+ *   @return the indexes of the input pins whose value has changed
+ */
+PinSet PokeyDevice::changedInputs(void)
+{
+    PinSet current;
+    PinSet inputs = _digitalInputs;
+
+    // PK_DigitalIOGet unpacks the board's IO into one struct per pin,
+    // gather just the input pins back into a packed set
+    while (!inputs.empty()) {
+        int i = inputs.takeFirst();
+        current.set(i, _pokey->Pins[_pins[i].pinNumber - 1].DigitalValueGet != 0);
+    }
+
+    return (current ^ _inputValues) & _digitalInputs;
+}
+
+/**
+ *   @brief  starts the digital output writer, the display refresh
+ *           and polling of the device inputs, either on the given
+ *           scheduler shared by all boards configured with
+ *           sharedPolling or on a loop and thread of its own
+ *
+ *   @return nothing
+ */
+void PokeyDevice::startPolling(PollScheduler *sharedScheduler)
+{
+    _outputFlusher.start();
+    _displayFlusher.start();
+
+    if (!_pollReady) {
+        return;
+    }
+
+    if (_sharedPolling && sharedScheduler) {
+        sharedScheduler->add([this] { return poll(); }, _pollPolicy, DEVICE_START_DELAY);
+        return;
+    }
+
+    _pollTimer.data = this;
+    _pollLoop = uv_loop_new();
+    uv_timer_init(_pollLoop, &_pollTimer);
+
+    // the callback restarts the timer with the interval chosen by the poll policy
+    int ret = uv_timer_start(&_pollTimer, (uv_timer_cb)&PokeyDevice::DigitalIOTimerCallback, DEVICE_START_DELAY, 0);
+
+    if (ret == 0) {
+        _pollThread = std::make_shared<std::thread>([=] { uv_run(_pollLoop, UV_RUN_DEFAULT); });
+    }
 }
 
 void PokeyDevice::stopPolling()
 {
-    assert(_pollLoop);
-    uv_stop(_pollLoop);
+    if (_pokeyMax7219Manager) {
+        _pokeyMax7219Manager->stopFlushing();
+    }
+
+    _outputFlusher.stop();
+    _displayFlusher.stop();
 
-    if (_pollThread->joinable())
+    if (_pollLoop) {
+        uv_stop(_pollLoop);
+    }
+
+    if (_pollThread && _pollThread->joinable())
         _pollThread->join();
 }
 
@@ -339,12 +392,7 @@ PokeyDevice::~PokeyDevice()
 {
     stopPolling();
 
-    if (_pollThread) {
-        if (_pollThread->joinable()) {
-            _pollThread->join();
-        }
-    }
-
+    std::lock_guard<std::mutex> lock(_ioMutex);
     PK_DisconnectDevice(_pokey);
 }
 
@@ -399,6 +447,7 @@ bool PokeyDevice::validateEncoder(int encoderNumber)
 
 bool PokeyDevice::isEncoderCapable(int pin)
 {
+    std::lock_guard<std::mutex> lock(_ioMutex);
 
     switch (pin) {
     case 1:
@@ -423,10 +472,12 @@ bool PokeyDevice::isEncoderCapable(int pin)
 }
 
 void PokeyDevice::addEncoder(
-    int encoderNumber, uint32_t defaultValue, std::string name, std::string description, int min, int max, int step, int invertDirection, std::string units, std::string type)
+    int encoderNumber, uint32_t defaultValue, std::string name, std::string description, int min, int max, int step, int invertDirection, std::string units, EncoderType type,
+    EncoderAccelerationCurve acceleration)
 {
     assert(encoderNumber >= 1);
 
+    std::lock_guard<std::mutex> lock(_ioMutex);
     PK_EncoderConfigurationGet(_pokey);
     int encoderIndex = encoderNumber - 1;
 
@@ -465,18 +516,13 @@ void PokeyDevice::addEncoder(
     }
 
     _encoders[encoderIndex].name = name;
+    _encoders[encoderIndex].elementId = _owner->elementId(name);
     _encoders[encoderIndex].number = encoderNumber;
     _encoders[encoderIndex].defaultValue = defaultValue;
-    _encoders[encoderIndex].value = defaultValue;
-    _encoders[encoderIndex].previousValue = defaultValue;
-    _encoders[encoderIndex].previousEncoderValue = defaultValue;
-
-    _encoders[encoderIndex].min = min;
-    _encoders[encoderIndex].max = max;
-    _encoders[encoderIndex].step = step;
     _encoders[encoderIndex].units = units;
     _encoders[encoderIndex].description = description;
-    _encoders[encoderIndex].type = type;
+    _encoders[encoderIndex].accumulator.configure(type, defaultValue, min, max, step, defaultValue);
+    _encoders[encoderIndex].accumulator.setAcceleration(acceleration);
 
     int val = PK_EncoderConfigurationSet(_pokey);
 
@@ -491,23 +537,40 @@ void PokeyDevice::addEncoder(
 
 void PokeyDevice::addMatrixLED(int id, std::string name, std::string type)
 {
-    PK_MatrixLEDConfigurationGet(_pokey);
+    {
+        std::lock_guard<std::mutex> lock(_ioMutex);
+        PK_MatrixLEDConfigurationGet(_pokey);
+    }
+
+
     _matrixLED[id].name = name;
     _matrixLED[id].type = type;
 
-    mapNameToMatrixLED(name, id);
+    mapElementToMatrixLED(_owner->elementId(name), id);
 }
 
 void PokeyDevice::addGroupToMatrixLED(int id, int displayId, std::string name, int digits, int position)
 {
     _matrixLED[displayId].group[position].name = name;
+    _matrixLED[displayId].group[position].elementId = _owner->elementId(name);
     _matrixLED[displayId].group[position].position = position;
     _matrixLED[displayId].group[position].length = digits;
     _matrixLED[displayId].group[position].value = 0;
+
+    ElementID elementId = _matrixLED[displayId].group[position].elementId;
+
+    if (elementId >= _displayTargets.size()) {
+        _displayTargets.resize(elementId + 1, { -1, -1 });
+    }
+
+    _displayTargets[elementId] = { (int8_t)displayId, (int8_t)position };
+    _displays[displayId].addGroup(position, position, digits);
 }
 
 void PokeyDevice::configMatrixLED(int id, int rows, int cols, int enabled)
 {
+    std::lock_guard<std::mutex> lock(_ioMutex);
+
     _pokey->MatrixLED[id].rows = rows;
     _pokey->MatrixLED[id].columns = cols;
     _pokey->MatrixLED[id].displayEnabled = enabled;
@@ -527,10 +590,11 @@ void PokeyDevice::configMatrixLED(int id, int rows, int cols, int enabled)
 
 void PokeyDevice::configMatrix(int id, uint8_t chipSelect, std::string type, uint8_t enabled, std::string name, std::string description)
 {
-    _pokeyMax7219Manager = std::make_shared<PokeyMAX7219Manager>(_pokey);
+    _pokeyMax7219Manager = std::make_shared<PokeyMAX7219Manager>(_pokey, &_ioMutex);
 
     if (enabled) {
         _pokeyMax7219Manager->addMatrix(id, chipSelect, type, enabled, name, description);
+        _pokeyMax7219Manager->startFlushing();
     }
 }
 
@@ -540,93 +604,145 @@ void PokeyDevice::addLedToLedMatrix(int ledMatrixIndex, uint8_t ledIndex, std::s
     _pokeyMax7219Manager->addLedToMatrix(ledMatrixIndex, ledIndex, name, description, enabled, row, col);
 }
 
-uint32_t PokeyDevice::targetValue(std::string targetName, int value)
+/**
+ *   @brief  stages the value for its display group, the display
+ *           refresh thread shows the latest value on the next frame
+ *
+ *   @return 0
+ */
+uint32_t PokeyDevice::targetValue(ElementID targetId, const char *targetName, int value)
 {
-    uint8_t displayNum = displayFromName(targetName);
-    displayNumber(displayNum, targetName, value);
+    if (targetId >= _displayTargets.size() || _displayTargets[targetId].display < 0) {
+        printf("---> cant find display\n");
+        return 0;
+    }
+
+    const device_display_target_t &target = _displayTargets[targetId];
+
+    if (_displays[target.display].set(target.group, value)) {
+        _displayFlusher.request();
+    }
+
     return 0;
 }
 
-uint32_t PokeyDevice::targetValue(std::string targetName, bool value)
+uint32_t PokeyDevice::targetValue(ElementID targetId, const char *targetName, bool value)
 {
-    uint32_t retValue = PK_OK;
-    uint32_t result = PK_OK;
+    int pin = pinFromElement(targetId) - 1;
 
-    uint8_t pin = pinFromName(targetName) - 1;
-
-    if (pin >= 0 && pin <= 55) {
-        result = PK_DigitalIOSetSingle(_pokey, pin, value);
+    if (pin >= 0 && pin < MAX_PINS) {
+        _outputUpdates.fetch_add(1, std::memory_order_relaxed);
+        stageOutput(pin, value);
     }
     else {
         // we have output matrix - so deliver there
         _pokeyMax7219Manager->setLedByName(targetName, value);
     }
 
-    if (result == PK_ERR_TRANSFER) {
-        printf("----> PK_ERR_TRANSFER pin %d --> %d %d (pokey: %s)\n\n", pin, (uint8_t)value, result, name().c_str());
-    }
-    else if (result == PK_ERR_GENERIC) {
-        printf("----> PK_ERR_GENERIC pin %d --> %d %d (pokey: %s)\n\n", pin, (uint8_t)value, result, name().c_str());
-    }
-    else if (result == PK_ERR_PARAMETER) {
-        printf("----> PK_ERR_PARAMETER pin %d --> %d %d (pokey: %s)\n\n", pin, (uint8_t)value, result, name().c_str());
-    }
-
     // for now always return succes as we don't want to terminate
-    // eveinting on setsingle error
-
-    return retValue;
+    // eveinting on a failed write
+    return PK_OK;
 }
 
-uint8_t PokeyDevice::displayNumber(uint8_t displayNumber, std::string targetName, int value)
+/**
+ *   @brief  records the level of an output pin, the writer thread
+ *           sends every staged output in one PK_DigitalIOSet
+ *
+ *   @return nothing
+ */
+void PokeyDevice::stageOutput(int pin, bool value)
 {
-    int groupIndex = 0;
+    uint64_t bit = 1ULL << pin;
+    uint64_t previous = value ? _outputValues.fetch_or(bit, std::memory_order_release) : _outputValues.fetch_and(~bit, std::memory_order_release);
 
-    for (int i = 0; i < MAX_MATRIX_LED_GROUPS; i++) {
-        if (_matrixLED[displayNumber].group[i].name == targetName) {
-            groupIndex = i;
-        }
+    // an output already staged at this level needs no write
+    if (((previous & bit) != 0) != value || !_outputsSentValid.load(std::memory_order_relaxed)) {
+        _outputFlusher.request();
     }
+}
 
-    // we should only display +ve values
-    if (value < -1) {
-        value = value * -1;
+/**
+ *   @brief  writes the staged outputs with one PK_DigitalIOSet unless
+ *           they match what was last sent, runs on the writer thread
+ *
+ *   @return true when the write failed and should be retried
+ */
+bool PokeyDevice::flushOutputs(void)
+{
+    uint64_t values = _outputValues.load(std::memory_order_acquire) & _outputPins.bits();
+
+    if (_outputsSentValid.load(std::memory_order_relaxed) && values == _outputsSent) {
+        return false;
     }
 
-    std::string charString = std::to_string(value);
-    int numberOfChars = charString.length();
-    int groupLength = _matrixLED[displayNumber].group[groupIndex].length;
+    PinSet pins = _outputPins;
+    int result;
 
-    if (value == 0) {
-        int position = _matrixLED[displayNumber].group[groupIndex].position;
-        for (int i = position; i < (groupLength + position); i++) {
-            _pokey->MatrixLED[displayNumber].data[i] = 0b00000000;
+    {
+        std::lock_guard<std::mutex> lock(_ioMutex);
+
+        while (!pins.empty()) {
+            int pin = pins.takeFirst();
+            _pokey->Pins[pin].DigitalValueSet = (values >> pin) & 1;
+            _pokey->Pins[pin].preventUpdate = 0;
         }
-        _pokey->MatrixLED[displayNumber].data[(position + groupLength) - 1] = _intToDisplayRow[0];
+
+        result = PK_DigitalIOSet(_pokey);
     }
 
-    if (numberOfChars <= groupLength) {
+    _outputWrites.fetch_add(1, std::memory_order_relaxed);
 
-        for (int i = 0; i < numberOfChars; i++) {
-            int displayOffset = (int)charString.at(i) - 48;
-            int convertedValue = _intToDisplayRow[displayOffset];
-            int position = groupIndex + i;
+    if (result == PK_ERR_TRANSFER) {
+        printf("----> PK_ERR_TRANSFER outputs %llx %d (pokey: %s)\n\n", (unsigned long long)values, result, name().c_str());
+    }
+    else if (result == PK_ERR_GENERIC) {
+        printf("----> PK_ERR_GENERIC outputs %llx %d (pokey: %s)\n\n", (unsigned long long)values, result, name().c_str());
+    }
+    else if (result == PK_ERR_PARAMETER) {
+        printf("----> PK_ERR_PARAMETER outputs %llx %d (pokey: %s)\n\n", (unsigned long long)values, result, name().c_str());
+    }
 
-            if (value > 0) {
-                _matrixLED[displayNumber].group[groupIndex].value = convertedValue;
-                _pokey->MatrixLED[displayNumber].data[position] = convertedValue;
-            }
-            else if (value == -1) {
-                for (int i = groupIndex; i < groupLength + groupIndex; i++) {
-                    _pokey->MatrixLED[displayNumber].data[i] = 0b00000000;
-                }
+    if (result != PK_OK) {
+        return true;
+    }
+
+    _outputsSent = values;
+    _outputsSentValid.store(true, std::memory_order_relaxed);
+
+    return false;
+}
+
+/**
+ *   @brief  renders the groups staged since the last frame and sends
+ *           the changed displays, runs on the display refresh thread
+ *
+ *   @return true when the update failed and should be retried
+ */
+bool PokeyDevice::flushDisplays(void)
+{
+    bool refresh = false;
+    int retValue;
+
+    // the frame is rendered into _pokey->MatrixLED, which the update
+    // sends, so both happen under the device lock
+    {
+        std::lock_guard<std::mutex> lock(_ioMutex);
+
+        for (int i = 0; i < MAX_MATRIX_LEDS && i < _pokey->info.iMatrixLED; i++) {
+            if (_displays[i].render(_pokey->MatrixLED[i].data)) {
+                _pokey->MatrixLED[i].RefreshFlag = 1;
             }
+
+            // a display that failed to update last frame is still flagged
+            refresh = refresh || _pokey->MatrixLED[i].RefreshFlag;
         }
-    }
 
-    _pokey->MatrixLED[displayNumber].RefreshFlag = 1;
+        if (!refresh) {
+            return false;
+        }
 
-    int retValue = PK_MatrixLEDUpdate(_pokey);
+        retValue = PK_MatrixLEDUpdate(_pokey);
+    }
 
     if (retValue == PK_ERR_TRANSFER) {
         printf("----> PK_ERR_TRANSFER %i\n\n", retValue);
@@ -638,7 +754,7 @@ uint8_t PokeyDevice::displayNumber(uint8_t displayNumber, std::string targetName
         printf("----> PK_ERR_PARAMETER pin %i\n\n", retValue);
     }
 
-    return retValue;
+    return retValue != PK_OK;
 }
 
 int PokeyDevice::configSwitchMatrix(int id, std::string name, std::string type, bool enabled)
@@ -653,19 +769,20 @@ int PokeyDevice::configSwitchMatrix(int id, std::string name, std::string type,
 int PokeyDevice::configSwitchMatrixSwitch(int switchMatrixId, int switchId, std::string name, int pin, int enablePin, bool invert, bool invertEnablePin)
 {
     std::shared_ptr<PokeySwitchMatrix> matrix = _switchMatrixManager->matrix(switchMatrixId);
-    matrix->addSwitch(switchId, name, pin, enablePin, invert, invertEnablePin);
+    matrix->addSwitch(switchId, name, _owner->elementId(name), pin, enablePin, invert, invertEnablePin);
     return 0;
 }
 
 int PokeyDevice::configSwitchMatrixVirtualPin(int switchMatrixId, std::string name, bool invert, PinMaskMap &virtualPinMask, std::map<int, std::string> &valueTransforms)
 {
     std::shared_ptr<PokeySwitchMatrix> matrix = _switchMatrixManager->matrix(switchMatrixId);
-    matrix->addVirtualPin(name, invert, virtualPinMask, valueTransforms);
+    matrix->addVirtualPin(name, _owner->elementId(name), invert, virtualPinMask, valueTransforms);
     return 0;
 }
 
 uint32_t PokeyDevice::outputPin(uint8_t pin)
 {
+    std::lock_guard<std::mutex> lock(_ioMutex);
     _pokey->Pins[--pin].PinFunction = PK_PinCap_digitalOutput | PK_PinCap_invertPin;
     return PK_PinConfigurationSet(_pokey);
 }
@@ -678,6 +795,7 @@ uint32_t PokeyDevice::inputPin(uint8_t pin, bool invert)
         pinSetting = pinSetting | PK_PinCap_invertPin;
     }
 
+    std::lock_guard<std::mutex> lock(_ioMutex);
     _pokey->Pins[--pin].PinFunction = pinSetting;
     return PK_PinConfigurationSet(_pokey);
 }
@@ -685,19 +803,21 @@ uint32_t PokeyDevice::inputPin(uint8_t pin, bool invert)
 uint32_t PokeyDevice::inactivePin(uint8_t pin)
 {
     int pinSetting = PK_PinCap_pinRestricted;
+    std::lock_guard<std::mutex> lock(_ioMutex);
     return PK_PinConfigurationSet(_pokey);
 }
 
 int32_t PokeyDevice::name(std::string name)
 {
+    std::lock_guard<std::mutex> lock(_ioMutex);
     strncpy((char *)_pokey->DeviceData.DeviceName, name.c_str(), 30);
     return PK_DeviceNameSet(_pokey);
 }
 
-uint8_t PokeyDevice::displayFromName(std::string targetName)
+uint8_t PokeyDevice::displayFromElement(ElementID targetId)
 {
-    std::map<std::string, int>::iterator it;
-    it = _displayMap.find(targetName);
+    std::map<ElementID, int>::iterator it;
+    it = _displayMap.find(targetId);
 
     if (it != _displayMap.end()) {
         return it->second;
@@ -708,10 +828,10 @@ uint8_t PokeyDevice::displayFromName(std::string targetName)
     }
 }
 
-int PokeyDevice::pinIndexFromName(std::string targetName)
+int PokeyDevice::pinIndexFromElement(ElementID targetId)
 {
     for (size_t i = 0; i < MAX_PINS; i++) {
-        if (_pins[i].pinName == targetName) {
+        if (_pins[i].elementId == targetId) {
             return _pins[i].pinIndex;
         }
     }
@@ -719,10 +839,10 @@ int PokeyDevice::pinIndexFromName(std::string targetName)
     return -1;
 }
 
-int PokeyDevice::pinFromName(std::string targetName)
+int PokeyDevice::pinFromElement(ElementID targetId)
 {
-    std::map<std::string, int>::iterator it;
-    it = _pinMap.find(targetName);
+    std::map<ElementID, int>::iterator it;
+    it = _pinMap.find(targetId);
 
     if (it != _pinMap.end()) {
         return it->second;
@@ -731,9 +851,9 @@ int PokeyDevice::pinFromName(std::string targetName)
         return -1;
 }
 
-void PokeyDevice::mapNameToPin(std::string name, int pin)
+void PokeyDevice::mapElementToPin(ElementID elementId, int pin)
 {
-    _pinMap.emplace(name, pin);
+    _pinMap.emplace(elementId, pin);
 }
 
 void PokeyDevice::mapNameToEncoder(std::string name, int encoderNumber)
@@ -741,17 +861,19 @@ void PokeyDevice::mapNameToEncoder(std::string name, int encoderNumber)
     _encoderMap.emplace(name, encoderNumber);
 }
 
-void PokeyDevice::mapNameToMatrixLED(std::string name, int id)
+void PokeyDevice::mapElementToMatrixLED(ElementID elementId, int id)
 {
-    _displayMap.emplace(name, id);
+    _displayMap.emplace(elementId, id);
 }
 
 bool PokeyDevice::isPinDigitalOutput(uint8_t pin)
 {
+    std::lock_guard<std::mutex> lock(_ioMutex);
     return (bool)PK_CheckPinCapability(_pokey, pin, PK_AllPinCap_digitalOutput);
 }
 
 bool PokeyDevice::isPinDigitalInput(uint8_t pin)
 {
+    std::lock_guard<std::mutex> lock(_ioMutex);
     return (bool)PK_CheckPinCapability(_pokey, pin, PK_AllPinCap_digitalInput);
 }
@@ -1,7 +1,12 @@
 #ifndef __POKEYDEVICE_H
 #define __POKEYDEVICE_H
 
+#include "FrameFlusher/FrameFlusher.h"
+#include "PinSet/PinSet.h"
+#include "EncoderAccumulator/EncoderAccumulator.h"
 #include "PoKeysLib.h"
+#include "PollScheduler/PollScheduler.h"
+#include "SegmentDisplay/SegmentDisplay.h"
 #include "common/simhubdeviceplugin.h"
 #include "drivers/PokeyMAX7219Manager/PokeyMAX7219Manager.h"
 #include "drivers/PokeySwitchMatrixManager/PokeySwitchMatrixManager.h"
@@ -9,13 +14,16 @@
 #include <cmath>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <stdlib.h>
 #include <thread>
 #include <unistd.h>
 #include <uv.h>
 
-#define DEVICE_READ_INTERVAL 100
+#define DEVICE_READ_INTERVAL POLL_DEFAULT_INTERVAL
 #define DEVICE_START_DELAY 1000
+#define DEVICE_WRITE_INTERVAL 10 ///< ms, staged digital outputs are written at most once per interval
+#define DEVICE_DISPLAY_INTERVAL 33 ///< ms, matrix LED displays refresh at ~30Hz
 #define ENCODER_1 1
 #define ENCODER_2 2
 #define ENCODER_3 3
@@ -29,7 +37,6 @@
 #define MAX_ENCODERS 10
 #define MAX_MATRIX_LEDS 2
 #define MAX_MATRIX_LED_GROUPS 8
-#define MAX_DIGITS 10
 #define MAX_PWM_CHANNELS 6
 #define MAX_SWITCH_MATRIX 10
 #define MAX_SWITCH_MATRIX_SWITCHES 256
@@ -37,6 +44,7 @@
 
 typedef struct {
     std::string pinName;
+    ElementID elementId;
     int pinNumber;
     int pinIndex;
     std::string type;
@@ -45,27 +53,22 @@ typedef struct {
     uint8_t defaultValue;
     uint8_t value;
     uint8_t previousValue;
-    bool skipNext;
 } device_port_t;
 
 typedef struct {
     std::string name;
+    ElementID elementId;
     int number;
     std::string description;
     std::string units;
-    std::string type; // relative or absolute
     int32_t defaultValue;
-    int32_t value;
-    int32_t previousValue;
-    int32_t previousEncoderValue;
-    int32_t min;
-    int32_t max;
-    int32_t step;
+    EncoderAccumulator accumulator; ///< value, limits and type, relative or absolute
 } device_encoder_t;
 
 typedef struct {
     uint8_t position;
     std::string name;
+    ElementID elementId;
     uint8_t length;
     uint8_t value;
 } device_matrixLED_group_t;
@@ -77,6 +80,12 @@ typedef struct {
     device_matrixLED_group_t group[MAX_MATRIX_LED_GROUPS];
 } device_matrixLED_t;
 
+//! display group a value element is shown on
+typedef struct {
+    int8_t display;
+    int8_t group;
+} device_display_target_t;
+
 typedef struct {
     uint8_t id;
     std::string name;
@@ -119,9 +128,9 @@ protected:
     uint8_t _hardwareType;
     uint8_t _dhcp;
 
-    std::map<std::string, int> _pinMap;
+    std::map<ElementID, int> _pinMap;
     std::map<std::string, int> _encoderMap;
-    std::map<std::string, int> _displayMap;
+    std::map<ElementID, int> _displayMap;
     std::map<std::string, int> _pwmMap;
     std::map<std::string, int> _ledMatrix;
 
@@ -129,29 +138,51 @@ protected:
     std::shared_ptr<PokeyMAX7219Manager> _pokeyMax7219Manager;
 
     sPoKeysDevice *_pokey;
+    std::mutex _ioMutex; ///< held for every PK_* call on _pokey, the poll, writer and display threads share the device
     void *_callbackArg;
     SPHANDLE _pluginInstance;
     device_port_t _pins[MAX_PINS];
+    PinSet _digitalInputs; ///< indexes of the pins configured as DIGITAL_INPUT
+    PinSet _inputValues; ///< packed copy of _pins[i].value, kept by setPinValue
+    PinSet _outputPins; ///< pin numbers - 1 of the pins configured as DIGITAL_OUTPUT
+    std::atomic<uint64_t> _outputValues; ///< staged output levels, by pin number - 1
+    uint64_t _outputsSent; ///< levels of the last successful PK_DigitalIOSet, writer thread only
+    std::atomic<bool> _outputsSentValid;
+    std::atomic<uint64_t> _outputUpdates; ///< output values delivered
+    std::atomic<uint64_t> _outputWrites; ///< PK_DigitalIOSet transactions
     device_pwm_t _pwm[MAX_PWM_CHANNELS];
     device_encoder_t _encoders[MAX_ENCODERS];
     device_matrixLED_t _matrixLED[MAX_MATRIX_LEDS];
-    uint8_t _intToDisplayRow[MAX_DIGITS];
+    SegmentDisplay _displays[MAX_MATRIX_LEDS];
+    std::vector<device_display_target_t> _displayTargets; ///< indexed by ElementID
 
     EnqueueEventHandler _enqueueCallback;
 
     std::shared_ptr<std::thread> _pollThread;
     uv_loop_t *_pollLoop;
     uv_timer_t _pollTimer;
+    bool _pollReady; ///< all pins were reset so inputs can be polled
+    bool _sharedPolling; ///< polled by the plugin's PollScheduler rather than its own loop
+    PollPolicy _pollPolicy;
+    LatencyHistogram _inputLatency; ///< bound on the time from an input change to its event
+    std::chrono::steady_clock::time_point _lastPollStart;
+    FrameFlusher _outputFlusher; ///< writes the staged digital outputs off the event thread
+    FrameFlusher _displayFlusher; ///< refreshes the matrix LED displays once per frame
 
-    int pinFromName(std::string targetName);
+    int pinFromElement(ElementID targetId);
     bool makeAllPinsInactive(); // disable all pins
-    int pinIndexFromName(std::string targetName);
-    uint8_t displayFromName(std::string targetName);
-    uint8_t displayNumber(uint8_t displayNumwber, std::string targetName, int value);
+    int pinIndexFromElement(ElementID targetId);
+    uint8_t displayFromElement(ElementID targetId);
     void processPokeyPhysicalInputPin(int i);
     void processEncoderInputValues(void);
     void processMatrixInputValues(void);
     void pollCallback(uv_timer_t *timer, int status);
+    bool readInputs(void);
+    void setPinValue(int pinIndex, uint8_t value);
+    PinSet changedInputs(void);
+    void stageOutput(int pin, bool value);
+    bool flushOutputs(void);
+    bool flushDisplays(void);
 
     std::shared_ptr<PokeySwitchMatrixManager> _switchMatrixManager;
 
@@ -162,15 +193,16 @@ public:
     bool ownsPin(std::string pinName);
     bool validatePinCapability(int, std::string);
     bool validateEncoder(int encoderNumber);
-    void mapNameToPin(std::string name, int pin);
+    void mapElementToPin(ElementID elementId, int pin);
     void mapNameToEncoder(std::string name, int encoderNumber);
-    void mapNameToMatrixLED(std::string name, int id);
+    void mapElementToMatrixLED(ElementID elementId, int id);
 
-    uint32_t targetValue(std::string targetName, bool value);
-    uint32_t targetValue(std::string targetName, int value);
+    uint32_t targetValue(ElementID targetId, const char *targetName, bool value);
+    uint32_t targetValue(ElementID targetId, const char *targetName, int value);
     uint32_t inputPin(uint8_t pin, bool invert = false);
     uint32_t outputPin(uint8_t pin);
     uint32_t inactivePin(uint8_t pin); // make a pin inactive
+    void enqueuePinValue(ElementID elementId, const char *pinName, bool value);
 
     int32_t name(std::string name);
 
@@ -190,6 +222,7 @@ public:
     device_port_t *pins(void) { return _pins; };
     device_encoder_t *encoders() { return _encoders; };
     sPoKeysDevice *pokey() { return _pokey; }
+    std::mutex &ioMutex() { return _ioMutex; }
     sPoKeysDevice_Info info() { return _pokey->info; }
     sPoKeysMatrixLED *matrixLED() { return _pokey->MatrixLED; };
 
@@ -201,14 +234,18 @@ public:
         return _pokey->DeviceData;
     }
 
-    uint8_t loadPinConfiguration() { return PK_PinConfigurationGet(_pokey); }
+    uint8_t loadPinConfiguration()
+    {
+        std::lock_guard<std::mutex> lock(_ioMutex);
+        return PK_PinConfigurationGet(_pokey);
+    }
     bool isPinDigitalOutput(uint8_t pin);
     bool isPinDigitalInput(uint8_t pin);
     bool isEncoderCapable(int pin);
     void addPin(int pindex, std::string name, int pinNumber, std::string pinType, int defaultValue, std::string description, bool invert);
     void addEncoder(int encoderNumber, uint32_t defaultValue, std::string name = DEFAULT_ENCODER_NAME, std::string description = DEFAULT_ENCODER_DESCRIPTION,
         int min = DEFAULT_ENCODER_MIN, int max = DEFAULT_ENCODER_MAX, int step = DEFAULT_ENCODER_STEP, int invertDirection = DEFAULT_ENCODER_DIRECTION, std::string units = "",
-        std::string type = "relative");
+        EncoderType type = ENCODER_RELATIVE, EncoderAccelerationCurve acceleration = EncoderAccelerationCurve());
 
     void addMatrixLED(int id, std::string name, std::string type);
     void configMatrixLED(int id, int rows, int cols = 8, int enabled = 0);
@@ -222,8 +259,25 @@ public:
     // led matrix "handlers"
     void configMatrix(int id, uint8_t chipSelect, std::string type, uint8_t enabled = 0, std::string name = "", std::string description = "");
     void addLedToLedMatrix(int ledMatrixIndex, uint8_t ledIndex, std::string name, std::string description, uint8_t enabled, uint8_t row, uint8_t col);
+    std::shared_ptr<PokeyMAX7219Manager> max7219Manager(void) { return _pokeyMax7219Manager; };
+
+    //! round trips avoided compared to one PK_DigitalIOSetSingle per output value
+    uint64_t outputWritesSaved(void)
+    {
+        uint64_t updates = _outputUpdates.load(std::memory_order_relaxed);
+        uint64_t writes = _outputWrites.load(std::memory_order_relaxed);
+        return updates > writes ? updates - writes : 0;
+    };
+
+    // input polling
+    void setPollPolicy(PollPolicy policy) { _pollPolicy = policy; };
+    PollPolicy &pollPolicy(void) { return _pollPolicy; };
+    void setSharedPolling(bool shared) { _sharedPolling = shared; };
+    bool sharedPolling(void) { return _sharedPolling; };
+    LatencyHistogram &inputLatency(void) { return _inputLatency; };
+    bool poll(void);
 
-    void startPolling();
+    void startPolling(PollScheduler *sharedScheduler);
     void stopPolling();
     std::string name();
 };
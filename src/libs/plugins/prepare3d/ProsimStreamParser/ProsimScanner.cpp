@@ -0,0 +1,129 @@
+#include <assert.h>
+
+#include "ProsimScanner.h"
+
+#if defined(PROSIM_SCAN_X86)
+#include <immintrin.h>
+#endif
+
+void ProsimScanScalar(const char *data, size_t length, ProsimScanResult *result)
+{
+    assert(length <= PROSIM_SCAN_CHUNK);
+
+    result->newlineCount = 0;
+    result->equalsCount = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] == '\n') {
+            result->newlines[result->newlineCount++] = i;
+        }
+        else if (data[i] == '=') {
+            result->equals[result->equalsCount++] = i;
+        }
+    }
+}
+
+#if defined(PROSIM_SCAN_X86)
+
+//! appends the offset of every set bit of mask
+static inline size_t appendOffsets(uint32_t mask, uint32_t base, uint32_t *offsets, size_t count)
+{
+    while (mask) {
+        offsets[count++] = base + __builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+
+    return count;
+}
+
+static inline void scanTail(const char *data, size_t start, size_t length, ProsimScanResult *result)
+{
+    for (size_t i = start; i < length; i++) {
+        if (data[i] == '\n') {
+            result->newlines[result->newlineCount++] = i;
+        }
+        else if (data[i] == '=') {
+            result->equals[result->equalsCount++] = i;
+        }
+    }
+}
+
+__attribute__((target("sse2"))) void ProsimScanSSE2(const char *data, size_t length, ProsimScanResult *result)
+{
+    assert(length <= PROSIM_SCAN_CHUNK);
+
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i equals = _mm_set1_epi8('=');
+    size_t i = 0;
+
+    result->newlineCount = 0;
+    result->equalsCount = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+        uint32_t newlineMask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        uint32_t equalsMask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, equals));
+
+        result->newlineCount = appendOffsets(newlineMask, i, result->newlines, result->newlineCount);
+        result->equalsCount = appendOffsets(equalsMask, i, result->equals, result->equalsCount);
+    }
+
+    scanTail(data, i, length, result);
+}
+
+__attribute__((target("avx2"))) void ProsimScanAVX2(const char *data, size_t length, ProsimScanResult *result)
+{
+    assert(length <= PROSIM_SCAN_CHUNK);
+
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i equals = _mm256_set1_epi8('=');
+    size_t i = 0;
+
+    result->newlineCount = 0;
+    result->equalsCount = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+        uint32_t newlineMask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+        uint32_t equalsMask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, equals));
+
+        result->newlineCount = appendOffsets(newlineMask, i, result->newlines, result->newlineCount);
+        result->equalsCount = appendOffsets(equalsMask, i, result->equals, result->equalsCount);
+    }
+
+    scanTail(data, i, length, result);
+}
+
+#endif
+
+ProsimScanFunction ProsimSelectScanner(void)
+{
+#if defined(PROSIM_SCAN_X86)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return ProsimScanAVX2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return ProsimScanSSE2;
+    }
+#endif
+
+    return ProsimScanScalar;
+}
+
+const char *ProsimScannerName(ProsimScanFunction scanner)
+{
+#if defined(PROSIM_SCAN_X86)
+    if (scanner == ProsimScanAVX2) {
+        return "avx2";
+    }
+
+    if (scanner == ProsimScanSSE2) {
+        return "sse2";
+    }
+#endif
+
+    return "scalar";
+}
@@ -0,0 +1,35 @@
+#ifndef __PROSIM_SCANNER_H
+#define __PROSIM_SCANNER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define PROSIM_SCAN_CHUNK 4096 ///< most bytes scanned per call
+
+/**
+ * offsets (relative to the scanned data) of every line terminator and
+ * field separator, both in ascending order
+ */
+typedef struct {
+    uint32_t newlines[PROSIM_SCAN_CHUNK];
+    size_t newlineCount;
+    uint32_t equals[PROSIM_SCAN_CHUNK];
+    size_t equalsCount;
+} ProsimScanResult;
+
+//! scans up to PROSIM_SCAN_CHUNK bytes for '\n' and '=' in a single pass
+typedef void (*ProsimScanFunction)(const char *data, size_t length, ProsimScanResult *result);
+
+void ProsimScanScalar(const char *data, size_t length, ProsimScanResult *result);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROSIM_SCAN_X86
+void ProsimScanSSE2(const char *data, size_t length, ProsimScanResult *result);
+void ProsimScanAVX2(const char *data, size_t length, ProsimScanResult *result);
+#endif
+
+//! widest scanner the cpu we're running on supports
+ProsimScanFunction ProsimSelectScanner(void);
+const char *ProsimScannerName(ProsimScanFunction scanner);
+
+#endif
@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+#include "ProsimStreamParser.h"
+
+//! element types indexed by the first char of the element name
+static const struct ProsimTypeTable {
+    ConfigType types[256];
+
+    ProsimTypeTable(void)
+    {
+        // unknown identifiers are passed through as strings
+        for (int i = 0; i < 256; i++) {
+            types[i] = CONFIG_STRING;
+        }
+
+        types[(uint8_t)GAUGE_IDENTIFIER] = CONFIG_FLOAT;
+        types[(uint8_t)NUMBER_IDENTIFIER] = CONFIG_INT;
+        types[(uint8_t)INDICATOR_IDENTIFIER] = CONFIG_BOOL;
+        types[(uint8_t)VALUE_IDENTIFIER] = CONFIG_UINT;
+        types[(uint8_t)ANALOG_IDENTIFIER] = CONFIG_STRING;
+        types[(uint8_t)ROTARY_IDENTIFIER] = CONFIG_STRING;
+        types[(uint8_t)BOOLEAN_IDENTIFIER] = CONFIG_BOOL;
+        types[(uint8_t)SWITCH_IDENTIFIER] = CONFIG_BOOL;
+        types[(uint8_t)ENCODER_IDENTIFIER] = CONFIG_FLOAT;
+    }
+} TypeTable;
+
+static const double PowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool ParseProsimInt(const char *begin, const char *end, int *value)
+{
+    const char *p = begin;
+    bool negative = false;
+    int64_t result = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    if (p == end) {
+        return false;
+    }
+
+    for (; p < end; p++) {
+        if (!isDigit(*p)) {
+            return false;
+        }
+
+        result = result * 10 + (*p - '0');
+
+        if (result > (int64_t)INT32_MAX + 1) {
+            return false;
+        }
+    }
+
+    result = negative ? -result : result;
+
+    if (result > INT32_MAX) {
+        return false;
+    }
+
+    *value = (int)result;
+
+    return true;
+}
+
+bool ParseProsimFloat(const char *begin, const char *end, float *value)
+{
+    const char *p = begin;
+    bool negative = false;
+    bool anyDigits = false;
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    for (; p < end && isDigit(*p); p++) {
+        anyDigits = true;
+
+        if (significantDigits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            significantDigits += mantissa > 0;
+        }
+        else {
+            exponent++;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        for (p++; p < end && isDigit(*p); p++) {
+            anyDigits = true;
+
+            if (significantDigits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                significantDigits += mantissa > 0;
+                exponent--;
+            }
+        }
+    }
+
+    if (!anyDigits) {
+        return false;
+    }
+
+    if (p < end) {
+        if (*p != 'e' && *p != 'E') {
+            return false;
+        }
+
+        // exponents are rare enough to leave to libc - the token is
+        // NUL terminated by the time it gets here
+        char *strtodEnd;
+        double result = strtod(begin, &strtodEnd);
+
+        if (strtodEnd != end) {
+            return false;
+        }
+
+        *value = (float)result;
+
+        return true;
+    }
+
+    double result = (double)mantissa;
+
+    if (exponent < 0) {
+        if (-exponent > 22) {
+            return false;
+        }
+
+        result /= PowersOfTen[-exponent];
+    }
+    else if (exponent > 0) {
+        if (exponent > 22) {
+            return false;
+        }
+
+        result *= PowersOfTen[exponent];
+    }
+
+    *value = (float)(negative ? -result : result);
+
+    return true;
+}
+
+ProsimStreamParser::ProsimStreamParser(size_t capacity)
+    : _capacity(capacity)
+    , _mask(capacity - 1)
+    , _readPos(0)
+    , _scanPos(0)
+    , _writePos(0)
+    , _lineEquals(PROSIM_NO_POSITION)
+    , _discarding(false)
+    , _scanner(ProsimSelectScanner())
+    , _elementCount(0)
+    , _malformedCount(0)
+    , _overflowCount(0)
+{
+    assert(capacity > PROSIM_MAX_LINE_LEN && (capacity & (capacity - 1)) == 0);
+
+    _buffer.reset(new char[capacity]);
+}
+
+ConfigType ProsimStreamParser::TypeForIdentifier(char identifier)
+{
+    return TypeTable.types[(uint8_t)identifier];
+}
+
+void ProsimStreamParser::writableRegion(char **base, size_t *length)
+{
+    if (_writePos - _readPos == _capacity) {
+        // a single line filled the whole ring - drop it and skip
+        // whatever is left of it in the following reads
+        _readPos = _scanPos = _writePos;
+        _lineEquals = PROSIM_NO_POSITION;
+        _discarding = true;
+        _overflowCount++;
+    }
+
+    size_t offset = _writePos & _mask;
+    size_t free = _capacity - (_writePos - _readPos);
+
+    *base = &_buffer[offset];
+    *length = std::min(free, _capacity - offset);
+}
+
+void ProsimStreamParser::commit(size_t length)
+{
+    assert(_writePos - _readPos + length <= _capacity);
+    _writePos += length;
+}
+
+//! parses the line ending at newline (an absolute position) and moves past it
+void ProsimStreamParser::dispatchLine(size_t newline, ProsimElementHandler handler, void *arg)
+{
+    size_t length = newline - _readPos;
+    size_t offset = _readPos & _mask;
+    size_t equalsOffset = _lineEquals != PROSIM_NO_POSITION ? _lineEquals - _readPos : PROSIM_NO_POSITION;
+
+    if (_discarding) {
+        _discarding = false;
+    }
+    else if (offset + length < _capacity) {
+        // the newline itself is overwritten when the line is tokenised
+        char *line = &_buffer[offset];
+        parseLine(line, length, equalsOffset != PROSIM_NO_POSITION ? line + equalsOffset : NULL, handler, arg);
+    }
+    else if (length <= PROSIM_MAX_LINE_LEN) {
+        size_t head = _capacity - offset;
+
+        memcpy(_line, &_buffer[offset], head);
+        memcpy(_line + head, &_buffer[0], length - head);
+        parseLine(_line, length, equalsOffset != PROSIM_NO_POSITION ? _line + equalsOffset : NULL, handler, arg);
+    }
+    else {
+        _malformedCount++;
+    }
+
+    _readPos = newline + 1;
+    _lineEquals = PROSIM_NO_POSITION;
+}
+
+size_t ProsimStreamParser::parse(ProsimElementHandler handler, void *arg)
+{
+    uint64_t elementCount = _elementCount;
+
+    while (_scanPos < _writePos) {
+        size_t offset = _scanPos & _mask;
+        size_t span = std::min(std::min(_writePos - _scanPos, _capacity - offset), (size_t)PROSIM_SCAN_CHUNK);
+        size_t equals = 0;
+
+        _scanner(&_buffer[offset], span, &_scanResult);
+
+        // walk both offset lists in step - the first '=' of each line
+        // is its field separator
+        for (size_t i = 0; i < _scanResult.newlineCount; i++) {
+            size_t newline = _scanPos + _scanResult.newlines[i];
+
+            for (; equals < _scanResult.equalsCount && _scanPos + _scanResult.equals[equals] < newline; equals++) {
+                if (_lineEquals == PROSIM_NO_POSITION) {
+                    _lineEquals = _scanPos + _scanResult.equals[equals];
+                }
+            }
+
+            dispatchLine(newline, handler, arg);
+        }
+
+        // anything left belongs to a line that is still arriving
+        if (equals < _scanResult.equalsCount && _lineEquals == PROSIM_NO_POSITION) {
+            _lineEquals = _scanPos + _scanResult.equals[equals];
+        }
+
+        _scanPos += span;
+    }
+
+    return _elementCount - elementCount;
+}
+
+size_t ProsimStreamParser::feed(const char *data, size_t length, ProsimElementHandler handler, void *arg)
+{
+    size_t retVal = 0;
+
+    while (length > 0) {
+        char *base;
+        size_t space;
+
+        writableRegion(&base, &space);
+        space = std::min(space, length);
+
+        memcpy(base, data, space);
+        commit(space);
+
+        retVal += parse(handler, arg);
+        data += space;
+        length -= space;
+    }
+
+    return retVal;
+}
+
+void ProsimStreamParser::reset(void)
+{
+    _readPos = _scanPos = _writePos;
+    _lineEquals = PROSIM_NO_POSITION;
+    _discarding = false;
+}
+
+/**
+ * tokenises "NAME = value" in place - equals is the first '=' found by
+ * the scanner (NULL if there is none) and line[length] must be writable
+ * as it may receive the terminator of the value
+ */
+void ProsimStreamParser::parseLine(char *line, size_t length, char *equals, ProsimElementHandler handler, void *arg)
+{
+    char *end = line + length;
+
+    while (line < end && isSpace(*line)) {
+        line++;
+    }
+
+    while (end > line && isSpace(end[-1])) {
+        end--;
+    }
+
+    // blank lines separate the updates
+    if (end - line <= 2) {
+        return;
+    }
+
+    if (!equals || equals >= end) {
+        _malformedCount++;
+        return;
+    }
+
+    char *nameEnd = equals;
+
+    while (nameEnd > line && isSpace(nameEnd[-1])) {
+        nameEnd--;
+    }
+
+    char *value = equals + 1;
+
+    while (value < end && (isSpace(*value) || *value == '=')) {
+        value++;
+    }
+
+    char *valueEnd = value;
+
+    while (valueEnd < end && !isSpace(*valueEnd) && *valueEnd != '=') {
+        valueEnd++;
+    }
+
+    if (nameEnd == line || valueEnd == value) {
+        _malformedCount++;
+        return;
+    }
+
+    *nameEnd = '\0';
+    *valueEnd = '\0';
+
+    ProsimElement element;
+
+    element.name = line;
+    element.nameLength = nameEnd - line;
+    element.type = TypeForIdentifier(line[0]);
+    element.valueLength = valueEnd - value;
+
+    switch (element.type) {
+    case CONFIG_FLOAT:
+        if (!ParseProsimFloat(value, valueEnd, &element.value.float_value)) {
+            _malformedCount++;
+            return;
+        }
+        break;
+
+    case CONFIG_INT:
+    case CONFIG_UINT:
+        if (!ParseProsimInt(value, valueEnd, &element.value.int_value)) {
+            float floatValue;
+
+            // some numbers arrive formatted as decimals
+            if (!ParseProsimFloat(value, valueEnd, &floatValue)) {
+                _malformedCount++;
+                return;
+            }
+
+            element.value.int_value = (int)floatValue;
+        }
+        break;
+
+    case CONFIG_BOOL:
+        element.value.bool_value = !(element.valueLength == 1 && value[0] == '0');
+        break;
+
+    default:
+        element.value.string_value = value;
+        break;
+    }
+
+    _elementCount++;
+    handler(&element, arg);
+}
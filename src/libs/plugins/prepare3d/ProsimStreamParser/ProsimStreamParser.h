@@ -0,0 +1,117 @@
+#ifndef __PROSIM_STREAM_PARSER_H
+#define __PROSIM_STREAM_PARSER_H
+
+#include <memory>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ProsimScanner.h"
+#include "plugins/common/simhubdeviceplugin.h"
+
+#define PROSIM_PARSER_BUFFER_LEN 65536 ///< must be a power of two
+#define PROSIM_MAX_LINE_LEN 512 ///< longest line that may wrap around the end of the ring
+#define PROSIM_NO_POSITION ((size_t)-1)
+
+#define GAUGE_IDENTIFIER 'G'
+#define NUMBER_IDENTIFIER 'N'
+#define INDICATOR_IDENTIFIER 'I'
+#define VALUE_IDENTIFIER 'V'
+#define ANALOG_IDENTIFIER 'A'
+#define ROTARY_IDENTIFIER 'R'
+#define BOOLEAN_IDENTIFIER 'B'
+#define SWITCH_IDENTIFIER 'S'
+#define ENCODER_IDENTIFIER 'E'
+
+//! one "NAME = value" line - name and string_value point into the parser's buffer
+typedef struct {
+    const char *name; ///< NUL terminated
+    size_t nameLength;
+    ConfigType type;
+    VariantUnion value;
+    size_t valueLength; ///< length of the value token
+} ProsimElement;
+
+typedef void (*ProsimElementHandler)(ProsimElement *element, void *arg);
+
+//! strict integer parse of [begin, end) - false unless the whole range is a number
+bool ParseProsimInt(const char *begin, const char *end, int *value);
+
+//! strict decimal parse of [begin, end) - false unless the whole range is a number
+bool ParseProsimFloat(const char *begin, const char *end, float *value);
+
+/**
+ * Incremental parser for the line based ProSim TCP stream
+ *
+ * - socket reads land directly in a ring buffer (see writableRegion /
+ *   commit) so bytes are never copied on the normal path
+ * - new bytes are scanned once, in chunks, by a vectorised scanner that
+ *   reports the offsets of every '\n' and '=' - lines are then cut
+ *   at those offsets rather than searched again
+ * - complete lines are tokenised in place, lines split across reads
+ *   simply wait in the ring for the rest of their bytes
+ * - the type of an element comes from a table indexed by the first
+ *   char of its name, numbers are parsed without going through libc
+ * - a line that wraps around the end of the ring is the only thing
+ *   copied (into a small line buffer)
+ *
+ * The element handed to the handler is only valid for the duration of
+ * the call.
+ */
+class ProsimStreamParser
+{
+protected:
+    std::unique_ptr<char[]> _buffer;
+    size_t _capacity;
+    size_t _mask;
+    size_t _readPos; ///< start of the first unparsed line
+    size_t _scanPos; ///< bytes before this have been scanned
+    size_t _writePos; ///< end of the committed bytes
+    size_t _lineEquals; ///< first '=' of the line at _readPos, PROSIM_NO_POSITION if none seen yet
+    bool _discarding; ///< dropping the rest of a line that overflowed the ring
+    char _line[PROSIM_MAX_LINE_LEN + 1];
+
+    ProsimScanFunction _scanner;
+    ProsimScanResult _scanResult;
+
+    // statistics
+    uint64_t _elementCount;
+    uint64_t _malformedCount;
+    uint64_t _overflowCount;
+
+    void dispatchLine(size_t newline, ProsimElementHandler handler, void *arg);
+    void parseLine(char *line, size_t length, char *equals, ProsimElementHandler handler, void *arg);
+
+public:
+    ProsimStreamParser(size_t capacity = PROSIM_PARSER_BUFFER_LEN);
+
+    ProsimStreamParser(const ProsimStreamParser &) = delete; // disable copying
+    ProsimStreamParser &operator=(const ProsimStreamParser &) = delete; // disable assignment
+
+    static ConfigType TypeForIdentifier(char identifier);
+
+    //! defaults to the widest scanner the cpu supports
+    void setScanner(ProsimScanFunction scanner) { _scanner = scanner; };
+    ProsimScanFunction scanner(void) const { return _scanner; };
+
+    //! contiguous free space for the next read - makes room by dropping data if the ring is full
+    void writableRegion(char **base, size_t *length);
+
+    //! marks length bytes written into the last writableRegion as received
+    void commit(size_t length);
+
+    //! dispatches every complete line received so far - returns the number of elements
+    size_t parse(ProsimElementHandler handler, void *arg);
+
+    //! copies data into the ring and parses it - for callers that don't read into writableRegion
+    size_t feed(const char *data, size_t length, ProsimElementHandler handler, void *arg);
+
+    //! drops any partially received line
+    void reset(void);
+
+    size_t buffered(void) const { return _writePos - _readPos; };
+    uint64_t elementCount(void) const { return _elementCount; };
+    uint64_t malformedCount(void) const { return _malformedCount; };
+    uint64_t overflowCount(void) const { return _overflowCount; };
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include <assert.h>
+#include <string.h>
+
+#include "ProsimWriteQueue.h"
+
+ProsimWriteQueue::ProsimWriteQueue(size_t highWater, size_t maxPending)
+    : _writeInFlight(false)
+    , _closed(false)
+    , _highWater(highWater)
+    , _maxPending(maxPending)
+    , _recordCount(0)
+    , _batchCount(0)
+    , _droppedCount(0)
+{
+    _pending.reserve(highWater);
+    _writing.reserve(highWater);
+}
+
+bool ProsimWriteQueue::append(const char *name, const std::string &value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t before = _pending.size();
+
+    if (_closed || before >= _maxPending) {
+        _droppedCount++;
+        return false;
+    }
+
+    _pending.append(name, strlen(name));
+    _pending += '=';
+    _pending.append(value);
+    _pending += '\n';
+    _recordCount++;
+
+    // a write in flight picks up whatever is pending when it completes
+    if (_writeInFlight) {
+        return false;
+    }
+
+    return before == 0 || (before < _highWater && _pending.size() >= _highWater);
+}
+
+bool ProsimWriteQueue::full(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending.size() >= _highWater;
+}
+
+bool ProsimWriteQueue::takeBatch(const char **data, size_t *length)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_writeInFlight || _pending.empty()) {
+        return false;
+    }
+
+    // swapping keeps the capacity of both buffers so steady state
+    // appends don't allocate
+    _pending.swap(_writing);
+    _pending.clear();
+    _writeInFlight = true;
+    _batchCount++;
+
+    *data = _writing.data();
+    *length = _writing.size();
+
+    return true;
+}
+
+bool ProsimWriteQueue::writeComplete(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    assert(_writeInFlight);
+    _writeInFlight = false;
+    _writing.clear();
+
+    return !_pending.empty();
+}
+
+void ProsimWriteQueue::close(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _closed = true;
+    _pending.clear();
+}
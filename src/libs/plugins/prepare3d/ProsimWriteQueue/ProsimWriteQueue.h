@@ -0,0 +1,70 @@
+#ifndef __PROSIM_WRITE_QUEUE_H
+#define __PROSIM_WRITE_QUEUE_H
+
+#include <mutex>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+#define PROSIM_WRITE_MAX_LATENCY_MS 2 ///< default longest a record waits to be coalesced
+#define PROSIM_WRITE_HIGH_WATER 16384 ///< pending bytes that force a write without waiting
+#define PROSIM_WRITE_MAX_PENDING (64 * PROSIM_WRITE_HIGH_WATER) ///< pending bytes beyond which records are dropped
+
+/**
+ * Coalesces the "NAME=value\n" records sent to ProSim so that many
+ * of them go out in a single write
+ *
+ * - records are appended from whichever thread delivers values, they
+ *   are formatted straight into the pending buffer
+ * - the event loop takes everything pending as one batch, the batch
+ *   stays owned by the queue until the write completes so nothing is
+ *   copied for the write itself
+ * - while a write is in flight new records keep gathering in the
+ *   other buffer and become the next batch
+ *
+ * The queue has no idea about sockets or timers, append tells the
+ * caller when the loop needs waking and the loop decides when to take
+ * a batch. Records are dropped and counted rather than kept once the
+ * queue is closed or maxPending bytes are waiting, so a connection
+ * that's gone or never comes up can't grow it without bound.
+ */
+class ProsimWriteQueue
+{
+protected:
+    std::mutex _mutex;
+    std::string _pending; ///< records waiting for the next batch
+    std::string _writing; ///< batch owned by the write in flight
+    bool _writeInFlight;
+    bool _closed;
+    size_t _highWater;
+    size_t _maxPending;
+
+    // statistics
+    uint64_t _recordCount;
+    uint64_t _batchCount;
+    uint64_t _droppedCount;
+
+public:
+    ProsimWriteQueue(size_t highWater = PROSIM_WRITE_HIGH_WATER, size_t maxPending = PROSIM_WRITE_MAX_PENDING);
+
+    //! appends name=value\n, true when the loop should be woken to schedule a write - false when it's dropped
+    bool append(const char *name, const std::string &value);
+
+    //! true when enough is pending that the loop shouldn't wait any longer
+    bool full(void);
+
+    //! hands out everything pending, false if there's nothing or a write is still in flight
+    bool takeBatch(const char **data, size_t *length);
+
+    //! releases the batch, true if more records arrived in the meantime
+    bool writeComplete(void);
+
+    //! drops anything pending and every record appended from now on, once the connection has gone away
+    void close(void);
+
+    uint64_t recordCount(void) { return _recordCount; };
+    uint64_t batchCount(void) { return _batchCount; };
+    uint64_t droppedCount(void) { return _droppedCount; };
+};
+
+#endif
@@ -1,12 +1,9 @@
 #include <assert.h>
-#include <iostream>
 #include <memory>
-#include <sstream>
 #include <vector>
 #include <thread>
 
 #include "common/simhubdeviceplugin.h"
-#include "elements/attributes/attribute.h"
 #include "main.h"
 
 using namespace std::chrono_literals;
@@ -14,6 +11,11 @@ using namespace std::chrono_literals;
 // -- public C FFI
 
 extern "C" {
+int simplug_abi_version(void)
+{
+    return SIMPLUG_ABI_VERSION;
+}
+
 int simplug_init(SPHANDLE *plugin_instance, LoggingFunctionCB logger)
 {
     *plugin_instance = new SimSourcePluginStateManager(logger);
@@ -25,6 +27,11 @@ int simplug_config_passthrough(SPHANDLE plugin_instance, void *libconfig_instanc
     return static_cast<PluginStateManager *>(plugin_instance)->configPassthrough(static_cast<libconfig::Config *>(libconfig_instance));
 }
 
+void simplug_bind_symbol_resolver(SPHANDLE plugin_instance, SymbolResolverCB resolver, void *arg)
+{
+    static_cast<PluginStateManager *>(plugin_instance)->bindSymbolResolver(resolver, arg);
+}
+
 int simplug_preflight_complete(SPHANDLE plugin_instance)
 {
     return static_cast<PluginStateManager *>(plugin_instance)->preflightComplete();
@@ -40,6 +47,11 @@ int simplug_deliver_value(SPHANDLE plugin_instance, GenericTLV *value)
     return static_cast<PluginStateManager *>(plugin_instance)->deliverValue(value);
 }
 
+int simplug_deliver_values(SPHANDLE plugin_instance, GenericTLV **values, int count)
+{
+    return static_cast<PluginStateManager *>(plugin_instance)->deliverValues(values, count);
+}
+
 void simplug_cease_eventing(SPHANDLE plugin_instance)
 {
     static_cast<PluginStateManager *>(plugin_instance)->ceaseEventing();
@@ -56,9 +68,14 @@ void simplug_release(SPHANDLE plugin_instance)
 
 SimSourcePluginStateManager *SimSourcePluginStateManager::_StateManagerInstance = NULL;
 
+//! reads go straight into the free space of the parser's ring buffer
 void SimSourcePluginStateManager::AllocBuffer(uv_handle_t *handle, size_t size, uv_buf_t *buf)
 {
-    *buf = SimSourcePluginStateManager::StateManagerInstance()->_readBuffer;
+    char *base;
+    size_t length;
+
+    SimSourcePluginStateManager::StateManagerInstance()->_parser.writableRegion(&base, &length);
+    *buf = uv_buf_init(base, length);
 }
 
 //! static getter for singleton instance of our class
@@ -75,25 +92,19 @@ SimSourcePluginStateManager::SimSourcePluginStateManager(LoggingFunctionCB logge
     assert(!_StateManagerInstance);
 
     _StateManagerInstance = this;
+    _eventLoop = NULL;
     _processedElementCount = 0;
+    _maxWriteLatency = PROSIM_WRITE_MAX_LATENCY_MS;
+    _connected = false;
+    _writeWakeupClosed = true;
+    _writeWakeupSenders = 0;
     _name = "prepar3d";
-
-    if (!(_rawBuffer = (char *)malloc(BUFFER_LEN))) {
-        printf("Unable to allocate buffer of size %d", BUFFER_LEN);
-    }
-    else {
-        _readBuffer = ::uv_buf_init(_rawBuffer, BUFFER_LEN);
-    }
 }
 
 SimSourcePluginStateManager::~SimSourcePluginStateManager(void)
 {
     ceaseEventing();
 
-    if (_rawBuffer != NULL) {
-        free(_rawBuffer);
-    }
-
     _StateManagerInstance = NULL;
 }
 
@@ -128,6 +139,14 @@ int SimSourcePluginStateManager::preflightComplete(void)
             iter->lookupValue("port", port);
         }
 
+        if (iter->exists("maxWriteLatency")) {
+            unsigned int maxWriteLatency;
+
+            if (iter->lookupValue("maxWriteLatency", maxWriteLatency)) {
+                _maxWriteLatency = maxWriteLatency;
+            }
+        }
+
         if (iter->exists("transforms")) {
             loadTransforms(&iter->lookup("transforms"));
         }
@@ -142,6 +161,17 @@ int SimSourcePluginStateManager::preflightComplete(void)
     check_uv(uv_tcp_init(_eventLoop, &_tcpClient));
     uv_tcp_keepalive(&_tcpClient, 1, 60);
 
+    // writes are already coalesced by the write queue, nagle would
+    // only add to their latency
+    uv_tcp_nodelay(&_tcpClient, 1);
+
+    check_uv(uv_async_init(_eventLoop, &_writeWakeup, &SimSourcePluginStateManager::OnWriteWakeup));
+    check_uv(uv_timer_init(_eventLoop, &_writeTimer));
+    _writeWakeup.data = this;
+    _writeWakeupClosed = false;
+    _writeTimer.data = this;
+    _writeReq.data = this;
+
     uv_ip4_addr(ipAddress.c_str(), port, &req_addr);
 
     // so the callback can see member values
@@ -153,12 +183,6 @@ int SimSourcePluginStateManager::preflightComplete(void)
         retVal = PREFLIGHT_FAIL;
     }
 
-    // connect to simulated prosim listener
-    _sendSocketClient.setLogger(_logger);
-    if (retVal != PREFLIGHT_FAIL && !_sendSocketClient.connect(ipAddress, port)) {
-        retVal = PREFLIGHT_FAIL;
-    }
-
     return retVal;
 }
 
@@ -177,23 +201,27 @@ void SimSourcePluginStateManager::loadTransforms(libconfig::Setting *transforms)
 
             transform.lookupValue("On", transformResultOn);
             transform.lookupValue("Off", transformResultOff);
-            _transformMap.emplace(
-                transformName, std::bind(&SimSourcePluginStateManager::transformBoolToString, this, std::placeholders::_1, transformResultOff, transformResultOn));
+
+            ElementID transformId = elementId(transformName);
+
+            if (transformId >= _transformTable.size()) {
+                _transformTable.resize(transformId + 1);
+            }
+
+            _transformTable[transformId] = std::bind(&SimSourcePluginStateManager::transformBoolToString, this, std::placeholders::_1, transformResultOff, transformResultOn);
         }
     }
 }
 
 /**
- *   @brief  Default  find a transform by element name
+ *   @brief  Default  find a transform by element id
  *
  *   @return TransformFunction or NULL if not found
  */
-TransformFunction SimSourcePluginStateManager::transform(std::string transformName)
+TransformFunction SimSourcePluginStateManager::transform(ElementID elementId)
 {
-    TransformMap::iterator it = _transformMap.find(transformName);
-
-    if (it != _transformMap.end()) {
-        return (*it).second;
+    if (elementId < _transformTable.size()) {
+        return _transformTable[elementId];
     }
 
     return NULL;
@@ -226,172 +254,147 @@ void SimSourcePluginStateManager::OnClose(uv_handle_t *handle)
     SimSourcePluginStateManager::StateManagerInstance()->instanceCloseHandler(handle);
 }
 
+void SimSourcePluginStateManager::OnWriteWakeup(uv_async_t *handle)
+{
+    static_cast<SimSourcePluginStateManager *>(handle->data)->instanceWriteWakeupHandler();
+}
+
+void SimSourcePluginStateManager::OnWriteTimer(uv_timer_t *handle)
+{
+    static_cast<SimSourcePluginStateManager *>(handle->data)->flushWrites();
+}
+
+void SimSourcePluginStateManager::OnWrite(uv_write_t *req, int status)
+{
+    static_cast<SimSourcePluginStateManager *>(req->data)->instanceWriteHandler(status);
+}
+
 void SimSourcePluginStateManager::instanceConnectionHandler(uv_connect_t *req, int status)
 {
     if (uv_is_readable(req->handle)) {
         uv_read_start(req->handle, &SimSourcePluginStateManager::AllocBuffer, &SimSourcePluginStateManager::OnRead);
+        _connected = true;
+
+        // anything delivered while connecting
+        flushWrites();
     }
     else {
         printf("not readable\n");
     }
 }
 
-void SimSourcePluginStateManager::instanceReadHandler(uv_stream_t *server, ssize_t nread, const uv_buf_t *buf)
+//! records are pending - write now if there are plenty, otherwise give others time to join them
+void SimSourcePluginStateManager::instanceWriteWakeupHandler(void)
 {
-    if (nread > 0) {
-        uv_buf_t buffer = uv_buf_init((char *)malloc(nread), nread);
-        memcpy(buffer.base, buf->base, nread);
-        buffer.base[nread - 1] = '\0';
-        processData(buffer.base, nread);
-        free(buffer.base);
+    if (_maxWriteLatency == 0 || _writeQueue.full()) {
+        flushWrites();
     }
-    else if (nread < 0) {
-        if (nread == UV_EOF) {
-            SimSourcePluginStateManager::StateManagerInstance()->_logger(LOG_INFO, " - Stopping prepare3d ingest loop");
-            stopUVLoop();
-            // deliver NULL value to indicate failure to app
-            _enqueueCallback(this, (void *)NULL, _callbackArg);
-        }
-        else {
-            SimSourcePluginStateManager::StateManagerInstance()->_logger(LOG_INFO, " - %s", uv_strerror(nread));
-            uv_close((uv_handle_t *)server, &SimSourcePluginStateManager::OnClose);
-        }
+    else if (!uv_is_active((uv_handle_t *)&_writeTimer)) {
+        uv_timer_start(&_writeTimer, &SimSourcePluginStateManager::OnWriteTimer, _maxWriteLatency, 0);
     }
 }
 
-void SimSourcePluginStateManager::processData(char *data, int len)
+//! writes everything pending as one batch, only ever called on the loop thread
+void SimSourcePluginStateManager::flushWrites(void)
 {
-    if (len > 2) {
-        int elementCount = 0;
-        char *p = strtok(data, "\n");
-        char *array[MAX_ELEMENTS_PER_UPDATE];
+    const char *data;
+    size_t length;
 
-        while (p != NULL) {
-            size_t len = strlen(p);
+    uv_timer_stop(&_writeTimer);
 
-            if (len > 2) {
-                char *buffer = (char *)malloc(BUFFER_LEN);
-                memset(buffer, 0, BUFFER_LEN);
-                strncpy(buffer, p, len);
-                buffer[len - 1] = '\0';
-                array[elementCount++] = buffer;
-            }
+    if (!_connected || !_writeQueue.takeBatch(&data, &length)) {
+        return;
+    }
 
-            p = strtok(NULL, "\n");
-        }
+    uv_buf_t buf = uv_buf_init((char *)data, length);
+    int err = uv_write(&_writeReq, _connectReq.handle, &buf, 1, &SimSourcePluginStateManager::OnWrite);
 
-        for (int i = 0; i < elementCount; ++i) {
-            processElement(array[i]);
-            free(array[i]);
-        }
+    if (err < 0) {
+        _logger(LOG_ERROR, " - Failed to write to simulator: %s", uv_strerror(err));
+        _writeQueue.writeComplete();
     }
 }
 
-void SimSourcePluginStateManager::processElement(char *element)
+void SimSourcePluginStateManager::instanceWriteHandler(int status)
 {
-    char *name = strtok(element, "=");
-    char *value = strtok(NULL, " =");
-
-    if (value == NULL) {
-        return;
+    if (status < 0) {
+        _logger(LOG_ERROR, " - Failed to write to simulator: %s", uv_strerror(status));
     }
 
-    name[strlen(name) - 1] = '\0';
-    
-    if (strlen(name) == 0) {
-        return;
+    // whatever arrived during the write has already waited long enough
+    if (_writeQueue.writeComplete()) {
+        flushWrites();
     }
-    
-    char *type = getElementDataType(name[0]);
+}
 
-    if (type != NULL) {
-        GenericTLV *el = make_generic(name, "-");
+void SimSourcePluginStateManager::closeHandles(void)
+{
+    _connected = false;
+    closeWriter();
 
-        el->ownerPlugin = this;
+    uv_close((uv_handle_t *)&_writeTimer, &SimSourcePluginStateManager::OnClose);
+    uv_close((uv_handle_t *)&_writeWakeup, &SimSourcePluginStateManager::OnClose);
+    uv_close((uv_handle_t *)&_tcpClient, &SimSourcePluginStateManager::OnClose);
+}
 
-        if (strncmp(type, "float", sizeof(&type)) == 0) {
-            el->type = CONFIG_FLOAT;
-            el->value.float_value = atof(value);
-            el->length = sizeof(float);
-        }
-        else if (strncmp(type, "char", sizeof(&type)) == 0) {
-            el->type = CONFIG_STRING;
-            dupe_string(&(el->value.string_value), value);
-            el->length = strlen(value);
-        }
-        else if (strncmp(type, "int", sizeof(&type)) == 0) {
-            el->type = CONFIG_INT;
-            el->value.int_value = atoi(value);
-            el->length = sizeof(int);
-        }
-        else if (strncmp(type, "uint", sizeof(&type)) == 0) {
-            el->type = CONFIG_UINT;
-            el->value.int_value = (uint)atoi(value);
-            el->length = sizeof(int);
-        }
-        else if (strncmp(type, "bool", sizeof(&type)) == 0) {
-            el->type = CONFIG_BOOL;
-            el->length = sizeof(uint8_t);
-            if (strncmp(value, "0", sizeof(el->value)) == 0) {
-                el->value.bool_value = 0;
-            }
-            else {
-                el->value.bool_value = 1;
-            }
+void SimSourcePluginStateManager::instanceReadHandler(uv_stream_t *server, ssize_t nread, const uv_buf_t *buf)
+{
+    if (nread > 0) {
+        // buf is the region handed out by AllocBuffer
+        _parser.commit(nread);
+        _parser.parse(&SimSourcePluginStateManager::OnElement, this);
+    }
+    else if (nread < 0) {
+        if (nread == UV_EOF) {
+            SimSourcePluginStateManager::StateManagerInstance()->_logger(LOG_INFO, " - Stopping prepare3d ingest loop");
+            stopUVLoop();
+            // deliver NULL value to indicate failure to app
+            _enqueueCallback(this, (void *)NULL, _callbackArg);
         }
         else {
-            _logger(LOG_ERROR, "Missing prosim type mapping %s %s %s", name, value, type);
+            SimSourcePluginStateManager::StateManagerInstance()->_logger(LOG_INFO, " - %s", uv_strerror(nread));
+            closeHandles();
         }
-
-        _enqueueCallback(this, (void *)el, _callbackArg);
-
-        // TODO remove this echo test - or make it a configuartion switch
-        // deliverValue(&el);
-
-        _processedElementCount++;
     }
 }
 
-char *SimSourcePluginStateManager::getElementDataType(char identifier)
+void SimSourcePluginStateManager::OnElement(ProsimElement *element, void *arg)
 {
+    static_cast<SimSourcePluginStateManager *>(arg)->processElement(element);
+}
 
-    switch (identifier) {
-    case GAUGE_IDENTIFIER:
-        return (char *)"float";
-        break;
-    case NUMBER_IDENTIFIER:
-        return (char *)"int";
-        break;
-    case INDICATOR_IDENTIFIER:
-        return (char *)"bool";
-        break;
-    case VALUE_IDENTIFIER:
-        return (char *)"uint";
-        break;
-    case ANALOG_IDENTIFIER:
-        return (char *)"char";
-        break;
-    case ROTARY_IDENTIFIER:
-        return (char *)"char";
-        break;
-    case BOOLEAN_IDENTIFIER:
-        return (char *)"bool";
+void SimSourcePluginStateManager::processElement(ProsimElement *element)
+{
+    GenericTLV *el = pool_make_generic(&_eventPool, elementId(element->name), element->name, "-");
+
+    el->ownerPlugin = this;
+    el->type = element->type;
+
+    switch (element->type) {
+    case CONFIG_FLOAT:
+        el->value.float_value = element->value.float_value;
+        el->length = sizeof(float);
         break;
-    case SWITCH_IDENTIFIER:
-        return (char *)"bool";
+    case CONFIG_STRING:
+        generic_set_string_value(el, element->value.string_value);
+        el->length = element->valueLength;
         break;
-    case ENCODER_IDENTIFIER:
-        return (char *)"float";
+    case CONFIG_BOOL:
+        el->value.bool_value = element->value.bool_value;
+        el->length = sizeof(uint8_t);
         break;
     default:
-        //_logger(LOG_ERROR, "Missing prosim element data type %c", identifier);
+        el->value.int_value = element->value.int_value;
+        el->length = sizeof(int);
         break;
     }
 
-    return (char *)"char";
+    _enqueueCallback(this, (void *)el, _callbackArg);
+
+    _processedElementCount++;
 }
 
-std::string SimSourcePluginStateManager::prosimValueString(std::shared_ptr<Attribute> attribute)
+std::string SimSourcePluginStateManager::prosimValueString(GenericTLV *value)
 {
     std::string retVal("");
 
@@ -399,45 +402,80 @@ std::string SimSourcePluginStateManager::prosimValueString(std::shared_ptr<Attri
     // validate the type of attribute and to convert the
     // attribute value to a prosim value string
 
-    switch (attribute->name().c_str()[0]) {
+    switch (value->name[0]) {
     case SWITCH_IDENTIFIER:
     // printf("SimSourcePluginStateManager\n");
     // retVal = attribute->value<bool>() ? 0 : 1;
     // break;
 
     default:
-        retVal = attribute->valueToString();
+        retVal = GenericValueToString(value);
         break;
     }
 
     return retVal;
 }
 
-int SimSourcePluginStateManager::deliverValue(GenericTLV *value)
+//! formats value into the write queue, true if the loop needs waking to send it
+bool SimSourcePluginStateManager::queueValue(GenericTLV *value)
 {
-    std::ostringstream oss;
-    std::shared_ptr<Attribute> attribute = AttributeFromCGeneric(value);
+    TransformFunction transformFunction = transform(value->element_id != INVALID_ELEMENT_ID ? value->element_id : elementId(value->name));
+
+    if (transformFunction) {
+        return _writeQueue.append(value->name, transformFunction(GenericValueToString(value), "NULL", "NULL"));
+    }
 
-    TransformFunction transformFunction = transform(attribute->name());
-    std::string val = "";
+    return _writeQueue.append(value->name, prosimValueString(value));
+}
+
+/**
+ * wakes the loop from a delivering thread - the loop thread may be
+ * closing the handle meanwhile, so senders announce themselves before
+ * checking the closed flag and closeWriter waits for them to leave
+ */
+void SimSourcePluginStateManager::wakeWriter(void)
+{
+    _writeWakeupSenders.fetch_add(1, std::memory_order_seq_cst);
 
-    if (value->type == CONFIG_STRING) {
-        std::cout << "::deliverValue just got value with name: " << value->name << " and value " << value->value.string_value << std::endl;
+    if (!_writeWakeupClosed.load(std::memory_order_seq_cst)) {
+        uv_async_send(&_writeWakeup);
     }
-    else if (value->type == CONFIG_BOOL) {
-        std::cout << "::deliverValue just got value with name: " << value->name << " and value " << value->value.bool_value << std::endl;
+
+    _writeWakeupSenders.fetch_sub(1, std::memory_order_release);
+}
+
+//! stops taking records for the simulator, after this no thread touches _writeWakeup
+void SimSourcePluginStateManager::closeWriter(void)
+{
+    _writeQueue.close();
+    _writeWakeupClosed.store(true, std::memory_order_seq_cst);
+
+    while (_writeWakeupSenders.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
     }
+}
 
-    if (transformFunction) {
-        val = transformFunction(attribute->valueToString(), "NULL", "NULL");
-        oss << attribute->name() << "=" << val << "\n";
+int SimSourcePluginStateManager::deliverValue(GenericTLV *value)
+{
+    if (queueValue(value)) {
+        wakeWriter();
     }
-    else {
-        oss << attribute->name() << "=" << prosimValueString(attribute) << "\n";
+
+    return 0;
+}
+
+//! queues the whole batch, the loop writes it with the other pending records
+int SimSourcePluginStateManager::deliverValues(GenericTLV **values, int count)
+{
+    bool wake = false;
+
+    for (int i = 0; i < count; i++) {
+        wake |= queueValue(values[i]);
     }
 
-    // printf("SimSourcePluginStateManager::deliverValue %s %s\n", oss.str().c_str(), val.c_str());
-    _sendSocketClient.sendData(oss.str());
+    if (wake) {
+        wakeWriter();
+    }
 
     return 0;
 }
@@ -451,6 +489,8 @@ void SimSourcePluginStateManager::instanceCloseHandler(uv_handle_t *handle)
 
 void SimSourcePluginStateManager::stopUVLoop(void)
 {
+    closeWriter();
+
     if (_eventLoop) {
         uv_stop(_eventLoop);
         uv_loop_close(_eventLoop);
@@ -466,6 +506,10 @@ void SimSourcePluginStateManager::ceaseEventing(void)
         if (_pluginThread->joinable()) {
             _pluginThread->join();
         }
+
+        if (_writeQueue.droppedCount() > 0) {
+            _logger(LOG_INFO, " - %lu value(s) for the simulator were dropped while it wasn't connected", (unsigned long)_writeQueue.droppedCount());
+        }
     }
 }
 
@@ -475,109 +519,3 @@ void SimSourcePluginStateManager::commenceEventing(EnqueueEventHandler enqueueCa
     _callbackArg = arg;
     _pluginThread = std::make_shared<std::thread>([=] { check_uv(uv_run(_eventLoop, UV_RUN_DEFAULT)); });
 }
-
-// -- simple socket send/receive wrapper
-
-TCPClient::TCPClient(void)
-{
-    _sock = -1;
-    _port = 0;
-    _address = "";
-}
-
-void TCPClient::setLogger(LoggingFunctionCB logger)
-{
-    _logger = logger;
-}
-
-/**
-    Connect to a host on a certain port number
-*/
-bool TCPClient::connect(std::string address, int port)
-{
-    bool retVal = true;
-
-    _address = address;
-    _port = port;
-
-    // create socket if it is not already created
-    if (_sock == -1) {
-        _sock = socket(AF_INET, SOCK_STREAM, 0);
-
-        if (_sock == -1) {
-            perror("Could not create socket");
-            retVal = false;
-        }
-    }
-
-    // setup address structure
-    if (inet_addr(_address.c_str()) == -1) {
-        struct hostent *he;
-        struct in_addr **addr_list;
-
-        // resolve the hostname, its not an ip address
-        if ((he = gethostbyname(_address.c_str())) == NULL) {
-            herror("gethostbyname");
-            _logger(LOG_ERROR, "Failed to resolve hostname %s", _address.c_str());
-            retVal = false;
-        }
-        else {
-            // cast the h_addr_list to in_addr , since h_addr_list also has the ip
-            // address in long format only
-
-            addr_list = (struct in_addr **)he->h_addr_list;
-            for (int i = 0; addr_list[i] != NULL; i++) {
-                _server.sin_addr = *addr_list[i];
-                _logger(LOG_INFO, "prepar3d hostname resolved to %s", inet_ntoa(*addr_list[i]));
-                break;
-            }
-        }
-    }
-    else {
-        _server.sin_addr.s_addr = inet_addr(address.c_str());
-    }
-
-    _server.sin_family = AF_INET;
-    _server.sin_port = htons(port);
-
-    // connect to remote server
-    if (::connect(_sock, (struct sockaddr *)&_server, sizeof(_server)) < 0) {
-        perror("connect failed. Error");
-        retVal = false;
-    }
-
-    if (retVal)
-        _logger(LOG_INFO, "<SimSourcePlugin> Connected to %s:%d", address.c_str(), port);
-
-    return retVal;
-}
-
-/**
-    Send data to the connected host
-*/
-bool TCPClient::sendData(std::string data)
-{
-    // Send some data
-    if (send(_sock, data.c_str(), data.size(), 0) < 0) {
-        perror("Send failed : ");
-        return false;
-    }
-
-    return true;
-}
-
-/**
-    Receive data from the connected host
-*/
-std::string TCPClient::receive(int size = 512)
-{
-    char buffer[size];
-    std::string reply;
-
-    // Receive a reply from the server
-    if (recv(_sock, buffer, sizeof(buffer), 0) < 0)
-        puts("recv failed");
-
-    reply = buffer;
-    return reply;
-}
@@ -2,29 +2,18 @@
 #define __SIMSOURCE_MAIN_H
 
 #include "common/private/pluginstatemanager.h"
+#include "ProsimStreamParser/ProsimStreamParser.h"
+#include "ProsimWriteQueue/ProsimWriteQueue.h"
 
-#include <arpa/inet.h>
+#include <atomic>
 #include <errno.h>
 #include <map>
-#include <netdb.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/socket.h>
 #include <thread>
 #include <uv.h>
-
-#define BUFFER_LEN 4096
-#define MAX_ELEMENTS_PER_UPDATE 1024
-#define GAUGE_IDENTIFIER 'G'
-#define NUMBER_IDENTIFIER 'N'
-#define INDICATOR_IDENTIFIER 'I'
-#define VALUE_IDENTIFIER 'V'
-#define ANALOG_IDENTIFIER 'A'
-#define ROTARY_IDENTIFIER 'R'
-#define BOOLEAN_IDENTIFIER 'B'
-#define SWITCH_IDENTIFIER 'S'
-#define ENCODER_IDENTIFIER 'E'
+#include <vector>
 
 #define SIM_CONNECT_NOT_FOUND -61
 
@@ -37,41 +26,27 @@
         }                                                                                                                                                                          \
     } while (0)
 
-/**
- * simple tcp socket wrapper class
- */
-class TCPClient
-{
-private:
-    int _sock;
-    std::string _address;
-    int _port;
-    struct sockaddr_in _server;
-    LoggingFunctionCB _logger;
-
-public:
-    TCPClient(void);
-    bool connect(std::string, int);
-    bool sendData(std::string data);
-    std::string receive(int);
-    void setLogger(LoggingFunctionCB logger);
-};
-
 // every function pointer will be stored as this type
 // typedef void (*voidFunctionType)(void);
 typedef std::function<std::string(std::string, std::string, std::string)> TransformFunction;
-typedef std::map<std::string, TransformFunction> TransformMap;
+typedef std::vector<TransformFunction> TransformTable; ///< indexed by ElementID
 
 //! barest specialisation of the internal plugin management support base class
 class SimSourcePluginStateManager : public PluginStateManager
 {
 private:
     uv_loop_t *_eventLoop; ///< main libuv event loop
-    uv_buf_t _readBuffer; ///< tcp read buffer
     uv_tcp_t _tcpClient; ///< TCPClient
     uv_connect_t _connectReq;
-    char *_rawBuffer; ///< raw buffer for the tcp loop
-    TCPClient _sendSocketClient;
+    ProsimStreamParser _parser; ///< owns the tcp read buffer
+    ProsimWriteQueue _writeQueue; ///< values on their way to ProSim
+    uv_async_t _writeWakeup; ///< tells the loop records are pending
+    std::atomic<bool> _writeWakeupClosed; ///< set before _writeWakeup is closed, see wakeWriter
+    std::atomic<int> _writeWakeupSenders; ///< delivering threads inside wakeWriter
+    uv_timer_t _writeTimer; ///< bounds how long records wait to be coalesced
+    uv_write_t _writeReq;
+    uint64_t _maxWriteLatency; ///< ms, 0 writes on the next loop iteration
+    bool _connected;
 
     // statistics
     long _processedElementCount;
@@ -86,21 +61,30 @@ private:
     static void OnRead(uv_stream_t *server, ssize_t nread, const uv_buf_t *buf);
     static void OnClose(uv_handle_t *handle);
     static void OnConnect(uv_connect_t *req, int status);
+    static void OnWriteWakeup(uv_async_t *handle);
+    static void OnWriteTimer(uv_timer_t *handle);
+    static void OnWrite(uv_write_t *req, int status);
 
     void instanceReadHandler(uv_stream_t *server, ssize_t nread, const uv_buf_t *buf);
     void instanceCloseHandler(uv_handle_t *handle);
     void instanceConnectionHandler(uv_connect_t *req, int status);
+    void instanceWriteWakeupHandler(void);
+    void instanceWriteHandler(int status);
+    void flushWrites(void);
+    void closeHandles(void);
 
     // data element processing
-    void processData(char *data, int len);
-    void processElement(char *element);
-    char *getElementDataType(char identifier);
-    std::string prosimValueString(std::shared_ptr<Attribute> attribute);
+    static void OnElement(ProsimElement *element, void *arg);
+    void processElement(ProsimElement *element);
+    std::string prosimValueString(GenericTLV *value);
+    bool queueValue(GenericTLV *value);
+    void wakeWriter(void);
+    void closeWriter(void);
 
 protected:
-    TransformMap _transformMap;
+    TransformTable _transformTable;
     void loadTransforms(libconfig::Setting *transforms);
-    TransformFunction transform(std::string transformName);
+    TransformFunction transform(ElementID elementId);
     virtual void stopUVLoop(void);
 
 public:
@@ -111,6 +95,7 @@ public:
     void commenceEventing(EnqueueEventHandler enqueueCallback, void *arg);
     void ceaseEventing(void);
     int deliverValue(GenericTLV *value);
+    int deliverValues(GenericTLV **values, int count);
 };
 
 #endif
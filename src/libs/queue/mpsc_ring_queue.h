@@ -0,0 +1,514 @@
+#ifndef __MPSC_RING_QUEUE_H
+#define __MPSC_RING_QUEUE_H
+
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(build_linux)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "concurrent_queue.h" // ConcurrentQueueInterrupted
+
+#define MPSC_RING_DEFAULT_CAPACITY 4096
+#define MPSC_RING_SPIN_COUNT 64
+#define MPSC_RING_PAD_SIZE 64
+
+//! what a producer does when it finds the ring full
+typedef enum { OVERFLOW_BLOCK = 0, OVERFLOW_DROP_OLDEST, OVERFLOW_COALESCE } QueueOverflowPolicy;
+
+//! maps the configuration names ("block", "dropOldest", "coalesce") onto a policy
+inline bool QueueOverflowPolicyFromString(const std::string &name, QueueOverflowPolicy *policy)
+{
+    if (name == "block") {
+        *policy = OVERFLOW_BLOCK;
+    }
+    else if (name == "dropOldest") {
+        *policy = OVERFLOW_DROP_OLDEST;
+    }
+    else if (name == "coalesce") {
+        *policy = OVERFLOW_COALESCE;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Event count used to park a thread until another thread signals.
+ *
+ * Waiters announce themselves before re-checking their condition, so
+ * a signaller only pays for a wake-up (a futex syscall on linux) when
+ * somebody is actually parked - otherwise notify is a fence and a
+ * load.
+ *
+ * usage:
+ *   key = prepareWait(); if (condition) { cancelWait(); } else { commitWait(key); }
+ */
+class WakeEvent
+{
+protected:
+    std::atomic<uint32_t> _sequence;
+    std::atomic<uint32_t> _waiters;
+#if !defined(build_linux)
+    std::mutex _mutex;
+    std::condition_variable _cond;
+#endif
+
+public:
+    WakeEvent(void)
+        : _sequence(0)
+        , _waiters(0){};
+
+    uint32_t prepareWait(void)
+    {
+        _waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _sequence.load(std::memory_order_acquire);
+    }
+
+    void cancelWait(void) { _waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+    //! parks until notified (or the timeout elapses when one is given) - returns false on timeout
+    bool commitWait(uint32_t key, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max())
+    {
+        bool retVal = true;
+
+#if defined(build_linux)
+        struct timespec ts;
+        struct timespec *tsp = NULL;
+
+        if (timeout != std::chrono::nanoseconds::max()) {
+            ts.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(timeout).count();
+            ts.tv_nsec = (timeout - std::chrono::seconds(ts.tv_sec)).count();
+            tsp = &ts;
+        }
+
+        if (_sequence.load(std::memory_order_acquire) == key) {
+            long err = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&_sequence), FUTEX_WAIT_PRIVATE, key, tsp, NULL, 0);
+            retVal = !(err < 0 && errno == ETIMEDOUT);
+        }
+#else
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (timeout == std::chrono::nanoseconds::max()) {
+            _cond.wait(lock, [&] { return _sequence.load(std::memory_order_acquire) != key; });
+        }
+        else {
+            retVal = _cond.wait_for(lock, timeout, [&] { return _sequence.load(std::memory_order_acquire) != key; });
+        }
+#endif
+
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
+        return retVal;
+    }
+
+    //! wakes every parked thread - cheap when there are none
+    void notifyAll(void)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (_waiters.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+#if defined(build_linux)
+        _sequence.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&_sequence), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _sequence.fetch_add(1, std::memory_order_release);
+        }
+        _cond.notify_all();
+#endif
+    }
+};
+
+/**
+ * Bounded multi-producer/single-consumer queue built on a power of
+ * two ring of sequenced cells (after Dmitry Vyukov's bounded queue).
+ *
+ * - producers claim a cell with a single CAS and never take a lock on
+ *   the normal path; the consumer is only woken when it is parked
+ * - a full ring is handled according to the overflow policy:
+ *     OVERFLOW_BLOCK      - producer parks until the consumer frees a cell
+ *     OVERFLOW_DROP_OLDEST - producer discards the oldest queued item
+ *     OVERFLOW_COALESCE    - producer spills into a side table keyed by
+ *                            coalesceKey, where a newer value replaces an
+ *                            older one with the same key (latest wins)
+ * - pop/unblock behave exactly like ConcurrentQueue: once unblocked,
+ *   pop throws ConcurrentQueueInterrupted
+ * - items the queue throws away (dropped from the head, or pushed after
+ *   unblock) are handed to the drop callback when one is set
+ */
+template <typename T> class MPSCRingQueue
+{
+public:
+    typedef std::function<std::string(const T &)> CoalesceKeyFunction;
+    typedef std::function<void(const T &)> DropFunction;
+
+protected:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> _buffer;
+    size_t _mask;
+    QueueOverflowPolicy _policy;
+    CoalesceKeyFunction _coalesceKey;
+    DropFunction _onDrop;
+
+    char _pad0[MPSC_RING_PAD_SIZE];
+    std::atomic<size_t> _enqueuePos;
+    char _pad1[MPSC_RING_PAD_SIZE];
+    std::atomic<size_t> _dequeuePos;
+    char _pad2[MPSC_RING_PAD_SIZE];
+
+    std::atomic<bool> _terminated;
+    WakeEvent _itemEvent; ///< consumer parks here when the ring is empty
+    WakeEvent _spaceEvent; ///< blocked producers park here when the ring is full
+
+    // overflow side table - only touched once the ring has filled up
+    std::mutex _overflowMutex;
+    std::deque<std::string> _overflowOrder;
+    std::map<std::string, T> _overflowValues;
+    std::atomic<size_t> _overflowCount;
+
+    // statistics
+    std::atomic<uint64_t> _droppedCount;
+    std::atomic<uint64_t> _coalescedCount;
+
+    bool tryEnqueue(const T &item)
+    {
+        Cell *cell;
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell = &_buffer[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+            if (dif == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (dif < 0) {
+                return false;
+            }
+            else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // NOTE: safe for concurrent callers so that drop-oldest producers
+    //       can discard from the head alongside the consumer
+    bool tryDequeue(T &item)
+    {
+        Cell *cell;
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell = &_buffer[pos & _mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+            if (dif == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (dif < 0) {
+                return false;
+            }
+            else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+
+        if (_policy == OVERFLOW_BLOCK) {
+            _spaceEvent.notifyAll();
+        }
+
+        return true;
+    }
+
+    void discard(const T &item)
+    {
+        if (_onDrop) {
+            _onDrop(item);
+        }
+    }
+
+    void pushOverflow(const T &item)
+    {
+        assert(_coalesceKey);
+
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+        std::string key = _coalesceKey(item);
+        typename std::map<std::string, T>::iterator it = _overflowValues.find(key);
+
+        if (it != _overflowValues.end()) {
+            it->second = item;
+            _coalescedCount++;
+        }
+        else {
+            _overflowOrder.push_back(key);
+            _overflowValues.emplace(key, item);
+        }
+
+        _overflowCount.store(_overflowValues.size(), std::memory_order_release);
+    }
+
+    bool popOverflow(T &item)
+    {
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+
+        if (_overflowOrder.empty()) {
+            return false;
+        }
+
+        typename std::map<std::string, T>::iterator it = _overflowValues.find(_overflowOrder.front());
+        item = std::move(it->second);
+        _overflowValues.erase(it);
+        _overflowOrder.pop_front();
+        _overflowCount.store(_overflowValues.size(), std::memory_order_release);
+
+        return true;
+    }
+
+public:
+    MPSCRingQueue(size_t capacity = MPSC_RING_DEFAULT_CAPACITY, QueueOverflowPolicy policy = OVERFLOW_BLOCK)
+        : _mask(0)
+        , _enqueuePos(0)
+        , _dequeuePos(0)
+        , _terminated(false)
+        , _overflowCount(0)
+        , _droppedCount(0)
+        , _coalescedCount(0)
+    {
+        configure(capacity, policy);
+    }
+
+    MPSCRingQueue(const MPSCRingQueue &) = delete; // disable copying
+    MPSCRingQueue &operator=(const MPSCRingQueue &) = delete; // disable assignment
+
+    /**
+     * (re)sizes the ring - capacity is rounded up to a power of two.
+     * Must only be called before any producer or consumer is running.
+     */
+    void configure(size_t capacity, QueueOverflowPolicy policy)
+    {
+        size_t size = 2;
+
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        _buffer.reset(new Cell[size]);
+        _mask = size - 1;
+        _policy = policy;
+
+        for (size_t i = 0; i < size; i++) {
+            _buffer[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        _enqueuePos.store(0, std::memory_order_relaxed);
+        _dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    //! key used to merge values when the policy is OVERFLOW_COALESCE
+    void setCoalesceKey(CoalesceKeyFunction coalesceKey) { _coalesceKey = coalesceKey; };
+
+    //! called on the pushing thread with every item the queue throws away - set before any producer runs
+    void setDropCallback(DropFunction onDrop) { _onDrop = onDrop; };
+
+    void push(const T &item)
+    {
+        // keep FIFO order while an overflow backlog exists
+        if (_policy == OVERFLOW_COALESCE && _overflowCount.load(std::memory_order_acquire) > 0) {
+            pushOverflow(item);
+            _itemEvent.notifyAll();
+            return;
+        }
+
+        while (!tryEnqueue(item)) {
+            if (_terminated) {
+                discard(item);
+                return;
+            }
+
+            if (_policy == OVERFLOW_BLOCK) {
+                uint32_t key = _spaceEvent.prepareWait();
+
+                if (tryEnqueue(item)) {
+                    _spaceEvent.cancelWait();
+                    break;
+                }
+                else if (_terminated) {
+                    _spaceEvent.cancelWait();
+                    discard(item);
+                    return;
+                }
+
+                _spaceEvent.commitWait(key);
+            }
+            else if (_policy == OVERFLOW_DROP_OLDEST) {
+                T discarded;
+
+                if (tryDequeue(discarded)) {
+                    _droppedCount++;
+                    discard(discarded);
+                }
+            }
+            else {
+                pushOverflow(item);
+                break;
+            }
+        }
+
+        _itemEvent.notifyAll();
+    }
+
+    //! non-blocking pop - returns false when there is nothing queued
+    bool tryPop(T &item)
+    {
+        if (tryDequeue(item)) {
+            return true;
+        }
+
+        if (_overflowCount.load(std::memory_order_acquire) > 0) {
+            return popOverflow(item);
+        }
+
+        return false;
+    }
+
+    /**
+     * blocking pop with the same contract as ConcurrentQueue::pop -
+     * throws ConcurrentQueueInterrupted once unblock has been called.
+     * When a timeout is given, returns false if it elapses first.
+     */
+    bool pop(T &item, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max())
+    {
+        for (;;) {
+            if (_terminated) {
+                throw ConcurrentQueueInterrupted();
+            }
+
+            for (int spin = 0; spin < MPSC_RING_SPIN_COUNT; spin++) {
+                if (tryPop(item)) {
+                    return true;
+                }
+            }
+
+            uint32_t key = _itemEvent.prepareWait();
+
+            if (tryPop(item)) {
+                _itemEvent.cancelWait();
+                return true;
+            }
+            else if (_terminated) {
+                _itemEvent.cancelWait();
+                throw ConcurrentQueueInterrupted();
+            }
+
+            if (!_itemEvent.commitWait(key, timeout)) {
+                return false;
+            }
+        }
+    }
+
+    T pop()
+    {
+        T item;
+        pop(item);
+        return item;
+    }
+
+    /**
+     * appends up to maxItems queued items to items without blocking and
+     * returns how many were taken
+     */
+    size_t drainTo(std::vector<T> &items, size_t maxItems)
+    {
+        size_t count = 0;
+        T item;
+
+        while (count < maxItems && tryPop(item)) {
+            items.push_back(std::move(item));
+            count++;
+        }
+
+        return count;
+    }
+
+    /**
+     * blocks like pop until at least one item is available and then
+     * drains whatever else is already queued (up to maxItems in total)
+     * so a burst of events costs a single wake-up
+     */
+    size_t popBatch(std::vector<T> &items, size_t maxItems)
+    {
+        assert(maxItems > 0);
+
+        T item;
+        pop(item);
+        items.push_back(std::move(item));
+
+        return 1 + drainTo(items, maxItems - 1);
+    }
+
+    //! provide way to interrupt the blocking wait in "pop" member(s) - async signal safe on linux
+    void unblock(void)
+    {
+        _terminated = true;
+        _itemEvent.notifyAll();
+        _spaceEvent.notifyAll();
+    }
+
+    //! approximate number of queued items
+    size_t size(void)
+    {
+        size_t enqueued = _enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = _dequeuePos.load(std::memory_order_relaxed);
+        return (enqueued > dequeued ? enqueued - dequeued : 0) + _overflowCount.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity(void) { return _mask + 1; };
+    QueueOverflowPolicy overflowPolicy(void) { return _policy; };
+    uint64_t droppedCount(void) { return _droppedCount; };
+    uint64_t coalescedCount(void) { return _coalescedCount; };
+};
+
+#endif
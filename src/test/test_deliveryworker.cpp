@@ -0,0 +1,112 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "delivery/deliveryworker.h"
+
+static EventValue makeValue(ElementID id, int64_t value)
+{
+    EventValue event;
+    memset(&event, 0, sizeof(EventValue));
+    event.elementId = id;
+    event.type = INT_ATTRIBUTE;
+    event.value.int_value = value;
+    event.timestamp = EventTimestampNow();
+    return event;
+}
+
+TEST(DeliveryWorkerTest, DeliversInQueuedOrder)
+{
+    std::mutex mutex;
+    std::vector<int64_t> delivered;
+
+    DeliveryWorker worker("pokey", [&](std::vector<EventValue> &values) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (EventValue &value : values) {
+            delivered.push_back(value.value.int_value);
+        }
+
+        return true;
+    });
+
+    worker.configure({ 64, "block", 8 });
+    worker.start();
+
+    for (int i = 0; i < 50; i++) {
+        worker.push(makeValue(i % 3, i));
+    }
+
+    // stop hands over everything already queued
+    worker.stop();
+
+    ASSERT_EQ(50u, delivered.size());
+
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(i, delivered[i]);
+    }
+
+    EXPECT_EQ(50u, worker.deliveredCount());
+    EXPECT_EQ(50u, worker.queuedCount());
+}
+
+TEST(DeliveryWorkerTest, SlowDestinationDoesNotHoldUpOthers)
+{
+    std::atomic<bool> release(false);
+    std::atomic<int> fastDelivered(0);
+
+    DeliveryWorker slow("pokey", [&](std::vector<EventValue> &) {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    });
+
+    DeliveryWorker fast("prepare3d", [&](std::vector<EventValue> &values) {
+        fastDelivered += values.size();
+        return true;
+    });
+
+    slow.configure({ 4, "coalesce", 1 });
+    fast.configure({ 64, "block", 8 });
+    slow.start();
+    fast.start();
+
+    // the slow queue overflows while its destination is stuck, pushes
+    // still return straight away
+    for (int i = 0; i < 20; i++) {
+        slow.push(makeValue(1 + (i % 2), i));
+        fast.push(makeValue(7, i));
+    }
+
+    for (int i = 0; i < 1000 && fastDelivered < 20; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(20, fastDelivered);
+    EXPECT_GT(slow.coalescedCount(), 0u);
+    EXPECT_GE(slow.maxDepth(), 4u);
+
+    release = true;
+    slow.stop();
+    fast.stop();
+}
+
+TEST(DeliveryWorkerTest, UnknownPolicyFallsBackToBlock)
+{
+    DeliveryWorker worker("pokey", [](std::vector<EventValue> &) { return false; });
+
+    EXPECT_FALSE(worker.configure({ 16, "sometimes", 4 }));
+    EXPECT_EQ(OVERFLOW_BLOCK, worker.overflowPolicy());
+    EXPECT_EQ(16u, worker.capacity());
+
+    worker.start();
+    worker.push(makeValue(1, 1));
+    worker.stop();
+
+    EXPECT_EQ(1u, worker.failedCount());
+}
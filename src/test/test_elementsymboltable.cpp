@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "plugins/common/elementsymboltable.h"
+
+TEST(ElementSymbolTableTest, InternAssignsDenseStableIds)
+{
+    ElementSymbolTable symbols(8);
+
+    EXPECT_EQ(INVALID_ELEMENT_ID, symbols.find("G_MIP_FLAP"));
+
+    ElementID flap = symbols.intern("G_MIP_FLAP");
+    ElementID battery = symbols.intern("S_OH_BATTERY");
+
+    EXPECT_EQ(1, flap);
+    EXPECT_EQ(2, battery);
+    EXPECT_EQ(flap, symbols.intern("G_MIP_FLAP"));
+    EXPECT_EQ(battery, symbols.find(std::string("S_OH_BATTERY")));
+    EXPECT_EQ("G_MIP_FLAP", symbols.name(flap));
+    EXPECT_EQ(2, symbols.size());
+}
+
+TEST(ElementSymbolTableTest, InternFailsOnceFull)
+{
+    ElementSymbolTable symbols(2);
+
+    symbols.intern("A");
+    symbols.intern("B");
+
+    EXPECT_EQ(INVALID_ELEMENT_ID, symbols.intern("C"));
+    EXPECT_EQ("", symbols.name(3));
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "plugins/pokey/EncoderAccumulator/EncoderAccumulator.h"
+
+using namespace std::chrono;
+
+TEST(EncoderAccumulatorTest, OneValueForAllDetentsBetweenReads)
+{
+    EncoderAccumulator encoder;
+    steady_clock::time_point now = steady_clock::now();
+
+    encoder.configure(ENCODER_RELATIVE, 1000, 0, 2000, 10, 1000);
+
+    EXPECT_FALSE(encoder.update(1000, now));
+
+    EXPECT_TRUE(encoder.update(1007, now));
+    EXPECT_EQ(1070, encoder.value());
+
+    EXPECT_TRUE(encoder.update(1004, now + seconds(1)));
+    EXPECT_EQ(1040, encoder.value());
+
+    // clamped to the configured range
+    EXPECT_TRUE(encoder.update(1204, now + seconds(20)));
+    EXPECT_EQ(2000, encoder.value());
+    EXPECT_TRUE(encoder.update(904, now + seconds(40)));
+    EXPECT_EQ(0, encoder.value());
+}
+
+TEST(EncoderAccumulatorTest, AbsoluteSendsDetentsTurned)
+{
+    EncoderAccumulator encoder;
+    steady_clock::time_point now = steady_clock::now();
+
+    encoder.configure(ENCODER_ABSOLUTE, 0, 0, 100, 5, 10);
+
+    EXPECT_TRUE(encoder.update(13, now));
+    EXPECT_EQ(-3, encoder.value());
+
+    EXPECT_TRUE(encoder.update(12, now + seconds(1)));
+    EXPECT_EQ(1, encoder.value());
+}
+
+TEST(EncoderAccumulatorTest, CounterWrapIsASmallDelta)
+{
+    EncoderAccumulator encoder;
+
+    encoder.configure(ENCODER_RELATIVE, 50, 0, 100, 1, 0xFFFFFFFE);
+
+    EXPECT_TRUE(encoder.update(1));
+    EXPECT_EQ(53, encoder.value());
+}
+
+TEST(EncoderAccumulatorTest, AccelerationScalesFastTurns)
+{
+    EncoderAccumulator encoder;
+    steady_clock::time_point now = steady_clock::now();
+
+    encoder.configure(ENCODER_RELATIVE, 0, 0, 100000, 1, 0);
+    encoder.setAcceleration({ { 30, 20 }, { 10, 5 } });
+
+    EXPECT_EQ(1, encoder.multiplier(9));
+    EXPECT_EQ(5, encoder.multiplier(10));
+    EXPECT_EQ(20, encoder.multiplier(500));
+
+    // first movement has no speed yet
+    EXPECT_TRUE(encoder.update(1, now));
+    EXPECT_EQ(1, encoder.value());
+
+    // 1 detent in 1s is slow
+    EXPECT_TRUE(encoder.update(2, now + seconds(1)));
+    EXPECT_EQ(2, encoder.value());
+
+    // 2 detents in 100ms is 20 a second
+    EXPECT_TRUE(encoder.update(4, now + milliseconds(1100)));
+    EXPECT_EQ(12, encoder.value());
+
+    // 4 detents in 100ms is 40 a second
+    EXPECT_TRUE(encoder.update(8, now + milliseconds(1200)));
+    EXPECT_EQ(92, encoder.value());
+}
+
+TEST(EncoderAccumulatorTest, TypeResolvedFromConfiguration)
+{
+    EncoderAccumulator encoder;
+
+    EXPECT_EQ(ENCODER_UNUSED, encoder.type());
+    EXPECT_FALSE(encoder.update(5));
+
+    EXPECT_EQ(ENCODER_ABSOLUTE, EncoderAccumulator::TypeFromString("absolute"));
+    EXPECT_EQ(ENCODER_RELATIVE, EncoderAccumulator::TypeFromString("relative"));
+    EXPECT_EQ(ENCODER_RELATIVE, EncoderAccumulator::TypeFromString("fast"));
+}
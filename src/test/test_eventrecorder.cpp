@@ -0,0 +1,297 @@
+#include <chrono>
+#include <dirent.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "recorder/eventlogreader.h"
+#include "recorder/eventrecorder.h"
+
+//! recording directory under /tmp, removed with the logs in it
+class RecordingDirectory
+{
+public:
+    std::string path;
+
+    RecordingDirectory(void)
+    {
+        char pattern[] = "/tmp/simhub_recorder_XXXXXX";
+        path = mkdtemp(pattern);
+    }
+
+    ~RecordingDirectory(void)
+    {
+        DIR *directory = opendir(path.c_str());
+
+        while (struct dirent *entry = readdir(directory)) {
+            if (entry->d_name[0] != '.') {
+                unlink((path + "/" + entry->d_name).c_str());
+            }
+        }
+
+        closedir(directory);
+        rmdir(path.c_str());
+    }
+
+    EventRecorderConfiguration configuration(void)
+    {
+        EventRecorderConfiguration retVal = EventRecorder::DefaultConfiguration();
+        retVal.directory = path;
+        retVal.flushInterval = 5;
+        return retVal;
+    }
+};
+
+static EventValue makeValue(ElementID id, uint8_t type, EventOwnerID owner, int64_t timestamp)
+{
+    EventValue event;
+    memset(&event, 0, sizeof(EventValue));
+    event.elementId = id;
+    event.type = type;
+    event.owner = owner;
+    event.timestamp = timestamp;
+    return event;
+}
+
+static bool waitForRecording(EventRecorder &recorder, bool recording)
+{
+    for (int i = 0; i < 200 && recorder.recording() != recording; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    return recorder.recording() == recording;
+}
+
+TEST(EventRecorderTest, RoundTripsEveryEvent)
+{
+    RecordingDirectory directory;
+    ElementSymbolTable symbols;
+    EventStringTable strings;
+    std::vector<EventValue> recorded;
+    int64_t timestamp = EventTimestampNow();
+
+    ElementID volts = symbols.intern("N_ELEC_PANEL_LOWER_LEFT");
+    ElementID altitude = symbols.intern("N_ALTITUDE");
+    ElementID mode = symbols.intern("S_MODE");
+    ElementID gear = symbols.intern("I_GEAR");
+
+    for (int i = 0; i < 10000; i++) {
+        // plugins stamp events on their own threads, so they can arrive a little out of order
+        timestamp += i % 7 == 0 ? -500 : 20000 + i;
+
+        switch (i % 4) {
+        case 0:
+            recorded.push_back(makeValue(volts, INT_ATTRIBUTE, 1, timestamp));
+            recorded.back().value.int_value = i % 2 ? -i : i * 1000;
+            break;
+
+        case 1:
+            recorded.push_back(makeValue(altitude, FLOAT_ATTRIBUTE, 2, timestamp));
+            recorded.back().value.float_value = i * 0.25f;
+            break;
+
+        case 2:
+            recorded.push_back(makeValue(mode, STRING_ATTRIBUTE, 2, timestamp));
+            EventValueSetString(recorded.back(), i % 8 == 2 ? "ON" : "HEADING HOLD ENGAGED", strings);
+            break;
+
+        case 3:
+            recorded.push_back(makeValue(gear, BOOL_ATTRIBUTE, 1, timestamp));
+            recorded.back().value.bool_value = i % 8 == 3;
+            break;
+        }
+    }
+
+    EventRecorderConfiguration configuration = directory.configuration();
+    configuration.enabled = true;
+
+    EventRecorder recorder(symbols, strings, configuration);
+    recorder.setOwnerName(1, "pokey");
+    recorder.setOwnerName(2, "prepare3d");
+    recorder.start();
+
+    ASSERT_TRUE(waitForRecording(recorder, true));
+
+    for (size_t i = 0; i < recorded.size(); i += 256) {
+        recorder.record(&recorded[i], std::min((size_t)256, recorded.size() - i));
+    }
+
+    recorder.stop();
+
+    EXPECT_EQ(10000u, recorder.recordedCount());
+    EXPECT_EQ(0u, recorder.droppedCount());
+
+    // delta encoded timestamps and varints keep these well under the 32 bytes of an event
+    EXPECT_LT(recorder.bytesWritten(), recorded.size() * 12);
+
+    EventLogReader reader;
+    EventValue value;
+    size_t count = 0;
+
+    ASSERT_TRUE(reader.open(recorder.path()));
+
+    while (reader.next(value)) {
+        ASSERT_LT(count, recorded.size());
+
+        // long strings come back with handles of the log's own
+        if (value.flags & EVENT_FLAG_STRING_HANDLE) {
+            EventStringBuffer buffer;
+            EXPECT_EQ(EventValueString(recorded[count], strings, buffer), reader.stringValue(value.value.string_handle)) << "event " << count;
+            value.value.string_handle = recorded[count].value.string_handle;
+        }
+
+        EXPECT_EQ(0, memcmp(&recorded[count], &value, sizeof(EventValue))) << "event " << count;
+        count++;
+    }
+
+    EXPECT_EQ(recorded.size(), count);
+    EXPECT_EQ("N_ALTITUDE", reader.elementName(altitude));
+    EXPECT_EQ("prepare3d", reader.pluginName(2));
+
+    std::vector<EventLogIndexEntry> index;
+    size_t indexed = 0;
+
+    ASSERT_TRUE(reader.index(index));
+    ASSERT_FALSE(index.empty());
+    EXPECT_EQ(recorded[0].timestamp, index[0].timestamp);
+
+    for (const EventLogIndexEntry &entry : index) {
+        indexed += entry.count;
+    }
+
+    EXPECT_EQ(recorded.size(), indexed);
+}
+
+TEST(EventRecorderTest, RecordsOnlyWhileEnabled)
+{
+    RecordingDirectory directory;
+    ElementSymbolTable symbols;
+    EventStringTable strings;
+    EventRecorder recorder(symbols, strings, directory.configuration());
+    EventValue value = makeValue(symbols.intern("N_ELEMENT"), INT_ATTRIBUTE, 1, EventTimestampNow());
+
+    recorder.start();
+
+    recorder.record(value);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(0u, recorder.recordedCount());
+    EXPECT_EQ("", recorder.path());
+
+    recorder.toggleRecording();
+    ASSERT_TRUE(waitForRecording(recorder, true));
+    std::string first = recorder.path();
+
+    for (int i = 0; i < 3; i++) {
+        recorder.record(value);
+    }
+
+    recorder.toggleRecording();
+    ASSERT_TRUE(waitForRecording(recorder, false));
+    recorder.record(value);
+
+    // every recording gets a log of its own
+    recorder.setRecording(true);
+    ASSERT_TRUE(waitForRecording(recorder, true));
+    recorder.record(value);
+    recorder.stop();
+
+    EXPECT_EQ(4u, recorder.recordedCount());
+    EXPECT_NE(first, recorder.path());
+
+    EventLogReader reader;
+    size_t count = 0;
+
+    ASSERT_TRUE(reader.open(first));
+
+    while (reader.next(value)) {
+        count++;
+    }
+
+    EXPECT_EQ(3u, count);
+}
+
+TEST(EventRecorderTest, DropsRatherThanWaitForTheWriter)
+{
+    RecordingDirectory directory;
+    ElementSymbolTable symbols;
+    EventStringTable strings;
+    EventRecorderConfiguration configuration = directory.configuration();
+    std::vector<EventValue> batch;
+
+    configuration.enabled = true;
+    configuration.bufferEvents = 64;
+
+    for (int i = 0; i < 256; i++) {
+        batch.push_back(makeValue(symbols.intern("N_ELEMENT_" + std::to_string(i)), INT_ATTRIBUTE, 1, EventTimestampNow()));
+    }
+
+    EventRecorder recorder(symbols, strings, configuration);
+    recorder.start();
+    ASSERT_TRUE(waitForRecording(recorder, true));
+
+    for (int i = 0; i < 1000; i++) {
+        recorder.record(batch.data(), batch.size());
+    }
+
+    recorder.stop();
+
+    // whatever the writer couldn't keep up with is counted, and the log holds the rest
+    EXPECT_EQ(256000u, recorder.recordedCount() + recorder.droppedCount());
+
+    EventLogReader reader;
+    EventValue value;
+    uint64_t count = 0;
+
+    ASSERT_TRUE(reader.open(recorder.path()));
+
+    while (reader.next(value)) {
+        count++;
+    }
+
+    EXPECT_EQ(recorder.recordedCount(), count);
+}
+
+TEST(EventLogReaderTest, ReadsALogCutShort)
+{
+    RecordingDirectory directory;
+    ElementSymbolTable symbols;
+    EventStringTable strings;
+    EventRecorderConfiguration configuration = directory.configuration();
+    EventValue value = makeValue(symbols.intern("N_ELEMENT"), INT_ATTRIBUTE, 1, EventTimestampNow());
+
+    configuration.enabled = true;
+
+    EventRecorder recorder(symbols, strings, configuration);
+    recorder.start();
+    ASSERT_TRUE(waitForRecording(recorder, true));
+
+    for (int i = 0; i < 100; i++) {
+        value.value.int_value = i;
+        recorder.record(value);
+    }
+
+    recorder.stop();
+
+    // lose the trailer, the index and part of the events
+    std::string path = recorder.path();
+    ASSERT_EQ(0, truncate(path.c_str(), recorder.bytesWritten() / 2));
+
+    EventLogReader reader;
+    std::vector<EventLogIndexEntry> index;
+    int64_t count = 0;
+
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_FALSE(reader.index(index));
+
+    // the complete blocks are still read, in order
+    while (reader.next(value)) {
+        EXPECT_EQ(count, value.value.int_value);
+        count++;
+    }
+
+    EXPECT_LT(count, 100);
+}
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "elements/events/eventvalue.h"
+
+TEST(EventStringTableTest, ShortStringsTravelInline)
+{
+    EventStringTable strings(4);
+    EventStringBuffer buffer;
+    EventValue event;
+
+    memset(&event, 0, sizeof(EventValue));
+    EventValueSetString(event, "HDG SEL", strings);
+
+    EXPECT_FALSE(event.flags & EVENT_FLAG_STRING_HANDLE);
+    EXPECT_STREQ("HDG SEL", EventValueString(event, strings, buffer));
+
+    EventValueSetString(event, "VERTICAL SPEED 1200", strings);
+
+    EXPECT_TRUE(event.flags & EVENT_FLAG_STRING_HANDLE);
+    EXPECT_STREQ("VERTICAL SPEED 1200", EventValueString(event, strings, buffer));
+}
+
+TEST(EventStringTableTest, ReusedSlotsExpireRatherThanAlias)
+{
+    EventStringTable strings(4);
+    EventStringBuffer buffer;
+    std::vector<StringHandle> handles;
+
+    for (int i = 0; i < 6; i++) {
+        handles.push_back(strings.store(("FREE FORM MESSAGE " + std::to_string(i)).c_str()));
+    }
+
+    // the two oldest slots were reused for the last two strings
+    EXPECT_FALSE(strings.load(handles[0], buffer));
+    EXPECT_STREQ("", buffer);
+    EXPECT_FALSE(strings.load(handles[1], buffer));
+    EXPECT_EQ(2u, strings.expiredCount());
+
+    ASSERT_TRUE(strings.load(handles[5], buffer));
+    EXPECT_STREQ("FREE FORM MESSAGE 5", buffer);
+}
+
+TEST(EventStringTableTest, CutsShortStringsLongerThanASlot)
+{
+    EventStringTable strings(4);
+    EventStringBuffer buffer;
+    std::string message(EVENT_STRING_SLOT_SIZE * 2, 'X');
+
+    ASSERT_TRUE(strings.load(strings.store(message.c_str()), buffer));
+    EXPECT_EQ(EVENT_STRING_SLOT_SIZE - 1, strlen(buffer));
+    EXPECT_EQ(1u, strings.truncatedCount());
+}
+
+TEST(EventStringTableTest, ConcurrentStoresNeverTearStrings)
+{
+    static const int PRODUCERS = 4;
+    static const int STORES = 20000;
+
+    EventStringTable strings(8);
+    std::atomic<int> running(PRODUCERS);
+    std::atomic<StringHandle> latest(INVALID_STRING_HANDLE);
+    std::vector<std::thread> producers;
+
+    // every string is one character repeated, so a torn copy mixes them
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.push_back(std::thread([&, p] {
+            for (int i = 0; i < STORES; i++) {
+                std::string value(16 + i % 64, (char)('A' + p));
+                latest = strings.store(value.c_str());
+            }
+            running--;
+        }));
+    }
+
+    EventStringBuffer buffer;
+
+    while (running > 0) {
+        if (strings.load(latest, buffer)) {
+            size_t length = strlen(buffer);
+
+            EXPECT_GE(length, 16u);
+            EXPECT_EQ(length, strspn(buffer, std::string(1, buffer[0]).c_str()));
+        }
+    }
+
+    for (auto &producer : producers) {
+        producer.join();
+    }
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <string>
+
+#include "elements/events/eventvalue.h"
+
+TEST(EventValueTest, RoundTripsThroughCGeneric)
+{
+    ElementSymbolTable symbols(8);
+    EventStringTable strings(8);
+    GenericTLVPool pool;
+
+    generic_pool_init(&pool);
+
+    ElementID mode = symbols.intern("S_MCP_MODE");
+    GenericTLV *source = pool_make_string_generic(&pool, mode, "S_MCP_MODE", "-", "HDG");
+
+    EventValue event = EventValueFromCGeneric(source, 2, strings);
+    release_generic(source);
+
+    EXPECT_EQ(mode, event.elementId);
+    EXPECT_EQ(STRING_ATTRIBUTE, event.type);
+    EXPECT_EQ(2, event.owner);
+    EXPECT_EQ("HDG", EventValueToString(event, strings));
+
+    GenericTLV *delivered = EventValueToCGeneric(event, symbols, strings, &pool);
+
+    EXPECT_STREQ("S_MCP_MODE", delivered->name);
+    EXPECT_EQ(CONFIG_STRING, delivered->type);
+    EXPECT_STREQ("HDG", delivered->value.string_value);
+
+    release_generic(delivered);
+    generic_pool_destroy(&pool);
+}
+
+TEST(EventValueTest, AttributeFacadeMatchesValue)
+{
+    ElementSymbolTable symbols(8);
+    EventStringTable strings(8);
+    EventValue event;
+
+    memset(&event, 0, sizeof(EventValue));
+    event.elementId = symbols.intern("G_MIP_FLAP");
+    event.type = FLOAT_ATTRIBUTE;
+    event.value.float_value = 2.5f;
+
+    std::shared_ptr<Attribute> attribute = AttributeFromEventValue(event, symbols, strings, NULL);
+
+    EXPECT_EQ("G_MIP_FLAP", attribute->name());
+    EXPECT_EQ(2.5f, attribute->value<float>());
+    EXPECT_EQ(EventValueToString(event, strings), attribute->valueToString());
+}
@@ -0,0 +1,85 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "plugins/pokey/FrameFlusher/FrameFlusher.h"
+
+using namespace std::chrono_literals;
+
+TEST(FrameFlusherTest, BurstIsFlushedOncePerFrame)
+{
+    std::atomic<int> staged(0);
+    std::atomic<int> flushed(0);
+    std::atomic<int> flushes(0);
+
+    FrameFlusher flusher(
+        [&] {
+            flushed = staged.load();
+            flushes++;
+            return false;
+        },
+        50);
+
+    flusher.start();
+
+    // the first change is sent straight away, the rest of the burst
+    // lands inside that frame and goes out together
+    for (int i = 1; i <= 40; i++) {
+        staged = i;
+        flusher.request();
+    }
+
+    for (int i = 0; i < 200 && flushed.load() != 40; i++) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    flusher.stop();
+
+    EXPECT_EQ(40, flushed.load());
+    EXPECT_LE(flushes.load(), 2);
+    EXPECT_EQ(40, flusher.requestCount());
+    EXPECT_EQ(flushes.load(), flusher.flushCount());
+}
+
+TEST(FrameFlusherTest, FailedFlushIsRetried)
+{
+    std::atomic<int> attempts(0);
+
+    FrameFlusher flusher([&] { return ++attempts < 3; }, 1);
+
+    flusher.start();
+    flusher.request();
+
+    for (int i = 0; i < 200 && attempts.load() < 3; i++) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    flusher.stop();
+
+    EXPECT_EQ(3, attempts.load());
+}
+
+TEST(FrameFlusherTest, StopFlushesWhatIsStaged)
+{
+    std::atomic<int> flushes(0);
+
+    FrameFlusher flusher(
+        [&] {
+            flushes++;
+            return false;
+        },
+        1000);
+
+    flusher.start();
+    flusher.request();
+
+    for (int i = 0; i < 200 && flushes.load() < 1; i++) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    // inside the frame hold off, so only stop can send this one
+    flusher.request();
+    flusher.stop();
+
+    EXPECT_EQ(2, flushes.load());
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "plugins/common/simhubdeviceplugin.h"
+
+TEST(GenericTLVPoolTest, RecyclesReleasedRecords)
+{
+    GenericTLVPool pool;
+    generic_pool_init(&pool);
+
+    GenericTLV *first = pool_make_generic(&pool, 3, "N_ELEC_PANEL_LOWER_LEFT", "-");
+    EXPECT_EQ(3, first->element_id);
+    EXPECT_STREQ("N_ELEC_PANEL_LOWER_LEFT", first->name);
+    EXPECT_EQ(1, pool.outstanding);
+    release_generic(first);
+
+    for (int i = 0; i < 100; i++) {
+        GenericTLV *value = pool_make_string_generic(&pool, 4, "S_OH_TEST", "-", "ON");
+        EXPECT_STREQ("ON", value->value.string_value);
+        release_generic(value);
+    }
+
+    EXPECT_EQ(1, pool.allocated);
+    EXPECT_EQ(0, pool.outstanding);
+
+    generic_pool_destroy(&pool);
+}
+
+TEST(GenericTLVPoolTest, LongStringsFallBackToHeap)
+{
+    GenericTLVPool pool;
+    generic_pool_init(&pool);
+
+    std::string longName(GENERIC_INLINE_NAME_LEN * 2, 'N');
+    std::string longValue(GENERIC_INLINE_STRING_LEN * 2, 'V');
+
+    GenericTLV *value = pool_make_string_generic(&pool, 1, longName.c_str(), "-", longValue.c_str());
+    generic_set_units(value, "volts");
+    generic_set_name(value, 2, "I_SHORT");
+
+    EXPECT_EQ(2, value->element_id);
+    EXPECT_STREQ("I_SHORT", value->name);
+    EXPECT_STREQ("volts", value->units);
+    EXPECT_EQ(longValue, value->value.string_value);
+
+    release_generic(value);
+    generic_pool_destroy(&pool);
+}
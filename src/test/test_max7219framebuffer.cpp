@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "plugins/pokey/drivers/PokeyMAX7219Manager/MAX7219FrameBuffer.h"
+
+typedef std::vector<std::pair<uint8_t, uint8_t>> WriteLog;
+
+static MAX7219RegisterWriter logWrites(WriteLog &log, bool succeed = true)
+{
+    return [&log, succeed](uint8_t col, uint8_t rowMask) {
+        log.push_back({ col, rowMask });
+        return succeed;
+    };
+}
+
+TEST(MAX7219FrameBufferTest, OnePacketPerDirtyColumn)
+{
+    MAX7219FrameBuffer frame;
+    WriteLog writes;
+
+    // a panel's worth of LEDs spread over two columns
+    for (uint8_t row = 1; row <= 8; row++) {
+        frame.set(2, row, true);
+    }
+
+    frame.set(5, 1, true);
+    frame.set(5, 3, true);
+
+    EXPECT_TRUE(frame.dirty());
+    EXPECT_EQ(0, frame.flush(logWrites(writes)));
+    EXPECT_FALSE(frame.dirty());
+
+    ASSERT_EQ(2, writes.size());
+    EXPECT_EQ(2, writes[0].first);
+    EXPECT_EQ(0xFF, writes[0].second);
+    EXPECT_EQ(5, writes[1].first);
+    EXPECT_EQ(0x05, writes[1].second);
+
+    EXPECT_EQ(10, frame.updates());
+    EXPECT_EQ(2, frame.writes());
+    EXPECT_EQ(8, frame.writesSaved());
+
+    // nothing changed, nothing sent
+    EXPECT_EQ(0, frame.flush(logWrites(writes)));
+    EXPECT_EQ(2, writes.size());
+}
+
+TEST(MAX7219FrameBufferTest, ToggleWithinFrameIsNotSent)
+{
+    MAX7219FrameBuffer frame;
+    WriteLog writes;
+
+    frame.set(1, 1, true);
+    frame.flush(logWrites(writes));
+
+    frame.set(1, 1, false);
+    frame.set(1, 1, true);
+    frame.flush(logWrites(writes));
+
+    EXPECT_EQ(1, writes.size());
+    EXPECT_TRUE(frame.get(1, 1));
+    EXPECT_FALSE(frame.get(1, 2));
+}
+
+TEST(MAX7219FrameBufferTest, FailedWriteIsRetried)
+{
+    MAX7219FrameBuffer frame;
+    WriteLog writes;
+
+    frame.set(3, 4, true);
+
+    EXPECT_EQ(1, frame.flush(logWrites(writes, false)));
+    EXPECT_TRUE(frame.dirty());
+
+    EXPECT_EQ(0, frame.flush(logWrites(writes)));
+    EXPECT_FALSE(frame.dirty());
+
+    ASSERT_EQ(2, writes.size());
+    EXPECT_EQ(writes[0], writes[1]);
+}
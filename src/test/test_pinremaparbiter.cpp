@@ -0,0 +1,113 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "plugins/pokey/PinRemapArbiter/PinRemapArbiter.h"
+
+using namespace std::chrono_literals;
+
+TEST(PinRemapArbiterTest, ReportsOnceSourcesSettle)
+{
+    PinRemapArbiter arbiter(20);
+    std::vector<std::pair<int, bool>> reports;
+    PinRemapArbiter::Clock::time_point start = PinRemapArbiter::Clock::now();
+
+    int target = arbiter.addTarget();
+    int source = arbiter.addSource(target, false);
+
+    arbiter.setReportFunction([&](int target, bool value) { reports.push_back({ target, value }); });
+
+    arbiter.edge(target, source, true, start);
+
+    EXPECT_EQ(20ms, arbiter.arbitrate(start));
+    EXPECT_EQ(5ms, arbiter.arbitrate(start + 15ms));
+    EXPECT_TRUE(reports.empty());
+
+    EXPECT_EQ(PinRemapArbiter::Clock::duration::max(), arbiter.arbitrate(start + 20ms));
+    ASSERT_EQ(1, reports.size());
+    EXPECT_EQ(target, reports[0].first);
+    EXPECT_TRUE(reports[0].second);
+    EXPECT_TRUE(arbiter.value(target));
+
+    // nothing new to report
+    arbiter.arbitrate(start + 100ms);
+    EXPECT_EQ(1, reports.size());
+}
+
+TEST(PinRemapArbiterTest, HandOverBetweenSourcesIsNotReported)
+{
+    PinRemapArbiter arbiter(20);
+    int reports = 0;
+    PinRemapArbiter::Clock::time_point start = PinRemapArbiter::Clock::now();
+
+    int target = arbiter.addTarget();
+    int first = arbiter.addSource(target, true);
+    int second = arbiter.addSource(target, false);
+
+    arbiter.setReportFunction([&](int, bool) { reports++; });
+
+    // break before make
+    arbiter.edge(target, first, false, start);
+    arbiter.arbitrate(start + 5ms);
+    arbiter.edge(target, second, true, start + 10ms);
+    arbiter.arbitrate(start + 50ms);
+
+    // make before break
+    arbiter.edge(target, first, true, start + 100ms);
+    arbiter.edge(target, second, false, start + 105ms);
+    arbiter.arbitrate(start + 150ms);
+
+    EXPECT_EQ(0, reports);
+    EXPECT_EQ(2, arbiter.suppressedCount());
+    EXPECT_TRUE(arbiter.value(target));
+
+    // releasing the last active source is
+    arbiter.edge(target, first, false, start + 200ms);
+    arbiter.arbitrate(start + 250ms);
+
+    EXPECT_EQ(1, reports);
+    EXPECT_FALSE(arbiter.value(target));
+}
+
+TEST(PinRemapArbiterTest, ArbitratesEdgesFromManyThreads)
+{
+    PinRemapArbiter arbiter(5);
+    std::atomic<int> reports(0);
+    std::thread::id reportThread;
+    std::vector<int> targets;
+    std::vector<std::thread> pollers;
+
+    for (int i = 0; i < 4; i++) {
+        targets.push_back(arbiter.addTarget());
+        arbiter.addSource(targets[i], false);
+    }
+
+    arbiter.setReportFunction([&](int, bool) {
+        reportThread = std::this_thread::get_id();
+        reports++;
+    });
+
+    arbiter.start();
+
+    for (int i = 0; i < 4; i++) {
+        pollers.push_back(std::thread([&, i] { arbiter.edge(targets[i], 0, true); }));
+    }
+
+    for (auto &poller : pollers) {
+        poller.join();
+    }
+
+    for (int i = 0; i < 100 && reports.load() < 4; i++) {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    arbiter.stop();
+
+    EXPECT_EQ(4, reports.load());
+    EXPECT_NE(std::this_thread::get_id(), reportThread);
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(arbiter.value(targets[i]));
+    }
+}
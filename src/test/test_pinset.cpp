@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "plugins/pokey/PinSet/PinSet.h"
+
+TEST(PinSetTest, SetClearAndTest)
+{
+    PinSet pins;
+
+    EXPECT_TRUE(pins.empty());
+
+    pins.set(0);
+    pins.set(54);
+    pins.set(7, true);
+    pins.set(7, false);
+
+    EXPECT_TRUE(pins.test(0));
+    EXPECT_TRUE(pins.test(54));
+    EXPECT_FALSE(pins.test(7));
+    EXPECT_EQ(2, pins.count());
+
+    pins.clear(0);
+    EXPECT_FALSE(pins.test(0));
+    EXPECT_EQ(1, pins.count());
+}
+
+TEST(PinSetTest, ChangedInputsVisitedInOrder)
+{
+    PinSet inputs;
+    PinSet previous;
+    PinSet current;
+
+    for (int i = 0; i < 55; i += 3) {
+        inputs.set(i);
+    }
+
+    previous.set(3);
+    previous.set(9);
+    current.set(9);
+    current.set(12);
+    current.set(13); // not an input, ignored
+
+    PinSet changed = (current ^ previous) & inputs;
+    std::vector<int> visited;
+    int index;
+
+    while ((index = changed.takeFirst()) >= 0) {
+        visited.push_back(index);
+    }
+
+    EXPECT_EQ(std::vector<int>({ 3, 12 }), visited);
+    EXPECT_TRUE(changed.empty());
+    EXPECT_EQ(-1, changed.takeFirst());
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "plugins/pokey/PollScheduler/PollScheduler.h"
+
+using namespace std::chrono_literals;
+
+TEST(PollSchedulerTest, AdaptivePolicyTightensAndBacksOff)
+{
+    PollPolicy fixed(POLL_FIXED, 100, 5);
+    PollPolicy adaptive(POLL_ADAPTIVE, 100, 5);
+
+    EXPECT_EQ(100, fixed.next(true));
+    EXPECT_EQ(100, adaptive.next(false));
+
+    // activity drops straight to the fastest rate and holds it
+    EXPECT_EQ(5, adaptive.next(true));
+
+    for (int i = 0; i < POLL_ADAPTIVE_HOLD; i++) {
+        EXPECT_EQ(5, adaptive.next(false));
+    }
+
+    // then doubles back to the configured interval
+    EXPECT_EQ(10, adaptive.next(false));
+    EXPECT_EQ(20, adaptive.next(false));
+    EXPECT_EQ(40, adaptive.next(false));
+    EXPECT_EQ(80, adaptive.next(false));
+    EXPECT_EQ(100, adaptive.next(false));
+    EXPECT_EQ(100, adaptive.next(false));
+}
+
+TEST(PollSchedulerTest, HistogramPercentiles)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_EQ(0, histogram.percentile(50));
+
+    for (int i = 0; i < 90; i++) {
+        histogram.record(1000);
+    }
+
+    for (int i = 0; i < 10; i++) {
+        histogram.record(100000);
+    }
+
+    EXPECT_EQ(100, histogram.count());
+    EXPECT_EQ(100000, histogram.max());
+    EXPECT_EQ(1024, histogram.percentile(50));
+    EXPECT_EQ(1024, histogram.percentile(90));
+    EXPECT_EQ(131072, histogram.percentile(99));
+}
+
+TEST(PollSchedulerTest, MultiplexesDevicesOnOneThread)
+{
+    PollScheduler scheduler;
+    std::atomic<int> fast(0);
+    std::atomic<int> slow(0);
+    std::thread::id pollThreads[2];
+
+    scheduler.add(
+        [&] {
+            pollThreads[0] = std::this_thread::get_id();
+            fast++;
+            return false;
+        },
+        PollPolicy(POLL_FIXED, 5));
+
+    scheduler.add(
+        [&] {
+            pollThreads[1] = std::this_thread::get_id();
+            slow++;
+            return false;
+        },
+        PollPolicy(POLL_FIXED, 50));
+
+    scheduler.start();
+    std::this_thread::sleep_for(220ms);
+    scheduler.stop();
+
+    EXPECT_EQ(pollThreads[0], pollThreads[1]);
+    EXPECT_NE(std::this_thread::get_id(), pollThreads[0]);
+    EXPECT_GE(slow.load(), 3);
+    EXPECT_GT(fast.load(), 4 * slow.load());
+    EXPECT_EQ(fast.load() + slow.load(), scheduler.pollCount());
+}
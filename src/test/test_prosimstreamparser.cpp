@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "plugins/prepare3d/ProsimStreamParser/ProsimStreamParser.h"
+
+struct ParsedElement {
+    std::string name;
+    ConfigType type;
+    int intValue;
+    float floatValue;
+    std::string stringValue;
+};
+
+static void collectElement(ProsimElement *element, void *arg)
+{
+    ParsedElement parsed;
+
+    parsed.name = element->name;
+    parsed.type = element->type;
+    parsed.intValue = element->value.int_value;
+    parsed.floatValue = element->value.float_value;
+
+    if (element->type == CONFIG_STRING) {
+        parsed.stringValue = element->value.string_value;
+    }
+
+    static_cast<std::vector<ParsedElement> *>(arg)->push_back(parsed);
+}
+
+TEST(ProsimStreamParserTest, ParsesEachElementType)
+{
+    ProsimStreamParser parser(1024);
+    std::vector<ParsedElement> elements;
+    std::string data = "I_OH_SPEED_TRIM = 1 \nG_THROTTLE_LEFT = -12.625\nN_ELEC_PANEL_LOWER_LEFT = 28\nA_ASP_PA_VOLUME = 200\r\nS_OH_CROSSFEED = 0 \n\n";
+
+    EXPECT_EQ(5, parser.feed(data.c_str(), data.size(), collectElement, &elements));
+    ASSERT_EQ(5, elements.size());
+
+    EXPECT_EQ("I_OH_SPEED_TRIM", elements[0].name);
+    EXPECT_EQ(CONFIG_BOOL, elements[0].type);
+    EXPECT_EQ(1, elements[0].intValue);
+
+    EXPECT_EQ(CONFIG_FLOAT, elements[1].type);
+    EXPECT_FLOAT_EQ(-12.625f, elements[1].floatValue);
+
+    EXPECT_EQ(CONFIG_INT, elements[2].type);
+    EXPECT_EQ(28, elements[2].intValue);
+
+    EXPECT_EQ("A_ASP_PA_VOLUME", elements[3].name);
+    EXPECT_EQ("200", elements[3].stringValue);
+
+    EXPECT_EQ(0, elements[4].intValue);
+    EXPECT_EQ(0, parser.malformedCount());
+}
+
+TEST(ProsimStreamParserTest, LinesSplitAcrossReadsAndRingWrap)
+{
+    ProsimStreamParser parser(1024);
+    std::vector<ParsedElement> elements;
+    std::string line = "G_OH_FUEL_TEMP = 21.5\n";
+    std::string stream;
+
+    // enough lines to wrap the ring several times
+    for (int i = 0; i < 200; i++) {
+        stream += line;
+    }
+
+    // feed in awkward chunk sizes so lines straddle reads
+    for (size_t pos = 0; pos < stream.size(); pos += 7) {
+        parser.feed(stream.c_str() + pos, std::min((size_t)7, stream.size() - pos), collectElement, &elements);
+    }
+
+    ASSERT_EQ(200, elements.size());
+
+    for (ParsedElement &element : elements) {
+        EXPECT_EQ("G_OH_FUEL_TEMP", element.name);
+        EXPECT_FLOAT_EQ(21.5f, element.floatValue);
+    }
+
+    EXPECT_EQ(0, parser.buffered());
+}
+
+TEST(ProsimStreamParserTest, MalformedAndOverlongLinesAreSkipped)
+{
+    ProsimStreamParser parser(1024);
+    std::vector<ParsedElement> elements;
+    std::string data = "G_BAD = 1.2.3\nNO_EQUALS_SIGN\n" + std::string(2000, 'X') + "\nN_GOOD = 7\n";
+
+    parser.feed(data.c_str(), data.size(), collectElement, &elements);
+
+    ASSERT_EQ(1, elements.size());
+    EXPECT_EQ("N_GOOD", elements[0].name);
+    EXPECT_EQ(2, parser.malformedCount());
+    EXPECT_EQ(1, parser.overflowCount());
+}
+
+TEST(ProsimStreamParserTest, NumberParsing)
+{
+    int intValue;
+    float floatValue;
+    const char *number = "-2147483648";
+
+    EXPECT_TRUE(ParseProsimInt(number, number + strlen(number), &intValue));
+    EXPECT_EQ(INT32_MIN, intValue);
+
+    number = "2147483648";
+    EXPECT_FALSE(ParseProsimInt(number, number + strlen(number), &intValue));
+
+    number = "0.0000000000";
+    EXPECT_TRUE(ParseProsimFloat(number, number + strlen(number), &floatValue));
+    EXPECT_EQ(0.0f, floatValue);
+
+    number = "114.4296875000";
+    EXPECT_TRUE(ParseProsimFloat(number, number + strlen(number), &floatValue));
+    EXPECT_FLOAT_EQ(114.4296875f, floatValue);
+
+    number = "1.5e3";
+    EXPECT_TRUE(ParseProsimFloat(number, number + strlen(number), &floatValue));
+    EXPECT_FLOAT_EQ(1500.0f, floatValue);
+
+    number = "abc";
+    EXPECT_FALSE(ParseProsimFloat(number, number + strlen(number), &floatValue));
+}
+
+TEST(ProsimStreamParserTest, ScannersAgreeWithScalar)
+{
+    std::vector<ProsimScanFunction> scanners = { ProsimSelectScanner() };
+    std::unique_ptr<ProsimScanResult> expected(new ProsimScanResult);
+    std::unique_ptr<ProsimScanResult> actual(new ProsimScanResult);
+    std::string data;
+
+#if defined(PROSIM_SCAN_X86)
+    scanners.push_back(ProsimScanSSE2);
+
+    if (__builtin_cpu_supports("avx2")) {
+        scanners.push_back(ProsimScanAVX2);
+    }
+#endif
+
+    srand(1);
+
+    for (int i = 0; i < PROSIM_SCAN_CHUNK; i++) {
+        static const char alphabet[] = "G_ABC =\n 0123.";
+        data += alphabet[rand() % (sizeof(alphabet) - 1)];
+    }
+
+    // every length exercises a different mix of vector blocks and tail
+    for (size_t length = 0; length <= 100; length++) {
+        ProsimScanScalar(data.c_str(), length, expected.get());
+
+        for (ProsimScanFunction scanner : scanners) {
+            scanner(data.c_str(), length, actual.get());
+
+            ASSERT_EQ(expected->newlineCount, actual->newlineCount) << ProsimScannerName(scanner);
+            ASSERT_EQ(expected->equalsCount, actual->equalsCount) << ProsimScannerName(scanner);
+            EXPECT_EQ(0, memcmp(expected->newlines, actual->newlines, expected->newlineCount * sizeof(uint32_t)));
+            EXPECT_EQ(0, memcmp(expected->equals, actual->equals, expected->equalsCount * sizeof(uint32_t)));
+        }
+    }
+
+    ProsimScanScalar(data.c_str(), data.size(), expected.get());
+
+    for (ProsimScanFunction scanner : scanners) {
+        scanner(data.c_str(), data.size(), actual.get());
+        EXPECT_EQ(expected->newlineCount, actual->newlineCount);
+        EXPECT_EQ(0, memcmp(expected->equals, actual->equals, expected->equalsCount * sizeof(uint32_t)));
+    }
+}
+
+TEST(ProsimStreamParserTest, ScalarScannerParsesTheSame)
+{
+    ProsimStreamParser parser(1024);
+    std::vector<ParsedElement> elements;
+    std::string data = "G_OH_TEMPERATURE = 12.5\nN_VALUE = 3\nNO_EQUALS\nS_OH_CROSSFEED = 1 \n";
+
+    parser.setScanner(ProsimScanScalar);
+
+    for (int i = 0; i < 100; i++) {
+        parser.feed(data.c_str(), data.size(), collectElement, &elements);
+    }
+
+    EXPECT_EQ(300, elements.size());
+    EXPECT_EQ(100, parser.malformedCount());
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "plugins/prepare3d/ProsimWriteQueue/ProsimWriteQueue.h"
+
+TEST(ProsimWriteQueueTest, CoalescesRecordsIntoOneBatch)
+{
+    ProsimWriteQueue queue(1024);
+    const char *data;
+    size_t length;
+
+    // only the first record needs to wake the loop
+    EXPECT_TRUE(queue.append("S_OH_CROSSFEED", "1"));
+    EXPECT_FALSE(queue.append("S_MIP_GEAR", "Down"));
+    EXPECT_FALSE(queue.append("N_VALUE", "12"));
+
+    ASSERT_TRUE(queue.takeBatch(&data, &length));
+    EXPECT_EQ("S_OH_CROSSFEED=1\nS_MIP_GEAR=Down\nN_VALUE=12\n", std::string(data, length));
+    EXPECT_EQ(3, queue.recordCount());
+    EXPECT_EQ(1, queue.batchCount());
+
+    // records arriving mid write wait for it to complete
+    EXPECT_FALSE(queue.append("S_OH_CROSSFEED", "0"));
+    EXPECT_FALSE(queue.takeBatch(&data, &length));
+    EXPECT_TRUE(queue.writeComplete());
+
+    ASSERT_TRUE(queue.takeBatch(&data, &length));
+    EXPECT_EQ("S_OH_CROSSFEED=0\n", std::string(data, length));
+    EXPECT_FALSE(queue.writeComplete());
+    EXPECT_FALSE(queue.takeBatch(&data, &length));
+}
+
+TEST(ProsimWriteQueueTest, HighWaterWakesTheLoop)
+{
+    ProsimWriteQueue queue(32);
+    std::string value(8, '1');
+
+    EXPECT_TRUE(queue.append("N_VALUE", value));
+    EXPECT_FALSE(queue.full());
+    EXPECT_TRUE(queue.append("N_VALUE", value));
+    EXPECT_TRUE(queue.full());
+    EXPECT_FALSE(queue.append("N_VALUE", value));
+}
+
+TEST(ProsimWriteQueueTest, DropsRecordsItCantSend)
+{
+    ProsimWriteQueue queue(32, 64);
+    std::string value(8, '1');
+
+    // nothing takes batches, as while the connection is coming up
+    for (int i = 0; i < 8; i++) {
+        queue.append("N_VALUE", value);
+    }
+
+    EXPECT_EQ(4u, queue.droppedCount());
+
+    queue.close();
+
+    const char *data;
+    size_t length;
+
+    EXPECT_FALSE(queue.append("N_VALUE", value));
+    EXPECT_FALSE(queue.takeBatch(&data, &length));
+    EXPECT_EQ(5u, queue.droppedCount());
+}
+
+TEST(ProsimWriteQueueTest, ConcurrentProducersLoseNothing)
+{
+    ProsimWriteQueue queue(256);
+    std::vector<std::thread> producers;
+    std::string written;
+    const int perProducer = 5000;
+
+    for (int i = 0; i < 4; i++) {
+        producers.push_back(std::thread([&queue] {
+            for (int j = 0; j < perProducer; j++) {
+                queue.append("S_OH_CROSSFEED", "1");
+            }
+        }));
+    }
+
+    // drain as the loop would while the producers are running
+    while (written.size() < 4 * perProducer * strlen("S_OH_CROSSFEED=1\n")) {
+        const char *data;
+        size_t length;
+
+        if (queue.takeBatch(&data, &length)) {
+            written.append(data, length);
+            queue.writeComplete();
+        }
+    }
+
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_EQ(4 * perProducer, std::count(written.begin(), written.end(), '\n'));
+    EXPECT_EQ(4 * perProducer, queue.recordCount());
+    EXPECT_LT(queue.batchCount(), queue.recordCount());
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "streaming/recordaggregator.h"
+#include "streaming/recordbatcher.h"
+
+//! stand-in for the stream - keeps what it takes and refuses the records it's told to, once each
+class StandInStream
+{
+public:
+    std::mutex mutex;
+    std::vector<std::string> received; ///< deaggregated, in the order they were taken
+    size_t requests = 0;
+    size_t maxRequestRecords = 0;
+    size_t refuseFirst = 0; ///< refuse the first record of this many requests
+    bool down = false;
+
+    PutRecordsFunction put(void)
+    {
+        return [this](const std::vector<std::string> &records, std::vector<bool> &failed) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            requests++;
+            maxRequestRecords = std::max(maxRequestRecords, records.size());
+
+            if (down) {
+                return false;
+            }
+
+            for (size_t i = 0; i < records.size(); i++) {
+                if (i == 0 && refuseFirst > 0) {
+                    refuseFirst--;
+                    failed[i] = true;
+                    continue;
+                }
+
+                EXPECT_TRUE(RecordAggregator::Deaggregate(records[i], received));
+            }
+
+            return true;
+        };
+    }
+};
+
+static RecordBatcherConfiguration testConfiguration(void)
+{
+    RecordBatcherConfiguration configuration = RecordBatcher::DefaultConfiguration();
+    configuration.linger = 10;
+    configuration.retryBackoff = 1;
+    return configuration;
+}
+
+TEST(RecordAggregatorTest, RoundTripsRecords)
+{
+    RecordAggregator aggregator("simhub");
+    std::vector<std::string> records;
+    std::string aggregate;
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(aggregator.add("{ \"s\" : \"N_ELEMENT_" + std::to_string(i) + "\" }"));
+    }
+
+    size_t expectedSize = aggregator.size();
+    aggregator.build(aggregate);
+
+    EXPECT_EQ(expectedSize, aggregate.size());
+    EXPECT_TRUE(aggregator.empty());
+    EXPECT_EQ(0, aggregate.compare(0, AGGREGATION_MAGIC_SIZE, AGGREGATION_MAGIC));
+
+    ASSERT_TRUE(RecordAggregator::Deaggregate(aggregate, records));
+    ASSERT_EQ(100u, records.size());
+    EXPECT_EQ("{ \"s\" : \"N_ELEMENT_42\" }", records[42]);
+
+    // a corrupted message fails its digest
+    aggregate[AGGREGATION_MAGIC_SIZE + 12] ^= 1;
+    records.clear();
+    EXPECT_FALSE(RecordAggregator::Deaggregate(aggregate, records));
+}
+
+TEST(RecordAggregatorTest, LoneRecordIsSentAsIs)
+{
+    RecordAggregator aggregator("simhub");
+    std::string built;
+
+    aggregator.add("only");
+    EXPECT_EQ(4u, aggregator.size());
+    aggregator.build(built);
+
+    EXPECT_EQ("only", built);
+}
+
+TEST(RecordAggregatorTest, StopsAtMaxSize)
+{
+    RecordAggregator aggregator("simhub", 256);
+    std::string record(100, 'x');
+
+    EXPECT_TRUE(aggregator.add(record));
+    EXPECT_TRUE(aggregator.add(record));
+    EXPECT_FALSE(aggregator.add(record));
+    EXPECT_LE(aggregator.size(), 256u);
+
+    // an empty aggregator takes a record whatever its size
+    aggregator.clear();
+    EXPECT_TRUE(aggregator.add(std::string(1000, 'x')));
+}
+
+TEST(RecordBatcherTest, SendsRecordsInOrderInFewRequests)
+{
+    StandInStream stream;
+    RecordBatcher batcher("simhub", stream.put(), testConfiguration());
+
+    batcher.start();
+
+    for (int i = 0; i < 1000; i++) {
+        batcher.push(std::to_string(i));
+    }
+
+    batcher.stop();
+
+    ASSERT_EQ(1000u, stream.received.size());
+
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(std::to_string(i), stream.received[i]);
+    }
+
+    EXPECT_EQ(1000u, batcher.recordCount());
+    EXPECT_LT(stream.requests, 20u);
+    EXPECT_EQ(0u, batcher.failedCount());
+}
+
+TEST(RecordBatcherTest, SplitsBatchesAtTheRecordLimit)
+{
+    StandInStream stream;
+    RecordBatcherConfiguration configuration = testConfiguration();
+
+    configuration.maxBatchRecords = 4;
+    configuration.maxAggregateSize = 64;
+
+    RecordBatcher batcher("simhub", stream.put(), configuration);
+
+    for (int i = 0; i < 200; i++) {
+        batcher.push(std::string(20, 'a' + i % 26));
+    }
+
+    batcher.start();
+    batcher.stop();
+
+    EXPECT_EQ(200u, stream.received.size());
+    EXPECT_LE(stream.maxRequestRecords, 4u);
+    EXPECT_GT(stream.requests, 1u);
+}
+
+TEST(RecordBatcherTest, RetriesRefusedRecords)
+{
+    StandInStream stream;
+    RecordBatcher batcher("simhub", stream.put(), testConfiguration());
+
+    stream.refuseFirst = 2;
+
+    for (int i = 0; i < 10; i++) {
+        batcher.push(std::to_string(i));
+    }
+
+    batcher.start();
+    batcher.stop();
+
+    EXPECT_EQ(10u, stream.received.size());
+    EXPECT_EQ(2u, batcher.retriedCount());
+    EXPECT_EQ(0u, batcher.failedCount());
+}
+
+TEST(RecordBatcherTest, DropsRecordsAfterLastRetry)
+{
+    StandInStream stream;
+    RecordBatcherConfiguration configuration = testConfiguration();
+
+    configuration.maxRetries = 2;
+    stream.down = true;
+
+    RecordBatcher batcher("simhub", stream.put(), configuration);
+
+    batcher.push("lost");
+    batcher.start();
+    batcher.stop();
+
+    EXPECT_EQ(3u, stream.requests);
+    EXPECT_EQ(1u, batcher.failedCount());
+    EXPECT_EQ(0u, batcher.sentCount());
+}
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "streaming/recordaggregator.h"
+#include "streaming/recordbatcher.h"
+#include "streaming/recordspool.h"
+
+//! spool directory under /tmp, removed with everything in it
+class SpoolDirectory
+{
+public:
+    std::string path;
+
+    SpoolDirectory(void)
+    {
+        char pattern[] = "/tmp/simhub_spool_XXXXXX";
+        path = mkdtemp(pattern);
+    }
+
+    ~SpoolDirectory(void)
+    {
+        for (const std::string &file : files()) {
+            unlink((path + "/" + file).c_str());
+        }
+
+        rmdir(path.c_str());
+    }
+
+    std::vector<std::string> files(void)
+    {
+        std::vector<std::string> retVal;
+        DIR *directory = opendir(path.c_str());
+
+        while (struct dirent *entry = readdir(directory)) {
+            if (entry->d_name[0] != '.') {
+                retVal.push_back(entry->d_name);
+            }
+        }
+
+        closedir(directory);
+        std::sort(retVal.begin(), retVal.end());
+
+        return retVal;
+    }
+};
+
+//! stand-in for a stream that can be taken down
+class SpoolStream
+{
+public:
+    std::mutex mutex;
+    std::vector<std::string> received;
+    bool down = false;
+
+    PutRecordsFunction put(void)
+    {
+        return [this](const std::vector<std::string> &records, std::vector<bool> &) {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (down) {
+                return false;
+            }
+
+            for (const std::string &record : records) {
+                EXPECT_TRUE(RecordAggregator::Deaggregate(record, received));
+            }
+
+            return true;
+        };
+    }
+
+    size_t count(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return received.size();
+    }
+};
+
+static std::string makeRecord(int i)
+{
+    return "{ \"s\" : \"N_ELEMENT_" + std::to_string(i) + "\" }";
+}
+
+TEST(RecordSpoolTest, ReadsBackInOrder)
+{
+    SpoolDirectory directory;
+    RecordSpool spool(RecordSpool::DefaultConfiguration(directory.path));
+    std::vector<std::string> records;
+
+    ASSERT_TRUE(spool.open());
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(spool.append(makeRecord(i)));
+    }
+
+    EXPECT_TRUE(spool.wait(std::chrono::milliseconds(0)));
+    EXPECT_GT(spool.read(records, 1024), 0u);
+    EXPECT_LT(records.size(), 100u);
+
+    spool.read(records, SPOOL_DEFAULT_SEGMENT_SIZE);
+    ASSERT_EQ(100u, records.size());
+    EXPECT_EQ(makeRecord(42), records[42]);
+    EXPECT_EQ(0u, spool.readableSize());
+
+    spool.commit();
+    EXPECT_EQ(100u, spool.committedCount());
+    EXPECT_FALSE(spool.wait(std::chrono::milliseconds(10)));
+}
+
+TEST(RecordSpoolTest, ReopenResumesFromTheCommit)
+{
+    SpoolDirectory directory;
+    std::vector<std::string> records;
+
+    {
+        RecordSpool spool(RecordSpool::DefaultConfiguration(directory.path));
+        ASSERT_TRUE(spool.open());
+
+        for (int i = 0; i < 10; i++) {
+            spool.append(makeRecord(i));
+        }
+
+        spool.read(records, makeRecord(0).size() * 4);
+        ASSERT_EQ(4u, records.size());
+        spool.commit();
+
+        // read but not committed - sent again after a restart
+        spool.read(records, makeRecord(0).size() * 2);
+    }
+
+    RecordSpool spool(RecordSpool::DefaultConfiguration(directory.path));
+    ASSERT_TRUE(spool.open());
+
+    records.clear();
+    spool.read(records, SPOOL_DEFAULT_SEGMENT_SIZE);
+    ASSERT_EQ(6u, records.size());
+    EXPECT_EQ(makeRecord(4), records[0]);
+    EXPECT_EQ(makeRecord(9), records[5]);
+}
+
+TEST(RecordSpoolTest, RecoveryStopsAtATornWrite)
+{
+    SpoolDirectory directory;
+    std::vector<std::string> records;
+
+    {
+        RecordSpool spool(RecordSpool::DefaultConfiguration(directory.path));
+        ASSERT_TRUE(spool.open());
+
+        for (int i = 0; i < 5; i++) {
+            spool.append(makeRecord(i));
+        }
+    }
+
+    // a frame cut short by a crash, followed by garbage
+    std::vector<std::string> files = directory.files();
+    ASSERT_EQ("segment-0000000000000001.spool", files[1]);
+
+    int fd = open((directory.path + "/" + files[1]).c_str(), O_WRONLY | O_APPEND);
+    const char torn[] = "\x40\x00\x00\x00\x12\x34\x56\x78{ \"s\" : \"N_";
+    ASSERT_EQ((ssize_t)sizeof(torn), write(fd, torn, sizeof(torn)));
+    close(fd);
+
+    RecordSpool spool(RecordSpool::DefaultConfiguration(directory.path));
+    ASSERT_TRUE(spool.open());
+
+    spool.read(records, SPOOL_DEFAULT_SEGMENT_SIZE);
+    ASSERT_EQ(5u, records.size());
+    EXPECT_EQ(makeRecord(4), records[4]);
+
+    // appends carry on in a new segment
+    spool.append(makeRecord(5));
+    spool.read(records, SPOOL_DEFAULT_SEGMENT_SIZE);
+    ASSERT_EQ(6u, records.size());
+    EXPECT_EQ(makeRecord(5), records[5]);
+}
+
+TEST(RecordSpoolTest, RetentionDropsTheOldestSegments)
+{
+    SpoolDirectory directory;
+    RecordSpoolConfiguration configuration = RecordSpool::DefaultConfiguration(directory.path);
+    std::vector<std::string> records;
+
+    configuration.segmentSize = 1024;
+    configuration.maxSize = 4096;
+
+    RecordSpool spool(configuration);
+    ASSERT_TRUE(spool.open());
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(spool.append(makeRecord(i)));
+    }
+
+    EXPECT_LE(spool.size(), configuration.maxSize);
+    EXPECT_LE(spool.segmentCount(), 4u);
+    EXPECT_GT(spool.droppedCount(), 0u);
+
+    // the newest records survive, in order
+    spool.read(records, SPOOL_DEFAULT_SEGMENT_SIZE);
+    ASSERT_FALSE(records.empty());
+    EXPECT_EQ(1000u, records.size() + spool.droppedCount());
+    EXPECT_EQ(makeRecord(999), records.back());
+
+    // too big for a segment
+    EXPECT_FALSE(spool.append(std::string(2048, 'x')));
+}
+
+TEST(RecordSpoolTest, BatcherDeliversEverythingOnceTheStreamIsBack)
+{
+    SpoolDirectory directory;
+    SpoolStream stream;
+    RecordSpool spool(RecordSpool::DefaultConfiguration(directory.path));
+    RecordBatcherConfiguration configuration = RecordBatcher::DefaultConfiguration();
+
+    configuration.linger = 10;
+    configuration.retryBackoff = 1;
+    configuration.maxRetries = 0;
+    stream.down = true;
+
+    ASSERT_TRUE(spool.open());
+
+    {
+        RecordBatcher batcher("simhub", stream.put(), configuration, &spool);
+        batcher.start();
+
+        for (int i = 0; i < 500; i++) {
+            batcher.push(makeRecord(i));
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_EQ(0u, stream.count());
+        EXPECT_EQ(0u, batcher.failedCount());
+
+        {
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.down = false;
+        }
+
+        for (int i = 0; i < 100 && stream.count() < 500; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        batcher.stop();
+    }
+
+    ASSERT_EQ(500u, stream.received.size());
+    EXPECT_EQ(makeRecord(0), stream.received[0]);
+    EXPECT_EQ(makeRecord(499), stream.received[499]);
+    EXPECT_EQ(500u, spool.committedCount());
+    EXPECT_EQ(0u, spool.readableSize());
+}
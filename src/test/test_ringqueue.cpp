@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "queue/mpsc_ring_queue.h"
+
+TEST(MPSCRingQueueTest, PreservesFifoOrder)
+{
+    MPSCRingQueue<int> queue(8);
+
+    for (int i = 0; i < 8; i++) {
+        queue.push(i);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(i, queue.pop());
+    }
+}
+
+TEST(MPSCRingQueueTest, MultipleProducersDeliverEverything)
+{
+    static const int PRODUCERS = 4;
+    static const int ITEMS_PER_PRODUCER = 50000;
+
+    MPSCRingQueue<int> queue(64, OVERFLOW_BLOCK);
+    std::vector<std::thread> producers;
+    std::vector<int> lastSeen(PRODUCERS, -1);
+
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.push_back(std::thread([&queue, p] {
+            for (int i = 0; i < ITEMS_PER_PRODUCER; i++) {
+                queue.push(p * ITEMS_PER_PRODUCER + i);
+            }
+        }));
+    }
+
+    for (int i = 0; i < PRODUCERS * ITEMS_PER_PRODUCER; i++) {
+        int value = queue.pop();
+        int producer = value / ITEMS_PER_PRODUCER;
+
+        // per producer order must be preserved
+        EXPECT_LT(lastSeen[producer], value);
+        lastSeen[producer] = value;
+    }
+
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_EQ(0, queue.size());
+}
+
+TEST(MPSCRingQueueTest, PopBatchDrainsQueuedItems)
+{
+    MPSCRingQueue<int> queue(16);
+    std::vector<int> batch;
+
+    for (int i = 0; i < 10; i++) {
+        queue.push(i);
+    }
+
+    EXPECT_EQ(4, queue.popBatch(batch, 4));
+    EXPECT_EQ(6, queue.drainTo(batch, 100));
+    EXPECT_EQ(0, queue.drainTo(batch, 100));
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i, batch[i]);
+    }
+}
+
+TEST(MPSCRingQueueTest, DropOldestKeepsNewest)
+{
+    MPSCRingQueue<int> queue(4, OVERFLOW_DROP_OLDEST);
+
+    for (int i = 0; i < 10; i++) {
+        queue.push(i);
+    }
+
+    EXPECT_EQ(6, queue.droppedCount());
+
+    for (int i = 6; i < 10; i++) {
+        EXPECT_EQ(i, queue.pop());
+    }
+}
+
+TEST(MPSCRingQueueTest, DroppedItemsAreHandedToTheDropCallback)
+{
+    MPSCRingQueue<int> queue(4, OVERFLOW_DROP_OLDEST);
+    std::vector<int> dropped;
+
+    queue.setDropCallback([&](const int &item) { dropped.push_back(item); });
+
+    for (int i = 0; i < 6; i++) {
+        queue.push(i);
+    }
+
+    // nothing is queued once unblocked
+    queue.unblock();
+    queue.push(6);
+
+    EXPECT_EQ(std::vector<int>({ 0, 1, 6 }), dropped);
+}
+
+TEST(MPSCRingQueueTest, CoalesceMergesOverflowByKey)
+{
+    MPSCRingQueue<std::string> queue(2, OVERFLOW_COALESCE);
+    queue.setCoalesceKey([](const std::string &value) { return value.substr(0, 1); });
+
+    queue.push("a1");
+    queue.push("b1");
+    queue.push("c1");
+    queue.push("d1");
+    queue.push("c2");
+
+    EXPECT_EQ(1, queue.coalescedCount());
+    EXPECT_EQ("a1", queue.pop());
+    EXPECT_EQ("b1", queue.pop());
+    EXPECT_EQ("c2", queue.pop());
+    EXPECT_EQ("d1", queue.pop());
+}
+
+TEST(MPSCRingQueueTest, UnblockInterruptsParkedConsumer)
+{
+    MPSCRingQueue<int> queue(8);
+    bool interrupted = false;
+
+    std::thread consumer([&] {
+        try {
+            queue.pop();
+        }
+        catch (ConcurrentQueueInterrupted &except) {
+            interrupted = true;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.unblock();
+    consumer.join();
+
+    EXPECT_TRUE(interrupted);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <vector>
+
+#include "routing/routingtable.h"
+
+static const ElementID S_OH_BATTERY_ID = 1;
+static const ElementID G_MIP_FLAP_ID = 4;
+static const ElementID G_MIP_FLAP_LEFT_ID = 5;
+static const ElementID I_OH_CROSSFEED_ID = 9;
+
+class RoutingTableTest : public ::testing::Test
+{
+protected:
+    simplug_vtable _pokey;
+    simplug_vtable _prepare3d;
+    simplug_vtable _recorder;
+    RoutingTable _table;
+    EventOwnerID _pokeyOwner;
+    EventOwnerID _prepare3dOwner;
+    EventOwnerID _recorderOwner;
+
+    void SetUp(void)
+    {
+        memset(&_pokey, 0, sizeof(simplug_vtable));
+        memset(&_prepare3d, 0, sizeof(simplug_vtable));
+        memset(&_recorder, 0, sizeof(simplug_vtable));
+
+        _pokeyOwner = _table.addPlugin("pokey", &_pokey);
+        _prepare3dOwner = _table.addPlugin("prepare3d", &_prepare3d);
+        _recorderOwner = _table.addPlugin("recorder", &_recorder);
+    }
+
+    //! plugins a value from source would be handed to
+    std::vector<simplug_vtable *> destinations(ElementID element, EventOwnerID source)
+    {
+        std::vector<simplug_vtable *> retVal;
+
+        for (const Route &route : _table.routes(element)) {
+            if (!(route.skipSource && route.owner == source)) {
+                retVal.push_back(route.methods);
+            }
+        }
+
+        return retVal;
+    }
+};
+
+TEST_F(RoutingTableTest, PluginsGetOwnerIds)
+{
+    EXPECT_EQ(1, _pokeyOwner);
+    EXPECT_EQ(3u, _table.pluginCount());
+    EXPECT_EQ(_prepare3dOwner, _table.owner("prepare3d"));
+    EXPECT_EQ(EVENT_OWNER_NONE, _table.owner("missing"));
+    EXPECT_EQ(&_recorder, _table.plugin(_recorderOwner));
+    EXPECT_EQ("recorder", _table.pluginName(_recorderOwner));
+    EXPECT_EQ(NULL, _table.plugin(EVENT_OWNER_NONE));
+}
+
+TEST_F(RoutingTableTest, UnmappedElementsGoToEveryOtherPlugin)
+{
+    _table.compile();
+
+    std::vector<simplug_vtable *> expected = { &_prepare3d, &_recorder };
+    EXPECT_EQ(expected, destinations(I_OH_CROSSFEED_ID, _pokeyOwner));
+
+    expected = { &_pokey, &_prepare3d };
+    EXPECT_EQ(expected, destinations(I_OH_CROSSFEED_ID, _recorderOwner));
+}
+
+TEST_F(RoutingTableTest, MappedElementsFanOut)
+{
+    _table.addRoute(G_MIP_FLAP_ID, INVALID_ELEMENT_ID, _pokeyOwner);
+    _table.addRoute(S_OH_BATTERY_ID, INVALID_ELEMENT_ID, _prepare3dOwner);
+    _table.addRoute(G_MIP_FLAP_ID, G_MIP_FLAP_LEFT_ID, _recorderOwner);
+    _table.compile();
+
+    EXPECT_EQ(3u, _table.routeCount());
+
+    RouteRange flap = _table.routes(G_MIP_FLAP_ID);
+    ASSERT_EQ(2u, flap.size());
+    EXPECT_EQ(&_pokey, flap.begin()[0].methods);
+    EXPECT_EQ(INVALID_ELEMENT_ID, flap.begin()[0].target);
+    EXPECT_EQ(&_recorder, flap.begin()[1].methods);
+    EXPECT_EQ(G_MIP_FLAP_LEFT_ID, flap.begin()[1].target);
+
+    // an explicit destination is honoured even when it's the source
+    std::vector<simplug_vtable *> expected = { &_prepare3d };
+    EXPECT_EQ(expected, destinations(S_OH_BATTERY_ID, _prepare3dOwner));
+
+    // elements between and beyond the mapped ones keep the default
+    EXPECT_EQ(3u, _table.routes(2).size());
+    EXPECT_EQ(3u, _table.routes(I_OH_CROSSFEED_ID).size());
+}
+
+TEST_F(RoutingTableTest, RouteToOthersExpandsPerPlugin)
+{
+    _table.addRoute(G_MIP_FLAP_ID, G_MIP_FLAP_LEFT_ID);
+    _table.compile();
+
+    std::vector<simplug_vtable *> expected = { &_pokey, &_recorder };
+    EXPECT_EQ(expected, destinations(G_MIP_FLAP_ID, _prepare3dOwner));
+
+    for (const Route &route : _table.routes(G_MIP_FLAP_ID)) {
+        EXPECT_EQ(G_MIP_FLAP_LEFT_ID, route.target);
+    }
+}
+
+TEST(RoutingTableLimitTest, TableHoldsAFixedNumberOfPlugins)
+{
+    RoutingTable table;
+    simplug_vtable methods;
+
+    for (int i = 1; i < ROUTING_MAX_PLUGINS; i++) {
+        EXPECT_EQ(i, table.addPlugin("plugin", &methods));
+    }
+
+    EXPECT_EQ(EVENT_OWNER_NONE, table.addPlugin("one too many", &methods));
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "plugins/pokey/SegmentDisplay/SegmentDisplay.h"
+
+TEST(SegmentDisplayTest, RendersGroups)
+{
+    uint8_t data[SEGMENT_DISPLAY_DIGITS];
+
+    memset(data, 0xAA, sizeof(data));
+
+    SegmentDisplay::RenderGroup(275, 1, 4, data);
+    EXPECT_EQ(0xAA, data[0]);
+    EXPECT_EQ(SegmentDisplay::Digits[2], data[1]);
+    EXPECT_EQ(SegmentDisplay::Digits[7], data[2]);
+    EXPECT_EQ(SegmentDisplay::Digits[5], data[3]);
+    EXPECT_EQ(0, data[4]);
+    EXPECT_EQ(0xAA, data[5]);
+
+    // a shorter value doesn't leave digits of the longer one behind
+    SegmentDisplay::RenderGroup(9, 1, 4, data);
+    EXPECT_EQ(SegmentDisplay::Digits[9], data[1]);
+    EXPECT_EQ(0, data[2]);
+    EXPECT_EQ(0, data[3]);
+
+    // zero sits on the rightmost digit
+    SegmentDisplay::RenderGroup(0, 1, 4, data);
+    EXPECT_EQ(0, data[1]);
+    EXPECT_EQ(SegmentDisplay::Digits[0], data[4]);
+
+    // negative values are shown as positive
+    SegmentDisplay::RenderGroup(-42, 1, 4, data);
+    EXPECT_EQ(SegmentDisplay::Digits[4], data[1]);
+    EXPECT_EQ(SegmentDisplay::Digits[2], data[2]);
+
+    // too long for the group, left as it was
+    SegmentDisplay::RenderGroup(12345, 1, 4, data);
+    EXPECT_EQ(SegmentDisplay::Digits[4], data[1]);
+
+    SegmentDisplay::RenderGroup(SEGMENT_BLANK, 1, 4, data);
+    EXPECT_EQ(0, data[1]);
+    EXPECT_EQ(0, data[2]);
+    EXPECT_EQ(0xAA, data[5]);
+}
+
+TEST(SegmentDisplayTest, LatestStagedValueWins)
+{
+    SegmentDisplay display;
+    uint8_t data[SEGMENT_DISPLAY_DIGITS] = { 0 };
+
+    display.addGroup(0, 0, 3);
+    display.addGroup(3, 3, 5);
+
+    EXPECT_FALSE(display.render(data));
+
+    // only the first value of a frame needs to wake the refresh
+    EXPECT_TRUE(display.set(0, 1));
+    EXPECT_FALSE(display.set(0, 2));
+    EXPECT_FALSE(display.set(0, 360));
+    EXPECT_FALSE(display.set(3, 12000));
+
+    EXPECT_TRUE(display.render(data));
+    EXPECT_FALSE(display.dirty());
+
+    EXPECT_EQ(SegmentDisplay::Digits[3], data[0]);
+    EXPECT_EQ(SegmentDisplay::Digits[6], data[1]);
+    EXPECT_EQ(SegmentDisplay::Digits[0], data[2]);
+    EXPECT_EQ(SegmentDisplay::Digits[1], data[3]);
+    EXPECT_EQ(SegmentDisplay::Digits[2], data[4]);
+
+    EXPECT_EQ(4, display.updates());
+    EXPECT_EQ(1, display.renders());
+
+    // unconfigured groups are ignored
+    EXPECT_FALSE(display.set(5, 1));
+    EXPECT_FALSE(display.dirty());
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "sustain/sustainscheduler.h"
+
+static EventValue makeValue(ElementID id, int64_t value)
+{
+    EventValue event;
+    memset(&event, 0, sizeof(EventValue));
+    event.elementId = id;
+    event.type = INT_ATTRIBUTE;
+    event.value.int_value = value;
+    event.timestamp = EventTimestampNow();
+    return event;
+}
+
+//! collects what the scheduler resends
+class Resent
+{
+public:
+    std::mutex mutex;
+    std::vector<EventValue> values;
+
+    SustainFunction function(void)
+    {
+        return [this](const EventValue &value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            values.push_back(value);
+        };
+    }
+
+    size_t count(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return values.size();
+    }
+};
+
+TEST(SustainSchedulerTest, ResendsAfterThePeriod)
+{
+    Resent resent;
+    SustainScheduler scheduler(resent.function());
+    EventValue value = makeValue(3, 42);
+
+    scheduler.start();
+    scheduler.update(value, 20);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(110));
+    scheduler.stop();
+
+    // once per period, give or take scheduling
+    EXPECT_GE(resent.count(), 3u);
+    EXPECT_LE(resent.count(), 6u);
+    EXPECT_EQ(1u, scheduler.sustainedCount());
+
+    ASSERT_FALSE(resent.values.empty());
+    EXPECT_EQ(3u, resent.values[0].elementId);
+    EXPECT_EQ(42, resent.values[0].value.int_value);
+    EXPECT_GE(resent.values[0].timestamp, value.timestamp + 20000000);
+}
+
+TEST(SustainSchedulerTest, NewerValuesPostponeTheResend)
+{
+    Resent resent;
+    SustainScheduler scheduler(resent.function());
+
+    scheduler.start();
+
+    for (int i = 0; i < 10; i++) {
+        scheduler.update(makeValue(1, i), 50);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_EQ(0u, resent.count());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    scheduler.stop();
+
+    ASSERT_GE(resent.count(), 1u);
+    EXPECT_EQ(9, resent.values[0].value.int_value);
+}
+
+TEST(SustainSchedulerTest, ZeroPeriodStopsSustaining)
+{
+    Resent resent;
+    SustainScheduler scheduler(resent.function());
+
+    scheduler.start();
+    scheduler.update(makeValue(1, 1), 20);
+    scheduler.setPeriod(1, 0);
+
+    // a period for an element without a value is kept for its first value
+    scheduler.setPeriod(2, 20);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    scheduler.stop();
+
+    EXPECT_EQ(0u, resent.count());
+    EXPECT_EQ(0u, scheduler.sustainedCount());
+}
+
+TEST(SustainSchedulerTest, IdleWithoutSustainedElements)
+{
+    Resent resent;
+    SustainScheduler scheduler(resent.function());
+
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.stop();
+
+    EXPECT_EQ(0u, scheduler.wakeCount());
+}
+
+TEST(SustainSchedulerTest, ScalesToManyElements)
+{
+    Resent resent;
+    SustainScheduler scheduler(resent.function());
+
+    for (ElementID id = 1; id <= 2000; id++) {
+        scheduler.update(makeValue(id, id), 30);
+    }
+
+    scheduler.start();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.stop();
+
+    EXPECT_EQ(2000u, scheduler.sustainedCount());
+    EXPECT_GE(resent.count(), 2000u);
+
+    // wakes follow the deadlines, not the element count
+    EXPECT_LT(scheduler.wakeCount(), 200u);
+}
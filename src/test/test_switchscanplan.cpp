@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "plugins/pokey/drivers/PokeySwitchMatrixManager/SwitchScanPlan.h"
+
+static PinMaskMap maskOf(std::map<std::string, size_t> positions)
+{
+    PinMaskMap mask;
+
+    for (auto &position : positions) {
+        mask[position.first] = std::make_shared<std::pair<size_t, int>>(position.second, 0);
+    }
+
+    return mask;
+}
+
+TEST(SwitchScanPlanTest, SplitsPartialAndStandaloneSwitches)
+{
+    SwitchScanPlan plan;
+    PinMaskMap mask = maskOf({ { "SW_A", 0 }, { "SW_C", 1 } });
+    std::map<int, std::string> transforms;
+
+    plan.addVirtualPin("MODE", 1, mask, transforms);
+    EXPECT_FALSE(plan.compiled());
+
+    plan.compile({ "SW_A", "SW_B", "SW_C", "SW_D" }, { 2, 3, 4, 5 });
+    EXPECT_TRUE(plan.compiled());
+
+    EXPECT_EQ(std::vector<size_t>({ 0, 2 }), plan.partialSwitches());
+    EXPECT_EQ(std::vector<size_t>({ 1, 3 }), plan.standaloneSwitches());
+
+    // the ids resolved at configure time are reported without a lookup
+    EXPECT_EQ(3u, plan.switchElementId(1));
+    EXPECT_EQ(5u, plan.switchElementId(3));
+    EXPECT_EQ(1u, plan.virtualPinElementId(0));
+}
+
+TEST(SwitchScanPlanTest, PacksSwitchesIntoVirtualPinValue)
+{
+    SwitchScanPlan plan;
+    PinMaskMap mask = maskOf({ { "SW_A", 0 }, { "SW_B", 1 } });
+    std::map<int, std::string> transforms = { { 0, "OFF" }, { 1, "LOW" }, { 3, "HIGH" } };
+
+    plan.addVirtualPin("MODE", 1, mask, transforms);
+    plan.compile({ "SW_A", "SW_B" }, { 2, 3 });
+
+    EXPECT_FALSE(plan.virtualPinChanged(0));
+    EXPECT_EQ("OFF", plan.transformedValue(0));
+
+    plan.setSwitchValue(0, true);
+    EXPECT_TRUE(plan.virtualPinChanged(0));
+    EXPECT_FALSE(plan.virtualPinChanged(0));
+    EXPECT_EQ("LOW", plan.transformedValue(0));
+
+    plan.setSwitchValue(1, true);
+    EXPECT_EQ(3u, plan.virtualPinValue(0));
+    EXPECT_TRUE(plan.virtualPinChanged(0));
+    EXPECT_EQ("HIGH", plan.transformedValue(0));
+
+    // no transform configured for 2
+    plan.setSwitchValue(0, false);
+    EXPECT_TRUE(plan.virtualPinChanged(0));
+    EXPECT_EQ("", plan.transformedValue(0));
+
+    // flipping back within one scan isn't a change
+    plan.setSwitchValue(0, true);
+    plan.setSwitchValue(0, false);
+    EXPECT_FALSE(plan.virtualPinChanged(0));
+}
+
+TEST(SwitchScanPlanTest, SwitchFeedsEveryVirtualPinItBelongsTo)
+{
+    SwitchScanPlan plan;
+    PinMaskMap first = maskOf({ { "SW_A", 0 } });
+    PinMaskMap second = maskOf({ { "SW_A", 2 }, { "SW_B", 0 } });
+    std::map<int, std::string> transforms;
+
+    plan.addVirtualPin("FIRST", 1, first, transforms);
+    plan.addVirtualPin("SECOND", 2, second, transforms);
+    plan.compile({ "SW_A", "SW_B" }, { 3, 4 });
+
+    ASSERT_EQ(2u, plan.virtualPinCount());
+    EXPECT_EQ("FIRST", plan.virtualPinName(0));
+
+    plan.setSwitchValue(0, true);
+    EXPECT_EQ(1u, plan.virtualPinValue(0));
+    EXPECT_EQ(4u, plan.virtualPinValue(1));
+
+    // reconfiguring a virtual pin replaces it and stales the plan
+    PinMaskMap replacement = maskOf({ { "SW_B", 1 } });
+    plan.addVirtualPin("FIRST", 1, replacement, transforms);
+    EXPECT_FALSE(plan.compiled());
+    EXPECT_EQ(2u, plan.virtualPinCount());
+
+    plan.compile({ "SW_A", "SW_B" }, { 3, 4 });
+    plan.setSwitchValue(1, true);
+    EXPECT_EQ(2u, plan.virtualPinValue(0));
+    EXPECT_EQ(5u, plan.virtualPinValue(1));
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "telemetry/telemetryencoder.h"
+
+static EventValue makeValue(ElementID id, uint8_t type)
+{
+    EventValue event;
+    memset(&event, 0, sizeof(EventValue));
+    event.elementId = id;
+    event.type = type;
+    event.timestamp = EventTimestampNow();
+    return event;
+}
+
+//! the ts field of a JSON record
+static std::string timestampOf(const std::string &record)
+{
+    size_t start = record.find("\"ts\":\"") + 6;
+    return record.substr(start, record.find('"', start) - start);
+}
+
+TEST(TelemetryEncoderTest, EncodesJSON)
+{
+    ElementSymbolTable symbols(8);
+    EventStringTable strings(8);
+    TelemetryEncoder encoder(symbols, strings);
+    std::string record;
+
+    EventValue volts = makeValue(symbols.intern("N_ELEC_PANEL_LOWER_LEFT"), INT_ATTRIBUTE);
+    volts.value.int_value = -28;
+
+    encoder.encode(volts, record);
+
+    EXPECT_EQ("{\"s\":\"N_ELEC_PANEL_LOWER_LEFT\",\"val\":\"-28\",\"ts\":\"" + timestampOf(record) + "\",\"d\":\"none\",\"u\":\"none\"}", record);
+    EXPECT_EQ(std::to_string(EventTimestampToEpochMs(volts.timestamp)), timestampOf(record));
+
+    EventValue speed = makeValue(symbols.intern("N_SPEED"), FLOAT_ATTRIBUTE);
+    speed.value.float_value = 250.5f;
+    encoder.encode(speed, record);
+    EXPECT_NE(std::string::npos, record.find("\"val\":\"250.5\""));
+
+    EventValue lights = makeValue(symbols.intern("I_LIGHTS"), BOOL_ATTRIBUTE);
+    lights.value.bool_value = true;
+    encoder.encode(lights, record);
+    EXPECT_NE(std::string::npos, record.find("\"val\":\"1\""));
+}
+
+TEST(TelemetryEncoderTest, EscapesStrings)
+{
+    ElementSymbolTable symbols(8);
+    EventStringTable strings(8);
+    TelemetryEncoder encoder(symbols, strings);
+    std::string record;
+
+    EventValue mode = makeValue(symbols.intern("S_\"MODE\""), STRING_ATTRIBUTE);
+    EventValueSetString(mode, "A\\B\n", strings);
+
+    encoder.encode(mode, record);
+
+    EXPECT_EQ(0u, record.find("{\"s\":\"S_\\\"MODE\\\"\",\"val\":\"A\\\\B\\n\""));
+}
+
+TEST(TelemetryEncoderTest, FormatsIntegers)
+{
+    std::string out;
+
+    TelemetryEncoder::AppendInteger(out, 0);
+    out += ",";
+    TelemetryEncoder::AppendInteger(out, INT64_MIN);
+    out += ",";
+    TelemetryEncoder::AppendInteger(out, INT64_MAX);
+
+    EXPECT_EQ("0,-9223372036854775808,9223372036854775807", out);
+}
+
+TEST(TelemetryEncoderTest, EncodesBinary)
+{
+    ElementSymbolTable symbols(8);
+    EventStringTable strings(8);
+    TelemetryEncoder encoder(symbols, strings, TELEMETRY_BINARY);
+    std::string record;
+
+    EventValue heading = makeValue(symbols.intern("N_HDG"), INT_ATTRIBUTE);
+    heading.value.int_value = 0x0102;
+
+    encoder.encode(heading, record);
+
+    // tag, name, type, 8 byte value, 8 byte timestamp
+    ASSERT_EQ(1u + 2u + 5u + 1u + 8u + 8u, record.size());
+    EXPECT_EQ(TELEMETRY_SCHEMA_EVENT, (uint8_t)record[0]);
+    EXPECT_EQ(5, record[1]);
+    EXPECT_EQ(0, record[2]);
+    EXPECT_EQ("N_HDG", record.substr(3, 5));
+    EXPECT_EQ(INT_ATTRIBUTE, record[8]);
+    EXPECT_EQ(0x02, record[9]);
+    EXPECT_EQ(0x01, record[10]);
+
+    int64_t timestamp = 0;
+
+    for (int i = 0; i < 8; i++) {
+        timestamp |= (int64_t)(uint8_t)record[17 + i] << (i * 8);
+    }
+
+    EXPECT_EQ(EventTimestampToEpochMs(heading.timestamp), timestamp);
+
+    EventValue mode = makeValue(symbols.intern("S_MODE"), STRING_ATTRIBUTE);
+    EventValueSetString(mode, "HDG", strings);
+
+    encoder.encode(mode, record);
+
+    EXPECT_EQ(1u + 2u + 6u + 1u + 2u + 3u + 8u, record.size());
+    EXPECT_EQ("HDG", record.substr(12, 3));
+}
+
+TEST(TelemetryEncoderTest, SharesFragmentsBetweenThreads)
+{
+    ElementSymbolTable symbols(64);
+    EventStringTable strings(8);
+    TelemetryEncoder encoder(symbols, strings);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 32; i++) {
+        symbols.intern("N_ELEMENT_" + std::to_string(i));
+    }
+
+    for (int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([&] {
+            std::string record;
+
+            for (ElementID id = 1; id <= 32; id++) {
+                EventValue value = makeValue(id, INT_ATTRIBUTE);
+                encoder.encode(value, record);
+                EXPECT_EQ(0u, record.find("{\"s\":\"" + symbols.name(id) + "\""));
+            }
+        }));
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}